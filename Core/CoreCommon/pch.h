@@ -22,6 +22,8 @@
 #include "mem_helpers.h"
 #include "StrHelper.h"
 #include "cvector.h"
+#include "scratch_arena.h"
+#include "job_system.h"
 #include "Types.h"
 #include "file_system.h"
 #include "FileSystemPaths.h"
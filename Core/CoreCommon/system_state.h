@@ -71,6 +71,10 @@ struct SystemState
 
     uint32 numDrawnEnttsInstances   = 0;        // the number of rendered entities instances
     uint32 numDrawCallsEnttsInstances = 0;      // the number of draw calls for all entities
+    uint32 numReusedRenderItems     = 0;        // render items which are kept from the prev frame
+    uint32 numRebuiltRenderItems    = 0;        // render items which are prepared from scratch
+    uint32 numDrawnGrassInstances   = 0;        // after thinning by distance and instances budget
+    uint32 grassResidentMemKB       = 0;        // memory of instances of grass cells around the camera
 
     float deltaTime = 0.0f;                     // seconds per last frame
     float frameTime = 0.0f;                     // ms per last frame
@@ -11,6 +11,7 @@
 
 #include "../Texture/texture_mgr.h"
 #include "../Model/model_mgr.h"
+#include "../Model/asset_streamer.h"
 #include "../Sound/sound_mgr.h"
 
 #include <psapi.h>
@@ -54,6 +55,8 @@ Engine::~Engine()
     }
 
     imGuiLayer_.Shutdown();
+    g_AssetStreamer.Shutdown();     // wait for streaming jobs before workers are stopped
+    g_JobSystem.Shutdown();
 
     LogMsg(LOG, "the engine is shut down successfully");
 }
@@ -102,6 +105,9 @@ void Engine::Init(
     if (!IsDebuggerPresent())
         SetUnhandledExceptionFilter(UnhandleExceptionFilter);
 
+    // JOBS: start worker threads (one per hardware thread except the main one)
+    g_JobSystem.Init();
+
     // WINDOW: store a handle to the application instance
     hInstance_      = hInstance;  
     hwnd_           = mainWnd;
@@ -241,6 +247,10 @@ void Engine::Update(const float dt, const float gameTime)
 
     pUserInterface_->Update(systemState_);
     keyboard_.Update();
+
+    // the editor could change transforms of entities after the ECS update
+    pEnttMgr_->UpdateDirtyTransforms();
+
     graphics_.Update(dt, gameTime);
 
     g_ModelMgr.Update(dt);
@@ -36,6 +36,7 @@ MaterialMgr::MaterialMgr()
         constexpr size newCapacity = 128;
         ids_.reserve(newCapacity);
         materials_.reserve(newCapacity);
+        idsByNames_.Reserve(newCapacity);
     }
     else
     {
@@ -105,6 +106,8 @@ Material& MaterialMgr::AddMaterial(const char* matName)
     newMat.id = id;
     newMat.shaderId = DEFAULT_SHADER_ID;
 
+    idsByNames_.Insert(HashStr(newMat.name), id);
+
     return newMat;
 }
 
@@ -135,6 +138,8 @@ MaterialID MaterialMgr::AddMaterial(const Material& material)
     if (mat.shaderId == INVALID_SHADER_ID)
         mat.shaderId = DEFAULT_SHADER_ID;
 
+    idsByNames_.Insert(HashStr(mat.name), id);
+
     return id;
 }
 
@@ -157,6 +162,8 @@ MaterialID MaterialMgr::AddMaterial(Material&& material)
     if (mat.shaderId == INVALID_SHADER_ID)
         mat.shaderId = DEFAULT_SHADER_ID;
 
+    idsByNames_.Insert(HashStr(mat.name), id);
+
     return id;
 }
 
@@ -234,11 +241,10 @@ Material& MaterialMgr::GetMatByName(const char* name)
     }
 
     // find a material by name
-    for (Material& mat : materials_)
-    {
-        if (strcmp(mat.name, name) == 0)
-            return mat;
-    }
+    const MaterialID id = GetMatIdByName(name);
+
+    if (id != INVALID_MAT_ID)
+        return materials_[ids_.get_idx(id)];
 
     LogErr(LOG, "there is no material by name: %s", name);
     return materials_[INVALID_MAT_ID];
@@ -291,13 +297,15 @@ MaterialID MaterialMgr::GetMatIdByName(const char* name) const
         return INVALID_MAT_ID;
     }
 
-    for (index i = 0; i < materials_.size(); ++i)
+    MaterialID id = INVALID_MAT_ID;
+
+    auto isEqual = [this, name](const MaterialID matId)
     {
-        if (strcmp(materials_[i].name, name) == 0)
-            return ids_[i];
-    }
+        return strcmp(materials_[ids_.get_idx(matId)].name, name) == 0;
+    };
 
-    return INVALID_MAT_ID;
+    idsByNames_.Find(HashStr(name), isEqual, id);
+    return id;
 }
 
 //---------------------------------------------------------
@@ -11,6 +11,7 @@
 #include "material.h"
 #include <Types.h>
 #include <cvector.h>
+#include <str_hash_index.h>
 
 namespace Core
 {
@@ -50,6 +51,7 @@ public:
 private:
     cvector<MaterialID> ids_;
     cvector<Material>   materials_;
+    StrHashIndex        idsByNames_;    // hash index [name => material ID]
 
     cvector<index>      idxs_;
 
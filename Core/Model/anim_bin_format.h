@@ -0,0 +1,133 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: anim_bin_format.h
+    Desc:     layout of the binary skeleton/animations file (.animb); the file
+              is memory mapped and its blocks are copied into the skeleton
+              as is (without any parsing):
+
+              [header][chunk table][chunk 0][chunk 1]...[chunk N-1]
+
+              - header has a magic number, version and the total file size;
+              - chunk table describes each chunk (id, offset, size, count);
+              - each chunk starts at offset aligned to ANIM_BIN_ALIGNMENT;
+              - animations are stored as compressed tracks (look at
+                animation_compression.h) so they aren't rebuilt after loading;
+              - strings (names) are kept in the string table chunk and
+                referred by offsets inside of this chunk;
+              - all the values are little-endian
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <Types.h>
+#include <DirectXMath.h>
+#include "animation_compression.h"
+#include "animation_helper.h"
+
+
+namespace Core
+{
+
+#define ANIM_BIN_FOURCC(a, b, c, d) \
+    ((uint32)(a) | ((uint32)(b) << 8) | ((uint32)(c) << 16) | ((uint32)(d) << 24))
+
+constexpr uint32 ANIM_BIN_MAGIC     = ANIM_BIN_FOURCC('D', 'E', 'A', 'B');
+constexpr uint32 ANIM_BIN_VERSION   = 1;
+constexpr uint32 ANIM_BIN_ALIGNMENT = 16;
+constexpr char   ANIM_BIN_EXT[]     = ".animb";
+
+enum eAnimBinChunk : uint32
+{
+    ANIM_BIN_CHUNK_INFO      = ANIM_BIN_FOURCC('I', 'N', 'F', 'O'),   // AnimBinInfo     [1]
+    ANIM_BIN_CHUNK_BONES     = ANIM_BIN_FOURCC('B', 'O', 'N', 'E'),   // AnimBinBone     [numBones]
+    ANIM_BIN_CHUNK_WEIGHTS   = ANIM_BIN_FOURCC('W', 'G', 'H', 'T'),   // VertexBoneData  [numVertices]
+    ANIM_BIN_CHUNK_CLIPS     = ANIM_BIN_FOURCC('C', 'L', 'I', 'P'),   // AnimBinClip     [numAnimations]
+    ANIM_BIN_CHUNK_TRACKS    = ANIM_BIN_FOURCC('T', 'R', 'C', 'K'),   // AnimBinTrack    [numAnimations * numBones]
+    ANIM_BIN_CHUNK_KEY_FRAME = ANIM_BIN_FOURCC('K', 'F', 'R', 'M'),   // uint16          [numKeys]
+    ANIM_BIN_CHUNK_KEY_POS   = ANIM_BIN_FOURCC('K', 'P', 'O', 'S'),   // QuantPos        [numKeys]
+    ANIM_BIN_CHUNK_KEY_ROT   = ANIM_BIN_FOURCC('K', 'R', 'O', 'T'),   // QuantQuat       [numKeys]
+    ANIM_BIN_CHUNK_STRINGS   = ANIM_BIN_FOURCC('S', 'T', 'R', 'S'),   // char            [size] (null-terminated strings)
+};
+
+// align offset of chunk in the file
+inline size_t AnimBinAlign(const size_t offset)
+{
+    return (offset + ANIM_BIN_ALIGNMENT - 1) & ~((size_t)ANIM_BIN_ALIGNMENT - 1);
+}
+
+//---------------------------------------------------------
+
+struct AnimBinHeader
+{
+    uint32 magic            = ANIM_BIN_MAGIC;
+    uint32 version          = ANIM_BIN_VERSION;
+    uint32 fileSize         = 0;        // total size of the file in bytes
+    uint32 numChunks        = 0;
+    uint32 chunkTableOffset = 0;        // offset of the first AnimBinChunk
+    uint32 reserved[3]      = { 0 };
+};
+
+struct AnimBinChunk
+{
+    uint32 id     = 0;                  // eAnimBinChunk
+    uint32 offset = 0;                  // from the beginning of the file
+    uint32 size   = 0;                  // in bytes
+    uint32 count  = 0;                  // number of elements
+};
+
+struct AnimBinInfo
+{
+    uint32 nameOffset    = 0;           // offset in the string table
+    uint32 numBones      = 0;
+    uint32 numVertices   = 0;           // number of vertices with bones weights
+    uint32 numAnimations = 0;
+    uint32 numKeys       = 0;           // total number of keys of all the animations
+    uint32 reserved[3]   = { 0 };
+};
+
+struct AnimBinBone
+{
+    uint32              nameOffset  = 0;        // offset in the string table
+    int32_t             parentIdx   = -1;
+    uint32              reserved[2] = { 0 };
+    DirectX::XMFLOAT4X4 bindTransform;          // to parent space (bind pose)
+    DirectX::XMFLOAT4X4 offset;                 // offset transform of the bone
+};
+
+struct AnimBinClip
+{
+    uint32 nameOffset  = 0;             // offset in the string table
+    float  framerate   = 0;
+    uint32 numFrames   = 0;
+    uint32 firstKey    = 0;             // idx of the first key of the clip in the keys chunks
+    uint32 numKeys     = 0;
+    uint32 reserved[3] = { 0 };
+};
+
+struct AnimBinTrack
+{
+    TrackRange range;                   // range of translations of the bone
+    uint32     firstKey = 0;            // relatively to the first key of the clip
+    uint32     numKeys  = 0;
+};
+
+static_assert(sizeof(AnimBinHeader)  == 32,  "the binary animation layout is changed: update ANIM_BIN_VERSION");
+static_assert(sizeof(AnimBinChunk)   == 16,  "the binary animation layout is changed: update ANIM_BIN_VERSION");
+static_assert(sizeof(AnimBinInfo)    == 32,  "the binary animation layout is changed: update ANIM_BIN_VERSION");
+static_assert(sizeof(AnimBinBone)    == 144, "the binary animation layout is changed: update ANIM_BIN_VERSION");
+static_assert(sizeof(AnimBinClip)    == 32,  "the binary animation layout is changed: update ANIM_BIN_VERSION");
+static_assert(sizeof(AnimBinTrack)   == 32,  "the binary animation layout is changed: update ANIM_BIN_VERSION");
+static_assert(sizeof(QuantPos)       == 6,   "the binary animation layout is changed: update ANIM_BIN_VERSION");
+static_assert(sizeof(QuantQuat)      == 6,   "the binary animation layout is changed: update ANIM_BIN_VERSION");
+static_assert(sizeof(VertexBoneData) == 32,  "the binary animation layout is changed: update ANIM_BIN_VERSION");
+
+} // namespace
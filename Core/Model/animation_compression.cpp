@@ -0,0 +1,178 @@
+// =================================================================================
+// Filename:   animation_compression.cpp
+// Desc:       key reduction and quantization of animation tracks
+//
+// Created:    17.10.2026  by DimaSkup
+// =================================================================================
+#include <CoreCommon/pch.h>
+#include "animation_compression.h"
+#include "animation_helper.h"
+
+using namespace DirectX;
+
+
+namespace Core
+{
+
+//---------------------------------------------------------
+// Desc:   compute min translation of keys and a scale for quantization
+//---------------------------------------------------------
+void CalcTrackRange(const Keyframe* keys, const int numKeys, TrackRange& outRange)
+{
+    assert(keys && numKeys > 0);
+
+    XMVECTOR minP = XMLoadFloat3(&keys[0].translation);
+    XMVECTOR maxP = minP;
+
+    for (int i = 1; i < numKeys; ++i)
+    {
+        const XMVECTOR p = XMLoadFloat3(&keys[i].translation);
+        minP = XMVectorMin(minP, p);
+        maxP = XMVectorMax(maxP, p);
+    }
+
+    const XMVECTOR scale = XMVectorScale(XMVectorSubtract(maxP, minP), 1.0f / 65535.0f);
+
+    XMStoreFloat3(&outRange.minP, minP);
+    XMStoreFloat3(&outRange.scale, scale);
+}
+
+//---------------------------------------------------------
+// Desc:   quantize a single component relatively to the range
+//---------------------------------------------------------
+static inline uint16 QuantizeComponent(const float val, const float minVal, const float scale)
+{
+    // all the keys have the same value
+    if (scale <= 0.0f)
+        return 0;
+
+    const float q = (val - minVal) / scale + 0.5f;
+    return (uint16)clampf(q, 0.0f, 65535.0f);
+}
+
+//---------------------------------------------------------
+
+QuantPos QuantizePos(const XMFLOAT3& p, const TrackRange& range)
+{
+    QuantPos q;
+    q.x = QuantizeComponent(p.x, range.minP.x, range.scale.x);
+    q.y = QuantizeComponent(p.y, range.minP.y, range.scale.y);
+    q.z = QuantizeComponent(p.z, range.minP.z, range.scale.z);
+    return q;
+}
+
+//---------------------------------------------------------
+// Desc:   "smallest three" quantization of rotation quaternion
+//---------------------------------------------------------
+QuantQuat QuantizeQuat(const XMFLOAT4& quat)
+{
+    XMFLOAT4 normQuat;
+    XMStoreFloat4(&normQuat, XMQuaternionNormalize(XMLoadFloat4(&quat)));
+
+    const float q[4] = { normQuat.x, normQuat.y, normQuat.z, normQuat.w };
+
+    // find the largest component (by absolute value)
+    int maxIdx = 0;
+
+    for (int k = 1; k < 4; ++k)
+    {
+        if (fabsf(q[k]) > fabsf(q[maxIdx]))
+            maxIdx = k;
+    }
+
+    // q and -q is the same rotation so make the largest component positive
+    // (then it can be restored as sqrt(1 - a^2 - b^2 - c^2))
+    const float sign = (q[maxIdx] < 0.0f) ? -1.0f : 1.0f;
+
+    // components are in range [-1/sqrt(2), 1/sqrt(2)] => [0, 32767]
+    uint64 bits  = (uint64)maxIdx << 45;
+    int    shift = 0;
+
+    for (int k = 0; k < 4; ++k)
+    {
+        if (k == maxIdx)
+            continue;
+
+        const float  normVal = (q[k] * sign + 0.70710678f) * (32767.0f / 1.41421356f) + 0.5f;
+        const uint64 val     = (uint64)clampf(normVal, 0.0f, 32767.0f);
+
+        bits  |= val << shift;
+        shift += 15;
+    }
+
+    QuantQuat out;
+    out.v[0] = (uint16)(bits);
+    out.v[1] = (uint16)(bits >> 16);
+    out.v[2] = (uint16)(bits >> 32);
+    return out;
+}
+
+//---------------------------------------------------------
+// Desc:   check if all the keys in range (first, last) can be restored by
+//         interpolation between the first and the last keys (as in runtime: lerp/nlerp)
+//---------------------------------------------------------
+static bool CanInterpolateKeys(const Keyframe* keys, const int first, const int last)
+{
+    // |dot(q0, q1)| >= cos(angle/2) where angle is the rotation error
+    const float    minCosHalfAngle = cosf(ANIM_ROT_TOLERANCE * 0.5f);
+    const float    sqrPosTolerance = ANIM_POS_TOLERANCE * ANIM_POS_TOLERANCE;
+
+    const XMVECTOR p0 = XMLoadFloat3(&keys[first].translation);
+    const XMVECTOR p1 = XMLoadFloat3(&keys[last].translation);
+    const XMVECTOR q0 = XMQuaternionNormalize(XMLoadFloat4(&keys[first].rotQuat));
+          XMVECTOR q1 = XMQuaternionNormalize(XMLoadFloat4(&keys[last].rotQuat));
+
+    // take the shortest arc
+    if (XMVectorGetX(XMVector4Dot(q0, q1)) < 0.0f)
+        q1 = XMVectorNegate(q1);
+
+    const float invNumFrames = 1.0f / (float)(last - first);
+
+    for (int i = first + 1; i < last; ++i)
+    {
+        const float    alpha = (float)(i - first) * invNumFrames;
+        const XMVECTOR p     = XMVectorLerp(p0, p1, alpha);
+        const XMVECTOR q     = XMQuaternionNormalize(XMVectorLerp(q0, q1, alpha));
+
+        const XMVECTOR origP = XMLoadFloat3(&keys[i].translation);
+        const XMVECTOR origQ = XMQuaternionNormalize(XMLoadFloat4(&keys[i].rotQuat));
+
+        const float sqrPosErr = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(p, origP)));
+        const float cosRotErr = fabsf(XMVectorGetX(XMVector4Dot(q, origQ)));
+
+        if ((sqrPosErr > sqrPosTolerance) || (cosRotErr < minCosHalfAngle))
+            return false;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:   greedy key reduction: extend a segment from the last kept key while
+//         all the keys inside of it can be restored by interpolation
+//---------------------------------------------------------
+void ReduceKeys(const Keyframe* keys, const int numKeys, cvector<uint16>& outKeptKeys)
+{
+    assert(keys && numKeys > 0);
+    assert(numKeys <= UINT16_MAX);
+
+    outKeptKeys.clear();
+    outKeptKeys.push_back(0);
+
+    int first = 0;
+
+    for (int last = 2; last < numKeys; ++last)
+    {
+        if (!CanInterpolateKeys(keys, first, last))
+        {
+            // the previous key can't be removed
+            first = last - 1;
+            outKeptKeys.push_back((uint16)first);
+        }
+    }
+
+    if (numKeys > 1)
+        outKeptKeys.push_back((uint16)(numKeys - 1));
+}
+
+} // namespace
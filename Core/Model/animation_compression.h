@@ -0,0 +1,127 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: animation_compression.h
+    Desc:     compression of animation tracks (is done once after loading/importing):
+
+              - key reduction: a key is removed if it can be restored by
+                interpolation between its neighbours within an error tolerance;
+              - translations: 16 bits per component relatively to the range
+                of translations of the bone (6 bytes per key instead of 12);
+              - rotations: "smallest three" - the largest component is dropped
+                (restored from the unit length), the other three components
+                are stored in 15 bits each + 2 bits for the idx of dropped
+                component (6 bytes per key instead of 16)
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <Types.h>
+#include <cvector.h>
+#include <DirectXMath.h>
+
+
+namespace Core
+{
+
+// forward declaration (pointer use only)
+struct Keyframe;
+
+// max error of restored keys when redundant keys are removed
+constexpr float ANIM_POS_TOLERANCE = 0.0005f;    // in units of the model
+constexpr float ANIM_ROT_TOLERANCE = 0.001f;     // in radians
+
+//---------------------------------------------------------
+// quantized translation of a single key
+//---------------------------------------------------------
+struct QuantPos
+{
+    uint16 x = 0;
+    uint16 y = 0;
+    uint16 z = 0;
+};
+
+//---------------------------------------------------------
+// quantized rotation quaternion of a single key (48 bits):
+// [0, 14] - a, [15, 29] - b, [30, 44] - c, [45, 46] - idx of the dropped component
+//---------------------------------------------------------
+struct QuantQuat
+{
+    uint16 v[3] = { 0, 0, 0 };
+};
+
+//---------------------------------------------------------
+// range of translations of a single bone:
+// translation = minP + quantized * scale
+//---------------------------------------------------------
+struct TrackRange
+{
+    DirectX::XMFLOAT3 minP  = { 0,0,0 };
+    DirectX::XMFLOAT3 scale = { 0,0,0 };
+};
+
+//---------------------------------------------------------
+// compression
+//---------------------------------------------------------
+void      CalcTrackRange(const Keyframe* keys, const int numKeys, TrackRange& outRange);
+QuantPos  QuantizePos   (const DirectX::XMFLOAT3& p, const TrackRange& range);
+QuantQuat QuantizeQuat  (const DirectX::XMFLOAT4& q);
+
+// output: idxs of keys which must be kept (the first and the last keys are always kept)
+void      ReduceKeys    (const Keyframe* keys, const int numKeys, cvector<uint16>& outKeptKeys);
+
+
+//---------------------------------------------------------
+// Desc:   restore translation of key (w == 1)
+//---------------------------------------------------------
+inline DirectX::XMVECTOR DecodePos(const QuantPos& p, const TrackRange& range)
+{
+    using namespace DirectX;
+
+    const XMVECTOR v     = XMVectorSet((float)p.x, (float)p.y, (float)p.z, 0.0f);
+    const XMVECTOR scale = XMLoadFloat3(&range.scale);
+    const XMVECTOR minP  = XMLoadFloat3(&range.minP);
+
+    return XMVectorSetW(XMVectorMultiplyAdd(v, scale, minP), 1.0f);
+}
+
+//---------------------------------------------------------
+// Desc:   restore rotation quaternion of key
+//---------------------------------------------------------
+inline DirectX::XMVECTOR DecodeQuat(const QuantQuat& q)
+{
+    // range of the smallest three components: [-1/sqrt(2), 1/sqrt(2)]
+    constexpr float scale  = 1.41421356f / 32767.0f;
+    constexpr float offset = -0.70710678f;
+
+    const uint64 bits =
+        ((uint64)q.v[0])       |
+        ((uint64)q.v[1] << 16) |
+        ((uint64)q.v[2] << 32);
+
+    const int   maxIdx = (int)((bits >> 45) & 0x3);
+    const float a      = (float)((bits      ) & 0x7FFF) * scale + offset;
+    const float b      = (float)((bits >> 15) & 0x7FFF) * scale + offset;
+    const float c      = (float)((bits >> 30) & 0x7FFF) * scale + offset;
+    const float sqrSum = a*a + b*b + c*c;
+    const float d      = (sqrSum < 1.0f) ? sqrtf(1.0f - sqrSum) : 0.0f;
+
+    // put the smallest three around the restored one
+    const float smallest[3] = { a, b, c };
+    float       r[4];
+
+    for (int k = 0, i = 0; k < 4; ++k)
+        r[k] = (k == maxIdx) ? d : smallest[i++];
+
+    return DirectX::XMVectorSet(r[0], r[1], r[2], r[3]);
+}
+
+} // namespace
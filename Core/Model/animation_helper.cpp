@@ -16,6 +16,7 @@
 #include <CoreCommon/pch.h>
 #include "animation_helper.h"
 #include <DirectXMath.h>
+#include <algorithm>        // for std::upper_bound
 #pragma warning (disable:4996)
 
 
@@ -23,13 +24,6 @@ namespace Core
 {
 
 using namespace DirectX;
-
-// static arrays for internal purposes
-cvector<XMMATRIX> s_ToParentTransforms;
-cvector<XMMATRIX> s_ToRootTransforms;
-
-
-
 //**********************************************************************************
 // SKELETON DEBUG TOOLS
 //**********************************************************************************
@@ -151,6 +145,12 @@ void AnimSkeleton::DumpKeyframes(const char* animName, const int boneId) const
 
 
     const AnimationClip& anim = animations_[animIdx];
+
+    if (anim.boneAnimations.empty())
+    {
+        LogErr(LOG, "keyframes of animation '%s' are already released", animName);
+        return;
+    }
     assert(boneId < anim.boneAnimations.size());
 
     const cvector<Keyframe>& keyframes    = anim.boneAnimations[boneId].keyframes;
@@ -195,87 +195,6 @@ Keyframe::Keyframe() :
 {
 }
 
-//---------------------------------------------------------
-// Desc:  interpolated bone animation between two keyframes nearest to input time
-//---------------------------------------------------------
-void BoneAnimation::Interpolate(
-    const float framerate,
-    const float t,
-    XMMATRIX& M) const
-{
-    if (t <= 0)
-    {
-        const Keyframe& frame = keyframes[0];
-
-        const XMVECTOR S = { 1,1,1 };
-        const XMVECTOR P = XMLoadFloat3(&frame.translation);
-        const XMVECTOR Q = XMLoadFloat4(&frame.rotQuat);
-
-        const XMVECTOR zero = { 0,0,0,1 };
-        M = XMMatrixAffineTransformation(S, zero, Q, P);
-        return;
-    }
-
-
-    const float frametime = 1.0f / framerate;
-    const float endTime = (float)keyframes.size() * frametime;
-
-    if (t >= endTime)
-    {
-        const Keyframe& frame = keyframes.back();
-
-        const XMVECTOR S = { 1,1,1 };
-        const XMVECTOR P = XMLoadFloat3(&frame.translation);
-        const XMVECTOR Q = XMLoadFloat4(&frame.rotQuat);
-
-        const XMVECTOR zero = { 0,0,0,1 };
-        M = XMMatrixAffineTransformation(S, zero, Q, P);
-    }
-
-    else
-    {
-        // calc 2 current frames and ...
-        const float animFrame = t * framerate;
-        const int   numFrames = (int)keyframes.size();
-        const int   frameIdxA = (int)floorf(animFrame);
-        const int   frameIdxB = (frameIdxA + 1) % numFrames;
-
-        assert(frameIdxA < numFrames&& frameIdxB < numFrames);
-
-        const Keyframe& frame0 = keyframes[frameIdxA];
-        const Keyframe& frame1 = keyframes[frameIdxB];
-
-#if 1
-        float t0 = frameIdxA * frametime;
-        float t1 = frameIdxB * frametime;
-#else
-        float t0 = frame0.timePos;
-        float t1 = frame1.timePos;
-#endif
-
-
-        // ... lerp time between them
-        //float lerpPercent = (t - frame0.timePos) / (frame1.timePos - frame0.timePos);
-        float lerpPercent = (t - t0) / (t1 - t0);
-        lerpPercent = clampf(lerpPercent, 0, 1);
-
-
-        // calc interpolated values
-        const XMVECTOR p0 = XMLoadFloat3(&frame0.translation);
-        const XMVECTOR p1 = XMLoadFloat3(&frame1.translation);
-
-        const XMVECTOR q0 = XMLoadFloat4(&frame0.rotQuat);
-        const XMVECTOR q1 = XMLoadFloat4(&frame1.rotQuat);
-
-        const XMVECTOR S = { 1,1,1 };
-        const XMVECTOR P = XMVectorLerp(p0, p1, lerpPercent);
-        const XMVECTOR Q = XMQuaternionSlerp(q0, q1, lerpPercent);
-
-        const XMVECTOR zero = { 0,0,0,1 };
-        M = XMMatrixAffineTransformation(S, zero, Q, P);
-    }
-}
-
 //---------------------------------------------------------
 // Desc:  find smallest start time over all bones in this clip
 //---------------------------------------------------------
@@ -300,31 +219,78 @@ float AnimationClip::GetEndTime() const
 //---------------------------------------------------------
 size AnimationClip::GetNumKeyframes() const
 {
-    size maxKeys = 0;
-
-    for (index i = 0; i < boneAnimations.size(); ++i)
-        maxKeys = max(maxKeys, boneAnimations[i].keyframes.size());
-
-    return maxKeys;
-
-    //assert(boneAnimations[0].keyframes.size() > 0);
-    //return boneAnimations[0].keyframes.size();
+    // keyframes could be already purged so use the number computed during building of tracks
+    return (size)numFrames;
 }
 
 //---------------------------------------------------------
-// Desc:  interpolate animation for each bone of this animation clip
+// Desc:  build compressed tracks from keyframes of all the bones:
+//        remove redundant keys and quantize the rest of them
 //---------------------------------------------------------
-void AnimationClip::Interpolate(const float t, cvector<XMMATRIX>& outBoneTransforms) const
+void AnimationClip::BuildTracks()
 {
-    for (index i = 0; i < boneAnimations.size(); ++i)
+    const size      numBones = boneAnimations.size();
+    cvector<uint16> keptKeys;
+
+    trackKeyFrames.clear();
+    trackPositions.clear();
+    trackRotations.clear();
+    trackRanges.resize(numBones);
+    trackFirstKey.resize(numBones);
+    trackNumKeys.resize(numBones);
+
+    numFrames = 0;
+
+    for (index i = 0; i < numBones; ++i)
     {
-        if (boneAnimations[i].keyframes.size() == 0)
+        const cvector<Keyframe>& keyframes = boneAnimations[i].keyframes;
+        const int                numKeys   = (int)keyframes.size();
+
+        trackFirstKey[i] = (uint32)trackKeyFrames.size();
+        trackNumKeys[i]  = 0;
+        trackRanges[i]   = TrackRange();
+
+        if (numKeys == 0)
             continue;
 
-        boneAnimations[i].Interpolate(framerate, t, outBoneTransforms[i]);
+        numFrames = max(numFrames, (uint32)numKeys);
+
+        CalcTrackRange(keyframes.data(), numKeys, trackRanges[i]);
+        ReduceKeys(keyframes.data(), numKeys, keptKeys);
+
+        for (const uint16 k : keptKeys)
+        {
+            trackKeyFrames.push_back(k);
+            trackPositions.push_back(QuantizePos(keyframes[k].translation, trackRanges[i]));
+            trackRotations.push_back(QuantizeQuat(keyframes[k].rotQuat));
+        }
+
+        trackNumKeys[i] = (uint32)keptKeys.size();
     }
 }
 
+//---------------------------------------------------------
+// Desc:  release source keyframes (tracks are used for sampling)
+//---------------------------------------------------------
+void AnimationClip::PurgeKeyframes()
+{
+    boneAnimations.purge();
+}
+
+//---------------------------------------------------------
+// Desc:  return memory size of compressed tracks (in bytes)
+//---------------------------------------------------------
+uint32 AnimationClip::GetTracksMemSize() const
+{
+    const size numKeys  = trackKeyFrames.size();
+    const size numBones = trackNumKeys.size();
+
+    const size keysSize  = numKeys  * (sizeof(uint16) + sizeof(QuantPos) + sizeof(QuantQuat));
+    const size bonesSize = numBones * (sizeof(TrackRange) + 2 * sizeof(uint32));
+
+    return (uint32)(keysSize + bonesSize);
+}
+
 //---------------------------------------------------------
 // Desc:  find an index of animation clip by input name
 //---------------------------------------------------------
@@ -505,45 +471,159 @@ void AnimSkeleton::Set(
 #endif
 
 //---------------------------------------------------------
-// Desc:  calculate all the bones transformation for animation clip
-//        by input name at particular time position
+// Desc:  build runtime tracks for each animation clip of this skeleton
+//---------------------------------------------------------
+void AnimSkeleton::BuildTracks()
+{
+    size numSrcKeys = 0;
+    size numKeys    = 0;
+    size memSize    = 0;
+
+    for (AnimationClip& clip : animations_)
+    {
+        for (const BoneAnimation& boneAnim : clip.boneAnimations)
+            numSrcKeys += boneAnim.keyframes.size();
+
+        clip.BuildTracks();
+
+        numKeys += clip.trackKeyFrames.size();
+        memSize += clip.GetTracksMemSize();
+    }
+
+    // raw keyframe: float timePos + float3 translation + float4 rotation
+    const size srcMemSize = numSrcKeys * sizeof(Keyframe);
+
+    LogMsg("skeleton '%s': anim keys %d => %d, memory %d KB => %d KB",
+        name_,
+        (int)numSrcKeys,
+        (int)numKeys,
+        (int)(srcMemSize >> 10),
+        (int)(memSize >> 10));
+}
+
+//---------------------------------------------------------
+// Desc:  release source keyframes of all the animation clips
+//---------------------------------------------------------
+void AnimSkeleton::PurgeKeyframes()
+{
+    for (AnimationClip& clip : animations_)
+        clip.PurgeKeyframes();
+}
+
+//---------------------------------------------------------
+// Desc:  check if source keyframes are still here (for saving)
+//---------------------------------------------------------
+bool AnimSkeleton::HasKeyframes() const
+{
+    for (const AnimationClip& clip : animations_)
+    {
+        if (clip.boneAnimations.empty() && clip.numFrames > 0)
+            return false;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:  sample translation and rotation of a single bone track:
+//        nlerp between two keys nearest to input time
+//        (before the first key and after the last one the track is clamped)
 //---------------------------------------------------------
-void AnimSkeleton::GetFinalTransforms(
+static inline XMMATRIX SampleBoneTrack(
+    const AnimationClip& clip,
+    const int boneIdx,
+    const float animFrame)
+{
+    const uint32  firstKey = clip.trackFirstKey[boneIdx];
+    const int     numKeys  = (int)clip.trackNumKeys[boneIdx];
+    const uint16* frames   = clip.trackKeyFrames.data() + firstKey;
+
+    int   keyA  = 0;
+    int   keyB  = 0;
+    float alpha = 0;
+
+    if (animFrame > 0)
+    {
+        // find the last key which frame <= animFrame (the first key is always at frame 0)
+        const uint16 frame = (uint16)min((int)animFrame, UINT16_MAX);
+
+        keyA = (int)(std::upper_bound(frames, frames + numKeys, frame) - frames) - 1;
+        keyB = min(keyA + 1, numKeys - 1);
+
+        // (after the last key both keys are the same)
+        if (keyA != keyB)
+            alpha = (animFrame - (float)frames[keyA]) / (float)(frames[keyB] - frames[keyA]);
+    }
+
+    const TrackRange& range = clip.trackRanges[boneIdx];
+
+    const XMVECTOR p0 = DecodePos(clip.trackPositions[firstKey + keyA], range);
+    const XMVECTOR p1 = DecodePos(clip.trackPositions[firstKey + keyB], range);
+    const XMVECTOR q0 = DecodeQuat(clip.trackRotations[firstKey + keyA]);
+          XMVECTOR q1 = DecodeQuat(clip.trackRotations[firstKey + keyB]);
+
+    // take the shortest arc: flip the second quaternion if necessary
+    const XMVECTOR isOpposite = XMVectorLess(XMVector4Dot(q0, q1), XMVectorZero());
+    q1 = XMVectorSelect(q1, XMVectorNegate(q1), isOpposite);
+
+    // nlerp: lerp + normalize is much cheaper than slerp and for
+    // neighbour keyframes the difference is negligible
+    const XMVECTOR T = XMVectorLerp(p0, p1, alpha);
+    const XMVECTOR Q = XMQuaternionNormalize(XMVectorLerp(q0, q1, alpha));
+
+    XMMATRIX M = XMMatrixRotationQuaternion(Q);
+    M.r[3]     = XMVectorSetW(T, 1.0f);
+
+    return M;
+}
+
+//---------------------------------------------------------
+// Desc:  calculate final transformations of all the bones
+//        for animation clip at particular time position
+// Args:  - animId:      animation clip idx
+//        - timePos:     time position in seconds
+// Out:   - outPalette:  arr of transposed matrices (at least GetNumBones() elements)
+//---------------------------------------------------------
+void AnimSkeleton::SamplePalette(
     const AnimationID animId,
     const float timePos,
-    cvector<XMMATRIX>& outFinalTransforms)
+    XMMATRIX* outPalette) const
 {
+    assert(outPalette);
+
     if (animId >= animations_.size())
     {
         LogErr(LOG, "input animation id (%d) is invalid (must be lower than %d)", (int)animId, (int)animations_.size());
         return;
     }
-    const AnimationClip& animation = animations_[animId];
 
-    // interpolate all the bones of this animation clip at the given time instance
-    const size numBones = GetNumBones();
-    s_ToParentTransforms = boneTransforms_;
-    animation.Interpolate(timePos, s_ToParentTransforms);
+    const AnimationClip& clip     = animations_[animId];
+    const int            numBones = (int)GetNumBones();
 
+    assert(numBones > 0 && numBones <= MAX_NUM_BONES_PER_CHARACTER);
+    assert(clip.trackNumKeys.size() == numBones && "tracks aren't built");
 
-    //
-    // traverse the hierarchy and transform all the bones to the root space
-    //
-    s_ToRootTransforms.resize(numBones, DirectX::XMMatrixIdentity());
-    assert(numBones > 0);
+    const float animFrame = timePos * clip.framerate;
 
-    for (index i = 0; i < numBones; ++i)
+    // bones to the root space transformations
+    XMMATRIX toRoot[MAX_NUM_BONES_PER_CHARACTER];
+
+    // NOTE: parent bone always goes before its children
+    for (int i = 0; i < numBones; ++i)
     {
         const int parentIdx = boneHierarchy_[i];
-        XMMATRIX& toRoot    = s_ToRootTransforms[i];
-        XMMATRIX& toParent  = s_ToParentTransforms[i];
+
+        // bones without keys stay in bind pose
+        const XMMATRIX toParent = (clip.trackNumKeys[i] == 0)
+            ? boneTransforms_[i]
+            : SampleBoneTrack(clip, i, animFrame);
 
         if (parentIdx >= 0)
-            toRoot = toParent * s_ToRootTransforms[parentIdx];
+            toRoot[i] = XMMatrixMultiply(toParent, toRoot[parentIdx]);
         else
-            toRoot = toParent;
+            toRoot[i] = toParent;
 
-        outFinalTransforms[i] = boneOffsets_[i] * toRoot;
+        outPalette[i] = XMMatrixTranspose(XMMatrixMultiply(boneOffsets_[i], toRoot[i]));
     }
 }
 
@@ -19,6 +19,7 @@
 #include <Mesh/vertex_buffer.h>
 #include <cvector.h>
 #include <DirectXMath.h>
+#include "animation_compression.h"
 
 
 
@@ -72,12 +73,11 @@ struct VertexBoneData
 // values inbetween two frames, we interpolate between the two
 // nearest keyframes that bound the time
 //
-// we assume an animation always has two keyframes
+// NOTE: keyframes are used for import/export, for sampling at
+//       runtime we use tracks of the animation clip (see below)
 //---------------------------------------------------------
 struct BoneAnimation
 {
-    void Interpolate(const float framerate, const float t, DirectX::XMMATRIX& M) const;
-
     cvector<Keyframe> keyframes;
 };
 
@@ -93,7 +93,11 @@ struct AnimationClip
 
     size GetNumKeyframes() const;
 
-    void Interpolate(const float t, cvector<DirectX::XMMATRIX>& boneTransforms) const;
+    // build compressed tracks from keyframes of bones
+    void BuildTracks();
+    void PurgeKeyframes();
+
+    uint32 GetTracksMemSize() const;
 
     uint                   id = 0;
 
@@ -101,7 +105,18 @@ struct AnimationClip
     //float                  endTime   = 0;
     float                  framerate = 0;         // num frames per second
 
-    cvector<BoneAnimation> boneAnimations;   // set of keyframes per each bone
+    uint32                 numFrames = 0;    // max number of frames per bone
+
+    cvector<BoneAnimation> boneAnimations;   // set of keyframes per each bone (can be purged after building of tracks)
+
+    // compressed tracks (SoA): keys of all the bones one after another,
+    // redundant keys are removed so each key has its frame idx
+    cvector<uint16>        trackKeyFrames;   // per key: frame idx
+    cvector<QuantPos>      trackPositions;   // per key: quantized translation
+    cvector<QuantQuat>     trackRotations;   // per key: quantized rotation quaternion
+    cvector<TrackRange>    trackRanges;      // per bone: range of translations
+    cvector<uint32>        trackFirstKey;    // per bone: idx of the first key in tracks
+    cvector<uint32>        trackNumKeys;     // per bone: number of keys (0 if the bone isn't animated)
 };
 
 
@@ -149,10 +164,20 @@ public:
         const cvector<AnimationClip>& animations);
 #endif
 
-    void GetFinalTransforms(
+    // build runtime tracks for all the animation clips (after loading/importing)
+    void BuildTracks();
+
+    // release source keyframes (after that the skeleton can't be saved)
+    void PurgeKeyframes();
+    bool HasKeyframes() const;
+
+    // calc final transforms of all the bones for animation clip at
+    // particular time position; output matrices are transposed (ready for GPU);
+    // is thread-safe so poses of different entities can be sampled in parallel
+    void SamplePalette(
         const AnimationID animId,
         const float timePos,
-        cvector<DirectX::XMMATRIX>& outFinalTransforms);
+        DirectX::XMMATRIX* outPalette) const;
 
 
     // for debug
@@ -153,6 +153,7 @@ void AnimationImporter::LoadSkeletonAnimations(
     {
         printf("Load bone hierarhy and animations for this skeleton\n");
         AddAnimationsToSkeleton(pScene, skeleton);
+        skeleton.BuildTracks();
     }
 
     // ... or just load only bones hierarchy
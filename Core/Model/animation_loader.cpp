@@ -2,6 +2,9 @@
 #include "animation_loader.h"
 #include "animation_helper.h"
 #include "animation_mgr.h"
+#include "animation_saver.h"
+#include "anim_bin_format.h"
+#include <mapped_file.h>
 
 #pragma warning (disable : 4996)
 #include <parse_helpers.h>      // helpers for parsing string buffers, or reading data from file
@@ -29,14 +32,101 @@ void LoadAnimation      (FILE* pFile, AnimSkeleton* pSkeleton, const char* buf,
 void LoadKeyframes      (FILE* pFile, Keyframe* keyframes, const int numFrames);
 void InitSkeletonBonesVB(AnimSkeleton* pSkeleton);
 
+// (defined in model_loader.cpp)
+void ReplaceFileExt      (const char* path, const char* ext, char* outPath, const int outSize);
+void GetCachePath        (const char* srcPath, const char* ext, char* outPath, const int outSize);
+bool CreateCacheDirFor   (const char* cachePath);
+bool IsBinaryUpToDate    (const char* srcPath, const char* binPath);
+
 
 //---------------------------------------------------------
 // Desc:  load a skeleton, its bones data, weights, and animations from file
-// Args:  - pSkeleton: skeleton to init
-//        - filename:  path to file
+// Args:  - filename:  path to file
 // Ret:   id of created skeleton (if zero it means that we failed for some reason)
 //---------------------------------------------------------
 SkeletonID AnimationLoader::Load(const char* filename)
+{
+    if (StrHelper::IsEmpty(filename))
+    {
+        LogErr(LOG, "empty filename");
+        return 0;
+    }
+
+    char skeletonName[MAX_LEN_SKELETON_NAME]{'\0'};
+    FileSys::GetFileStem(filename, skeletonName);
+
+    // skeleton has the same name as its file
+    SkeletonID    skeletonId = g_AnimationMgr.AddSkeleton(skeletonName);
+    AnimSkeleton& skeleton   = g_AnimationMgr.GetSkeleton(skeletonId);
+
+    if (!LoadData(filename, skeleton))
+        return 0;
+
+    InitGpuData(skeleton);
+    return skeletonId;
+}
+
+//---------------------------------------------------------
+// Desc:  create GPU resources of the skeleton: a vertex buffer
+//        which contains bones weights and ids
+// NOTE:  call it only on the owner thread
+//---------------------------------------------------------
+void AnimationLoader::InitGpuData(AnimSkeleton& skeleton)
+{
+    InitSkeletonBonesVB(&skeleton);
+}
+
+//---------------------------------------------------------
+// Desc:  read skeleton's bones data, weights, and animations from file;
+//        neither global managers nor GPU are touched here so skeletons
+//        can be loaded in parallel by worker threads
+//
+//        for a text .anim file we prefer its cached binary version (.animb) if it
+//        is up to date, otherwise the text is parsed and the binary file is
+//        created in the cache dir (look at GetCachePath)
+//
+// Args:  - filename:  path to file
+// Out:   - skeleton:  skeleton to init
+//---------------------------------------------------------
+bool AnimationLoader::LoadData(const char* filename, AnimSkeleton& skeleton)
+{
+    if (StrHelper::IsEmpty(filename))
+    {
+        LogErr(LOG, "empty filename");
+        return false;
+    }
+
+    const size_t pathLen  = strlen(filename);
+    const size_t extLen   = strlen(ANIM_BIN_EXT);
+    const bool   isBinary = (pathLen > extLen) && (strcmp(filename + pathLen - extLen, ANIM_BIN_EXT) == 0);
+
+    if (isBinary)
+        return LoadBinary(filename, skeleton);
+
+    char binPath[256]{ '\0' };
+    GetCachePath(filename, ANIM_BIN_EXT, binPath, sizeof(binPath));
+
+    if (IsBinaryUpToDate(filename, binPath) && LoadBinary(binPath, skeleton))
+        return true;
+
+    if (!LoadText(filename, skeleton))
+        return false;
+
+    // so next time we will load the skeleton without parsing
+    if (CreateCacheDirFor(binPath))
+    {
+        AnimationSaver saver;
+        saver.SaveBinary(&skeleton, binPath);
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:  convert a text .anim file into binary .animb file
+// Args:  - filename:  path to the .anim file
+//---------------------------------------------------------
+bool AnimationLoader::ConvertIntoBinary(const char* filename)
 {
     if (StrHelper::IsEmpty(filename))
     {
@@ -44,6 +134,25 @@ SkeletonID AnimationLoader::Load(const char* filename)
         return false;
     }
 
+    char binPath[256]{ '\0' };
+    ReplaceFileExt(filename, ANIM_BIN_EXT, binPath, sizeof(binPath));
+
+    AnimSkeleton skeleton;
+
+    if (!LoadText(filename, skeleton))
+        return false;
+
+    AnimationSaver saver;
+    return saver.SaveBinary(&skeleton, binPath);
+}
+
+//---------------------------------------------------------
+// Desc:  parse skeleton's data from the text .anim file
+//---------------------------------------------------------
+bool AnimationLoader::LoadText(const char* filename, AnimSkeleton& skeleton)
+{
+    assert(!StrHelper::IsEmpty(filename));
+
     FILE* pFile = fopen(filename, "r");
     if (!pFile)
     {
@@ -54,13 +163,6 @@ SkeletonID AnimationLoader::Load(const char* filename)
 
     LogMsg(LOG, "\n\n\nload skeleton and animations from file: %s", filename);
 
-    char skeletonName[MAX_LEN_SKELETON_NAME]{'\0'};
-    FileSys::GetFileStem(filename, skeletonName);
-
-    // skeleton has the same name as its file
-    SkeletonID    skeletonId = g_AnimationMgr.AddSkeleton(skeletonName);
-    AnimSkeleton& skeleton   = g_AnimationMgr.GetSkeleton(skeletonId);
-
     char buf[512];
     int numAnimations = 0;
     int numBones = 0;
@@ -122,11 +224,218 @@ SkeletonID AnimationLoader::Load(const char* filename)
         }
     }
 
-    // init vertex buffer which contains bones weights and ids
-    InitSkeletonBonesVB(&skeleton);
+    fclose(pFile);
+
+    // compress keyframes into tracks for sampling at runtime,
+    // source keyframes aren't needed anymore
+    skeleton.BuildTracks();
+    skeleton.PurgeKeyframes();
+
+    LogMsg("%sis loaded%s", YELLOW, RESET);
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:   (helper) find a chunk by id and check if its data
+//         is inside of the file and has expected size
+// Ret:    a ptr to the chunk's data or nullptr if something is wrong
+//---------------------------------------------------------
+static const void* GetAnimBinChunk(
+    const MappedFile& file,
+    const AnimBinChunk* chunks,
+    const uint32 numChunks,
+    const uint32 chunkId,
+    const size_t elemSize,
+    uint32& outCount)
+{
+    for (uint32 i = 0; i < numChunks; ++i)
+    {
+        const AnimBinChunk& chunk = chunks[i];
+
+        if (chunk.id != chunkId)
+            continue;
+
+        const bool isValid =
+            ((size_t)chunk.offset + chunk.size <= file.GetSize()) &&
+            (chunk.offset % ANIM_BIN_ALIGNMENT == 0) &&
+            ((size_t)chunk.count * elemSize == chunk.size);
+
+        if (!isValid)
+            return nullptr;
+
+        outCount = chunk.count;
+        return file.GetData() + chunk.offset;
+    }
+
+    return nullptr;
+}
+
+//---------------------------------------------------------
+// Desc:   load skeleton from the binary .animb file: the file is mapped into
+//         memory and its blocks are copied into the skeleton as is; animations
+//         are already compressed so tracks aren't rebuilt
+// Args:   - filename:  a path to the file (relatively to the working dir)
+// Out:    - skeleton:  skeleton to init
+//---------------------------------------------------------
+bool AnimationLoader::LoadBinary(const char* filename, AnimSkeleton& skeleton)
+{
+    assert(!StrHelper::IsEmpty(filename));
+
+    MappedFile file;
+
+    if (!file.Open(filename))
+    {
+        LogErr(LOG, "can't open a file for skeleton loading: %s", filename);
+        return false;
+    }
+
+    // check header and chunk table
+    const AnimBinHeader* pHeader = (const AnimBinHeader*)file.GetData();
+
+    if ((file.GetSize() < sizeof(AnimBinHeader)) ||
+        (pHeader->magic != ANIM_BIN_MAGIC) ||
+        (pHeader->version != ANIM_BIN_VERSION) ||
+        (pHeader->fileSize != file.GetSize()) ||
+        ((size_t)pHeader->chunkTableOffset + sizeof(AnimBinChunk) * pHeader->numChunks > file.GetSize()))
+    {
+        LogErr(LOG, "invalid header of binary skeleton file: %s", filename);
+        return false;
+    }
+
+    const AnimBinChunk* chunks    = (const AnimBinChunk*)(file.GetData() + pHeader->chunkTableOffset);
+    const uint32        numChunks = pHeader->numChunks;
+
+    uint32 numInfos     = 0;
+    uint32 numBones     = 0;
+    uint32 numVertices  = 0;
+    uint32 numClips     = 0;
+    uint32 numTracks    = 0;
+    uint32 numKeyFrames = 0;
+    uint32 numKeyPos    = 0;
+    uint32 numKeyRot    = 0;
+    uint32 strsSize     = 0;
+
+    const AnimBinInfo*    pInfo     = (const AnimBinInfo*)   GetAnimBinChunk(file, chunks, numChunks, ANIM_BIN_CHUNK_INFO,      sizeof(AnimBinInfo),    numInfos);
+    const AnimBinBone*    bones     = (const AnimBinBone*)   GetAnimBinChunk(file, chunks, numChunks, ANIM_BIN_CHUNK_BONES,     sizeof(AnimBinBone),    numBones);
+    const VertexBoneData* weights   = (const VertexBoneData*)GetAnimBinChunk(file, chunks, numChunks, ANIM_BIN_CHUNK_WEIGHTS,   sizeof(VertexBoneData), numVertices);
+    const AnimBinClip*    clips     = (const AnimBinClip*)   GetAnimBinChunk(file, chunks, numChunks, ANIM_BIN_CHUNK_CLIPS,     sizeof(AnimBinClip),    numClips);
+    const AnimBinTrack*   tracks    = (const AnimBinTrack*)  GetAnimBinChunk(file, chunks, numChunks, ANIM_BIN_CHUNK_TRACKS,    sizeof(AnimBinTrack),   numTracks);
+    const uint16*         keyFrames = (const uint16*)        GetAnimBinChunk(file, chunks, numChunks, ANIM_BIN_CHUNK_KEY_FRAME, sizeof(uint16),         numKeyFrames);
+    const QuantPos*       keyPos    = (const QuantPos*)      GetAnimBinChunk(file, chunks, numChunks, ANIM_BIN_CHUNK_KEY_POS,   sizeof(QuantPos),       numKeyPos);
+    const QuantQuat*      keyRot    = (const QuantQuat*)     GetAnimBinChunk(file, chunks, numChunks, ANIM_BIN_CHUNK_KEY_ROT,   sizeof(QuantQuat),      numKeyRot);
+    const char*           strs      = (const char*)          GetAnimBinChunk(file, chunks, numChunks, ANIM_BIN_CHUNK_STRINGS,   sizeof(char),           strsSize);
+
+    // empty chunks have no data so check their ptrs only if there are elements
+    bool isValid =
+        pInfo && strs &&
+        (numInfos == 1) &&
+        (bones     || numBones == 0) &&
+        (weights   || numVertices == 0) &&
+        (clips     || numClips == 0) &&
+        (tracks    || numTracks == 0) &&
+        ((keyFrames && keyPos && keyRot) || pInfo->numKeys == 0) &&
+        (numBones     == pInfo->numBones) &&
+        (numBones     <= MAX_NUM_BONES_PER_CHARACTER) &&
+        (numVertices  == pInfo->numVertices) &&
+        (numClips     == pInfo->numAnimations) &&
+        (numTracks    == numClips * numBones) &&
+        (numKeyFrames == pInfo->numKeys) &&
+        (numKeyPos    == pInfo->numKeys) &&
+        (numKeyRot    == pInfo->numKeys) &&
+        (strsSize > 0) && (strs[strsSize - 1] == '\0');
+
+    // check that parents go before children and keys of clips/tracks are inside of the file
+    for (uint32 i = 0; isValid && (i < numBones); ++i)
+        isValid = (bones[i].parentIdx < (int32_t)i);
+
+    for (uint32 animIdx = 0; isValid && (animIdx < numClips); ++animIdx)
+    {
+        const AnimBinClip& clip = clips[animIdx];
+        isValid = ((size_t)clip.firstKey + clip.numKeys <= pInfo->numKeys);
+
+        for (uint32 boneIdx = 0; isValid && (boneIdx < numBones); ++boneIdx)
+        {
+            const AnimBinTrack& track = tracks[animIdx * numBones + boneIdx];
+            isValid = ((size_t)track.firstKey + track.numKeys <= clip.numKeys);
+        }
+    }
+
+    if (!isValid)
+    {
+        LogErr(LOG, "invalid chunks of binary skeleton file: %s", filename);
+        return false;
+    }
+
+    // get a string from the string table by offset
+    auto getString = [strs, strsSize](const uint32 offset) -> const char*
+    {
+        return (offset < strsSize) ? strs + offset : "";
+    };
+
+
+    LogMsg(LOG, "load skeleton and animations from binary file: %s", filename);
+
+    // bones
+    skeleton.boneNames_.resize(numBones);
+    skeleton.boneHierarchy_.resize(numBones);
+    skeleton.boneTransforms_.resize(numBones);
+    skeleton.boneOffsets_.resize(numBones);
+
+    for (uint32 i = 0; i < numBones; ++i)
+    {
+        strncpy(skeleton.boneNames_[i].name, getString(bones[i].nameOffset), MAX_LEN_BONE_NAME - 1);
+
+        skeleton.boneHierarchy_[i]  = bones[i].parentIdx;
+        skeleton.boneTransforms_[i] = DirectX::XMLoadFloat4x4(&bones[i].bindTransform);
+        skeleton.boneOffsets_[i]    = DirectX::XMLoadFloat4x4(&bones[i].offset);
+    }
+
+    // bones weights per vertex
+    skeleton.vertexToBones.resize(numVertices);
+
+    if (numVertices > 0)
+        memcpy(skeleton.vertexToBones.data(), weights, sizeof(VertexBoneData) * numVertices);
+
+    // animations (tracks are already compressed)
+    skeleton.animNames_.resize(numClips);
+    skeleton.animations_.resize(numClips);
+
+    for (uint32 animIdx = 0; animIdx < numClips; ++animIdx)
+    {
+        const AnimBinClip&  src       = clips[animIdx];
+        const AnimBinTrack* srcTracks = tracks + animIdx * numBones;
+        AnimationClip&      dst       = skeleton.animations_[animIdx];
+
+        strncpy(skeleton.animNames_[animIdx].name, getString(src.nameOffset), MAX_LEN_ANIMATION_NAME - 1);
+
+        dst.id        = animIdx;
+        dst.framerate = src.framerate;
+        dst.numFrames = src.numFrames;
+
+        dst.trackKeyFrames.resize(src.numKeys);
+        dst.trackPositions.resize(src.numKeys);
+        dst.trackRotations.resize(src.numKeys);
+
+        if (src.numKeys > 0)
+        {
+            memcpy(dst.trackKeyFrames.data(), keyFrames + src.firstKey, sizeof(uint16)    * src.numKeys);
+            memcpy(dst.trackPositions.data(), keyPos    + src.firstKey, sizeof(QuantPos)  * src.numKeys);
+            memcpy(dst.trackRotations.data(), keyRot    + src.firstKey, sizeof(QuantQuat) * src.numKeys);
+        }
+
+        dst.trackRanges.resize(numBones);
+        dst.trackFirstKey.resize(numBones);
+        dst.trackNumKeys.resize(numBones);
+
+        for (uint32 boneIdx = 0; boneIdx < numBones; ++boneIdx)
+        {
+            dst.trackRanges[boneIdx]   = srcTracks[boneIdx].range;
+            dst.trackFirstKey[boneIdx] = srcTracks[boneIdx].firstKey;
+            dst.trackNumKeys[boneIdx]  = srcTracks[boneIdx].numKeys;
+        }
+    }
 
     LogMsg("%sis loaded%s", YELLOW, RESET);
-    fclose(pFile);
     return true;
 }
 
@@ -11,7 +11,16 @@
     Filename: animation_loader.h
 
     Desc:     load a skeleton, its bones, weights, and animations
-              from a file of engine's internal format
+              from a file of engine's internal format;
+
+              loading can be split into two steps (for parallel loading):
+              - LoadData:     parse the file into the skeleton (no GPU/managers
+                              are touched so it can be executed by worker threads);
+              - InitGpuData:  create GPU resources of the skeleton (owner thread)
+
+              a text .anim file is converted once into binary .animb file
+              (look at anim_bin_format.h) which is kept in the cache dir
+              and used at next loadings
 
     Created:  29.12.2025  by DimaSkup
 \**********************************************************************************/
@@ -22,10 +31,23 @@
 namespace Core
 {
 
+// forward declaration (pointer use only)
+class AnimSkeleton;
+
 class AnimationLoader
 {
 public:
     SkeletonID Load(const char* filename);
+
+    bool LoadData   (const char* filename, AnimSkeleton& skeleton);
+    void InitGpuData(AnimSkeleton& skeleton);
+
+    // convert a text .anim file into binary .animb file (next to the source file)
+    bool ConvertIntoBinary(const char* filename);
+
+private:
+    bool LoadText  (const char* filename, AnimSkeleton& skeleton);
+    bool LoadBinary(const char* filename, AnimSkeleton& skeleton);
 };
 
 } // namespace
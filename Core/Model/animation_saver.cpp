@@ -19,6 +19,7 @@
 #include <CoreCommon/pch.h>
 #include "animation_saver.h"
 #include "animation_helper.h"
+#include "anim_bin_format.h"
 
 #pragma warning (disable : 4996)
 
@@ -38,6 +39,7 @@ void WriteBaseframe      (FILE* pFile, const AnimSkeleton* pSkeleton);
 void WriteOffsets        (FILE* pFile, const AnimSkeleton* pSkeleton);
 void WriteWeights        (FILE* pFile, const AnimSkeleton* pSkeleton);
 void WriteAnimations     (FILE* pFile, const AnimSkeleton* pSkeleton);
+bool WriteAnimBinChunks  (FILE* pFile, const AnimBinHeader& header, const AnimBinChunk* chunks, const void* const* chunksData);
 
 
 //---------------------------------------------------------
@@ -55,6 +57,11 @@ bool AnimationSaver::Save(const AnimSkeleton* pSkeleton, const char* filename)
         LogErr(LOG, "can't save skeleton '%s' into file: path is empty", pSkeleton->GetName());
         return false;
     }
+    if (!pSkeleton->HasKeyframes())
+    {
+        LogErr(LOG, "can't save skeleton '%s': its keyframes are released after compression (only imported skeletons can be saved)", pSkeleton->GetName());
+        return false;
+    }
 
 
     FILE* pFile = fopen(filename, "w");
@@ -78,6 +85,166 @@ bool AnimationSaver::Save(const AnimSkeleton* pSkeleton, const char* filename)
     return true;
 }
 
+//---------------------------------------------------------
+// Desc:  save input skeleton, its bones, weights, and compressed animation
+//        tracks into a binary file (for the layout look at anim_bin_format.h)
+//---------------------------------------------------------
+bool AnimationSaver::SaveBinary(const AnimSkeleton* pSkeleton, const char* filename)
+{
+    if (!pSkeleton)
+    {
+        LogErr(LOG, "ptr to skeleton == nullptr");
+        return false;
+    }
+    if (StrHelper::IsEmpty(filename))
+    {
+        LogErr(LOG, "can't save skeleton '%s' into file: path is empty", pSkeleton->GetName());
+        return false;
+    }
+
+    const AnimSkeleton& skeleton = *pSkeleton;
+    const uint32        numBones = (uint32)skeleton.GetNumBones();
+    const uint32        numAnims = (uint32)skeleton.GetNumAnimations();
+
+    // string table: each string is referred by its offset in the table
+    cvector<char> strings;
+
+    auto addString = [&strings](const char* str) -> uint32
+    {
+        const uint32 offset = (uint32)strings.size();
+        const size_t len    = strlen(str);
+
+        strings.resize(offset + len + 1);
+        memcpy(strings.data() + offset, str, len + 1);
+        return offset;
+    };
+
+    AnimBinInfo info;
+    info.nameOffset    = addString(skeleton.GetName());
+    info.numBones      = numBones;
+    info.numVertices   = (uint32)skeleton.vertexToBones.size();
+    info.numAnimations = numAnims;
+
+    // bones
+    cvector<AnimBinBone> bones(numBones);
+
+    for (uint32 i = 0; i < numBones; ++i)
+    {
+        bones[i].nameOffset = addString(skeleton.boneNames_[i].name);
+        bones[i].parentIdx  = skeleton.boneHierarchy_[i];
+
+        XMStoreFloat4x4(&bones[i].bindTransform, skeleton.boneTransforms_[i]);
+        XMStoreFloat4x4(&bones[i].offset,        skeleton.boneOffsets_[i]);
+    }
+
+    // clips and tracks (keys of all the clips are stored one after another)
+    cvector<AnimBinClip>  clips(numAnims);
+    cvector<AnimBinTrack> tracks(numAnims * numBones);
+    cvector<uint16>       keyFrames;
+    cvector<QuantPos>     keyPositions;
+    cvector<QuantQuat>    keyRotations;
+
+    for (uint32 animIdx = 0; animIdx < numAnims; ++animIdx)
+    {
+        const AnimationClip& clip = skeleton.animations_[animIdx];
+
+        if (clip.trackNumKeys.size() != numBones)
+        {
+            LogErr(LOG, "tracks of animation '%s' (skeleton '%s') aren't built", skeleton.animNames_[animIdx].name, skeleton.GetName());
+            return false;
+        }
+
+        clips[animIdx].nameOffset = addString(skeleton.animNames_[animIdx].name);
+        clips[animIdx].framerate  = clip.framerate;
+        clips[animIdx].numFrames  = clip.numFrames;
+        clips[animIdx].firstKey   = (uint32)keyFrames.size();
+        clips[animIdx].numKeys    = (uint32)clip.trackKeyFrames.size();
+
+        for (uint32 boneIdx = 0; boneIdx < numBones; ++boneIdx)
+        {
+            AnimBinTrack& track = tracks[animIdx * numBones + boneIdx];
+
+            track.range    = clip.trackRanges[boneIdx];
+            track.firstKey = clip.trackFirstKey[boneIdx];
+            track.numKeys  = clip.trackNumKeys[boneIdx];
+        }
+
+        keyFrames.append_vector(clip.trackKeyFrames);
+        keyPositions.append_vector(clip.trackPositions);
+        keyRotations.append_vector(clip.trackRotations);
+    }
+
+    info.numKeys = (uint32)keyFrames.size();
+
+
+    // describe chunks of the file
+    constexpr int numChunks = 9;
+    AnimBinChunk  chunks[numChunks];
+    const void*   chunksData[numChunks];
+
+    chunks[0] = { ANIM_BIN_CHUNK_INFO,      0, (uint32)sizeof(info),                                1 };
+    chunks[1] = { ANIM_BIN_CHUNK_BONES,     0, (uint32)(sizeof(AnimBinBone) * numBones),            numBones };
+    chunks[2] = { ANIM_BIN_CHUNK_WEIGHTS,   0, (uint32)(sizeof(VertexBoneData) * info.numVertices), info.numVertices };
+    chunks[3] = { ANIM_BIN_CHUNK_CLIPS,     0, (uint32)(sizeof(AnimBinClip) * numAnims),            numAnims };
+    chunks[4] = { ANIM_BIN_CHUNK_TRACKS,    0, (uint32)(sizeof(AnimBinTrack) * tracks.size()),      (uint32)tracks.size() };
+    chunks[5] = { ANIM_BIN_CHUNK_KEY_FRAME, 0, (uint32)(sizeof(uint16) * info.numKeys),             info.numKeys };
+    chunks[6] = { ANIM_BIN_CHUNK_KEY_POS,   0, (uint32)(sizeof(QuantPos) * info.numKeys),           info.numKeys };
+    chunks[7] = { ANIM_BIN_CHUNK_KEY_ROT,   0, (uint32)(sizeof(QuantQuat) * info.numKeys),          info.numKeys };
+    chunks[8] = { ANIM_BIN_CHUNK_STRINGS,   0, (uint32)strings.size(),                              (uint32)strings.size() };
+
+    chunksData[0] = &info;
+    chunksData[1] = bones.data();
+    chunksData[2] = skeleton.vertexToBones.data();
+    chunksData[3] = clips.data();
+    chunksData[4] = tracks.data();
+    chunksData[5] = keyFrames.data();
+    chunksData[6] = keyPositions.data();
+    chunksData[7] = keyRotations.data();
+    chunksData[8] = strings.data();
+
+    // compute offsets of chunks (each chunk is aligned)
+    AnimBinHeader header;
+    header.numChunks        = numChunks;
+    header.chunkTableOffset = sizeof(AnimBinHeader);
+
+    size_t offset = sizeof(AnimBinHeader) + sizeof(chunks);
+
+    for (AnimBinChunk& chunk : chunks)
+    {
+        offset       = AnimBinAlign(offset);
+        chunk.offset = (uint32)offset;
+        offset      += chunk.size;
+    }
+
+    if (offset > UINT32_MAX)
+    {
+        LogErr(LOG, "skeleton is too big for binary format: %s", skeleton.GetName());
+        return false;
+    }
+
+    header.fileSize = (uint32)offset;
+
+
+    FILE* pFile = fopen(filename, "wb");
+    if (!pFile)
+    {
+        LogErr(LOG, "can't open file for writing: %s", filename);
+        return false;
+    }
+
+    const bool result = WriteAnimBinChunks(pFile, header, chunks, chunksData);
+    fclose(pFile);
+
+    if (!result)
+    {
+        LogErr(LOG, "can't write skeleton into file: %s", filename);
+        return false;
+    }
+
+    LogMsg(LOG, "skeleton '%s' is saved into file: %s", skeleton.GetName(), filename);
+    return true;
+}
+
 //---------------------------------------------------------
 //---------------------------------------------------------
 void WriteCommonInfo(FILE* pFile, const AnimSkeleton* pSkeleton)
@@ -315,5 +482,45 @@ void WriteAnimations(FILE* pFile, const AnimSkeleton* pSkeleton)
     }
 }
 
+//---------------------------------------------------------
+// Desc:  write header, chunk table, and data of each chunk
+//        (with zero padding up to the chunk's offset)
+//---------------------------------------------------------
+bool WriteAnimBinChunks(
+    FILE* pFile,
+    const AnimBinHeader& header,
+    const AnimBinChunk* chunks,
+    const void* const* chunksData)
+{
+    assert(pFile);
+    assert(chunks);
+    assert(chunksData);
+
+    const uint8 zeros[ANIM_BIN_ALIGNMENT]{ 0 };
+
+    if (fwrite(&header, sizeof(header), 1, pFile) != 1)
+        return false;
+
+    if (fwrite(chunks, sizeof(AnimBinChunk), header.numChunks, pFile) != header.numChunks)
+        return false;
+
+    size_t pos = sizeof(header) + sizeof(AnimBinChunk) * header.numChunks;
+
+    for (uint32 i = 0; i < header.numChunks; ++i)
+    {
+        assert(chunks[i].offset >= pos);
+        const size_t padding = chunks[i].offset - pos;
+
+        if (fwrite(zeros, 1, padding, pFile) != padding)
+            return false;
+
+        if (fwrite(chunksData[i], 1, chunks[i].size, pFile) != chunks[i].size)
+            return false;
+
+        pos = chunks[i].offset + chunks[i].size;
+    }
+
+    return true;
+}
 
 } // namespace
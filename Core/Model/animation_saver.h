@@ -26,7 +26,10 @@ class AnimSkeleton;
 class AnimationSaver
 {
 public:
-    bool Save(const AnimSkeleton* pSkeleton, const char* filename);
+    bool Save      (const AnimSkeleton* pSkeleton, const char* filename);
+
+    // save into binary .animb file (animations are stored as compressed tracks)
+    bool SaveBinary(const AnimSkeleton* pSkeleton, const char* filename);
 };
 
 } // namespace
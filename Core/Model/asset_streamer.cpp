@@ -0,0 +1,689 @@
+// =================================================================================
+// Filename:   asset_streamer.cpp
+// Desc:       implementation of streaming of models and textures
+//
+// Created:    17.10.2026  by DimaSkup
+// =================================================================================
+#include <CoreCommon/pch.h>
+#include "asset_streamer.h"
+
+#include "model_mgr.h"
+#include "model_loader.h"
+#include <Mesh/material_mgr.h>
+#include <Texture/texture_mgr.h>
+#include <Entity/EntityMgr.h>
+#include <QuadTree/scene_object.h>
+#include <geometry/intersection_tests.h>
+
+
+namespace Core
+{
+
+// a global instance of the asset streamer
+AssetStreamer g_AssetStreamer;
+
+// limits of work per frame
+constexpr int MAX_NUM_STREAM_LOADS_IN_FLIGHT = 8;   // loads which are executed by workers at the same time
+constexpr int MAX_NUM_STREAM_UPLOADS         = 2;   // how many assets can be uploaded to GPU per frame
+
+
+//---------------------------------------------------------
+// Desc:   a single asset loading which is executed by a worker thread;
+//         the worker touches only fields of this request
+//---------------------------------------------------------
+struct StreamLoadRequest
+{
+    JobCounter         counter;
+    int                assetIdx   = -1;
+    eStreamAssetType   type       = STREAM_ASSET_MODEL;
+    char               path[256]{ '\0' };
+
+    Model              model;                   // loaded model's geometry
+    ModelMaterialsInfo mats;
+    Texture            tex;                     // loaded texture
+
+    bool               isDeferred = false;      // must be loaded on the owner thread
+    bool               isLoaded   = false;
+};
+
+//---------------------------------------------------------
+// Desc:   check if a texture by path is loaded using WIC (png/jpg/jpeg):
+//         it requires the immediate context so it can't be loaded by workers
+//---------------------------------------------------------
+static bool IsTexLoadedWithContext(const char* path)
+{
+    const char*  exts[] = { ".png", ".jpg", ".jpeg" };
+    const size_t len    = strlen(path);
+
+    for (const char* ext : exts)
+    {
+        const size_t extLen = strlen(ext);
+
+        if ((len >= extLen) && (strcmp(path + len - extLen, ext) == 0))
+            return true;
+    }
+
+    return false;
+}
+
+//---------------------------------------------------------
+// Desc:   approximate size of texture in GPU memory (32 bits per texel + mipmaps)
+//---------------------------------------------------------
+static uint32 GetTexMemSize(const Texture& tex)
+{
+    const uint64 size = (uint64)tex.GetWidth() * tex.GetHeight() * 4;
+    return (uint32)(size * 4 / 3);
+}
+
+//---------------------------------------------------------
+// Desc:   read/decode an asset (is executed by a worker thread)
+//---------------------------------------------------------
+static void StreamLoadJob(void* pArgs)
+{
+    StreamLoadRequest& req = *(StreamLoadRequest*)pArgs;
+
+    if (req.type == STREAM_ASSET_MODEL)
+    {
+        ModelLoader loader;
+        req.isLoaded = loader.LoadGeometry(req.path, req.model, req.mats);
+    }
+    else
+    {
+        // if failed to load a texture it becomes a 1x1 color texture
+        req.tex      = Texture(req.path, req.path);
+        req.isLoaded = true;
+    }
+}
+
+
+//==================================================================================
+// init / shutdown / registration
+//==================================================================================
+
+AssetStreamer::~AssetStreamer()
+{
+    Shutdown();
+}
+
+//---------------------------------------------------------
+// Desc:   turn on streaming
+// Args:   - memBudgetBytes:  max memory for all the streamable assets
+//         - streamRadius:    assets of entities in this radius around
+//                            the camera are kept loaded
+//---------------------------------------------------------
+void AssetStreamer::Init(const uint64 memBudgetBytes, const float streamRadius)
+{
+    if (memBudgetBytes == 0 || streamRadius <= 0)
+    {
+        LogErr(LOG, "invalid streaming params (budget: %" PRIu64 ", radius: %f)", memBudgetBytes, streamRadius);
+        return;
+    }
+
+    stats_.memBudget = memBudgetBytes;
+    streamRadius_    = streamRadius;
+    isEnabled_       = true;
+
+    LogMsg("asset streaming: budget %" PRIu64 " MB, radius %.1f", memBudgetBytes >> 20, streamRadius);
+}
+
+//---------------------------------------------------------
+// Desc:   wait for all the loads and release memory
+//---------------------------------------------------------
+void AssetStreamer::Shutdown()
+{
+    for (StreamLoadRequest* pReq : inFlight_)
+    {
+        g_JobSystem.Wait(&pReq->counter);
+        SafeDelete(pReq);
+    }
+
+    inFlight_.purge();
+    assets_.purge();
+    modelsAssets_.purge();
+    texturesAssets_.purge();
+    requests_.purge();
+
+    lruHead_   = -1;
+    lruTail_   = -1;
+    stats_     = StreamingStats();
+    isEnabled_ = false;
+}
+
+//---------------------------------------------------------
+// Desc:   register a model which geometry can be streamed
+// Args:   - path:        a path to model's file (relatively to the assets dir)
+//         - isResident:  is the model already loaded
+//---------------------------------------------------------
+void AssetStreamer::RegisterModel(const ModelID id, const char* path, const bool isResident)
+{
+    if (StrHelper::IsEmpty(path) || (id == INVALID_MODEL_ID))
+    {
+        LogErr(LOG, "invalid input args (model id: %" PRIu32 ")", id);
+        return;
+    }
+
+    if (id >= modelsAssets_.size())
+        modelsAssets_.resize(id + 1, -1);
+
+    const int idx = AddAsset(STREAM_ASSET_MODEL, id, path, isResident);
+
+    if (isResident)
+    {
+        assets_[idx].memSize = g_ModelMgr.GetModelById(id).GetGeometryMemSize();
+        stats_.memUsed      += assets_[idx].memSize;
+    }
+
+    modelsAssets_[id] = idx;
+}
+
+//---------------------------------------------------------
+// Desc:   register a texture which can be streamed
+// Args:   - path:        a path to texture's file (relatively to the working dir)
+//         - isResident:  is the texture already loaded
+//---------------------------------------------------------
+void AssetStreamer::RegisterTexture(const TexID id, const char* path, const bool isResident)
+{
+    if (StrHelper::IsEmpty(path) || (id == INVALID_TEX_ID))
+    {
+        LogErr(LOG, "invalid input args (texture id: %" PRIu32 ")", id);
+        return;
+    }
+
+    if (id >= texturesAssets_.size())
+        texturesAssets_.resize(id + 1, -1);
+
+    const int idx = AddAsset(STREAM_ASSET_TEXTURE, id, path, isResident);
+
+    if (isResident)
+    {
+        assets_[idx].memSize = GetTexMemSize(g_TextureMgr.GetTexById(id));
+        stats_.memUsed      += assets_[idx].memSize;
+    }
+
+    texturesAssets_[id] = idx;
+}
+
+//---------------------------------------------------------
+// Desc:   add a new asset record and put it into the LRU list if it is resident
+//---------------------------------------------------------
+int AssetStreamer::AddAsset(
+    const eStreamAssetType type,
+    const uint32 id,
+    const char* path,
+    const bool isResident)
+{
+    const int idx = (int)assets_.size();
+
+    assets_.push_back(StreamAsset());
+    StreamAsset& asset = assets_.back();
+
+    strncpy(asset.path, path, sizeof(asset.path) - 1);
+    asset.id    = id;
+    asset.type  = type;
+    asset.state = (isResident) ? STREAM_STATE_RESIDENT : STREAM_STATE_UNLOADED;
+
+    if (isResident)
+    {
+        LruPushFront(idx);
+        stats_.numResident++;
+    }
+
+    return idx;
+}
+
+//---------------------------------------------------------
+// Desc:   get an idx of asset record by ID of model/texture (or -1)
+//---------------------------------------------------------
+int AssetStreamer::GetAssetIdx(const cvector<int>& assetsByIds, const uint32 id) const
+{
+    return (id < assetsByIds.size()) ? assetsByIds[id] : -1;
+}
+
+
+//---------------------------------------------------------
+// Desc:   assets which aren't used by any entity (grass, sky, weapons HUD, etc.)
+//         are never requested by distance so load them right now (files are
+//         read in parallel); they aren't streamable so they are never unloaded
+// NOTE:   is called once after all the entities of the level are created
+//---------------------------------------------------------
+void AssetStreamer::LoadAssetsNotUsedByEntts(ECS::EntityMgr& enttMgr)
+{
+    if (!isEnabled_)
+        return;
+
+    // mark assets of entities as streamable (without loading)
+    const EntityID* ids      = nullptr;
+    size            numEntts = 0;
+
+    enttMgr.modelSys_.GetAllEntts(ids, numEntts);
+    RequestEntts(ids, (int)numEntts, { 0,0,0 }, enttMgr);
+
+    requests_.clear();
+
+    // start loading of the rest (the in-flight list is empty at this moment)
+    assert(inFlight_.empty());
+
+    for (int i = 0; i < (int)assets_.size(); ++i)
+    {
+        const StreamAsset& asset = assets_[i];
+
+        if (!asset.isStreamable && (asset.state == STREAM_STATE_UNLOADED))
+            StartLoad(i);
+    }
+
+    const int numLoads = (int)inFlight_.size();
+
+    for (StreamLoadRequest* pReq : inFlight_)
+    {
+        g_JobSystem.Wait(&pReq->counter);
+        FinishLoad(pReq);
+        SafeDelete(pReq);
+    }
+
+    inFlight_.clear();
+
+    LogMsg(LOG, "asset streaming: %d assets which aren't used by entities are loaded", numLoads);
+}
+
+
+//==================================================================================
+// update
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   request assets around the camera, finish loads of previous frames,
+//         start new loads (the nearest first) and unload LRU assets if
+//         the memory budget is exceeded
+// Args:   - camPos:        camera's current position
+//         - visibleEntts:  currently visible entities
+//---------------------------------------------------------
+void AssetStreamer::Update(
+    const DirectX::XMFLOAT3& camPos,
+    const cvector<EntityID>& visibleEntts,
+    ECS::EntityMgr& enttMgr)
+{
+    if (!isEnabled_)
+        return;
+
+    currFrame_++;
+    requests_.clear();
+
+    // request assets of entities around the camera (quad-tree search)
+    QuadTree& quadTree = enttMgr.GetQuadTree();
+
+    if (quadTree.IsReady())
+    {
+        const float r = streamRadius_;
+        Rect3d searchRect(camPos.x - r, camPos.x + r, camPos.y - r, camPos.y + r, camPos.z - r, camPos.z + r);
+        Rect3d clampedRect;
+
+        if (IntersectRect3d(searchRect, g_ModelMgr.GetTerrain().GetAABB(), clampedRect))
+        {
+            ScratchVec<EntityID> nearEntts;
+
+            for (SceneObject* pObj = quadTree.Search(clampedRect); pObj; pObj = pObj->GetNextSearchLink())
+                nearEntts.push_back(pObj->GetId());
+
+            RequestEntts(nearEntts.data(), (int)nearEntts.size(), camPos, enttMgr);
+        }
+    }
+
+    // visible entities can be farther than the streaming radius
+    RequestEntts(visibleEntts.data(), (int)visibleEntts.size(), camPos, enttMgr);
+
+    stats_.numRequested = (int)requests_.size();
+
+    FinishLoads();
+    StartLoads();
+
+    // unload assets if we are out of budget (for instance, right after level loading)
+    if (stats_.memUsed > stats_.memBudget)
+        EvictLru(0);
+}
+
+//---------------------------------------------------------
+// Desc:   request models (and their LODs) and textures of input entities
+//---------------------------------------------------------
+void AssetStreamer::RequestEntts(
+    const EntityID* ids,
+    const int numEntts,
+    const DirectX::XMFLOAT3& camPos,
+    ECS::EntityMgr& enttMgr)
+{
+    if (numEntts == 0)
+        return;
+
+    ScratchVec<EntityID>          enttsWithModels;
+    ScratchVec<ModelID>           modelsIds;
+    ScratchVec<DirectX::XMFLOAT3> positions;
+
+    // only entities with models are interesting for us
+    for (int i = 0; i < numEntts; ++i)
+    {
+        if (enttMgr.GetAddedComponentsByEntt(ids[i]).TestBit(ECS::ModelComponent))
+            enttsWithModels.push_back(ids[i]);
+    }
+
+    if (enttsWithModels.empty())
+        return;
+
+    const int num = (int)enttsWithModels.size();
+
+    enttMgr.modelSys_.GetModelsIdsPerEntts(enttsWithModels.data(), num, modelsIds);
+    enttMgr.transformSys_.GetPositions(enttsWithModels.data(), num, positions);
+
+    for (int i = 0; i < num; ++i)
+    {
+        const DirectX::XMFLOAT3& p = positions[i];
+        const float sqrDist = SQR(p.x - camPos.x) + SQR(p.y - camPos.y) + SQR(p.z - camPos.z);
+
+        // model and its LODs
+        const Model& model = g_ModelMgr.GetModelById(modelsIds[i]);
+
+        RequestModel(modelsIds[i], sqrDist);
+
+        for (int lod = 0; lod < model.GetNumLods(); ++lod)
+            RequestModel(model.GetLod(eModelLodLevel(lod)), sqrDist);
+
+        // textures of entity's materials
+        const ECS::MaterialData& matData = enttMgr.materialSys_.GetDataByEnttId(enttsWithModels[i]);
+
+        for (const MaterialID matId : matData.materialsIds)
+        {
+            const Material& mat = g_MaterialMgr.GetMatById(matId);
+
+            for (const TexID texId : mat.texIds)
+                RequestTexture(texId, sqrDist);
+        }
+    }
+}
+
+//---------------------------------------------------------
+
+void AssetStreamer::RequestModel(const ModelID id, const float sqrDist)
+{
+    const int idx = GetAssetIdx(modelsAssets_, id);
+
+    if (idx != -1)
+        RequestAsset(idx, sqrDist);
+}
+
+//---------------------------------------------------------
+
+void AssetStreamer::RequestTexture(const TexID id, const float sqrDist)
+{
+    const int idx = GetAssetIdx(texturesAssets_, id);
+
+    if (idx != -1)
+        RequestAsset(idx, sqrDist);
+}
+
+//---------------------------------------------------------
+// Desc:   mark asset as used in the current frame; if it isn't resident
+//         it is added into the requests (priority is the nearest distance)
+//---------------------------------------------------------
+void AssetStreamer::RequestAsset(const int assetIdx, const float sqrDist)
+{
+    StreamAsset& asset = assets_[assetIdx];
+
+    // the asset is used by entities so it can be unloaded later
+    asset.isStreamable = true;
+
+    if (asset.lastUsedFrame == currFrame_)
+    {
+        asset.sqrDist = min(asset.sqrDist, sqrDist);
+        return;
+    }
+
+    asset.lastUsedFrame = currFrame_;
+    asset.sqrDist       = sqrDist;
+
+    if (asset.state == STREAM_STATE_RESIDENT)
+    {
+        // move to the head of the LRU list
+        LruRemove(assetIdx);
+        LruPushFront(assetIdx);
+    }
+    else if ((asset.state == STREAM_STATE_UNLOADED) && !asset.isFailed)
+    {
+        requests_.push_back(assetIdx);
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   create GPU resources for assets which were loaded by workers
+//         (a limited number of assets per frame)
+//---------------------------------------------------------
+void AssetStreamer::FinishLoads()
+{
+    int numUploads = 0;
+
+    for (index i = 0; (i < inFlight_.size()) && (numUploads < MAX_NUM_STREAM_UPLOADS);)
+    {
+        StreamLoadRequest* pReq = inFlight_[i];
+
+        if (!pReq->counter.IsDone())
+        {
+            ++i;
+            continue;
+        }
+
+        FinishLoad(pReq);
+
+        SafeDelete(pReq);
+        numUploads++;
+
+        // swap n pop
+        inFlight_[i] = inFlight_.back();
+        inFlight_.pop_back();
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   create GPU resources for a single loaded asset and make it resident
+//---------------------------------------------------------
+void AssetStreamer::FinishLoad(StreamLoadRequest* pReq)
+{
+    StreamAsset& asset = assets_[pReq->assetIdx];
+    const uint32 reservedSize = asset.memSize;
+
+    if (asset.type == STREAM_ASSET_MODEL)
+    {
+        Model& model = g_ModelMgr.GetModelById(asset.id);
+
+        if (pReq->isLoaded && model.MoveGeometryFrom(pReq->model))
+        {
+            model.InitBuffers();
+            asset.memSize = model.GetGeometryMemSize();
+        }
+        else
+        {
+            pReq->isLoaded = false;
+        }
+    }
+    else
+    {
+        // textures which require the immediate context are loaded right here
+        if (pReq->isDeferred)
+            StreamLoadJob(pReq);
+
+        asset.memSize = GetTexMemSize(pReq->tex);
+        g_TextureMgr.ReplaceTexture(asset.id, std::move(pReq->tex));
+    }
+
+    stats_.memUsed -= reservedSize;
+    stats_.numLoading--;
+
+    if (pReq->isLoaded)
+    {
+        asset.state     = STREAM_STATE_RESIDENT;
+        stats_.memUsed += asset.memSize;
+        stats_.numResident++;
+        stats_.numLoaded++;
+
+        LruPushFront(pReq->assetIdx);
+        residencyVersion_++;
+    }
+    else
+    {
+        // don't try to load it again each frame
+        LogErr(LOG, "can't stream asset: %s", asset.path);
+        asset.state    = STREAM_STATE_UNLOADED;
+        asset.isFailed = true;
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   start loading of requested assets in order of distance to the camera
+//---------------------------------------------------------
+void AssetStreamer::StartLoads()
+{
+    // min-heap by distance: the nearest asset is on the top
+    auto isFarther = [this](const int a, const int b)
+    {
+        return assets_[a].sqrDist > assets_[b].sqrDist;
+    };
+
+    std::make_heap(requests_.begin(), requests_.end(), isFarther);
+
+    while (!requests_.empty() && (inFlight_.size() < MAX_NUM_STREAM_LOADS_IN_FLIGHT))
+    {
+        std::pop_heap(requests_.begin(), requests_.end(), isFarther);
+        const int assetIdx = requests_.back();
+        requests_.pop_back();
+
+        StreamAsset& asset = assets_[assetIdx];
+
+        // make space for the asset (its size is known if it was loaded before);
+        // if we can't, farther assets won't fit as well
+        if ((stats_.memUsed + asset.memSize > stats_.memBudget) && !EvictLru(asset.memSize))
+            break;
+
+        if (!StartLoad(assetIdx))
+            break;
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   create a load request for the asset and push it into the in-flight
+//         list (files are read by a worker, except of textures which need
+//         the immediate context: those are loaded in FinishLoad)
+//---------------------------------------------------------
+bool AssetStreamer::StartLoad(const int assetIdx)
+{
+    StreamAsset& asset = assets_[assetIdx];
+
+    StreamLoadRequest* pReq = NEW StreamLoadRequest();
+    if (!pReq)
+    {
+        LogErr(LOG, "can't alloc mem for stream request: %s", asset.path);
+        return false;
+    }
+
+    pReq->assetIdx = assetIdx;
+    pReq->type     = asset.type;
+    strncpy(pReq->path, asset.path, sizeof(pReq->path) - 1);
+
+    asset.state     = STREAM_STATE_LOADING;
+    stats_.memUsed += asset.memSize;            // reserve memory
+    stats_.numLoading++;
+
+    inFlight_.push_back(pReq);
+
+    if ((asset.type == STREAM_ASSET_TEXTURE) && IsTexLoadedWithContext(asset.path))
+        pReq->isDeferred = true;
+    else
+        g_JobSystem.Run(StreamLoadJob, pReq, &pReq->counter);
+
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:   unload the least recently used assets (only ones which weren't
+//         requested in the current frame) until needMemSize fits into the budget
+// Ret:    true if there is enough memory now
+//---------------------------------------------------------
+bool AssetStreamer::EvictLru(const uint64 needMemSize)
+{
+    int idx = lruTail_;
+
+    while ((stats_.memUsed + needMemSize > stats_.memBudget) && (idx != -1))
+    {
+        const StreamAsset& asset = assets_[idx];
+        const int          prev  = asset.lruPrev;
+
+        // assets which aren't used by entities are never unloaded
+        if (asset.isStreamable && (asset.lastUsedFrame != currFrame_))
+            Unload(idx);
+
+        idx = prev;
+    }
+
+    return (stats_.memUsed + needMemSize <= stats_.memBudget);
+}
+
+//---------------------------------------------------------
+// Desc:   release memory of the resident asset
+//---------------------------------------------------------
+void AssetStreamer::Unload(const int assetIdx)
+{
+    StreamAsset& asset = assets_[assetIdx];
+    assert(asset.state == STREAM_STATE_RESIDENT);
+
+    if (asset.type == STREAM_ASSET_MODEL)
+        g_ModelMgr.GetModelById(asset.id).ReleaseGeometry();
+    else
+        g_TextureMgr.UnloadTexture(asset.id);
+
+    LruRemove(assetIdx);
+
+    asset.state     = STREAM_STATE_UNLOADED;
+    stats_.memUsed -= asset.memSize;
+    stats_.numResident--;
+    stats_.numEvicted++;
+
+    residencyVersion_++;
+}
+
+
+//==================================================================================
+// LRU list
+//==================================================================================
+
+void AssetStreamer::LruPushFront(const int assetIdx)
+{
+    StreamAsset& asset = assets_[assetIdx];
+
+    asset.lruPrev = -1;
+    asset.lruNext = lruHead_;
+
+    if (lruHead_ != -1)
+        assets_[lruHead_].lruPrev = assetIdx;
+
+    lruHead_ = assetIdx;
+
+    if (lruTail_ == -1)
+        lruTail_ = assetIdx;
+}
+
+//---------------------------------------------------------
+
+void AssetStreamer::LruRemove(const int assetIdx)
+{
+    StreamAsset& asset = assets_[assetIdx];
+
+    if (asset.lruPrev != -1)
+        assets_[asset.lruPrev].lruNext = asset.lruNext;
+    else
+        lruHead_ = asset.lruNext;
+
+    if (asset.lruNext != -1)
+        assets_[asset.lruNext].lruPrev = asset.lruPrev;
+    else
+        lruTail_ = asset.lruPrev;
+
+    asset.lruPrev = -1;
+    asset.lruNext = -1;
+}
+
+} // namespace
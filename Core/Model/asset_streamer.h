@@ -0,0 +1,172 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: asset_streamer.h
+    Desc:     streaming of models and textures around the camera
+              with a memory budget:
+
+              - each frame assets of entities which are close to the camera
+                (quad-tree search in radius) and visible entities are requested;
+              - requests are served in order of distance to the camera (the nearest
+                first): files are read/decoded by worker threads, GPU resources
+                are created on the owner thread (a few assets per frame);
+              - resident assets are kept in LRU order, when the memory budget is
+                exceeded the least recently used assets (which weren't requested
+                in the current frame) are unloaded;
+              - while asset isn't resident a placeholder is used instead:
+                the default model (cube, id: 0) and the "unloaded" texture (id: 0);
+              - when streaming is enabled only metadata of models (subsets,
+                materials, boundings, LODs) and records of textures are created
+                at level loading, geometry and texels are loaded on demand;
+              - only assets which are used by entities can be unloaded: asset
+                becomes streamable after it was requested for the first time;
+                assets which aren't used by entities (grass, sky, UI, etc.)
+                are loaded once after the level is created and never unloaded
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <Types.h>
+#include <cvector.h>
+#include <DirectXMath.h>
+
+
+// forward declarations (pointer use only)
+namespace ECS
+{
+class EntityMgr;
+}
+
+namespace Core
+{
+
+enum eStreamAssetType : uint8
+{
+    STREAM_ASSET_MODEL,
+    STREAM_ASSET_TEXTURE,
+};
+
+enum eStreamAssetState : uint8
+{
+    STREAM_STATE_UNLOADED,
+    STREAM_STATE_LOADING,
+    STREAM_STATE_RESIDENT,
+};
+
+//---------------------------------------------------------
+
+struct StreamAsset
+{
+    char              path[256]{ '\0' };    // model: relatively to the assets dir; texture: relatively to the working dir
+    uint32            id            = 0;    // model or texture ID
+    uint32            memSize       = 0;    // memory size in bytes (is known after the first loading)
+    uint32            lastUsedFrame = 0;
+    float             sqrDist       = 0;    // priority: squared distance to the camera (less is more important)
+    int               lruPrev       = -1;   // neighbours in the LRU list (only for resident assets)
+    int               lruNext       = -1;
+    eStreamAssetType  type          = STREAM_ASSET_MODEL;
+    eStreamAssetState state         = STREAM_STATE_UNLOADED;
+    bool              isStreamable  = false;
+    bool              isFailed      = false;
+};
+
+//---------------------------------------------------------
+
+struct StreamingStats
+{
+    uint64 memUsed      = 0;    // resident + reserved for loading (in bytes)
+    uint64 memBudget    = 0;
+    int    numResident  = 0;
+    int    numLoading   = 0;
+    int    numRequested = 0;    // during the last frame
+    int    numLoaded    = 0;    // total
+    int    numEvicted   = 0;    // total
+};
+
+// forward declaration (pointer use only)
+struct StreamLoadRequest;
+
+//---------------------------------------------------------
+
+class AssetStreamer
+{
+public:
+    AssetStreamer() {}
+    ~AssetStreamer();
+
+    // restrict any copying
+    AssetStreamer(const AssetStreamer&)            = delete;
+    AssetStreamer& operator=(const AssetStreamer&) = delete;
+
+    void Init(const uint64 memBudgetBytes, const float streamRadius);
+    void Shutdown();
+
+    // register assets which can be streamed (in any order, before or after Init)
+    void RegisterModel  (const ModelID id, const char* path, const bool isResident);
+    void RegisterTexture(const TexID id,   const char* path, const bool isResident);
+
+    // load assets which aren't used by any entity (is called once
+    // after all the entities of the level are created)
+    void LoadAssetsNotUsedByEntts(ECS::EntityMgr& enttMgr);
+
+    // is called on the owner thread once per frame
+    void Update(
+        const DirectX::XMFLOAT3& camPos,
+        const cvector<EntityID>& visibleEntts,
+        ECS::EntityMgr& enttMgr);
+
+    inline bool                  IsEnabled()           const { return isEnabled_; }
+    inline uint32                GetResidencyVersion() const { return residencyVersion_; }
+    inline const StreamingStats& GetStats()            const { return stats_; }
+
+private:
+    void RequestEntts  (const EntityID* ids, const int numEntts, const DirectX::XMFLOAT3& camPos, ECS::EntityMgr& enttMgr);
+    void RequestModel  (const ModelID id, const float sqrDist);
+    void RequestTexture(const TexID id,   const float sqrDist);
+    void RequestAsset  (const int assetIdx, const float sqrDist);
+
+    void FinishLoads();
+    void FinishLoad(StreamLoadRequest* pReq);
+    void StartLoads();
+    bool StartLoad(const int assetIdx);
+    bool EvictLru(const uint64 needMemSize);
+    void Unload  (const int assetIdx);
+
+    void LruPushFront(const int assetIdx);
+    void LruRemove   (const int assetIdx);
+
+    int  AddAsset(const eStreamAssetType type, const uint32 id, const char* path, const bool isResident);
+    int  GetAssetIdx(const cvector<int>& assetsByIds, const uint32 id) const;
+
+private:
+    cvector<StreamAsset>        assets_;
+    cvector<int>                modelsAssets_;      // [model ID => asset idx] (-1 if the model isn't streamed)
+    cvector<int>                texturesAssets_;    // [texture ID => asset idx]
+    cvector<int>                requests_;          // idxs of assets requested in the current frame (heap by distance)
+    cvector<StreamLoadRequest*> inFlight_;          // loads which are executed by worker threads
+
+    int                         lruHead_ = -1;      // most recently used
+    int                         lruTail_ = -1;      // least recently used
+
+    StreamingStats              stats_;
+    float                       streamRadius_     = 0;
+    uint32                      currFrame_        = 0;
+    uint32                      residencyVersion_ = 0;    // is changed each time when any asset is loaded/unloaded
+    bool                        isEnabled_        = false;
+};
+
+
+//==================================================================================
+// GLOBAL instance of the asset streamer
+//==================================================================================
+extern AssetStreamer g_AssetStreamer;
+
+} // namespace
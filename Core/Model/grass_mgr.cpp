@@ -24,6 +24,7 @@
 #include <Mesh/material_mgr.h>
 #include <Model/model_mgr.h>
 #include <Model/model_creator.h>
+#include <str_hash_index.h>
 
 
 namespace Core
@@ -35,9 +36,8 @@ struct GrassTimeStats
     TimeDurationMs timeCellsGen;
 
     TimeDurationMs timeCellsPrepare;
-    TimeDurationMs timeGenInstances;
-    TimeDurationMs timeGenPositions;
-    TimeDurationMs timeGroupByCells;
+    TimeDurationMs timeLoadDensity;
+    TimeDurationMs timeCellsDensity;
 };
 
 GrassTimeStats s_TimeStats;
@@ -47,6 +47,28 @@ GrassTimeStats s_TimeStats;
 //---------------------------------------------------------
 GrassMgr g_GrassMgr;
 
+// generation of a single cell is cheap so don't create
+// jobs for less than this number of cells
+constexpr int MIN_GRASS_CELLS_PER_JOB = 8;
+
+// cells are generated a bit before they become visible and
+// evicted a bit later (to prevent regeneration at the border)
+constexpr float GRASS_STREAM_PRELOAD_DIST     = 16.0f;
+constexpr float GRASS_STREAM_EVICT_DIST       = 32.0f;
+constexpr int   MAX_GRASS_CELLS_GEN_PER_FRAME = 64;
+
+// thinning of grass by distance: all the instances are rendered up to
+// this part of visibility range, then density linearly goes down to the min
+constexpr float GRASS_THINNING_START  = 0.5f;
+constexpr float GRASS_MIN_DENSITY_FAR = 0.25f;
+
+// density of visible cells is quantized so the instanced buffer isn't
+// rewritten each frame because of a tiny motion of the camera
+constexpr float GRASS_DENSITY_STEPS   = 64.0f;
+
+// leaf of cells quadtree covers up to NxN cells
+constexpr int   GRASS_TREE_LEAF_SIZE  = 4;
+
 
 //---------------------------------------------------------
 // forward declaration of private helpers
@@ -54,10 +76,8 @@ GrassMgr g_GrassMgr;
 void CheckInitParams        (const GrassFieldInitParams& params);
 void CalcFieldXZBoundings   (GrassField& field, const GrassFieldInitParams& params);
 void CreateCells            (GrassField& field, const GrassFieldInitParams& params);
-void GenGrassRandPositions  (GrassField& field, cvector<GrassInstance>& outGrass);
-void GenGrassRandPositions2 (GrassField& field, cvector<GrassInstance>& outGrass);
 void CalcFieldYBoundings    (GrassField& field);
-void InitBuffers            (GrassField& field);
+void InitBuffers            (GrassField& field, const uint32 instancesBudget);
 
 
 //---------------------------------------------------------
@@ -88,6 +108,7 @@ bool GrassMgr::AddGrassField(const GrassFieldInitParams& params)
     field.cellsByZ   = params.cellsByZ;
     field.texSlots   = params.texSlots;
     field.texRows    = params.texRows;
+    field.seed       = (params.seed != 0) ? (uint32)params.seed : (uint32)HashStr(params.name);
 
     // setup chance of grass appearance per channel
     for (int i = 0; i < field.numChannels; ++i)
@@ -114,8 +135,11 @@ bool GrassMgr::AddGrassField(const GrassFieldInitParams& params)
     s_TimeStats.timeCellsGen = GetTimePoint() - startCellsGen;
 
     CalcFieldYBoundings(field);
+    BuildCellsTree(field);
+
+    InitBuffers(field, instancesBudget_);
 
-    InitBuffers(field);
+    stats_.memDensity += field.densityMaps[0].values.size() * field.numChannels;
 
     s_TimeStats.fullTime = GetTimePoint() - start;
 
@@ -126,13 +150,12 @@ bool GrassMgr::AddGrassField(const GrassFieldInitParams& params)
     LogMsg("cells generation took:            %.2f sec", s_TimeStats.timeCellsGen.count() / 1000.0f);
 
     LogMsg("cells preparation took:           %.2f sec", s_TimeStats.timeCellsPrepare.count() / 1000.0f);
-    LogMsg("cells gen instances took:         %.2f sec", s_TimeStats.timeGenInstances.count() / 1000.0f);
-    LogMsg("cells gen positions took:         %.2f sec", s_TimeStats.timeGenPositions.count() / 1000.0f);
-    LogMsg("cells group by cells took:        %.2f sec", s_TimeStats.timeGroupByCells.count() / 1000.0f);
+    LogMsg("cells load density took:          %.2f sec", s_TimeStats.timeLoadDensity.count() / 1000.0f);
+    LogMsg("cells density distribution took:  %.2f sec", s_TimeStats.timeCellsDensity.count() / 1000.0f);
     printf("\n\n");
     SetConsoleColor(RESET);
 
-    LogMsg(LOG, "grass field is initialized: %s", params.name);
+    LogMsg(LOG, "grass field is initialized: %s (instances: %u)", params.name, field.grassCount);
     return true;
 }
 
@@ -320,7 +343,7 @@ void CalcGrassCellsBoundings(GrassField& field)
     // go through each cell and calc boundings...
     for (int i = 0; i < numCells; ++i)
     {
-        int cellRow = (i / field.cellsByZ);
+        int cellRow = (i / field.cellsByX);
         int cellCol = (i % field.cellsByX);
 
         const float minX = field.worldBox.x0 + (cellCol * cellBoxSizeX);
@@ -330,7 +353,7 @@ void CalcGrassCellsBoundings(GrassField& field)
         const float maxZ = minZ + cellBoxSizeZ;
 
         // NOTE: Y-boundaries we recalc later, it will be based on height
-        //       of lowest and highest position of grass instances (of this cell)
+        //       of terrain under the cell (instances aren't generated yet)
         field.cellsWorldBoxes[i] = Rect3d(minX, maxX, 0, 200, minZ, maxZ);
     }
 }
@@ -438,90 +461,13 @@ bool CheckDensityMap(const Image& map, const GrassField& field)
 }
 
 //---------------------------------------------------------
+// Desc:   load density maps of the field and keep density values per channel
+//         (they are kept by the field so any cell can be regenerated later)
 //---------------------------------------------------------
-void GenerateGrassInstances(GrassField& field, cvector<GrassInstance>& outGrass)
+bool LoadDensityMaps(GrassField& field)
 {
-    //
-    // calc random position for each instance
-    // (currently instances are grouped by channels)
-    //
-    GenGrassRandPositions(field, outGrass);
-
-    //
-    // setup texture coords for each instance of each cell according to channel
-    //
-    int grassIdx = 0;
-
-    for (int ch = 0; ch < field.numChannels; ++ch)
-    {
-        bool bGeneratedModel = field.bGeneratedModel[ch];
-
-        // if a model for this channel is generated we need to setup
-        // for each instance its row and column on texture atlas
-        if (bGeneratedModel)
-        {
-            // setup each instance related to current channel
-            for (uint32 i = 0; i < field.numInstPerChannel[ch]; ++i)
-            {
-                GrassInstance& grass = outGrass[grassIdx++];
-
-                grass.texColumn = ch;                  // is the same as channel index
-                grass.texRow    = (int)RandUint(0, field.texRows);
-            }
-        }
-
-        // we use some specific model for this channel...
-        else
-        {
-            // setup each instance related to current channel
-            for (uint32 i = 0; i < field.numInstPerChannel[ch]; ++i)
-            {
-                GrassInstance& grass = outGrass[grassIdx++];
-
-                // set that we will use own tex coords of the model
-                grass.texColumn = -1;
-                grass.texRow    = -1;
-            }
-        }
-    }
-
-#if 0
-    //
-    // setup random rotation (in radians) around Y-axis (vertical)
-    //
-    for (GrassInstance& grass : outGrass)
-        grass.rotY = DEG_TO_RAD(RandUint(0, 360));
-
-  
-#endif
-
-    //
-    // setup random scale
-    //
-    grassIdx = 0;
-
-    for (int ch = 0; ch < field.numChannels; ++ch)
-    {
-        const float minS = field.channelGrassScaleMin[ch];
-        const float maxS = field.channelGrassScaleMax[ch];
-
-        // setup each instance related to current channel
-        for (uint32 i = 0; i < field.numInstPerChannel[ch]; ++i)
-        {
-            GrassInstance& grass = outGrass[grassIdx++];
-            grass.scale = RandF(minS, maxS);
-        }
-    }
-}
-
-//---------------------------------------------------------
-//---------------------------------------------------------
-void GenGrassRandPositions(GrassField& field, cvector<GrassInstance>& outGrass)
-{
-    const Terrain& terrain = g_ModelMgr.GetTerrain();
     Image densityMapRGB;
     Image densityMapAlpha;
-    Image* densityMaps[NUM_GRASS_CHANNELS]{ nullptr };
 
 
     // load density maps for this grass field
@@ -530,7 +476,7 @@ void GenGrassRandPositions(GrassField& field, cvector<GrassInstance>& outGrass)
     if (!densityMapRGB.IsLoaded())
     {
         LogErr(LOG, "can't initialize density map for grass field: %s", field.name);
-        return;
+        return false;
     }
 
     // load a density map for field's alpha channel if need
@@ -541,469 +487,281 @@ void GenGrassRandPositions(GrassField& field, cvector<GrassInstance>& outGrass)
         if (!densityMapAlpha.IsLoaded())
         {
             LogErr(LOG, "can't load density map for alpha channel of grass field: %s", field.name);
-            return;
+            return false;
         }
 
         if ((densityMapAlpha.GetWidth()  != densityMapRGB.GetWidth()) ||
             (densityMapAlpha.GetHeight() != densityMapRGB.GetHeight()))
         {
             LogErr(LOG, "density map both for RGB and alpha channels don't have the same dimensions for grass field: %s", field.name);
-            return;
+            return false;
         }
     }
 
-#if 0
-    if (!CheckDensityMap(densityMap, field))
-    {
-        LogErr(LOG, "can't generate grass instances");
-        return;
-    }
-#endif
-
-    // density map per channel
-    densityMaps[0] = &densityMapRGB;
-    densityMaps[1] = &densityMapRGB;
-    densityMaps[2] = &densityMapRGB;
-    densityMaps[3] = &densityMapAlpha;
-
-    const float worldBoxInvDX = 1.0f / (field.worldBox.x1 - field.worldBox.x0);
-    const float worldBoxInvDZ = 1.0f / (field.worldBox.z1 - field.worldBox.z0);
-
-    uint32 grassIdx = 0;
-    outGrass.resize(field.grassCount);
-
-    TimePoint start = GetTimePoint();
-
-    int numAllAttempts = 0;
-    int numWasted = 0;
+    const uint width  = densityMapRGB.GetWidth();
+    const uint height = densityMapRGB.GetHeight();
 
     for (int ch = 0; ch < field.numChannels; ++ch)
     {
-        // each channel has its own density map
-        const Image& densityMap = *densityMaps[ch];
+        GrassDensityMap& map = field.densityMaps[ch];
 
-        const uint densityMapWidth  = densityMap.GetWidth();
-        const uint densityMapHeight = densityMap.GetHeight();
+        map.width  = width;
+        map.height = height;
+        map.values.resize(width * height);
 
-        for (uint i = 0; i < field.numInstPerChannel[ch]; ++i)
+        for (uint y = 0; y < height; ++y)
         {
-            Vec3 pos;
-            uint8 density = 0;
+            uint8* values = map.values.data() + y * width;
 
-            // if we need to regenerate position for this instance
-            while (density < RandUint(1, 255))
+            // get density values according to the grass field's channel
+            for (uint x = 0; x < width; ++x)
             {
-                // random horizontal position
-                pos.x = RandF(field.worldBox.x0 + 0.1f, field.worldBox.x1 - 0.1f);
-                pos.z = RandF(field.worldBox.z0 + 0.1f, field.worldBox.z1 - 0.1f);
-
-                // calc pixel coord for density map
-                const float x = (pos.x - field.worldBox.x0) * worldBoxInvDX;
-                const float y = 1.0f - (pos.z - field.worldBox.z0) * worldBoxInvDZ;  // flip vertically texture coord
-
-                const uint px = (uint)(x * densityMapWidth);
-                const uint py = (uint)(y * densityMapHeight);
-
-                // get density value according to the current grass field's channel
-                if (ch == 0)        density = densityMap.GetPixelRed(px, py);
-                else if (ch == 1)   density = densityMap.GetPixelGreen(px, py);
-                else if (ch == 2)   density = densityMap.GetPixelBlue(px, py);
-                else if (ch == 3)   density = densityMap.GetPixelGray(px, py);
-
-                numAllAttempts++;
-                numWasted++;
+                if (ch == 0)        values[x] = densityMapRGB.GetPixelRed(x, y);
+                else if (ch == 1)   values[x] = densityMapRGB.GetPixelGreen(x, y);
+                else if (ch == 2)   values[x] = densityMapRGB.GetPixelBlue(x, y);
+                else if (ch == 3)   values[x] = densityMapAlpha.GetPixelGray(x, y);
             }
-
-            numWasted--;
-
-            // get instance height according to terrain
-            pos.y = terrain.GetScaledInterpolatedHeightAtPoint(pos.x, pos.z);
-
-            assert(pos.x >= 0);
-            assert(pos.y >= 0);
-            assert(pos.z >= 0);
-
-            outGrass[grassIdx++].pos = pos;
         }
     }
 
-    s_TimeStats.timeGenPositions = GetTimePoint() - start;
-
-    LogMsg(LOG, "grass stats:  %d / %d", numWasted, numAllAttempts);
-    LogMsg(LOG, "percent wasted: %d", (int)((float)numWasted / (float)numAllAttempts * 100.0f));
+    return true;
 }
 
-struct Rect2d
+//---------------------------------------------------------
+// Desc:   get coords of cell in the grid of cells
+//---------------------------------------------------------
+inline void GetCellCoords(const GrassField& field, const index cellIdx, int& outX, int& outZ)
 {
-    float minX, maxX;
-    float minZ, maxZ;
-};
+    // NOTE: the same as in CalcGrassCellsBoundings()
+    outX = (int)(cellIdx % field.cellsByX);
+    outZ = (int)(cellIdx / field.cellsByX);
+}
 
 //---------------------------------------------------------
-// Desc:  get available positions for channel
-//        (for each density value [0-255], 0-low, 255-high density)
-// Args:  channel      - index of current grass channel
-//        outPositions - available positions per each density value
-//        densityMap   - texture with encoded density values
-//        fieldMinP    - minimal point for curr field boundaries
-//        fieldMaxP    - maximal point for curr field boundaries
-//---------------------------------------------------------
-void GetAvailPosForChannel(
-    const int channel,
-    cvector<Rect2d>* outPositions,
-    const Image& densityMap,
-    const Vec3& fieldMinP,
-    const Vec3& fieldMaxP)
+// Desc:   get number of all the instances of the cell (over all the channels)
+//---------------------------------------------------------
+inline uint32 GetCellNumInstances(const GrassCell& cell)
 {
-    assert(channel >= 0 && channel <= 3);
-    assert(outPositions);
-    assert(densityMap.IsLoaded());
+    uint32 num = 0;
 
-    const float fieldSizeX = fieldMaxP.x - fieldMinP.x;
-    const float fieldSizeZ = fieldMaxP.z - fieldMinP.z;
+    for (int ch = 0; ch < NUM_GRASS_CHANNELS; ++ch)
+        num += cell.channelInstanceCount[ch];
 
-    const uint8* pixels      = densityMap.GetPixels();
-    const uint   width       = densityMap.GetWidth();
-    const uint   height      = densityMap.GetHeight();
-    //const uint   numPixels   = width * height;
-    const uint   pixelStride = densityMap.GetBPP() / 8;
-
-    // calc how many space in world is covered by a single pixel from density map
-    const float densityMapCellWidth  = fieldSizeX / (float)width;
-    const float densityMapCellHeight = fieldSizeZ / (float)height;
+    return num;
+}
 
-    for (uint y = 0; y < height; ++y)
-    {
-        for (uint x = 0; x < width; ++x)
-        {
-            uint8 density = pixels[(y * width + x) * pixelStride + channel];
+//---------------------------------------------------------
+// Desc:   calc density mass of each channel of cells in range [start, end)
+//---------------------------------------------------------
+struct CellsDensityArgs
+{
+    const GrassField* pField     = nullptr;
+    float*            cellsMass  = nullptr;     // [numCells * NUM_GRASS_CHANNELS]
+};
 
-            // no intensity for this channel on density map - no grass here
-            if (density == 0)
-                continue;
+void CalcCellsDensityRange(void* pArgs, const int start, const int end)
+{
+    const CellsDensityArgs& args  = *(const CellsDensityArgs*)pArgs;
+    const GrassField&       field = *args.pField;
 
-            // calc "world position" for this density pixel
-            Rect2d densityCellPos;
-            densityCellPos.minX = densityMapCellWidth * (float)x + fieldMinP.x;
-            densityCellPos.maxX = densityCellPos.minX + densityMapCellWidth;
-            densityCellPos.minZ = densityMapCellHeight * (float)y + fieldMinP.z;
-            densityCellPos.maxZ = densityCellPos.minZ + densityMapCellHeight;
+    for (int cellIdx = start; cellIdx < end; ++cellIdx)
+    {
+        const Rect3d& cellBox = field.cellsWorldBoxes[cellIdx];
+        float*        mass    = args.cellsMass + cellIdx * NUM_GRASS_CHANNELS;
 
-            assert(densityCellPos.minX >= fieldMinP.x);
-            assert(densityCellPos.maxX <= fieldMaxP.x);
-            assert(densityCellPos.minZ >= fieldMinP.z);
-            assert(densityCellPos.maxZ <= fieldMaxP.z);
+        for (int ch = 0; ch < field.numChannels; ++ch)
+        {
+            const GrassDensityMap& map    = field.densityMaps[ch];
+            const GrassMapRegion   region = GetGrassMapRegion(map, field.worldBox, cellBox);
 
-            outPositions[density].push_back(densityCellPos);
+            mass[ch] = CalcGrassDensityMass(map, region);
         }
     }
 }
 
 //---------------------------------------------------------
+// Desc:   define number of instances of each channel for each cell:
+//         instances of channel are distributed between cells according
+//         to density mass of the channel inside of each cell
 //---------------------------------------------------------
-void GenGrassRandPositions2(GrassField& field, cvector<GrassInstance>& outGrass)
+void DistributeInstancesByCells(GrassField& field)
 {
-    const Terrain& terrain = g_ModelMgr.GetTerrain();
-    const float terrainLen = (float)terrain.GetTerrainLength();
+    const int numCells = (int)field.cells.size();
 
-    Image densityMapRGB;
-    Image densityMapAlpha;
-    Image* densityMaps[NUM_GRASS_CHANNELS]{ nullptr };
+    cvector<float> cellsMass(numCells * NUM_GRASS_CHANNELS);
+    cellsMass.fill_zeros();
 
-    // density map per channel
-    densityMaps[0] = &densityMapRGB;
-    densityMaps[1] = &densityMapRGB;
-    densityMaps[2] = &densityMapRGB;
-    densityMaps[3] = &densityMapAlpha;
+    CellsDensityArgs args;
+    args.pField    = &field;
+    args.cellsMass = cellsMass.data();
 
-    //
-    // load density maps for this grass field
-    //
-    densityMapRGB.LoadRgbBMP(field.densityMaskRGB);
+    g_JobSystem.ParallelFor(numCells, MIN_GRASS_CELLS_PER_JOB, CalcCellsDensityRange, &args);
 
-    if (!densityMapRGB.IsLoaded())
-    {
-        LogErr(LOG, "can't initialize density map (RGB) for grass field: %s", field.name);
-        return;
-    }
 
-    // load a density map for field's alpha channel if need
-    if (field.numChannels == 4)
+    for (int ch = 0; ch < field.numChannels; ++ch)
     {
-        densityMapAlpha.LoadGrayscaleBMP(field.densityMaskAlpha);
+        const uint32 numInst = field.numInstPerChannel[ch];
+        double       sumMass = 0;
 
-        if (!densityMapAlpha.IsLoaded())
-        {
-            LogErr(LOG, "can't load density map (alpha) for grass field: %s", field.name);
-            return;
-        }
+        for (int i = 0; i < numCells; ++i)
+            sumMass += cellsMass[i * NUM_GRASS_CHANNELS + ch];
 
-        if ((densityMapAlpha.GetWidth()  != densityMapRGB.GetWidth()) ||
-            (densityMapAlpha.GetHeight() != densityMapRGB.GetHeight()))
+        if (sumMass <= 0.0)
         {
-            LogErr(LOG, "density maps (both RGB and alpha) must have the same dimensions for grass field: %s", field.name);
-            return;
-        }
-    }
-
-    uint grassIdx = 0;
-    TimePoint start = GetTimePoint();
-   
-    constexpr int NUM_DENSITIES = 256;
-    cvector<Rect2d> densityMapCells[NUM_DENSITIES];
+            LogErr(LOG, "there is no place in density map for grass instances (%u) of channel %d (field: %s)",
+                   numInst, ch, field.name);
 
-    const Vec3 fieldMinP = field.worldBox.MinPoint();
-    const Vec3 fieldMaxP = field.worldBox.MaxPoint();
+            // so we have no instances for this channel
+            field.grassCount -= numInst;
+            field.numInstPerChannel[ch] = 0;
+            continue;
+        }
 
-    for (int ch = 0; ch < field.numChannels; ++ch)
-    {
-        // get available positions for channel
-        // (for each density value [0-255], 0-low, 255-high density)
-        GetAvailPosForChannel(ch, densityMapCells, *densityMaps[ch], fieldMinP, fieldMaxP);
+        // round cumulative number of instances so each cell gets its expected
+        // number rounded up or down and the sum is exactly the number of instances
+        const double instPerMass = (double)numInst / sumMass;
+        double       cumInst     = 0;
+        uint32       prevCumInst = 0;
 
-        // generate pos for each grass instance of this channel
-        for (uint i = 0; i < field.numInstPerChannel[ch]; ++i)
+        for (int i = 0; i < numCells; ++i)
         {
-            const uint8            density        = RandUint(1, 255);
-            const cvector<Rect2d>& densityCells   = densityMapCells[density];
-            const uint             densityCellIdx = RandUint(0, (UINT)(densityCells.size()-1));
-            const Rect2d&          densityCell    = densityCells[densityCellIdx];
-
-            // gen rand pos within density cell
-            Vec3& pos = outGrass[grassIdx++].pos;
-            pos.x = RandF(densityCell.minX, densityCell.maxX);
-            pos.z = RandF(densityCell.minZ, densityCell.maxZ);
-            pos.y = terrain.GetScaledInterpolatedHeightAtPoint(pos.x, pos.z);
+            cumInst += cellsMass[i * NUM_GRASS_CHANNELS + ch] * instPerMass;
 
-            assert(pos.x >= fieldMinP.x);
-            assert(pos.y >= fieldMinP.y);
-            assert(pos.z >= fieldMinP.z);
+            uint32 currCumInst = (i == numCells - 1) ? numInst : (uint32)(cumInst + 0.5);
+            currCumInst        = (currCumInst < numInst) ? currCumInst : numInst;
 
-            assert(pos.x <= fieldMaxP.x);
-            assert(pos.z <= fieldMaxP.z);
+            field.cells[i].channelInstanceCount[ch] = currCumInst - prevCumInst;
+            prevCumInst = currCumInst;
         }
-
-        // clear before handling the next channel
-        for (int i = 0; i < NUM_DENSITIES; ++i)
-            densityMapCells[i].clear();
     }
 
-    s_TimeStats.timeGenPositions = GetTimePoint() - start;
-}
-
-//---------------------------------------------------------
-// group grass instances into its cells
-//---------------------------------------------------------
-void GroupGrassInstancesByCells(GrassField& field, const cvector<GrassInstance>& grassInstances)
-{
-    const vsize numCells = field.cells.size();
-
-    int channel = 0;
-    uint32 idx = 0;
-
+    // setup instances start index of each channel
     for (GrassCell& cell : field.cells)
-        cell.grassInstances.clear();
-
-#if 0
-    for (const GrassInstance& grass : grassInstances)
     {
-        // if we need to switch to the next channel
-        if (idx >= field.numInstPerChannel[channel])
-        {
-            idx = 0;
-            channel++;
-            assert(channel < field.numChannels);
-        }
-
-        const Vec3& p = grass.pos;
+        uint32 start = 0;
 
-        for (index cellIdx = 0; cellIdx < numCells; ++cellIdx)
+        for (int ch = 0; ch < field.numChannels; ++ch)
         {
-            const Rect3d& box = field.cellsWorldBoxes[cellIdx];
-
-            const bool bInBox = (p.x >= box.x0) && (p.x <= box.x1) &&
-                                (p.z >= box.z0) && (p.z <= box.z1);
-
-            if (!bInBox)
-                continue;
-
-           
-            // bind instance to cell
-            field.cells[cellIdx].grassInstances.push_back(grass);
-            field.cells[cellIdx].channelInstanceCount[channel]++;
-
-            cellIdx = numCells;
+            cell.channelStart[ch] = start;
+            start += cell.channelInstanceCount[ch];
         }
-
-        idx++;
     }
 
-#else
-    const uint32 grassStartIdxs[4] = {
-        0,
-        grassStartIdxs[0] + field.numInstPerChannel[0],
-        grassStartIdxs[1] + field.numInstPerChannel[1],
-        grassStartIdxs[2] + field.numInstPerChannel[2],
-    };
-
-    const Vec3 fieldMidP = field.worldBox.MidPoint();
+    //
+    // check yourself
+    //
+    uint32 numAllInst = 0;
 
-    struct CellsGroup
-    {
-        index cellsIdxs[64];
-        size count;
-        float minX, maxX;
-        float minZ, maxZ;
-    };
+    for (const GrassCell& cell : field.cells)
+        numAllInst += GetCellNumInstances(cell);
 
-    constexpr int numGroupsByX = 8;
-    constexpr int numGroupsByZ = 8;
-    constexpr int numGroups = numGroupsByX * numGroupsByZ;
-    assert(IS_POW2(numGroups));
+    assert(numAllInst == field.grassCount);
+}
 
-    CellsGroup groups[numGroups];
-    memset(&groups, 0, sizeof(groups));
+//---------------------------------------------------------
+// Desc:   generate grass instances of a single cell; the result depends only
+//         on the field's params (seed, density, etc.) and the cell itself
+//         so cells can be generated in any order and by any thread
+// Args:   - aliasTable: tmp table (is passed to reuse its memory between cells)
+//---------------------------------------------------------
+void GenGrassCell(
+    const GrassField& field,
+    const index cellIdx,
+    GrassAliasTable& aliasTable,
+    GrassCell& cell)
+{
+    const Terrain& terrain = g_ModelMgr.GetTerrain();
+    const Rect3d&  cellBox = field.cellsWorldBoxes[cellIdx];
 
-    float groupSizeX = field.worldBox.SizeX() / (float)numGroupsByX;
-    float groupSizeZ = field.worldBox.SizeZ() / (float)numGroupsByZ;
+    int cellX = 0;
+    int cellZ = 0;
+    GetCellCoords(field, cellIdx, cellX, cellZ);
 
-    // calc boundings for each group
-    for (int row = 0; row < numGroupsByZ; ++row)
+    for (int ch = 0; ch < field.numChannels; ++ch)
     {
-        for (int col = 0; col < numGroupsByX; ++col)
-        {
-            int groupIdx = (row * numGroupsByX) + col;
-
-            groups[groupIdx].minX = groupSizeX * col;
-            groups[groupIdx].maxX = groups[groupIdx].minX + groupSizeX;
+        const uint32 numInst = cell.channelInstanceCount[ch];
 
-            groups[groupIdx].minZ = groupSizeZ * row;
-            groups[groupIdx].maxZ = groups[groupIdx].minZ + groupSizeZ;
-        }
-    }
+        if (numInst == 0)
+            continue;
 
-    // group cells by its positions
-    for (index cellIdx = 0; cellIdx < numCells; ++cellIdx)
-    {
-        const Rect3d& cellBox = field.cellsWorldBoxes[cellIdx];
+        const GrassDensityMap& map    = field.densityMaps[ch];
+        const GrassMapRegion   region = GetGrassMapRegion(map, field.worldBox, cellBox);
 
-        for (int groupIdx = 0; groupIdx < numGroups; ++groupIdx)
+        if (!aliasTable.Build(map, region))
         {
-            if (cellBox.x0 >= groups[groupIdx].minX &&
-                cellBox.x1 <= groups[groupIdx].maxX &&
-                cellBox.z0 >= groups[groupIdx].minZ &&
-                cellBox.z1 <= groups[groupIdx].maxZ)
-            {
-                index i = groups[groupIdx].count++;
-                groups[groupIdx].cellsIdxs[i] = cellIdx;
-                groupIdx = numGroups;
-            }
+            LogErr(LOG, "there is no place for grass (channel: %d) in cell %d of field: %s", ch, (int)cellIdx, field.name);
+            continue;
         }
-    }
-
-    const size numCellsPerGroup = field.cells.size() / numGroups;
-    for (int groupIdx = 0; groupIdx < numGroups; ++groupIdx)
-    {
-        assert(groups[groupIdx].count == numCellsPerGroup);
-    }
 
+        const float    minS      = field.channelGrassScaleMin[ch];
+        const float    maxS      = field.channelGrassScaleMax[ch];
+        const bool     genModel  = field.bGeneratedModel[ch];
+        GrassInstance* instances = cell.grassInstances.data() + cell.channelStart[ch];
 
-    for (int ch = 0; ch < field.numChannels; ++ch)
-    {
-        const uint32 idxOffset = grassStartIdxs[ch];
+        // each channel of each cell has its own sequence of random values
+        RandGen rng(GetGrassCellSeed(field.seed, cellX, cellZ, ch));
 
-        // for each grass related to the current channel
-        for (uint32 i = 0; i < field.numInstPerChannel[ch]; ++i)
+        for (uint32 i = 0; i < numInst; ++i)
         {
-            const GrassInstance& grassInst = grassInstances[i + idxOffset];
-            const Vec3& p = grassInst.pos;
-            index groupIdx = -1;
+            GrassInstance& grass = instances[i];
+            Vec3&          pos   = grass.pos;
 
-            // define cells group
-            for (int idx = 0; idx < numGroups; ++idx)
-            {
-                if (p.x >= groups[idx].minX &&
-                    p.x <= groups[idx].maxX &&
-                    p.z >= groups[idx].minZ &&
-                    p.z <= groups[idx].maxZ)
-                {
-                    groupIdx = idx;
-                    idx = numGroups;
-                }
-            }
+            aliasTable.SamplePos(rng, field.worldBox, pos.x, pos.z);
 
-            assert(groupIdx != -1);
+            // get instance height according to terrain
+            pos.y = terrain.GetScaledInterpolatedHeightAtPoint(pos.x, pos.z);
 
-            size   numCells  = groups[groupIdx].count;
-            index* cellsIdxs = groups[groupIdx].cellsIdxs;
+            assert(pos.x >= 0);
+            assert(pos.y >= 0);
+            assert(pos.z >= 0);
 
-            for (index c = 0; c < numCells; ++c)
+            // if a model for this channel is generated we need to setup
+            // for each instance its row and column on texture atlas
+            if (genModel)
             {
-                const index cellIdx = cellsIdxs[c];
-                const Rect3d& box = field.cellsWorldBoxes[cellIdx];
-
-                // if grass is inside this cell's boundaries
-                if ((p.x >= box.x0) && (p.x <= box.x1) &&
-                    (p.z >= box.z0) && (p.z <= box.z1))
-                {
-                    // bind instance to cell
-                    field.cells[cellIdx].grassInstances.push_back(grassInst);
-                    field.cells[cellIdx].channelInstanceCount[ch]++;
-                    c = numCells;
-                }
+                grass.texColumn = ch;                  // is the same as channel index
+                grass.texRow    = (int)rng.NextUint(0, field.texRows);
+            }
+            // we use own tex coords of the model
+            else
+            {
+                grass.texColumn = -1;
+                grass.texRow    = -1;
             }
-        }
-    }
-   
-#endif
-
-    // setup instances start index of each channel
-    for (GrassCell& cell : field.cells)
-        cell.channelStart[0] = 0;
-
-    for (int ch = 1; ch < field.numChannels; ++ch)
-    {
-        for (GrassCell& cell : field.cells)
-        {
-            uint32 prevStart = cell.channelStart[ch - 1];
-            uint32 prevCount = cell.channelInstanceCount[ch - 1];
 
-            cell.channelStart[ch] = prevStart + prevCount;
+            grass.scale = rng.NextF(minS, maxS);
         }
     }
+}
 
-    //
-    // check yourself
-    //
-    for (const GrassCell& cell : field.cells)
-    {
-        uint32 start = 0;
+//---------------------------------------------------------
+// Desc:   get distance by XZ from the point to the box (0 if point is inside)
+//---------------------------------------------------------
+inline float GetDistXZ(const Vec3& p, const Rect3d& box)
+{
+    const float dx = Max(Max(box.x0 - p.x, p.x - box.x1), 0.0f);
+    const float dz = Max(Max(box.z0 - p.z, p.z - box.z1), 0.0f);
 
-        // >= 0 because cells aren't required to have any grass instances at all
-        assert(cell.grassInstances.size() >= 0);
+    return sqrtf(dx*dx + dz*dz);
+}
 
-        // the first channel is required
-        assert(cell.channelStart[0] == 0);
-        start += cell.channelInstanceCount[0];
+//---------------------------------------------------------
+// Desc:   get distance from the point to the box (0 if point is inside)
+//---------------------------------------------------------
+inline float GetDist3D(const Vec3& p, const Rect3d& box)
+{
+    const float dx = Max(Max(box.x0 - p.x, p.x - box.x1), 0.0f);
+    const float dy = Max(Max(box.y0 - p.y, p.y - box.y1), 0.0f);
+    const float dz = Max(Max(box.z0 - p.z, p.z - box.z1), 0.0f);
 
-        // check the rest of channels
-        for (int ch = 1; ch < field.numChannels; ++ch)
-        {
-            assert(cell.channelStart[ch] == start);
-            start += cell.channelInstanceCount[ch];
-        }
-    }
+    return sqrtf(dx*dx + dy*dy + dz*dz);
 }
 
 //---------------------------------------------------------
 //---------------------------------------------------------
 void CreateCells(GrassField& field, const GrassFieldInitParams& params)
 {
-    const Terrain& terrain  = g_ModelMgr.GetTerrain();
-    const int      numCells = field.cellsByX * field.cellsByZ;
-
-    cvector<GrassInstance> grassItems(field.grassCount);
-
+    const int numCells = field.cellsByX * field.cellsByZ;
 
     // alloc memory for cells and its boundings
     field.cells.resize(numCells);
@@ -1024,59 +782,69 @@ void CreateCells(GrassField& field, const GrassFieldInitParams& params)
 
 
     TimePoint start2 = GetTimePoint();
-    GenerateGrassInstances(field, grassItems);
-    s_TimeStats.timeGenInstances = GetTimePoint() - start2;
-    printf("here\n");
+    if (!LoadDensityMaps(field))
+    {
+        field.grassCount = 0;
+        return;
+    }
+    s_TimeStats.timeLoadDensity = GetTimePoint() - start2;
 
+
+    // NOTE: instances of cells aren't generated here: cells are
+    //       generated/evicted on demand around the camera (see StreamGrassCells)
     TimePoint start3 = GetTimePoint();
-    GroupGrassInstancesByCells(field, grassItems);
-    s_TimeStats.timeGroupByCells = GetTimePoint() - start3;
-    printf("here2\n");
+    DistributeInstancesByCells(field);
+    s_TimeStats.timeCellsDensity = GetTimePoint() - start3;
 }
 
 //---------------------------------------------------------
-// go for each grass instance and use its position to define
-// min and max height of grass field's bounding box 
+// Desc:   define min and max height of each cell and of the whole field
+//         according to terrain under it (so it doesn't depend on instances
+//         and can be computed when instances aren't generated yet)
 //---------------------------------------------------------
 void CalcFieldYBoundings(GrassField& field)
 {
-    float minY = FLT_MAX;
-    float maxY = FLT_MIN;
+    const Terrain& terrain    = g_ModelMgr.GetTerrain();
+    const int      maxCoord   = terrain.GetTerrainLength() - 1;
+
+    // instances are placed onto the ground so add the max height of grass
+    float maxGrassHeight = 0;
+
+    for (int ch = 0; ch < field.numChannels; ++ch)
+        maxGrassHeight = Max(maxGrassHeight, field.channelGrassScaleMax[ch]);
 
-    // calc Y-boundings of each cell
-    for (index i = 0; i < field.cells.size(); ++i)
+    // calc Y-boundings of each cell: terrain height is bilinearly
+    // interpolated so it is bounded by heights of the grid points around
+    for (Rect3d& box : field.cellsWorldBoxes)
     {
-        const GrassCell& cell = field.cells[i];
+        const int x0 = Max((int)floorf(box.x0), 0);
+        const int x1 = Min((int)ceilf (box.x1), maxCoord);
+        const int z0 = Max((int)floorf(box.z0), 1);
+        const int z1 = Min((int)ceilf (box.z1), maxCoord);
 
-        // min/max height is based on position of the lowest/highest grass instance
-        for (const GrassInstance& grass : cell.grassInstances)
-        {
-            minY = Min(minY, grass.pos.y);
-            maxY = Max(maxY, grass.pos.y);
-        }
+        float minY = FLT_MAX;
+        float maxY = -FLT_MAX;
 
-        // set Y-boundings
-        if (cell.grassInstances.size() > 0)
+        for (int z = z0; z <= z1; ++z)
         {
-            field.cellsWorldBoxes[i].y0 = minY;
-            field.cellsWorldBoxes[i].y1 = maxY;
-        }
-        else
-        {
-            field.cellsWorldBoxes[i].y0 = 0;
-            field.cellsWorldBoxes[i].y1 = 0;
+            for (int x = x0; x <= x1; ++x)
+            {
+                const float h = terrain.GetScaledHeightAtPoint(x, z);
+                minY = Min(minY, h);
+                maxY = Max(maxY, h);
+            }
         }
 
-        minY = FLT_MAX;
-        maxY = FLT_MIN;
+        box.y0 = (minY <= maxY) ? minY : 0;
+        box.y1 = (minY <= maxY) ? maxY + maxGrassHeight : 0;
     }
 
 
     // calc Y-bounding of the whole field (is based on lowest/highest cell)
-    minY = FLT_MAX;
-    maxY = FLT_MIN;
+    float minY = FLT_MAX;
+    float maxY = -FLT_MAX;
 
-    for (int i = 0; const Rect3d& box : field.cellsWorldBoxes)
+    for (const Rect3d& box : field.cellsWorldBoxes)
     {
         minY = Min(minY, box.y0);
         maxY = Max(maxY, box.y1);
@@ -1094,7 +862,7 @@ void CalcFieldYBoundings(GrassField& field)
     assert(field.worldBox.z0 >= 0);
 
     assert(field.worldBox.x0 < field.worldBox.x1);
-    assert(field.worldBox.y0 < field.worldBox.y1);
+    assert(field.worldBox.y0 <= field.worldBox.y1);
     assert(field.worldBox.z0 < field.worldBox.z1);
 
     // check world box of each cell
@@ -1105,25 +873,141 @@ void CalcFieldYBoundings(GrassField& field)
         assert(box.z0 >= 0);
 
         assert(box.x0 < box.x1);
-        assert(box.y0 <= box.y1);   // NOTE: minY can == maxY when there are no grass instances in the cell
+        assert(box.y0 <= box.y1);
         assert(box.z0 < box.z1);
     }
 }
 
+//---------------------------------------------------------
+// Desc:   extend the box so it will contain another box
+//---------------------------------------------------------
+inline void UnionBox(Rect3d& box, const Rect3d& other)
+{
+    box.x0 = Min(box.x0, other.x0);
+    box.y0 = Min(box.y0, other.y0);
+    box.z0 = Min(box.z0, other.z0);
+
+    box.x1 = Max(box.x1, other.x1);
+    box.y1 = Max(box.y1, other.y1);
+    box.z1 = Max(box.z1, other.z1);
+}
+
+//---------------------------------------------------------
+// Desc:   split the node into up to 4 children (contiguous in the array)
+//         until a node covers no more than NxN cells; a box of each node
+//         is a union of boxes of its cells
+//---------------------------------------------------------
+void BuildCellsSubtree(GrassField& field, const int nodeIdx)
+{
+    // copy since the array can be reallocated when we add children
+    GrassCellsNode node = field.cellsTree[nodeIdx];
+
+    const int sizeX = node.cellX1 - node.cellX0;
+    const int sizeZ = node.cellZ1 - node.cellZ0;
+
+    // leaf: compute its box by covered cells
+    if (sizeX <= GRASS_TREE_LEAF_SIZE && sizeZ <= GRASS_TREE_LEAF_SIZE)
+    {
+        node.box = field.cellsWorldBoxes[node.cellZ0 * field.cellsByX + node.cellX0];
+
+        for (int z = node.cellZ0; z < node.cellZ1; ++z)
+        {
+            for (int x = node.cellX0; x < node.cellX1; ++x)
+                UnionBox(node.box, field.cellsWorldBoxes[z * field.cellsByX + x]);
+        }
+
+        field.cellsTree[nodeIdx] = node;
+        return;
+    }
+
+    // don't split along axis which is already small enough
+    const int midX = (sizeX > GRASS_TREE_LEAF_SIZE) ? node.cellX0 + sizeX/2 : node.cellX1;
+    const int midZ = (sizeZ > GRASS_TREE_LEAF_SIZE) ? node.cellZ0 + sizeZ/2 : node.cellZ1;
+
+    const int rangesX[3] = { node.cellX0, midX, node.cellX1 };
+    const int rangesZ[3] = { node.cellZ0, midZ, node.cellZ1 };
+
+    node.firstChild  = (int)field.cellsTree.size();
+    node.numChildren = 0;
+
+    for (int iz = 0; iz < 2; ++iz)
+    {
+        for (int ix = 0; ix < 2; ++ix)
+        {
+            if (rangesX[ix] == rangesX[ix+1] || rangesZ[iz] == rangesZ[iz+1])
+                continue;
+
+            GrassCellsNode child;
+            child.cellX0      = (uint16)rangesX[ix];
+            child.cellX1      = (uint16)rangesX[ix+1];
+            child.cellZ0      = (uint16)rangesZ[iz];
+            child.cellZ1      = (uint16)rangesZ[iz+1];
+            child.firstChild  = -1;
+            child.numChildren = 0;
+
+            field.cellsTree.push_back(child);
+            node.numChildren++;
+        }
+    }
+
+    for (int i = 0; i < node.numChildren; ++i)
+        BuildCellsSubtree(field, node.firstChild + i);
+
+    node.box = field.cellsTree[node.firstChild].box;
+
+    for (int i = 1; i < node.numChildren; ++i)
+        UnionBox(node.box, field.cellsTree[node.firstChild + i].box);
+
+    field.cellsTree[nodeIdx] = node;
+}
+
+//---------------------------------------------------------
+// Desc:   build a coarse quadtree over cells of the field to reject
+//         groups of cells by visibility range and frustum at once
+//         (must be rebuilt when AABBs of cells are changed)
+//---------------------------------------------------------
+void BuildCellsTree(GrassField& field)
+{
+    field.cellsTree.clear();
+
+    if (field.cellsWorldBoxes.empty())
+        return;
+
+    GrassCellsNode root;
+    root.cellX0      = 0;
+    root.cellX1      = field.cellsByX;
+    root.cellZ0      = 0;
+    root.cellZ1      = field.cellsByZ;
+    root.firstChild  = -1;
+    root.numChildren = 0;
+
+    field.cellsTree.push_back(root);
+    BuildCellsSubtree(field, 0);
+}
+
 //---------------------------------------------------------
 // create instances buffer for the input grass field
+// (it is big enough only for instances to render per frame)
 //---------------------------------------------------------
-void InitBuffers(GrassField& field)
+void InitBuffers(GrassField& field, const uint32 instancesBudget)
 {
     HRESULT hr = S_OK;
     ID3D11Device* pDevice = Render::GetD3dDevice();
 
+    field.instancesBufCapacity = Min(field.grassCount, instancesBudget);
+
+    if (field.instancesBufCapacity == 0)
+    {
+        LogErr(LOG, "there is no instances to render for grass field: %s", field.name);
+        return;
+    }
+
     D3D11_BUFFER_DESC desc;
     memset(&desc, 0, sizeof(desc));
 
     // setup buffer's description
     desc.Usage               = D3D11_USAGE_DYNAMIC;
-    desc.ByteWidth           = (UINT)(sizeof(GrassInstance) * field.grassCount);
+    desc.ByteWidth           = (UINT)(sizeof(GrassInstance) * field.instancesBufCapacity);
     desc.BindFlags           = D3D11_BIND_VERTEX_BUFFER;
     desc.CPUAccessFlags      = D3D11_CPU_ACCESS_WRITE;
     desc.MiscFlags           = 0;
@@ -1133,11 +1017,301 @@ void InitBuffers(GrassField& field)
     if (FAILED(hr))
     {
         LogErr(LOG, "can't create an instanced buffer for grass field: %s", field.name);
+        field.instancesBufCapacity = 0;
+        return;
     }
 
     LogMsg(LOG, "instances buffer for grass field (%s) is initialized successfully!", field.name);
 }
 
+//---------------------------------------------------------
+// Desc:  generate instances of the cell again (if the cell is resident;
+//        otherwise it will be generated when the camera is near it);
+//        the number of instances of the cell isn't changed
+//---------------------------------------------------------
+void GrassMgr::RegenerateGrassCell(const index fieldIdx, const index cellIdx)
+{
+    assert(fieldIdx >= 0 && fieldIdx < grassFields_.size());
+
+    GrassField& field = grassFields_[fieldIdx];
+    assert(cellIdx >= 0 && cellIdx < field.cells.size());
+
+    // height of terrain could be changed
+    CalcFieldYBoundings(field);
+    BuildCellsTree(field);
+
+    GrassCell& cell = field.cells[cellIdx];
+
+    if (!cell.isResident)
+        return;
+
+    GrassAliasTable aliasTable;
+    GenGrassCell(field, cellIdx, aliasTable, cell);
+
+    // instances in the buffer are outdated
+    field.instancesBufHash = 0;
+}
+
+//---------------------------------------------------------
+// Desc:  distribute instances of the field between cells again and generate
+//        its resident cells again (the rest are generated when the camera
+//        is near them); the result must be the same as at creation
+//---------------------------------------------------------
+void GrassMgr::RegenerateGrassField(const index fieldIdx)
+{
+    assert(fieldIdx >= 0 && fieldIdx < grassFields_.size());
+
+    GrassField& field = grassFields_[fieldIdx];
+    DistributeInstancesByCells(field);
+
+    GrassAliasTable aliasTable;
+
+    for (index cellIdx = 0; cellIdx < field.cells.size(); ++cellIdx)
+    {
+        GrassCell& cell = field.cells[cellIdx];
+
+        if (!cell.isResident)
+            continue;
+
+        cell.grassInstances.resize(GetCellNumInstances(cell));
+        GenGrassCell(field, cellIdx, aliasTable, cell);
+    }
+
+    // instances in the buffer are outdated
+    field.instancesBufHash = 0;
+}
+
+//---------------------------------------------------------
+// Desc:  compute hashes of cells in range [start, end): each cell is
+//        generated into a tmp cell (independently of its residency)
+//---------------------------------------------------------
+struct CellsHashesArgs
+{
+    const GrassField* pField       = nullptr;
+    uint64*           cellsHashes  = nullptr;
+};
+
+void CalcCellsHashesRange(void* pArgs, const int start, const int end)
+{
+    const CellsHashesArgs& args  = *(const CellsHashesArgs*)pArgs;
+    const GrassField&      field = *args.pField;
+
+    GrassAliasTable aliasTable;
+    GrassCell       tmpCell;
+
+    for (int cellIdx = start; cellIdx < end; ++cellIdx)
+    {
+        const GrassCell& cell = field.cells[cellIdx];
+
+        memcpy(tmpCell.channelStart,         cell.channelStart,         sizeof(cell.channelStart));
+        memcpy(tmpCell.channelInstanceCount, cell.channelInstanceCount, sizeof(cell.channelInstanceCount));
+        tmpCell.grassInstances.resize(GetCellNumInstances(cell));
+
+        GenGrassCell(field, cellIdx, aliasTable, tmpCell);
+
+        // hash instances of the cell (64-bit FNV-1a)
+        const uint8* bytes    = (const uint8*)tmpCell.grassInstances.data();
+        const vsize  numBytes = tmpCell.grassInstances.size() * sizeof(GrassInstance);
+        uint64       hash     = 14695981039346656037ull;
+
+        for (vsize i = 0; i < numBytes; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+
+        args.cellsHashes[cellIdx] = hash;
+    }
+}
+
+//---------------------------------------------------------
+// Desc:  compute a hash of all the instances of the field in order of cells;
+//        is used to check that generation gives the same result for
+//        the same params (independently of threads and residency of cells)
+//---------------------------------------------------------
+uint64 GrassMgr::CalcGrassFieldHash(const index fieldIdx) const
+{
+    assert(fieldIdx >= 0 && fieldIdx < grassFields_.size());
+
+    const GrassField& field    = grassFields_[fieldIdx];
+    const int         numCells = (int)field.cells.size();
+
+    cvector<uint64> cellsHashes(numCells);
+
+    CellsHashesArgs args;
+    args.pField      = &field;
+    args.cellsHashes = cellsHashes.data();
+
+    g_JobSystem.ParallelFor(numCells, MIN_GRASS_CELLS_PER_JOB, CalcCellsHashesRange, &args);
+
+    // combine hashes of cells
+    uint64 hash = 14695981039346656037ull;
+
+    for (const uint64 cellHash : cellsHashes)
+    {
+        hash ^= cellHash;
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+//---------------------------------------------------------
+// Desc:  generate instances of cells from cellsToGen_ in range [start, end)
+//---------------------------------------------------------
+void GrassMgr::GenCellsRange(void* pArgs, const int start, const int end)
+{
+    GrassMgr&       mgr = *(GrassMgr*)pArgs;
+    GrassAliasTable aliasTable;
+
+    for (int i = start; i < end; ++i)
+    {
+        const GrassCellRef& ref   = mgr.cellsToGen_[i];
+        GrassField&         field = mgr.grassFields_[ref.fieldIdx];
+
+        GenGrassCell(field, ref.cellIdx, aliasTable, field.cells[ref.cellIdx]);
+    }
+}
+
+//---------------------------------------------------------
+// Desc:  keep instances only of cells around the camera:
+//        - cells which are too far are evicted (its instances are released);
+//        - the nearest not resident cells in the streaming radius are
+//          generated (in parallel, a limited number of cells per frame)
+//---------------------------------------------------------
+void GrassMgr::StreamGrassCells(const Vec3 camPos)
+{
+    const float loadRadius  = grassVisRange_ + GRASS_STREAM_PRELOAD_DIST;
+    const float evictRadius = grassVisRange_ + GRASS_STREAM_EVICT_DIST;
+
+    stats_.numGeneratedCells = 0;
+    stats_.numEvictedCells   = 0;
+
+    // evict cells which are too far from the camera
+    for (index i = 0; i < residentCells_.size(); )
+    {
+        const GrassCellRef& ref   = residentCells_[i];
+        GrassField&         field = grassFields_[ref.fieldIdx];
+
+        if (GetDistXZ(camPos, field.cellsWorldBoxes[ref.cellIdx]) <= evictRadius)
+        {
+            ++i;
+            continue;
+        }
+
+        GrassCell& cell = field.cells[ref.cellIdx];
+        cell.grassInstances.purge();
+        cell.isResident = false;
+
+        residentCells_.swap_pop(i);
+        stats_.numEvictedCells++;
+    }
+
+
+    // gather not resident cells in the streaming radius
+    cellsToGen_.clear();
+
+    for (index fieldIdx = 0; fieldIdx < grassFields_.size(); ++fieldIdx)
+    {
+        GrassField&   field = grassFields_[fieldIdx];
+        const Rect3d& box   = field.worldBox;
+
+        if (field.cells.empty() || GetDistXZ(camPos, box) > loadRadius)
+            continue;
+
+        // range of cells (by X and Z) around the camera
+        const float invCellSizeX = (float)field.cellsByX / box.SizeX();
+        const float invCellSizeZ = (float)field.cellsByZ / box.SizeZ();
+
+        const int col0 = Max((int)((camPos.x - loadRadius - box.x0) * invCellSizeX), 0);
+        const int row0 = Max((int)((camPos.z - loadRadius - box.z0) * invCellSizeZ), 0);
+        const int col1 = Min((int)((camPos.x + loadRadius - box.x0) * invCellSizeX), field.cellsByX - 1);
+        const int row1 = Min((int)((camPos.z + loadRadius - box.z0) * invCellSizeZ), field.cellsByZ - 1);
+
+        for (int row = row0; row <= row1; ++row)
+        {
+            for (int col = col0; col <= col1; ++col)
+            {
+                const index      cellIdx = row * field.cellsByX + col;
+                const GrassCell& cell    = field.cells[cellIdx];
+
+                if (cell.isResident || GetCellNumInstances(cell) == 0)
+                    continue;
+
+                const float dist = GetDistXZ(camPos, field.cellsWorldBoxes[cellIdx]);
+
+                if (dist <= loadRadius)
+                    cellsToGen_.push_back(GrassCellRef{ fieldIdx, cellIdx, dist });
+            }
+        }
+    }
+
+
+    // generate only the nearest cells during a single frame
+    // (so moving to a new place doesn't cause a spike)
+    const vsize numToGen = Min(cellsToGen_.size(), (vsize)MAX_GRASS_CELLS_GEN_PER_FRAME);
+
+    for (vsize i = 0; i < numToGen; ++i)
+    {
+        vsize nearest = i;
+
+        for (vsize j = i + 1; j < cellsToGen_.size(); ++j)
+        {
+            if (cellsToGen_[j].dist < cellsToGen_[nearest].dist)
+                nearest = j;
+        }
+
+        std::swap(cellsToGen_[i], cellsToGen_[nearest]);
+    }
+
+    cellsToGen_.resize(numToGen);
+
+    for (const GrassCellRef& ref : cellsToGen_)
+    {
+        GrassCell& cell = grassFields_[ref.fieldIdx].cells[ref.cellIdx];
+        cell.grassInstances.resize(GetCellNumInstances(cell));
+    }
+
+    g_JobSystem.ParallelFor((int)numToGen, 1, GenCellsRange, this);
+
+    for (const GrassCellRef& ref : cellsToGen_)
+    {
+        grassFields_[ref.fieldIdx].cells[ref.cellIdx].isResident = true;
+        residentCells_.push_back(ref);
+    }
+
+    stats_.numGeneratedCells = (uint32)numToGen;
+
+
+    // update memory stats
+    stats_.numResidentCells = (uint32)residentCells_.size();
+    stats_.numResidentInst  = 0;
+    stats_.memResident      = 0;
+
+    for (const GrassCellRef& ref : residentCells_)
+    {
+        const GrassCell& cell = grassFields_[ref.fieldIdx].cells[ref.cellIdx];
+
+        stats_.numResidentInst += (uint32)cell.grassInstances.size();
+        stats_.memResident     += cell.grassInstances.capacity() * sizeof(GrassInstance);
+    }
+}
+
+//---------------------------------------------------------
+// Desc:  get part of instances of cell to render according to its
+//        distance to the camera (far cells are thinned out)
+//---------------------------------------------------------
+float GrassMgr::GetDensityByDist(const float dist) const
+{
+    const float thinStart = Max(grassDistFullSize_, grassVisRange_ * GRASS_THINNING_START);
+
+    if (dist <= thinStart)
+        return 1.0f;
+
+    const float t = (dist - thinStart) / (grassVisRange_ - thinStart);
+    return lerp(1.0f, GRASS_MIN_DENSITY_FAR, clampf(t, 0.0f, 1.0f));
+}
+
 //---------------------------------------------------------
 // Args:  - camPos:         position of camera in world
 //        - pWorldFrustum:  camera's frustum in world space
@@ -1146,84 +1320,196 @@ void GrassMgr::Update(const Vec3 camPos, const Frustum* pWorldFrustum)
 {
     assert(pWorldFrustum);
 
-    // reset some rendering data
-    for (GrassField& field : grassFields_)
-    {
-        field.instancesBufCounts[0] = 0;
-        field.instancesBufCounts[1] = 0;
-        field.instancesBufCounts[2] = 0;
-        field.instancesBufCounts[3] = 0;
-    }
-   
     CalcVisibleGrass(camPos, pWorldFrustum);
-
     UpdateGrassInstancedBuf();
 }
 
 //---------------------------------------------------------
 // Desc:   calculate visible grass fields and its cells
+//
+// NOTE:   doesn't touch D3D so it can be executed by a worker thread
 //---------------------------------------------------------
 void GrassMgr::CalcVisibleGrass(const Vec3 camPos, const Frustum* pWorldFrustum)
 {
     assert(grassVisRange_ > 0);
 
-    const float grassVisRange = grassVisRange_;
+    // generate/evict cells around the camera
+    StreamGrassCells(camPos);
+
     visFields_.clear();
 
+    stats_.numTestedNodes = 0;
+    stats_.numTestedCells = 0;
+
 
     // gather visible grass fields
+    fieldsVisIdxs_.resize(grassFields_.size());
+
     for (index i = 0; i < grassFields_.size(); ++i)
     {
+        fieldsVisIdxs_[i] = -1;
+
         if (!pWorldFrustum->TestRect(grassFields_[i].worldBox))
             continue;
 
+        fieldsVisIdxs_[i] = visFields_.size();
         visFields_.push_back(VisibleGrassField());
         visFields_.back().fieldIdx = i;
     }
 
 
-    // go through each visible grass field...
-    for (index i = 0; i < visFields_.size(); ++i)
+    // gather visible cells of each visible field
+    float numInstToRender = 0;
+
+    for (VisibleGrassField& visField : visFields_)
+        CullGrassCells(grassFields_[visField.fieldIdx], camPos, pWorldFrustum, visField, numInstToRender);
+
+
+    // too many instances: thin out all the visible cells evenly
+    if (numInstToRender > (float)instancesBudget_)
+    {
+        const float scale = (float)instancesBudget_ / numInstToRender;
+
+        for (VisibleGrassField& visField : visFields_)
+        {
+            for (float& density : visField.cellsDensity)
+                density *= scale;
+        }
+
+        numInstToRender = (float)instancesBudget_;
+    }
+
+    stats_.numRenderedInst = (uint32)numInstToRender;
+
+
+    // quantize density and compute hash of each visible field (if it is
+    // the same as for instances in the buffer we don't rewrite the buffer)
+    for (VisibleGrassField& visField : visFields_)
     {
-        VisibleGrassField& visField = visFields_[i];
-        const GrassField&  field    = grassFields_[visField.fieldIdx];
+        uint64 hash = 14695981039346656037ULL;
 
-        // ... and gather visible cells
-        for (index cellIdx = 0; cellIdx < field.cells.size(); ++cellIdx)
+        for (index i = 0; i < visField.cellsIdxs.size(); ++i)
         {
-            // check if this cell is in the visibility range
-            const Rect3d& box = field.cellsWorldBoxes[cellIdx];
+            const float step = floorf(visField.cellsDensity[i] * GRASS_DENSITY_STEPS);
+
+            visField.cellsDensity[i] = step / GRASS_DENSITY_STEPS;
 
-            const Vec3 toEye = camPos - box.MidPoint();
-            const Vec3 ext   = box.Extents();
+            hash = (hash ^ (uint64)visField.cellsIdxs[i]) * 1099511628211ULL;
+            hash = (hash ^ (uint64)step)                  * 1099511628211ULL;
+        }
 
-            const float distToCam = FastDistance3D(toEye.x, toEye.y, toEye.z);
-            const float boxRadius = FastDistance3D(ext.x, ext.y, ext.z);
+        // 0 is reserved for "invalid"
+        visField.hash = (hash != 0) ? hash : 1;
+    }
+}
 
-            const float distToCenter = distToCam - boxRadius;
+//---------------------------------------------------------
+// Desc:  gather visible cells of the field: walk through the cells quadtree
+//        and reject the whole nodes which are out of visibility range or
+//        frustum; if a node is completely inside of the frustum then its
+//        cells are accepted without any frustum tests
+//---------------------------------------------------------
+void GrassMgr::CullGrassCells(
+    const GrassField& field,
+    const Vec3& camPos,
+    const Frustum* pWorldFrustum,
+    VisibleGrassField& visField,
+    float& numInstToRender)
+{
+    const float visRange = grassVisRange_;
 
-            // if cell is out of visibility range we don't render it
-            if (distToCenter > grassVisRange)
-                continue;
+    if (field.cellsTree.empty())
+        return;
 
-            // check if patch is in view frustum
-            if (!pWorldFrustum->TestRect(box))
+    // each entry: (node idx << 1) | (is node completely inside of frustum)
+    nodesStack_.clear();
+    nodesStack_.push_back(0);
+
+    while (!nodesStack_.empty())
+    {
+        const int entry = nodesStack_.back();
+        nodesStack_.pop_back();
+
+        const GrassCellsNode& node    = field.cellsTree[entry >> 1];
+        bool                  bInside = (entry & 1);
+
+        stats_.numTestedNodes++;
+
+        // the whole node is out of visibility range
+        if (GetDist3D(camPos, node.box) > visRange)
+            continue;
+
+        if (!bInside)
+        {
+            const int side = pWorldFrustum->ClassifyRect(node.box);
+
+            if (side == PLANE_BACK)
                 continue;
 
-            // this cell is visible
-            visField.cellsIdxs.push_back(cellIdx);
+            bInside = (side == PLANE_FRONT);
+        }
+
+        if (node.firstChild != -1)
+        {
+            for (int i = 0; i < node.numChildren; ++i)
+                nodesStack_.push_back(((node.firstChild + i) << 1) | (int)bInside);
+            continue;
+        }
+
+        // leaf: test its cells (only resident cells have instances to render)
+        for (int z = node.cellZ0; z < node.cellZ1; ++z)
+        {
+            for (int x = node.cellX0; x < node.cellX1; ++x)
+            {
+                const index      cellIdx = z * field.cellsByX + x;
+                const GrassCell& cell    = field.cells[cellIdx];
+
+                if (!cell.isResident)
+                    continue;
+
+                // if cell is out of visibility range we don't render it
+                const Rect3d& box  = field.cellsWorldBoxes[cellIdx];
+                const float   dist = GetDist3D(camPos, box);
+
+                if (dist > visRange)
+                    continue;
+
+                if (!bInside)
+                {
+                    stats_.numTestedCells++;
+
+                    if (!pWorldFrustum->TestRect(box))
+                        continue;
+                }
+
+                // this cell is visible
+                const float density = GetDensityByDist(dist);
+
+                visField.cellsIdxs.push_back(cellIdx);
+                visField.cellsDensity.push_back(density);
+
+                numInstToRender += density * (float)cell.grassInstances.size();
+            }
         }
     }
 }
 
 //---------------------------------------------------------
 // Desc:  update instanced buffer per visible grass field
+//        (must be called from the thread which owns the D3D context)
+//
+// NOTE:  instances of each channel of cell are in random order so
+//        a prefix of them is evenly thinned out grass of this cell;
+//        if the set of visible cells (and their density) isn't changed
+//        since the last update the buffer is kept as it is
 //---------------------------------------------------------
 void GrassMgr::UpdateGrassInstancedBuf()
 {
     ID3D11DeviceContext* pCtx = Render::GetD3dContext();
     D3D11_MAPPED_SUBRESOURCE mappedData;
 
+    stats_.numBufUpdates = 0;
+
 
     for (const VisibleGrassField& visField : visFields_)
     {
@@ -1231,6 +1517,19 @@ void GrassMgr::UpdateGrassInstancedBuf()
 
         ID3D11Buffer* pBuf = field.pInstancedBuf;
 
+        if (!pBuf)
+            continue;
+
+        // buffer already contains exactly these instances
+        if (field.instancesBufHash == visField.hash)
+            continue;
+
+        field.instancesBufHash      = 0;
+        field.instancesBufCounts[0] = 0;
+        field.instancesBufCounts[1] = 0;
+        field.instancesBufCounts[2] = 0;
+        field.instancesBufCounts[3] = 0;
+
         //
         // map the instanced buffer to wrote into it
         //
@@ -1242,7 +1541,8 @@ void GrassMgr::UpdateGrassInstancedBuf()
             return;
         }
 
-        GrassInstance* data = (GrassInstance*)mappedData.pData;
+        GrassInstance* data     = (GrassInstance*)mappedData.pData;
+        const uint32   capacity = field.instancesBufCapacity;
 
         //
         // write instances data into buffer
@@ -1250,21 +1550,21 @@ void GrassMgr::UpdateGrassInstancedBuf()
         for (uint32 i = 0, ch = 0; ch < (uint32)field.numChannels; ++ch)
         {
             // go through each visible cell
-            for (const index cellIdx : visField.cellsIdxs)
+            for (index visCellIdx = 0; visCellIdx < visField.cellsIdxs.size(); ++visCellIdx)
             {
-                const GrassCell& cell = field.cells[cellIdx];
-                const uint32  baseIdx = cell.channelStart[ch];
-                const uint32  numInst = cell.channelInstanceCount[ch];
+                const GrassCell& cell    = field.cells[visField.cellsIdxs[visCellIdx]];
+                const float      density = visField.cellsDensity[visCellIdx];
+                const uint32     baseIdx = cell.channelStart[ch];
 
                 // push data related only to the current channel
-                for (uint32 instanceIdx = 0; instanceIdx < numInst; ++instanceIdx)
-                {
-                    assert(i < field.grassCount);
-                    data[i++] = cell.grassInstances[baseIdx + instanceIdx];
+                uint32 numInst = (uint32)(density * (float)cell.channelInstanceCount[ch]);
+                numInst        = Min(numInst, capacity - i);
 
-                    // increase a number of instances for this channel to render
-                    field.instancesBufCounts[ch]++;
-                }
+                memcpy(data + i, cell.grassInstances.data() + baseIdx, numInst * sizeof(GrassInstance));
+                i += numInst;
+
+                // increase a number of instances for this channel to render
+                field.instancesBufCounts[ch] += numInst;
             }
         }
 
@@ -1272,6 +1572,9 @@ void GrassMgr::UpdateGrassInstancedBuf()
         // unmap the buffer
         //
         pCtx->Unmap(field.pInstancedBuf, 0);
+
+        field.instancesBufHash = visField.hash;
+        stats_.numBufUpdates++;
     }
 }
 
@@ -1295,5 +1598,17 @@ void GrassMgr::SetGrassVisibilityRange(const float range)
     grassVisRange_ = range;
 }
 
+//---------------------------------------------------------
+// Desc:  setup max number of grass instances to render per frame;
+//        NOTE: instanced buffers are created with this limit so set it
+//              before grass fields are added
+//---------------------------------------------------------
+void GrassMgr::SetGrassInstancesBudget(const uint32 maxNumInstances)
+{
+    assert(maxNumInstances > 0);
+    assert(grassFields_.empty() && "budget must be set before adding of grass fields");
+    instancesBudget_ = maxNumInstances;
+}
+
 
 } // namespace
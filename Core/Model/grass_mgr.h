@@ -20,6 +20,7 @@
 #include <Mesh/vertex_buffer.h>
 #include <Mesh/index_buffer.h>
 #include <geometry/rect3d.h>
+#include "grass_placement.h"
 
 #define NUM_GRASS_CHANNELS 4
 #define MAX_LEN_DENSITY_MASK_PATH 64
@@ -63,6 +64,7 @@ struct GrassFieldInitParams
 
     int numChannels;            // the same as number of texture slots
     int grassCount;             // how many grass instances we have on this field
+    int seed;                   // seed for placement of instances (if 0 it is defined by the field's name)
 
     float channelProbability[NUM_GRASS_CHANNELS];
 
@@ -91,6 +93,21 @@ struct GrassCell
     // channels metadata (NOTE: not required to use all 4)
     uint32 channelStart[NUM_GRASS_CHANNELS];            // index where instances begins for particular channel
     uint32 channelInstanceCount[NUM_GRASS_CHANNELS];    // how many instances related to particular channel
+
+    bool isResident;                                    // are instances generated (cell is near the camera)?
+};
+
+//---------------------------------------------------------
+// node of a coarse quadtree over cells of grass field: covers a rectangle
+// of cells [x0, x1) x [z0, z1); children of a node are stored in a row
+//---------------------------------------------------------
+struct GrassCellsNode
+{
+    Rect3d box;                         // union of world AABBs of covered cells
+    uint16 cellX0, cellX1;
+    uint16 cellZ0, cellZ1;
+    int    firstChild;                  // idx of the first child node (or -1 for a leaf)
+    int    numChildren;
 };
 
 //---------------------------------------------------------
@@ -107,12 +124,14 @@ struct GrassField
 
     MaterialID  matId;
     uint32      grassCount;                 // number of ALL grass instances of this field
+    uint32      seed;                       // the same seed always gives the same placement of instances
 
     Rect3d      worldBox;                   // field position and size in 3d space
 
   
     cvector<GrassCell> cells;               // grass sectors
     cvector<Rect3d>    cellsWorldBoxes;     // world AABB of each cell
+    cvector<GrassCellsNode> cellsTree;      // quadtree over cells (the root is the first)
     ModelID            grassModelId[NUM_GRASS_CHANNELS];
 
     uint8              cellsByX;            // number of cells by X-axis
@@ -131,9 +150,13 @@ struct GrassField
     float              channelGrassScaleMin[NUM_GRASS_CHANNELS];  // minimal scale of grass instances for this channel
     float              channelGrassScaleMax[NUM_GRASS_CHANNELS];  // maximal scale of grass instances for this channel
 
+    GrassDensityMap    densityMaps[NUM_GRASS_CHANNELS];           // density values per channel (to (re)generate cells)
+
 
     ID3D11Buffer* pInstancedBuf = nullptr;          // GPU-side buffer for all the visible grass instances
+    uint32 instancesBufCapacity;                    // max number of instances in the instanced buffer
     uint32 instancesBufCounts[NUM_GRASS_CHANNELS];  // number of instances per channel (in the instanced buffer)
+    uint64 instancesBufHash;                        // hash of visible cells which are in the buffer (0 - invalid)
 };
 
 //---------------------------------------------------------
@@ -145,6 +168,36 @@ struct VisibleGrassField
 {
     index          fieldIdx;
     cvector<index> cellsIdxs;
+    cvector<float> cellsDensity;        // part of instances of each visible cell to render [0, 1]
+    uint64         hash;                // hash of visible cells and their density
+};
+
+//---------------------------------------------------------
+// reference to a cell of some grass field
+//---------------------------------------------------------
+struct GrassCellRef
+{
+    index fieldIdx;
+    index cellIdx;
+    float dist;                         // distance to the camera (by XZ)
+};
+
+//---------------------------------------------------------
+// stats of grass streaming (for the last update)
+//---------------------------------------------------------
+struct GrassStreamingStats
+{
+    uint64 memResident       = 0;       // bytes of CPU-side instances of resident cells
+    uint64 memDensity        = 0;       // bytes of density values of all the fields
+    uint32 numResidentCells  = 0;
+    uint32 numResidentInst   = 0;
+    uint32 numRenderedInst   = 0;       // after distance thinning and budget
+    uint32 numGeneratedCells = 0;
+    uint32 numEvictedCells   = 0;
+
+    uint32 numTestedNodes    = 0;       // culling: tested quadtree nodes
+    uint32 numTestedCells    = 0;       // culling: cells tested by frustum
+    uint32 numBufUpdates     = 0;       // number of instanced buffers which were rewritten
 };
 
 //---------------------------------------------------------
@@ -157,22 +210,52 @@ public:
 
     void Update(const Vec3 cameraPos, const Frustum* pFrustum);
 
+    // the same as Update() but split into CPU part (can be executed
+    // by a worker thread) and GPU part (must be on the main thread)
+    void CalcVisibleGrass       (const Vec3 camPos, const Frustum* pWorldFrustum);
+    void UpdateGrassInstancedBuf();
+
     bool AddGrassField(const GrassFieldInitParams& params);
 
+    // generate instances of the cell again (the result is always the same
+    // for the same field's params so it can be used after terrain changes)
+    void RegenerateGrassCell(const index fieldIdx, const index cellIdx);
+
+    // distribute instances between cells again and regenerate resident cells
+    void RegenerateGrassField(const index fieldIdx);
+
+    // hash of all the instances of the field (to compare results of generation)
+    uint64 CalcGrassFieldHash(const index fieldIdx) const;
+
+    // gather visible cells of the field into outVisField (also is used
+    // by the headless culling benchmark on a synthetic field)
+    void CullGrassCells(
+        const GrassField& field,
+        const Vec3& camPos,
+        const Frustum* pWorldFrustum,
+        VisibleGrassField& outVisField,
+        float& numInstToRender);
+
     void SetGrassDistFullSize(const float dist);
     void SetGrassVisibilityRange(const float range);
+    void SetGrassInstancesBudget(const uint32 maxNumInstances);
 
     float GetGrassDistFullSize() const;
     float GetGrassVisibilityRange() const;
 
+    inline uint32                     GetGrassInstancesBudget() const { return instancesBudget_; }
+    inline const GrassStreamingStats& GetStats()                const { return stats_; }
+
     const GrassField&                 GetGrassField(const index index) const;
     const cvector<VisibleGrassField>& GetVisibleFields()               const;
 
     vsize GetNumGrassFields() const;
 
 private:
-    void CalcVisibleGrass(const Vec3 camPos, const Frustum* pWorldFrustum);
-    void UpdateGrassInstancedBuf();
+    void  StreamGrassCells(const Vec3 camPos);
+    float GetDensityByDist(const float dist) const;
+
+    static void GenCellsRange(void* pArgs, const int start, const int end);
 
 private:
     // registered grass fields
@@ -180,6 +263,19 @@ private:
 
     // data about each currently visible field
     cvector<VisibleGrassField> visFields_;
+    cvector<index>             fieldsVisIdxs_;      // per field: idx in visFields_ (or -1)
+
+    // cells with generated instances (only around the camera)
+    cvector<GrassCellRef> residentCells_;
+    cvector<GrassCellRef> cellsToGen_;
+
+    // tmp stack of quadtree nodes to traverse (is kept to prevent reallocations)
+    cvector<int>          nodesStack_;
+
+    // max number of instances to render per frame (over all the fields)
+    uint32 instancesBudget_ = 1 << 17;
+
+    GrassStreamingStats stats_;
 
     // radius around camera where grass has full size
     float grassDistFullSize_ = 0;
@@ -188,6 +284,12 @@ private:
     float grassVisRange_ = 0;
 };
 
+//---------------------------------------------------------
+// build a quadtree over cells of the field (cells and their world boxes
+// must be already set)
+//---------------------------------------------------------
+void BuildCellsTree(GrassField& field);
+
 //---------------------------------------------------------
 // GLOBAL instance of the grass manager
 //---------------------------------------------------------
@@ -0,0 +1,262 @@
+// =================================================================================
+// Filename:   grass_placement.cpp
+// Desc:       Walker alias table over density map for placement of grass
+//
+// Created:    17.10.2026  by DimaSkup
+// =================================================================================
+#include <CoreCommon/pch.h>
+#include "grass_placement.h"
+
+
+namespace Core
+{
+
+// don't put grass right on the field's border
+constexpr float GRASS_FIELD_BORDER_MARGIN = 0.1f;
+
+//---------------------------------------------------------
+// Desc:   mix bits of the input value (finalizer of splitmix64)
+//---------------------------------------------------------
+static inline uint64 MixBits(uint64 h)
+{
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+//---------------------------------------------------------
+// Desc:   seed of random values for a single channel of the cell
+//         (depends only on its input so cells don't affect each other)
+//---------------------------------------------------------
+uint64 GetGrassCellSeed(const uint32 fieldSeed, const int cellX, const int cellZ, const int channel)
+{
+    uint64 h = MixBits(fieldSeed);
+    h = MixBits(h ^ (uint32)cellX);
+    h = MixBits(h ^ (uint32)cellZ);
+    h = MixBits(h ^ (uint32)channel);
+    return h;
+}
+
+//---------------------------------------------------------
+// Desc:   get a rectangle on the density map which is covered by the cell
+//---------------------------------------------------------
+GrassMapRegion GetGrassMapRegion(
+    const GrassDensityMap& map,
+    const Rect3d& fieldBox,
+    const Rect3d& cellBox)
+{
+    const float invSizeX = 1.0f / (fieldBox.x1 - fieldBox.x0);
+    const float invSizeZ = 1.0f / (fieldBox.z1 - fieldBox.z0);
+    const float w        = (float)map.width;
+    const float h        = (float)map.height;
+
+    GrassMapRegion region;
+    region.u0 = (cellBox.x0 - fieldBox.x0) * invSizeX * w;
+    region.u1 = (cellBox.x1 - fieldBox.x0) * invSizeX * w;
+
+    // flip vertically
+    region.v0 = (1.0f - (cellBox.z1 - fieldBox.z0) * invSizeZ) * h;
+    region.v1 = (1.0f - (cellBox.z0 - fieldBox.z0) * invSizeZ) * h;
+
+    region.u0 = clampf(region.u0, 0.0f, w);
+    region.u1 = clampf(region.u1, 0.0f, w);
+    region.v0 = clampf(region.v0, 0.0f, h);
+    region.v1 = clampf(region.v1, 0.0f, h);
+
+    return region;
+}
+
+//---------------------------------------------------------
+// Desc:   get range of texels [first, last] which are covered by the region
+//---------------------------------------------------------
+static inline void GetTexelsRange(
+    const float r0,
+    const float r1,
+    const uint32 size,
+    uint32& outFirst,
+    uint32& outLast)
+{
+    outFirst = (uint32)r0;
+    outLast  = (uint32)ceilf(r1);
+    outLast  = (outLast > 0) ? outLast - 1 : 0;
+    outLast  = (outLast < size) ? outLast : size - 1;
+}
+
+//---------------------------------------------------------
+// Desc:   covered part of texel [t, t+1] by the range [r0, r1]
+//---------------------------------------------------------
+static inline float GetCoverage(const uint32 t, const float r0, const float r1)
+{
+    const float a = ((float)t > r0)         ? (float)t         : r0;
+    const float b = ((float)(t + 1) < r1)   ? (float)(t + 1)   : r1;
+    return (b > a) ? b - a : 0.0f;
+}
+
+//---------------------------------------------------------
+// Desc:   sum of density over the region (each texel is weighted by its covered area)
+//---------------------------------------------------------
+float CalcGrassDensityMass(const GrassDensityMap& map, const GrassMapRegion& region)
+{
+    if (map.values.empty())
+        return 0.0f;
+
+    uint32 x0, x1, y0, y1;
+    GetTexelsRange(region.u0, region.u1, map.width,  x0, x1);
+    GetTexelsRange(region.v0, region.v1, map.height, y0, y1);
+
+    float mass = 0;
+
+    for (uint32 y = y0; y <= y1; ++y)
+    {
+        const float   coverY = GetCoverage(y, region.v0, region.v1);
+        const uint8* density = map.values.data() + y * map.width;
+
+        for (uint32 x = x0; x <= x1; ++x)
+            mass += (float)density[x] * GetCoverage(x, region.u0, region.u1) * coverY;
+    }
+
+    return mass;
+}
+
+//---------------------------------------------------------
+// Desc:   build an alias table (Vose's method) over the texels of density map
+//         which are covered by the region so the chance to take a texel is
+//         proportional to its density (and covered area)
+// Ret:    false if there is no place for grass in the region
+//---------------------------------------------------------
+bool GrassAliasTable::Build(const GrassDensityMap& map, const GrassMapRegion& region)
+{
+    region_ = region;
+    width_  = map.width;
+    height_ = map.height;
+
+    prob_.clear();
+    texels_.clear();
+    alias_.clear();
+
+    if (map.values.empty())
+        return false;
+
+    uint32 x0, x1, y0, y1;
+    GetTexelsRange(region.u0, region.u1, map.width,  x0, x1);
+    GetTexelsRange(region.v0, region.v1, map.height, y0, y1);
+
+    // gather non-zero texels and the sum of their weights
+    double sumWeights = 0;
+
+    for (uint32 y = y0; y <= y1; ++y)
+    {
+        const float   coverY = GetCoverage(y, region.v0, region.v1);
+        const uint8* density = map.values.data() + y * width_;
+
+        for (uint32 x = x0; x <= x1; ++x)
+        {
+            const float weight = (float)density[x] * GetCoverage(x, region.u0, region.u1) * coverY;
+
+            if (weight <= 0.0f)
+                continue;
+
+            texels_.push_back(y * width_ + x);
+            prob_.push_back(weight);
+            sumWeights += weight;
+        }
+    }
+
+    const vsize numTexels = texels_.size();
+
+    if (numTexels == 0)
+        return false;
+
+    alias_.resize(numTexels);
+
+    // scale weights so the average is 1.0 and split slots
+    // into "small" (< 1) and "large" (>= 1) ones
+    const float scale = (float)((double)numTexels / sumWeights);
+
+    smallSlots_.clear();
+    largeSlots_.clear();
+
+    for (vsize i = 0; i < numTexels; ++i)
+    {
+        prob_[i] *= scale;
+        alias_[i] = texels_[i];
+
+        if (prob_[i] < 1.0f)
+            smallSlots_.push_back((uint32)i);
+        else
+            largeSlots_.push_back((uint32)i);
+    }
+
+    // fill up each small slot with a part of some large slot
+    while (!smallSlots_.empty() && !largeSlots_.empty())
+    {
+        const uint32 s = smallSlots_.back();
+        const uint32 l = largeSlots_.back();
+        smallSlots_.pop_back();
+
+        alias_[s]  = texels_[l];
+        prob_[l]  -= (1.0f - prob_[s]);
+
+        if (prob_[l] < 1.0f)
+        {
+            largeSlots_.pop_back();
+            smallSlots_.push_back(l);
+        }
+    }
+
+    // the rest of slots are full (only precision errors are left)
+    for (const uint32 i : largeSlots_)
+        prob_[i] = 1.0f;
+
+    for (const uint32 i : smallSlots_)
+        prob_[i] = 1.0f;
+
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:   get idx of a random texel (y * width + x) according to its density
+//---------------------------------------------------------
+uint32 GrassAliasTable::SampleTexel(RandGen& rng) const
+{
+    assert(!texels_.empty());
+
+    const uint32 slot = rng.NextUint(0, (uint32)texels_.size());
+
+    return (rng.NextF() < prob_[slot]) ? texels_[slot] : alias_[slot];
+}
+
+//---------------------------------------------------------
+// Desc:   get a random position (XZ) inside of the region according to density
+//---------------------------------------------------------
+void GrassAliasTable::SamplePos(
+    RandGen& rng,
+    const Rect3d& fieldBox,
+    float& outX,
+    float& outZ) const
+{
+    const uint32 texel = SampleTexel(rng);
+    const uint32 px    = texel % width_;
+    const uint32 py    = texel / width_;
+
+    // covered part of the texel
+    const float u0 = ((float)px       > region_.u0) ? (float)px       : region_.u0;
+    const float u1 = ((float)(px + 1) < region_.u1) ? (float)(px + 1) : region_.u1;
+    const float v0 = ((float)py       > region_.v0) ? (float)py       : region_.v0;
+    const float v1 = ((float)(py + 1) < region_.v1) ? (float)(py + 1) : region_.v1;
+
+    // random point inside of it (in normalized coords of the map)
+    const float u = lerp(u0, u1, rng.NextF()) / (float)width_;
+    const float v = lerp(v0, v1, rng.NextF()) / (float)height_;
+
+    const float x = fieldBox.x0 + u          * (fieldBox.x1 - fieldBox.x0);
+    const float z = fieldBox.z0 + (1.0f - v) * (fieldBox.z1 - fieldBox.z0);
+
+    outX = clampf(x, fieldBox.x0 + GRASS_FIELD_BORDER_MARGIN, fieldBox.x1 - GRASS_FIELD_BORDER_MARGIN);
+    outZ = clampf(z, fieldBox.z0 + GRASS_FIELD_BORDER_MARGIN, fieldBox.z1 - GRASS_FIELD_BORDER_MARGIN);
+}
+
+} // namespace
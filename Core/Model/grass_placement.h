@@ -0,0 +1,104 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: grass_placement.h
+    Desc:     placement of grass instances according to a density map:
+
+              - for each grass channel of a cell we build a Walker alias
+                table over texels of the density map which are covered by
+                the cell (weight == density * covered area of texel);
+              - then each position is drawn in O(1): one random texel
+                from the table + a random point inside of this texel;
+              - all the random values come from a seeded generator
+                (RandGen) which seed depends only on the field's seed,
+                the cell coords and the channel, so each cell can be
+                (re)generated independently (in any order, by any thread)
+                and the same seed always gives the same field
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <Types.h>
+#include <cvector.h>
+#include <math/random.h>
+#include <geometry/rect3d.h>
+
+
+namespace Core
+{
+
+//---------------------------------------------------------
+// density values of a single grass channel
+// (is kept by the grass field so cells can be regenerated at any moment)
+//---------------------------------------------------------
+struct GrassDensityMap
+{
+    cvector<uint8> values;          // width * height
+    uint32         width  = 0;
+    uint32         height = 0;
+};
+
+//---------------------------------------------------------
+// rectangle on density map in texels (right/bottom sides are excluded);
+// density map is flipped vertically relatively to the world Z-axis
+//---------------------------------------------------------
+struct GrassMapRegion
+{
+    float u0, u1;                   // along X-axis of the map
+    float v0, v1;                   // along Y-axis of the map
+};
+
+GrassMapRegion GetGrassMapRegion(
+    const GrassDensityMap& map,
+    const Rect3d& fieldBox,
+    const Rect3d& cellBox);
+
+// sum of density over the region (each texel is weighted by its covered area)
+float CalcGrassDensityMass(const GrassDensityMap& map, const GrassMapRegion& region);
+
+// seed of random values for a single channel of the cell
+uint64 GetGrassCellSeed(const uint32 fieldSeed, const int cellX, const int cellZ, const int channel);
+
+
+//---------------------------------------------------------
+// alias table over texels of a single channel of density map
+//---------------------------------------------------------
+class GrassAliasTable
+{
+public:
+    GrassAliasTable() {}
+
+    // ret: false if there is no place for grass in the region
+    bool   Build(const GrassDensityMap& map, const GrassMapRegion& region);
+
+    // get idx of a random texel (y * width + x) according to its weight
+    uint32 SampleTexel(RandGen& rng) const;
+
+    // get a random position (XZ) inside of the region according to density
+    void   SamplePos(RandGen& rng, const Rect3d& fieldBox, float& outX, float& outZ) const;
+
+    inline vsize  GetNumTexels() const { return texels_.size(); }
+    inline bool   IsEmpty()      const { return texels_.empty(); }
+
+private:
+    cvector<float>  prob_;          // chance to take texel of this slot (otherwise take its alias)
+    cvector<uint32> texels_;        // non-zero texels: idx in density map
+    cvector<uint32> alias_;         // alias texel of each slot: idx in density map
+
+    cvector<uint32> smallSlots_;    // tmp lists for building (are kept to prevent reallocations)
+    cvector<uint32> largeSlots_;
+
+    GrassMapRegion  region_ = { 0,0,0,0 };
+    uint32          width_  = 0;    // dimensions of the density map
+    uint32          height_ = 0;
+};
+
+} // namespace
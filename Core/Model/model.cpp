@@ -49,6 +49,7 @@ Model::Model(Model&& rhs) noexcept :
     modelAABB_  (std::exchange(rhs.modelAABB_, {})),
     
     subsetsAABB_(std::exchange(rhs.subsetsAABB_, nullptr)),
+    bvh_        (std::move(rhs.bvh_)),
     vertices_   (std::exchange(rhs.vertices_, nullptr)),
     indices_    (std::exchange(rhs.indices_, nullptr)),
 
@@ -92,6 +93,7 @@ void Model::Copy(const Model& rhs)
     modelBoundSphere_ = rhs.modelBoundSphere_;
     modelAABB_        = rhs.modelAABB_;
     std::copy(rhs.subsetsAABB_, rhs.subsetsAABB_ + numSubsets_, subsetsAABB_);
+    bvh_ = rhs.bvh_;
 
     // copy geometry
     CopyVertices(rhs.vertices_, rhs.numVertices_);
@@ -133,6 +135,7 @@ void Model::Shutdown(void)
     SafeDeleteArr(subsetsAABB_);
     SafeDeleteArr(vertices_);
     SafeDeleteArr(indices_);
+    bvh_.Clear();
 
     numVertices_  = 0;
     numIndices_   = 0;
@@ -149,6 +152,59 @@ void Model::ClearMemory()
     SafeDeleteArr(subsetsAABB_);
     SafeDeleteArr(vertices_);
     SafeDeleteArr(indices_);
+    bvh_.Clear();
+}
+
+//---------------------------------------------------------
+// Desc:   release vertices/indices (both CPU and GPU copies) and the BVH;
+//         subsets, materials, boundings, and LODs are kept so the model
+//         still can be culled and its geometry can be loaded back later
+//---------------------------------------------------------
+void Model::ReleaseGeometry()
+{
+    meshes_.vb_.Shutdown();
+    meshes_.ib_.Shutdown();
+
+    SafeDeleteArr(vertices_);
+    SafeDeleteArr(indices_);
+    bvh_.Clear();
+
+    numVertices_ = 0;
+    numIndices_  = 0;
+}
+
+//---------------------------------------------------------
+// Desc:   take geometry (vertices, indices, BVH) of just loaded model;
+//         the loaded model must have the same subsets layout
+// NOTE:   GPU buffers aren't created here (look at InitBuffers)
+//---------------------------------------------------------
+bool Model::MoveGeometryFrom(Model& rhs)
+{
+    if (rhs.numSubsets_ != numSubsets_)
+    {
+        LogErr(LOG, "subsets of loaded model don't match (model: %s)", name_);
+        return false;
+    }
+
+    ReleaseGeometry();
+
+    vertices_    = std::exchange(rhs.vertices_, nullptr);
+    indices_     = std::exchange(rhs.indices_,  nullptr);
+    numVertices_ = std::exchange(rhs.numVertices_, 0);
+    numIndices_  = std::exchange(rhs.numIndices_,  0);
+    bvh_         = std::move(rhs.bvh_);
+
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:   return memory size of geometry in bytes
+//         (CPU copy + vertex/index buffers)
+//---------------------------------------------------------
+uint32 Model::GetGeometryMemSize() const
+{
+    const uint32 size = numVertices_ * sizeof(Vertex3D) + numIndices_ * sizeof(UINT);
+    return size * 2;
 }
 
 //---------------------------------------------------------
@@ -364,6 +420,59 @@ void Model::ComputeSubsetsAABB()
     }
 }
 
+//---------------------------------------------------------
+// Desc:   build a BVH over triangles of the model (for ray tests)
+// NOTE:   there must be already data of vertices and indices
+//---------------------------------------------------------
+void Model::BuildBVH()
+{
+    if (!vertices_ || !indices_ || primTopology_ != D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST)
+    {
+        bvh_.Clear();
+        return;
+    }
+
+    bvh_.Build(&vertices_[0].pos, sizeof(Vertex3D), indices_, numIndices_);
+}
+
+//---------------------------------------------------------
+// Desc:   load BVH of the model from a cache file
+// Ret:    false if there is no cache or it doesn't match the model's geometry
+//---------------------------------------------------------
+bool Model::LoadBVH(const char* path)
+{
+    if (!vertices_ || !indices_)
+        return false;
+
+    const uint64 hash = HashModelGeometry(
+        &vertices_[0].pos,
+        sizeof(Vertex3D),
+        numVertices_,
+        indices_,
+        numIndices_);
+
+    return bvh_.LoadFromFile(path, hash, numIndices_);
+}
+
+//---------------------------------------------------------
+// Desc:   save BVH of the model into a cache file
+//---------------------------------------------------------
+void Model::SaveBVH(const char* path) const
+{
+    if (!bvh_.IsBuilt())
+        return;
+
+    const uint64 hash = HashModelGeometry(
+        &vertices_[0].pos,
+        sizeof(Vertex3D),
+        numVertices_,
+        indices_,
+        numIndices_);
+
+    if (!bvh_.SaveToFile(path, hash))
+        LogErr(LOG, "can't save BVH of model (%s) into file: %s", name_, path);
+}
+
 
 //==================================================================================
 // LOD related methods
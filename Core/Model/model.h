@@ -17,6 +17,7 @@
 #include "../Mesh/vertex.h"
 #include "../Mesh/material.h"
 #include "../Mesh/mesh_geometry.h"
+#include "model_bvh.h"
 
 #include <d3d11.h>
 #include <DirectXCollision.h>
@@ -99,6 +100,15 @@ public:
     void Shutdown();
     void ClearMemory();
 
+    //----------------------------
+    // streaming: geometry can be released and loaded again while
+    // metadata (name, subsets, materials, boundings, LODs) is kept
+    //----------------------------
+    void ReleaseGeometry();
+    bool MoveGeometryFrom(Model& rhs);
+    bool IsGeometryLoaded() const;
+    uint32 GetGeometryMemSize() const;
+
     void CopyVertices(const Vertex3D* vertices, const int numVertices);
     void CopyIndices(const UINT* indices, const int numIndices);
 
@@ -169,6 +179,15 @@ public:
     void ComputeBoundings();
     void ComputeSubsetsAABB();
 
+    //----------------------------
+    // BVH for ray tests
+    //----------------------------
+    void BuildBVH();
+    bool LoadBVH(const char* path);
+    void SaveBVH(const char* path) const;
+
+    const ModelBVH& GetBVH() const;
+
     //----------------------------
     // LOD related methods
     //----------------------------
@@ -196,6 +215,7 @@ private:
     DirectX::BoundingSphere  modelBoundSphere_;           // sphere around the whole model
     DirectX::BoundingBox     modelAABB_;                  // AABB of the whole model
     DirectX::BoundingBox*    subsetsAABB_ = nullptr;      // AABB of each subset (mesh)
+    ModelBVH                 bvh_;                        // hierarchy over triangles for ray tests
 
     // keep CPU copies of the meshes data to read from
     Vertex3D*                vertices_ = nullptr;
@@ -226,6 +246,7 @@ inline Subset*          Model::GetSubsets()              { return meshes_.subset
 inline const Subset*    Model::GetSubsets()        const { return meshes_.subsets_; }
 
 inline bool             Model::HasLods()           const { return numLods_ != 0; }
+inline bool             Model::IsGeometryLoaded()  const { return vertices_ != nullptr; }
 inline uint8            Model::GetNumLods()        const { return numLods_; }
 
 
@@ -253,6 +274,11 @@ inline const MeshGeometry& Model::GetMeshes() const
     return meshes_;
 }
 
+inline const ModelBVH& Model::GetBVH() const
+{
+    return bvh_;
+}
+
 inline const DirectX::BoundingSphere& Model::GetModelBoundSphere() const
 {
     return modelBoundSphere_;
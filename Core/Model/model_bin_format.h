@@ -0,0 +1,116 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: model_bin_format.h
+    Desc:     layout of the binary model file (.de3db); the file is memory
+              mapped and its blocks are used in place without any parsing:
+
+              [header][chunk table][chunk 0][chunk 1]...[chunk N-1]
+
+              - header has a magic number, version and the total file size;
+              - chunk table describes each chunk (id, offset, size, count);
+              - each chunk starts at offset aligned to MODEL_BIN_ALIGNMENT;
+              - strings (names) are kept in the string table chunk and
+                referred by offsets inside of this chunk;
+              - all the values are little-endian
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <Types.h>
+#include <DirectXMath.h>
+#include "../Mesh/vertex.h"
+
+
+namespace Core
+{
+
+#define MODEL_BIN_FOURCC(a, b, c, d) \
+    ((uint32)(a) | ((uint32)(b) << 8) | ((uint32)(c) << 16) | ((uint32)(d) << 24))
+
+constexpr uint32 MODEL_BIN_MAGIC     = MODEL_BIN_FOURCC('D', 'E', '3', 'B');
+constexpr uint32 MODEL_BIN_VERSION   = 1;
+constexpr uint32 MODEL_BIN_ALIGNMENT = 16;
+constexpr char   MODEL_BIN_EXT[]     = ".de3db";
+
+enum eModelBinChunk : uint32
+{
+    MODEL_BIN_CHUNK_INFO     = MODEL_BIN_FOURCC('I', 'N', 'F', 'O'),   // ModelBinInfo     [1]
+    MODEL_BIN_CHUNK_SUBSETS  = MODEL_BIN_FOURCC('S', 'U', 'B', 'S'),   // ModelBinSubset   [numSubsets]
+    MODEL_BIN_CHUNK_AABBS    = MODEL_BIN_FOURCC('A', 'A', 'B', 'B'),   // ModelBinAABB     [1 + numSubsets] (model, subsets)
+    MODEL_BIN_CHUNK_VERTICES = MODEL_BIN_FOURCC('V', 'E', 'R', 'T'),   // Vertex3D         [numVertices]
+    MODEL_BIN_CHUNK_INDICES  = MODEL_BIN_FOURCC('I', 'N', 'D', 'X'),   // UINT             [numIndices]
+    MODEL_BIN_CHUNK_STRINGS  = MODEL_BIN_FOURCC('S', 'T', 'R', 'S'),   // char             [size] (null-terminated strings)
+};
+
+// align offset of chunk in the file
+inline size_t ModelBinAlign(const size_t offset)
+{
+    return (offset + MODEL_BIN_ALIGNMENT - 1) & ~((size_t)MODEL_BIN_ALIGNMENT - 1);
+}
+
+//---------------------------------------------------------
+
+struct ModelBinHeader
+{
+    uint32 magic            = MODEL_BIN_MAGIC;
+    uint32 version          = MODEL_BIN_VERSION;
+    uint32 fileSize         = 0;        // total size of the file in bytes
+    uint32 numChunks        = 0;
+    uint32 chunkTableOffset = 0;        // offset of the first ModelBinChunk
+    uint32 reserved[3]      = { 0 };
+};
+
+struct ModelBinChunk
+{
+    uint32 id     = 0;                  // eModelBinChunk
+    uint32 offset = 0;                  // from the beginning of the file
+    uint32 size   = 0;                  // in bytes
+    uint32 count  = 0;                  // number of elements
+};
+
+struct ModelBinInfo
+{
+    uint32 nameOffset    = 0;           // offsets in the string table
+    uint32 matFileOffset = 0;           // name of the .demat file (next to the model's file)
+    uint32 numVertices   = 0;
+    uint32 numIndices    = 0;
+    uint32 numSubsets    = 0;
+    uint32 reserved[3]   = { 0 };
+};
+
+struct ModelBinSubset
+{
+    uint32 vertexStart   = 0;
+    uint32 vertexCount   = 0;
+    uint32 indexStart    = 0;
+    uint32 indexCount    = 0;
+    uint32 nameOffset    = 0;           // offsets in the string table
+    uint32 matNameOffset = 0;
+    uint16 id            = 0;
+    uint16 reserved      = 0;
+    uint32 reserved2     = 0;
+};
+
+struct ModelBinAABB
+{
+    DirectX::XMFLOAT3 center;
+    DirectX::XMFLOAT3 extents;
+};
+
+static_assert(sizeof(ModelBinHeader) == 32, "the binary model layout is changed: update MODEL_BIN_VERSION");
+static_assert(sizeof(ModelBinChunk)  == 16, "the binary model layout is changed: update MODEL_BIN_VERSION");
+static_assert(sizeof(ModelBinInfo)   == 32, "the binary model layout is changed: update MODEL_BIN_VERSION");
+static_assert(sizeof(ModelBinSubset) == 32, "the binary model layout is changed: update MODEL_BIN_VERSION");
+static_assert(sizeof(ModelBinAABB)   == 24, "the binary model layout is changed: update MODEL_BIN_VERSION");
+static_assert(sizeof(Vertex3D)       == 48, "the binary model layout is changed: update MODEL_BIN_VERSION");
+
+} // namespace
@@ -0,0 +1,646 @@
+// =================================================================================
+// Filename:   model_bvh.cpp
+// Desc:       implementation of the triangle BVH of a model
+//
+// Created:    17.10.2026  by DimaSkup
+// =================================================================================
+#include <CoreCommon/pch.h>
+#include "model_bvh.h"
+#include <DirectXCollision.h>
+
+using namespace DirectX;
+
+
+namespace Core
+{
+
+constexpr int   BVH_NUM_BINS       = 12;
+constexpr int   BVH_MAX_DEPTH      = 60;
+constexpr int   BVH_MAX_LEAF_TRIS  = 4;     // a node with more triangles is always split (if possible)
+constexpr int   BVH_STACK_SIZE     = 64;
+constexpr float BVH_TRAVERSAL_COST = 1.0f;  // cost of node visit relatively to ray/triangle test
+
+constexpr char  BVH_FILE_MAGIC[4]  = { 'D','B','V','H' };
+constexpr int   BVH_FILE_VERSION   = 1;
+
+//---------------------------------------------------------
+// helper structs and functions for building
+//---------------------------------------------------------
+struct BvhBox
+{
+    float minP[3] = { +FLT_MAX, +FLT_MAX, +FLT_MAX };
+    float maxP[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+};
+
+struct BvhBin
+{
+    BvhBox box;
+    int    numTris = 0;
+};
+
+struct BvhFileHeader
+{
+    char   magic[4];
+    uint32 version;
+    uint64 geomHash;
+    uint32 numTris;
+    uint32 numNodes;
+};
+
+//---------------------------------------------------------
+
+inline const XMFLOAT3& GetPos(const XMFLOAT3* positions, const int stride, const UINT idx)
+{
+    return *(const XMFLOAT3*)((const uint8*)positions + (size_t)idx * stride);
+}
+
+//---------------------------------------------------------
+
+inline void Grow(BvhBox& box, const float* minP, const float* maxP)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        if (minP[i] < box.minP[i]) box.minP[i] = minP[i];
+        if (maxP[i] > box.maxP[i]) box.maxP[i] = maxP[i];
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   half of the box surface area (is enough for SAH comparisons)
+//---------------------------------------------------------
+inline float HalfArea(const BvhBox& box)
+{
+    const float ex = box.maxP[0] - box.minP[0];
+    const float ey = box.maxP[1] - box.minP[1];
+    const float ez = box.maxP[2] - box.minP[2];
+
+    return ex*ey + ey*ez + ez*ex;
+}
+
+//---------------------------------------------------------
+
+inline void SetNodeBox(BvhNode& node, const BvhBox& box)
+{
+    node.minP = { box.minP[0], box.minP[1], box.minP[2] };
+    node.maxP = { box.maxP[0], box.maxP[1], box.maxP[2] };
+}
+
+//---------------------------------------------------------
+// Desc:   build BVH over triangles of a model
+// Args:   - positions:  ptr to position of the first vertex
+//         - posStride:  stride (in bytes) between positions of vertices
+//         - indices:    triangle list indices
+//---------------------------------------------------------
+void ModelBVH::Build(
+    const XMFLOAT3* positions,
+    const int posStride,
+    const UINT* indices,
+    const int numIndices)
+{
+    Clear();
+
+    const int numTris = numIndices / 3;
+
+    if (!positions || !indices || numTris <= 0)
+    {
+        LogErr(LOG, "invalid input args (no geometry)");
+        return;
+    }
+
+    // compute bounds and centroid of each triangle
+    cvector<BvhBox>   triBoxes(numTris);
+    cvector<XMFLOAT3> centroids(numTris);
+
+    for (int i = 0; i < numTris; ++i)
+    {
+        const XMFLOAT3& p0 = GetPos(positions, posStride, indices[i*3 + 0]);
+        const XMFLOAT3& p1 = GetPos(positions, posStride, indices[i*3 + 1]);
+        const XMFLOAT3& p2 = GetPos(positions, posStride, indices[i*3 + 2]);
+
+        BvhBox box;
+        Grow(box, &p0.x, &p0.x);
+        Grow(box, &p1.x, &p1.x);
+        Grow(box, &p2.x, &p2.x);
+
+        triBoxes[i] = box;
+        centroids[i] = {
+            (box.minP[0] + box.maxP[0]) * 0.5f,
+            (box.minP[1] + box.maxP[1]) * 0.5f,
+            (box.minP[2] + box.maxP[2]) * 0.5f };
+    }
+
+    triIdxs_.resize(numTris);
+    for (int i = 0; i < numTris; ++i)
+        triIdxs_[i] = (uint32)i;
+
+    // there are at most (2*numTris - 1) nodes
+    nodes_.reserve(2 * numTris);
+    nodes_.push_back(BvhNode());
+    nodes_[0].leftOrFirst = 0;
+    nodes_[0].numTris     = numTris;
+
+    // nodes which still have to be processed: [node idx, depth]
+    cvector<int> stack;
+    cvector<int> depths;
+    stack.push_back(0);
+    depths.push_back(0);
+
+    while (!stack.empty())
+    {
+        const int nodeIdx = stack.back();
+        const int depth   = depths.back();
+        stack.pop_back();
+        depths.pop_back();
+
+        const int first = (int)nodes_[nodeIdx].leftOrFirst;
+        const int count = (int)nodes_[nodeIdx].numTris;
+
+        // compute bounds of the node and bounds of its triangles centroids
+        BvhBox nodeBox;
+        BvhBox centroidBox;
+
+        for (int i = first; i < first + count; ++i)
+        {
+            const uint32 t = triIdxs_[i];
+            Grow(nodeBox, triBoxes[t].minP, triBoxes[t].maxP);
+            Grow(centroidBox, &centroids[t].x, &centroids[t].x);
+        }
+
+        SetNodeBox(nodes_[nodeIdx], nodeBox);
+
+        if (count <= 1 || depth >= BVH_MAX_DEPTH)
+            continue;
+
+        // find the best split plane using binned SAH
+        float bestCost  = FLT_MAX;
+        int   bestAxis  = -1;
+        int   bestSplit = 0;
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const float cmin   = centroidBox.minP[axis];
+            const float extent = centroidBox.maxP[axis] - cmin;
+
+            if (extent <= 0.0f)
+                continue;
+
+            const float scale = BVH_NUM_BINS / extent;
+            BvhBin bins[BVH_NUM_BINS];
+
+            for (int i = first; i < first + count; ++i)
+            {
+                const uint32 t = triIdxs_[i];
+                int b = (int)(((&centroids[t].x)[axis] - cmin) * scale);
+                if (b >= BVH_NUM_BINS)
+                    b = BVH_NUM_BINS - 1;
+
+                bins[b].numTris++;
+                Grow(bins[b].box, triBoxes[t].minP, triBoxes[t].maxP);
+            }
+
+            // sweep from the right to get area and count on the right of each plane
+            float  rightAreas [BVH_NUM_BINS - 1];
+            int    rightCounts[BVH_NUM_BINS - 1];
+            BvhBox rightBox;
+            int    rightCount = 0;
+
+            for (int b = BVH_NUM_BINS - 1; b > 0; --b)
+            {
+                Grow(rightBox, bins[b].box.minP, bins[b].box.maxP);
+                rightCount += bins[b].numTris;
+
+                rightAreas [b - 1] = (rightCount > 0) ? HalfArea(rightBox) : 0.0f;
+                rightCounts[b - 1] = rightCount;
+            }
+
+            // sweep from the left and evaluate each plane
+            BvhBox leftBox;
+            int    leftCount = 0;
+
+            for (int b = 0; b < BVH_NUM_BINS - 1; ++b)
+            {
+                Grow(leftBox, bins[b].box.minP, bins[b].box.maxP);
+                leftCount += bins[b].numTris;
+
+                if (leftCount == 0 || rightCounts[b] == 0)
+                    continue;
+
+                const float cost = leftCount * HalfArea(leftBox) + rightCounts[b] * rightAreas[b];
+
+                if (cost < bestCost)
+                {
+                    bestCost  = cost;
+                    bestAxis  = axis;
+                    bestSplit = b + 1;
+                }
+            }
+        }
+
+        // all the centroids are at the same point so we can't split
+        if (bestAxis == -1)
+            continue;
+
+        // small node which is cheaper to test as a leaf
+        const float nodeArea  = HalfArea(nodeBox);
+        const float leafCost  = count * nodeArea;
+        const float splitCost = BVH_TRAVERSAL_COST * nodeArea + bestCost;
+
+        if (count <= BVH_MAX_LEAF_TRIS && splitCost >= leafCost)
+            continue;
+
+        // partition triangles by the split plane
+        const float cmin  = centroidBox.minP[bestAxis];
+        const float scale = BVH_NUM_BINS / (centroidBox.maxP[bestAxis] - cmin);
+
+        int i = first;
+        int j = first + count - 1;
+
+        while (i <= j)
+        {
+            const uint32 t = triIdxs_[i];
+            int b = (int)(((&centroids[t].x)[bestAxis] - cmin) * scale);
+            if (b >= BVH_NUM_BINS)
+                b = BVH_NUM_BINS - 1;
+
+            if (b < bestSplit)
+                ++i;
+            else
+                std::swap(triIdxs_[i], triIdxs_[j--]);
+        }
+
+        const int leftCount = i - first;
+
+        if (leftCount == 0 || leftCount == count)
+            continue;
+
+        // create children (they are placed next to each other)
+        const int leftIdx = (int)nodes_.size();
+
+        nodes_.push_back(BvhNode());
+        nodes_.push_back(BvhNode());
+
+        nodes_[leftIdx].leftOrFirst     = first;
+        nodes_[leftIdx].numTris         = leftCount;
+        nodes_[leftIdx + 1].leftOrFirst = i;
+        nodes_[leftIdx + 1].numTris     = count - leftCount;
+
+        nodes_[nodeIdx].leftOrFirst = leftIdx;
+        nodes_[nodeIdx].numTris     = 0;
+
+        stack.push_back(leftIdx);
+        stack.push_back(leftIdx + 1);
+        depths.push_back(depth + 1);
+        depths.push_back(depth + 1);
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   release memory from BVH data
+//---------------------------------------------------------
+void ModelBVH::Clear()
+{
+    nodes_.purge();
+    triIdxs_.purge();
+}
+
+//---------------------------------------------------------
+// Desc:   ray/box slab test for 3 axes at once
+// Args:   - invDir:   1.0 / ray direction
+//         - tmax:     we don't need intersections which are farther
+// Out:    - outEnter: the distance along the ray where it enters the box
+//---------------------------------------------------------
+inline bool RayNodeTest(
+    const BvhNode& node,
+    const XMVECTOR& rayOrig,
+    const XMVECTOR& invDir,
+    const float tmax,
+    float& outEnter)
+{
+    const XMVECTOR t0 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&node.minP), rayOrig), invDir);
+    const XMVECTOR t1 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&node.maxP), rayOrig), invDir);
+
+    XMFLOAT3 tNear;
+    XMFLOAT3 tFar;
+    XMStoreFloat3(&tNear, XMVectorMin(t0, t1));
+    XMStoreFloat3(&tFar,  XMVectorMax(t0, t1));
+
+    float enter = (tNear.x > tNear.y) ? tNear.x : tNear.y;
+    float exit  = (tFar.x  < tFar.y)  ? tFar.x  : tFar.y;
+
+    if (tNear.z > enter) enter = tNear.z;
+    if (tFar.z  < exit)  exit  = tFar.z;
+    if (enter < 0.0f)    enter = 0.0f;
+    if (tmax < exit)     exit  = tmax;
+
+    outEnter = enter;
+    return enter <= exit;
+}
+
+//---------------------------------------------------------
+// Desc:   find the nearest intersection of ray and model's triangles
+// Args:   - positions, posStride, indices:  geometry which was used to build BVH
+//         - rayOrig, rayDir:   ray in model's local space (direction is normalized)
+// Out:    - tmin:              the distance to the nearest intersection
+//                              (input value limits the search)
+//         - outTriangleIdx:    the index of the intersected triangle
+// Ret:    true if there is an intersection which is closer than input tmin
+//---------------------------------------------------------
+bool ModelBVH::Intersect(
+    const XMFLOAT3* positions,
+    const int posStride,
+    const UINT* indices,
+    const XMVECTOR& rayOrig,
+    const XMVECTOR& rayDir,
+    float& tmin,
+    uint& outTriangleIdx) const
+{
+    if (nodes_.empty())
+        return false;
+
+    // replace zero components of the direction to avoid NaNs in the slab test
+    const XMVECTOR eps    = XMVectorReplicate(1e-20f);
+    const XMVECTOR isZero = XMVectorLess(XMVectorAbs(rayDir), eps);
+    const XMVECTOR invDir = XMVectorReciprocal(XMVectorSelect(rayDir, eps, isZero));
+
+    struct StackEntry
+    {
+        uint32 nodeIdx;
+        float  enter;
+    };
+
+    StackEntry stack[BVH_STACK_SIZE];
+    int        stackSize = 0;
+    bool       intersect = false;
+    float      enter     = 0;
+
+    if (!RayNodeTest(nodes_[0], rayOrig, invDir, tmin, enter))
+        return false;
+
+    stack[stackSize++] = { 0, enter };
+
+    while (stackSize > 0)
+    {
+        const StackEntry entry = stack[--stackSize];
+
+        // we have already found something closer
+        if (entry.enter > tmin)
+            continue;
+
+        const BvhNode& node = nodes_[entry.nodeIdx];
+
+        if (node.IsLeaf())
+        {
+            for (uint32 i = node.leftOrFirst; i < node.leftOrFirst + node.numTris; ++i)
+            {
+                const uint32 triIdx = triIdxs_[i];
+
+                const XMVECTOR v0 = XMLoadFloat3(&GetPos(positions, posStride, indices[triIdx*3 + 0]));
+                const XMVECTOR v1 = XMLoadFloat3(&GetPos(positions, posStride, indices[triIdx*3 + 1]));
+                const XMVECTOR v2 = XMLoadFloat3(&GetPos(positions, posStride, indices[triIdx*3 + 2]));
+
+                float t = 0;
+
+                if (!TriangleTests::Intersects(rayOrig, rayDir, v0, v1, v2, t))
+                    continue;
+
+                if (t > tmin)
+                    continue;
+
+                // this is a new nearest triangle
+                outTriangleIdx = triIdx;
+                tmin = t;
+                intersect = true;
+            }
+            continue;
+        }
+
+        // test both children and visit the nearest one first
+        const uint32 leftIdx  = node.leftOrFirst;
+        const uint32 rightIdx = node.leftOrFirst + 1;
+        float enterL = 0;
+        float enterR = 0;
+
+        const bool hitL = RayNodeTest(nodes_[leftIdx],  rayOrig, invDir, tmin, enterL);
+        const bool hitR = RayNodeTest(nodes_[rightIdx], rayOrig, invDir, tmin, enterR);
+
+        assert(stackSize + 2 <= BVH_STACK_SIZE);
+
+        if (hitL && hitR)
+        {
+            if (enterL <= enterR)
+            {
+                stack[stackSize++] = { rightIdx, enterR };
+                stack[stackSize++] = { leftIdx,  enterL };
+            }
+            else
+            {
+                stack[stackSize++] = { leftIdx,  enterL };
+                stack[stackSize++] = { rightIdx, enterR };
+            }
+        }
+        else if (hitL)
+        {
+            stack[stackSize++] = { leftIdx, enterL };
+        }
+        else if (hitR)
+        {
+            stack[stackSize++] = { rightIdx, enterR };
+        }
+    }
+
+    return intersect;
+}
+
+//---------------------------------------------------------
+// Desc:   write BVH into a binary cache file
+// Args:   - geomHash:  hash of geometry which was used to build the BVH
+//---------------------------------------------------------
+bool ModelBVH::SaveToFile(const char* path, const uint64 geomHash) const
+{
+    if (StrHelper::IsEmpty(path))
+    {
+        LogErr(LOG, "empty path");
+        return false;
+    }
+    if (nodes_.empty())
+    {
+        LogErr(LOG, "BVH isn't built, nothing to save: %s", path);
+        return false;
+    }
+
+    FILE* pFile = fopen(path, "wb");
+    if (!pFile)
+    {
+        LogErr(LOG, "can't open a file for writing: %s", path);
+        return false;
+    }
+
+    BvhFileHeader header;
+    memcpy(header.magic, BVH_FILE_MAGIC, sizeof(header.magic));
+    header.version  = BVH_FILE_VERSION;
+    header.geomHash = geomHash;
+    header.numTris  = (uint32)triIdxs_.size();
+    header.numNodes = (uint32)nodes_.size();
+
+    fwrite(&header,         sizeof(header),  1,                pFile);
+    fwrite(nodes_.data(),   sizeof(BvhNode), header.numNodes,  pFile);
+    fwrite(triIdxs_.data(), sizeof(uint32),  header.numTris,   pFile);
+
+    fclose(pFile);
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:   read BVH from a binary cache file
+// Args:   - geomHash:    hash of the current geometry of the model
+//         - numIndices:  the number of model's indices
+// Ret:    false if there is no file or it is out of date
+//---------------------------------------------------------
+bool ModelBVH::LoadFromFile(const char* path, const uint64 geomHash, const int numIndices)
+{
+    if (StrHelper::IsEmpty(path))
+    {
+        LogErr(LOG, "empty path");
+        return false;
+    }
+
+    FILE* pFile = fopen(path, "rb");
+    if (!pFile)
+        return false;
+
+    BvhFileHeader header;
+    const uint32  numTris = (uint32)(numIndices / 3);
+
+    const bool isValid =
+        (fread(&header, sizeof(header), 1, pFile) == 1)                      &&
+        (memcmp(header.magic, BVH_FILE_MAGIC, sizeof(header.magic)) == 0)    &&
+        (header.version  == BVH_FILE_VERSION)                                &&
+        (header.geomHash == geomHash)                                        &&
+        (header.numTris  == numTris)                                         &&
+        (header.numNodes > 0 && header.numNodes < 2 * numTris);
+
+    if (!isValid)
+    {
+        fclose(pFile);
+        return false;
+    }
+
+    Clear();
+    nodes_.resize(header.numNodes);
+    triIdxs_.resize(header.numTris);
+
+    const bool isRead =
+        (fread(nodes_.data(),   sizeof(BvhNode), header.numNodes, pFile) == header.numNodes) &&
+        (fread(triIdxs_.data(), sizeof(uint32),  header.numTris,  pFile) == header.numTris);
+
+    fclose(pFile);
+
+    if (!isRead)
+    {
+        LogErr(LOG, "can't read BVH data from file: %s", path);
+        Clear();
+        return false;
+    }
+
+    if (!IsValid(header.numTris))
+    {
+        LogErr(LOG, "BVH cache is corrupted (it will be rebuilt): %s", path);
+        Clear();
+        return false;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:   check loaded nodes so a corrupted cache can't make Intersect()
+//         read out of bounds or loop forever:
+//         - children are placed after their parent and are in range;
+//         - each node (except of the root) has exactly one parent;
+//         - depth fits into the traversal stack;
+//         - triangle ranges of leaves and triangles indices are in range
+//---------------------------------------------------------
+bool ModelBVH::IsValid(const uint32 numTris) const
+{
+    const uint32 numNodes = (uint32)nodes_.size();
+
+    cvector<uint8> depths(numNodes, 0);
+    cvector<uint8> numParents(numNodes, 0);
+
+    for (uint32 i = 0; i < numNodes; ++i)
+    {
+        const BvhNode& node = nodes_[i];
+
+        // NOTE: it is also false for NaN
+        if (!(node.minP.x <= node.maxP.x && node.minP.y <= node.maxP.y && node.minP.z <= node.maxP.z))
+            return false;
+
+        // only the root has no parent
+        if ((i == 0) != (numParents[i] == 0))
+            return false;
+
+        if (node.IsLeaf())
+        {
+            if ((uint64)node.leftOrFirst + node.numTris > numTris)
+                return false;
+
+            continue;
+        }
+
+        const uint32 left = node.leftOrFirst;
+
+        if (left <= i || (uint64)left + 1 >= numNodes)
+            return false;
+
+        if (depths[i] >= BVH_MAX_DEPTH)
+            return false;
+
+        // children are after their parent so their depth isn't checked yet
+        depths[left]     = depths[i] + 1;
+        depths[left + 1] = depths[i] + 1;
+
+        if (++numParents[left] > 1 || ++numParents[left + 1] > 1)
+            return false;
+    }
+
+    for (const uint32 triIdx : triIdxs_)
+    {
+        if (triIdx >= numTris)
+            return false;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:   64-bit FNV-1a over 32-bit words of positions and indices
+//---------------------------------------------------------
+uint64 HashModelGeometry(
+    const XMFLOAT3* positions,
+    const int posStride,
+    const int numVertices,
+    const UINT* indices,
+    const int numIndices)
+{
+    constexpr uint64 prime = 1099511628211ull;
+    uint64           hash  = 14695981039346656037ull;
+
+    for (int i = 0; i < numVertices; ++i)
+    {
+        const uint32* words = (const uint32*)&GetPos(positions, posStride, i);
+
+        hash = (hash ^ words[0]) * prime;
+        hash = (hash ^ words[1]) * prime;
+        hash = (hash ^ words[2]) * prime;
+    }
+
+    for (int i = 0; i < numIndices; ++i)
+        hash = (hash ^ indices[i]) * prime;
+
+    hash = (hash ^ (uint64)numVertices) * prime;
+    hash = (hash ^ (uint64)numIndices)  * prime;
+
+    return hash;
+}
+
+} // namespace
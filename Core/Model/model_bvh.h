@@ -0,0 +1,95 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: model_bvh.h
+    Desc:     bounding volume hierarchy over triangles of a model;
+              is used for CPU ray tests (picking, bullet hits) so we
+              don't have to test a ray against each triangle of the model:
+
+              - built with binned SAH (surface area heuristic);
+              - nodes are flattened into a single array, children of
+                inner node are stored next to each other (left, left+1);
+              - leaves refer to a range of triangles indices so
+                the model's vertices/indices are not duplicated;
+              - can be saved/loaded into/from a cache file
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <Types.h>
+#include <cvector.h>
+#include <DirectXMath.h>
+
+
+namespace Core
+{
+
+struct BvhNode
+{
+    DirectX::XMFLOAT3 minP;
+    uint32            leftOrFirst = 0;   // inner node: idx of the left child; leaf: idx of the first triangle
+    DirectX::XMFLOAT3 maxP;
+    uint32            numTris = 0;       // 0 for inner nodes
+
+    inline bool IsLeaf() const { return numTris != 0; }
+};
+
+//---------------------------------------------------------
+
+class ModelBVH
+{
+public:
+    ModelBVH() {}
+
+    void Build(
+        const DirectX::XMFLOAT3* positions,
+        const int posStride,
+        const UINT* indices,
+        const int numIndices);
+
+    void Clear();
+
+    bool SaveToFile  (const char* path, const uint64 geomHash) const;
+    bool LoadFromFile(const char* path, const uint64 geomHash, const int numIndices);
+
+    // find the nearest intersection which is closer than input tmin
+    bool Intersect(
+        const DirectX::XMFLOAT3* positions,
+        const int posStride,
+        const UINT* indices,
+        const DirectX::XMVECTOR& rayOrig,
+        const DirectX::XMVECTOR& rayDir,
+        float& tmin,
+        uint& outTriangleIdx) const;
+
+    inline bool IsBuilt()     const { return !nodes_.empty(); }
+    inline int  GetNumNodes() const { return (int)nodes_.size(); }
+
+private:
+    bool IsValid(const uint32 numTris) const;
+
+private:
+    cvector<BvhNode> nodes_;
+    cvector<uint32>  triIdxs_;      // triangles (idx in model's indices / 3) in order of leaves
+};
+
+//---------------------------------------------------------
+// Desc:   compute a hash of model's geometry (positions and indices);
+//         is used to check if the cached BVH still matches the model
+//---------------------------------------------------------
+uint64 HashModelGeometry(
+    const DirectX::XMFLOAT3* positions,
+    const int posStride,
+    const int numVertices,
+    const UINT* indices,
+    const int numIndices);
+
+} // namespace
@@ -82,6 +82,9 @@ ModelID ModelsCreator::ImportFromFile(const char* path)
         return INVALID_MODEL_ID;
     }
 
+    // imported models are usually high-poly so prepare BVH for ray tests
+    model.BuildBVH();
+
     return model.GetId();
 }
 
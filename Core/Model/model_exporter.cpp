@@ -10,7 +10,7 @@
 
     Filename: model_exporter.cpp
     Desc:     exports models which were imported or manually generated into
-              the .de3d format
+              the .de3d format (and its binary version .de3db)
 
     Created:  11.11.2024 by DimaSkup
 \**********************************************************************************/
@@ -18,6 +18,7 @@
 #include <CoreCommon/pch.h>
 #include "model_exporter.h"
 #include "model.h"
+#include "model_bin_format.h"
 
 #include "../Texture/enum_texture_types.h"
 #include <ImgConverter.h>
@@ -41,6 +42,7 @@ void WriteAABBs         (FILE* pFile, const Model* pModel);
 void WriteVertices      (FILE* pFile, const Vertex3D* vertices, const int numVertices);
 void WriteIndices       (FILE* pFile, const UINT* indices, const int numIndices);
 void StoreTextures      (const Model* pModel, const char* targetDir);
+bool WriteBinaryChunks  (FILE* pFile, const ModelBinHeader& header, const ModelBinChunk* chunks, const void* const* chunksData);
 
 //---------------------------------------------------------
 // Desc:   default constructor
@@ -92,10 +94,12 @@ bool ModelExporter::ExportIntoDE3D(
     // generate paths to model and material files (relatively to working dir)
     char relTargetDir[256]{ '\0' };
     char modelFilePath[256]{ '\0' };
+    char binFilePath[256]{ '\0' };
     char materialFilePath[256]{ '\0' };
 
     snprintf(relTargetDir, 256, "%s%s", g_RelPathAssetsDir, targetDir);
     snprintf(modelFilePath, 256, "%s%s.de3d", relTargetDir, targetName);
+    snprintf(binFilePath, 256, "%s%s%s", relTargetDir, targetName, MODEL_BIN_EXT);
     snprintf(materialFilePath, 256, "%s%s.demat", relTargetDir, targetName);
 
 
@@ -125,6 +129,161 @@ bool ModelExporter::ExportIntoDE3D(
 
     LogMsg(LOG, "model is converted into .de3d: %s", targetName);
     fclose(pFile);
+
+    // store the binary version as well so the model will be loaded without parsing
+    char matFileName[64]{ '\0' };
+    FileSys::GetFileName(materialFilePath, matFileName);
+
+    if (!ExportIntoBinary(pModel, matFileName, binFilePath))
+        LogErr(LOG, "can't export model into binary format: %s", binFilePath);
+
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:   store model's data into a binary .de3db file
+//         (for the layout look at model_bin_format.h)
+// Args:   - pModel:       a ptr to the model
+//         - matFileName:  a name of the model's .demat file (it must be placed
+//                         in the same directory as the model's file)
+//         - filePath:     a path to the output file (relatively to working dir)
+//         - subsetsMatNames: (optional) names of subsets materials; if not passed
+//                            the names are taken from the material manager
+//---------------------------------------------------------
+bool ModelExporter::ExportIntoBinary(
+    const Model* pModel,
+    const char* matFileName,
+    const char* filePath,
+    const char* const* subsetsMatNames)
+{
+    // check input args
+    if (!pModel)
+    {
+        LogErr(LOG, "ptr to model == NULL");
+        return false;
+    }
+    if (StrHelper::IsEmpty(matFileName))
+    {
+        LogErr(LOG, "material file name is empty!");
+        return false;
+    }
+    if (StrHelper::IsEmpty(filePath))
+    {
+        LogErr(LOG, "file path is empty!");
+        return false;
+    }
+
+    const int numSubsets = pModel->GetNumSubsets();
+
+    // string table: each string is referred by its offset in the table
+    cvector<char> strings;
+
+    auto addString = [&strings](const char* str) -> uint32
+    {
+        const uint32 offset = (uint32)strings.size();
+        const size_t len    = strlen(str);
+
+        strings.resize(offset + len + 1);
+        memcpy(strings.data() + offset, str, len + 1);
+        return offset;
+    };
+
+    ModelBinInfo info;
+    info.nameOffset    = addString(pModel->GetName());
+    info.matFileOffset = addString(matFileName);
+    info.numVertices   = pModel->GetNumVertices();
+    info.numIndices    = pModel->GetNumIndices();
+    info.numSubsets    = numSubsets;
+
+    // subsets (meshes) data
+    cvector<ModelBinSubset> subsets(numSubsets);
+    const Subset* srcSubsets = pModel->GetSubsets();
+
+    for (int i = 0; i < numSubsets; ++i)
+    {
+        const Subset&   src = srcSubsets[i];
+        ModelBinSubset& dst = subsets[i];
+
+        dst.vertexStart   = src.vertexStart;
+        dst.vertexCount   = src.vertexCount;
+        dst.indexStart    = src.indexStart;
+        dst.indexCount    = src.indexCount;
+        dst.nameOffset    = addString(src.name);
+        dst.matNameOffset = (subsetsMatNames)
+                            ? addString(subsetsMatNames[i])
+                            : addString(g_MaterialMgr.GetMatById(src.materialId).name);
+        dst.id            = src.id;
+    }
+
+    // AABB of the whole model and AABB of each subset
+    cvector<ModelBinAABB> aabbs(1 + numSubsets);
+    const DirectX::BoundingBox* subsetsAABBs = pModel->GetSubsetsAABB();
+
+    aabbs[0] = { pModel->GetModelAABB().Center, pModel->GetModelAABB().Extents };
+
+    for (int i = 0; i < numSubsets; ++i)
+        aabbs[i + 1] = { subsetsAABBs[i].Center, subsetsAABBs[i].Extents };
+
+
+    // describe chunks of the file
+    constexpr int numChunks = 6;
+    ModelBinChunk chunks[numChunks];
+    const void*   chunksData[numChunks];
+
+    chunks[0] = { MODEL_BIN_CHUNK_INFO,     0, (uint32)sizeof(info),                            1 };
+    chunks[1] = { MODEL_BIN_CHUNK_SUBSETS,  0, (uint32)(sizeof(ModelBinSubset) * numSubsets),   (uint32)numSubsets };
+    chunks[2] = { MODEL_BIN_CHUNK_AABBS,    0, (uint32)(sizeof(ModelBinAABB) * aabbs.size()),   (uint32)aabbs.size() };
+    chunks[3] = { MODEL_BIN_CHUNK_VERTICES, 0, (uint32)(sizeof(Vertex3D) * info.numVertices),   info.numVertices };
+    chunks[4] = { MODEL_BIN_CHUNK_INDICES,  0, (uint32)(sizeof(UINT) * info.numIndices),        info.numIndices };
+    chunks[5] = { MODEL_BIN_CHUNK_STRINGS,  0, (uint32)strings.size(),                          (uint32)strings.size() };
+
+    chunksData[0] = &info;
+    chunksData[1] = subsets.data();
+    chunksData[2] = aabbs.data();
+    chunksData[3] = pModel->GetVertices();
+    chunksData[4] = pModel->GetIndices();
+    chunksData[5] = strings.data();
+
+    // compute offsets of chunks (each chunk is aligned)
+    ModelBinHeader header;
+    header.numChunks        = numChunks;
+    header.chunkTableOffset = sizeof(ModelBinHeader);
+
+    size_t offset = sizeof(ModelBinHeader) + sizeof(chunks);
+
+    for (ModelBinChunk& chunk : chunks)
+    {
+        offset       = ModelBinAlign(offset);
+        chunk.offset = (uint32)offset;
+        offset      += chunk.size;
+    }
+
+    if (offset > UINT32_MAX)
+    {
+        LogErr(LOG, "model is too big for binary format: %s", pModel->GetName());
+        return false;
+    }
+
+    header.fileSize = (uint32)offset;
+
+
+    FILE* pFile = fopen(filePath, "wb");
+    if (!pFile)
+    {
+        LogErr(LOG, "can't open a file for model exporting (into %s format): %s", MODEL_BIN_EXT, filePath);
+        return false;
+    }
+
+    const bool result = WriteBinaryChunks(pFile, header, chunks, chunksData);
+    fclose(pFile);
+
+    if (!result)
+    {
+        LogErr(LOG, "can't write model into file: %s", filePath);
+        return false;
+    }
+
+    LogMsg(LOG, "model is converted into %s: %s", MODEL_BIN_EXT, filePath);
     return true;
 }
 
@@ -282,6 +441,47 @@ void WriteIndices(FILE* pFile, const UINT* indices, const int numIndices)
     fwrite((void*)indices, sizeof(UINT), numIndices, pFile);
 }
 
+//---------------------------------------------------------
+// Desc:   write header, chunk table, and data of each chunk
+//         (with zero padding up to the chunk's offset)
+//---------------------------------------------------------
+bool WriteBinaryChunks(
+    FILE* pFile,
+    const ModelBinHeader& header,
+    const ModelBinChunk* chunks,
+    const void* const* chunksData)
+{
+    assert(pFile);
+    assert(chunks);
+    assert(chunksData);
+
+    const uint8 zeros[MODEL_BIN_ALIGNMENT]{ 0 };
+
+    if (fwrite(&header, sizeof(header), 1, pFile) != 1)
+        return false;
+
+    if (fwrite(chunks, sizeof(ModelBinChunk), header.numChunks, pFile) != header.numChunks)
+        return false;
+
+    size_t pos = sizeof(header) + sizeof(ModelBinChunk) * header.numChunks;
+
+    for (uint32 i = 0; i < header.numChunks; ++i)
+    {
+        assert(chunks[i].offset >= pos);
+        const size_t padding = chunks[i].offset - pos;
+
+        if (fwrite(zeros, 1, padding, pFile) != padding)
+            return false;
+
+        if (fwrite(chunksData[i], 1, chunks[i].size, pFile) != chunks[i].size)
+            return false;
+
+        pos = chunks[i].offset + chunks[i].size;
+    }
+
+    return true;
+}
+
 //---------------------------------------------------------
 // Desc:  check if there is a need to rewrite existed texture
 //---------------------------------------------------------
@@ -10,7 +10,7 @@
 
     Filename: model_exporter.h
     Desc:     exports models which were imported or manually generated into
-              the .de3d format
+              the .de3d format (and its binary version .de3db)
 
     Created:  11.11.2024 by DimaSkup
 \**********************************************************************************/
@@ -32,6 +32,12 @@ public:
         const Model* pModel,
         const char* targetDir,
         const char* targetName);
+
+    bool ExportIntoBinary(
+        const Model* pModel,
+        const char* matFileName,
+        const char* filePath,
+        const char* const* subsetsMatNames = nullptr);
 };
 
 } // namespace
@@ -15,9 +15,12 @@
 #include <CoreCommon/pch.h>
 #include "model_loader.h"
 #include "model.h"
+#include "model_bin_format.h"
+#include "model_exporter.h"
 #include "FileSystemPaths.h"
 #include <Mesh/material_mgr.h>
 #include <Mesh/material_reader.h>
+#include <mapped_file.h>
 
 namespace Core
 {
@@ -26,11 +29,17 @@ namespace Core
 // helpers forward declaration
 //---------------------------------------------------------
 void ReadHeaderAndAllocMem(FILE* pFile, Model& model);
-void ReadMaterials        (FILE* pFile, Model& model, const char* path);
+void ReadMaterials        (FILE* pFile, Model& model, ModelMaterialsInfo& outMats);
 void ReadSubsets          (FILE* pFile, Model& model);
 void ReadAABBs            (FILE* pFile, Model& model);
 void ReadVertices         (FILE* pFile, Model& model);
 void ReadIndices          (FILE* pFile, Model& model);
+void LoadOrBuildBVH       (const char* modelPath, Model& model);
+void ReplaceFileExt       (const char* path, const char* ext, char* outPath, const int outSize);
+void GetCachePath         (const char* srcPath, const char* ext, char* outPath, const int outSize);
+bool CreateCacheDirFor    (const char* cachePath);
+bool IsBinaryUpToDate     (const char* de3dPath, const char* binPath);
+bool ExportLoadedIntoBinary(const Model& model, const ModelMaterialsInfo& mats, const char* binPath);
 
 
 //---------------------------------------------------------
@@ -38,23 +47,164 @@ void ReadIndices          (FILE* pFile, Model& model);
 //---------------------------------------------------------
 bool ModelLoader::Load(const char* filePath, Model* pModel)
 {
-    // check input args
+    if (!pModel)
+    {
+        LogErr(LOG, "ptr to model == NULL");
+        return false;
+    }
+
+    ModelMaterialsInfo mats;
+
+    if (!LoadGeometry(filePath, *pModel, mats))
+        return false;
+
+    BindMaterials(*pModel, mats);
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:   load model's data from file (everything except of materials);
+//         it doesn't touch any global managers so it can be executed
+//         in parallel for different models
+// Args:   - filePath:  a path to the model's file (relatively to the assets dir)
+// Out:    - model:     geometry, subsets, boundings, BVH
+//         - outMats:   materials of the model (look at BindMaterials)
+//---------------------------------------------------------
+bool ModelLoader::LoadGeometry(const char* filePath, Model& model, ModelMaterialsInfo& outMats)
+{
+    return LoadFile(filePath, model, outMats, true);
+}
+
+//---------------------------------------------------------
+// Desc:   load model's data from file except of geometry: subsets, boundings
+//         and materials info (so the model can be culled and rendered with
+//         a placeholder while its geometry is streamed); like LoadGeometry
+//         it can be executed in parallel for different models
+// Args:   - filePath:  a path to the model's file (relatively to the assets dir)
+//---------------------------------------------------------
+bool ModelLoader::LoadMetadata(const char* filePath, Model& model, ModelMaterialsInfo& outMats)
+{
+    return LoadFile(filePath, model, outMats, false);
+}
+
+//---------------------------------------------------------
+// Desc:   load model's file (prefer its binary version)
+// Args:   - withGeometry:  if false vertices/indices and BVH aren't loaded
+//---------------------------------------------------------
+bool ModelLoader::LoadFile(
+    const char* filePath,
+    Model& model,
+    ModelMaterialsInfo& outMats,
+    const bool withGeometry)
+{
     if (StrHelper::IsEmpty(filePath))
     {
         LogErr(LOG, "empty filepath");
         return false;
     }
-    if (!pModel)
+
+    // generate a path relatively to the working dir
+    char path[512]{ '\0' };
+    strcat(path, g_RelPathAssetsDir);
+    strcat(path, filePath);
+
+    LogMsg(LOG, "load model: %s", filePath);
+
+    const size_t pathLen  = strlen(path);
+    const size_t extLen   = strlen(MODEL_BIN_EXT);
+    const bool   isBinary = (pathLen > extLen) && (strcmp(path + pathLen - extLen, MODEL_BIN_EXT) == 0);
+
+    if (isBinary)
     {
-        LogErr(LOG, "ptr to model == NULL");
-        return false;
+        if (!LoadBinary(path, model, outMats, withGeometry))
+            return false;
     }
+    else
+    {
+        // prefer the cached binary version of the model if it is up to date
+        char binPath[512]{ '\0' };
+        GetCachePath(path, MODEL_BIN_EXT, binPath, sizeof(binPath));
+
+        if (!IsBinaryUpToDate(path, binPath) || !LoadBinary(binPath, model, outMats, withGeometry))
+        {
+            if (!LoadDE3D(path, model, outMats))
+                return false;
+
+            // so next time we will load the model without parsing
+            if (CreateCacheDirFor(binPath))
+                ExportLoadedIntoBinary(model, outMats, binPath);
+        }
+    }
+
+    if (withGeometry)
+        LoadOrBuildBVH(path, model);
+    else
+        model.ReleaseGeometry();
 
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:   read materials of the model and add them into the material manager,
+//         then bind the materials to the model's subsets (by names)
+// NOTE:   touches global managers so call it only on the owner thread
+//---------------------------------------------------------
+void ModelLoader::BindMaterials(Model& model, const ModelMaterialsInfo& mats)
+{
+    if (!StrHelper::IsEmpty(mats.matFileName))
+    {
+        // generate a relative path to the materials file
+        char relMatFilePath[256]{ '\0' };
+        FileSys::GetParentPath(mats.modelPath, relMatFilePath);
+        strcat(relMatFilePath, mats.matFileName);
+
+        MaterialReader matReader;
+        matReader.Read(relMatFilePath);
+    }
+
+    Subset*   subsets = model.GetSubsets();
+    const int num     = min(model.GetNumSubsets(), (int)mats.subsetsMatNames.size());
+
+    for (int i = 0; i < num; ++i)
+        subsets[i].materialId = g_MaterialMgr.GetMatIdByName(mats.subsetsMatNames[i].name);
+}
+
+//---------------------------------------------------------
+// Desc:   convert .de3d file into binary .de3db file
+// Args:   - filePath:  a path to .de3d file (relatively to the assets dir)
+//---------------------------------------------------------
+bool ModelLoader::ConvertIntoBinary(const char* filePath)
+{
+    if (StrHelper::IsEmpty(filePath))
+    {
+        LogErr(LOG, "empty filepath");
+        return false;
+    }
 
-    // open file for reading
     char path[512]{ '\0' };
+    char binPath[512]{ '\0' };
+
     strcat(path, g_RelPathAssetsDir);
     strcat(path, filePath);
+    ReplaceFileExt(path, MODEL_BIN_EXT, binPath, sizeof(binPath));
+
+    Model              model;
+    ModelMaterialsInfo mats;
+
+    if (!LoadDE3D(path, model, mats))
+        return false;
+
+    return ExportLoadedIntoBinary(model, mats, binPath);
+}
+
+//---------------------------------------------------------
+// Desc:   load model from the .de3d (text) file
+// Args:   - path:     a path to the file (relatively to the working dir)
+// Out:    - outMats:  materials of the model
+//---------------------------------------------------------
+bool ModelLoader::LoadDE3D(const char* path, Model& model, ModelMaterialsInfo& outMats)
+{
+    assert(!StrHelper::IsEmpty(path));
 
     FILE* pFile = fopen(path, "rb");
     if (!pFile)
@@ -63,19 +213,254 @@ bool ModelLoader::Load(const char* filePath, Model* pModel)
         return false;
     }
 
-    LogMsg(LOG, "load model: %s", filePath);
+    strncpy(outMats.modelPath, path, sizeof(outMats.modelPath) - 1);
 
-    ReadHeaderAndAllocMem(pFile, *pModel);
-    ReadMaterials        (pFile, *pModel, path);
-    ReadSubsets          (pFile, *pModel);
-    ReadAABBs            (pFile, *pModel);
-    ReadVertices         (pFile, *pModel);
-    ReadIndices          (pFile, *pModel);
+    ReadHeaderAndAllocMem(pFile, model);
+    ReadMaterials        (pFile, model, outMats);
+    ReadSubsets          (pFile, model);
+    ReadAABBs            (pFile, model);
+    ReadVertices         (pFile, model);
+    ReadIndices          (pFile, model);
 
     fclose(pFile);
     return true;
 }
 
+//---------------------------------------------------------
+// Desc:   (helper) find a chunk by id and check if its data
+//         is inside of the file and has expected size
+// Ret:    a ptr to the chunk's data or nullptr if something is wrong
+//---------------------------------------------------------
+static const void* GetBinaryChunk(
+    const MappedFile& file,
+    const ModelBinChunk* chunks,
+    const uint32 numChunks,
+    const uint32 chunkId,
+    const size_t elemSize,
+    uint32& outCount)
+{
+    for (uint32 i = 0; i < numChunks; ++i)
+    {
+        const ModelBinChunk& chunk = chunks[i];
+
+        if (chunk.id != chunkId)
+            continue;
+
+        const bool isValid =
+            ((size_t)chunk.offset + chunk.size <= file.GetSize()) &&
+            (chunk.offset % MODEL_BIN_ALIGNMENT == 0) &&
+            ((size_t)chunk.count * elemSize == chunk.size);
+
+        if (!isValid)
+            return nullptr;
+
+        outCount = chunk.count;
+        return file.GetData() + chunk.offset;
+    }
+
+    return nullptr;
+}
+
+//---------------------------------------------------------
+// Desc:   load model from the binary .de3db file: the file is mapped into memory
+//         and its blocks are used in place (the vertices/indices are copied
+//         into the model's memory as is)
+// Args:   - path:          a path to the file (relatively to the working dir)
+//         - withGeometry:  if false vertices/indices aren't read
+// Out:    - outMats:       materials of the model
+//---------------------------------------------------------
+bool ModelLoader::LoadBinary(
+    const char* path,
+    Model& model,
+    ModelMaterialsInfo& outMats,
+    const bool withGeometry)
+{
+    assert(!StrHelper::IsEmpty(path));
+
+    MappedFile file;
+
+    if (!file.Open(path))
+    {
+        LogErr(LOG, "can't open a file for model loading: %s", path);
+        return false;
+    }
+
+    // check header and chunk table
+    const ModelBinHeader* pHeader = (const ModelBinHeader*)file.GetData();
+
+    if ((file.GetSize() < sizeof(ModelBinHeader)) ||
+        (pHeader->magic != MODEL_BIN_MAGIC) ||
+        (pHeader->version != MODEL_BIN_VERSION) ||
+        (pHeader->fileSize != file.GetSize()) ||
+        ((size_t)pHeader->chunkTableOffset + sizeof(ModelBinChunk) * pHeader->numChunks > file.GetSize()))
+    {
+        LogErr(LOG, "invalid header of binary model file: %s", path);
+        return false;
+    }
+
+    const ModelBinChunk* chunks    = (const ModelBinChunk*)(file.GetData() + pHeader->chunkTableOffset);
+    const uint32         numChunks = pHeader->numChunks;
+
+    uint32 numInfos   = 0;
+    uint32 numSubsets = 0;
+    uint32 numAABBs   = 0;
+    uint32 numVerts   = 0;
+    uint32 numIdxs    = 0;
+    uint32 strsSize   = 0;
+
+    const ModelBinInfo*   pInfo   = (const ModelBinInfo*)  GetBinaryChunk(file, chunks, numChunks, MODEL_BIN_CHUNK_INFO,     sizeof(ModelBinInfo),   numInfos);
+    const ModelBinSubset* subsets = (const ModelBinSubset*)GetBinaryChunk(file, chunks, numChunks, MODEL_BIN_CHUNK_SUBSETS,  sizeof(ModelBinSubset), numSubsets);
+    const ModelBinAABB*   aabbs   = (const ModelBinAABB*)  GetBinaryChunk(file, chunks, numChunks, MODEL_BIN_CHUNK_AABBS,    sizeof(ModelBinAABB),   numAABBs);
+    const Vertex3D*       verts   = (const Vertex3D*)      GetBinaryChunk(file, chunks, numChunks, MODEL_BIN_CHUNK_VERTICES, sizeof(Vertex3D),       numVerts);
+    const UINT*           idxs    = (const UINT*)          GetBinaryChunk(file, chunks, numChunks, MODEL_BIN_CHUNK_INDICES,  sizeof(UINT),           numIdxs);
+    const char*           strs    = (const char*)          GetBinaryChunk(file, chunks, numChunks, MODEL_BIN_CHUNK_STRINGS,  sizeof(char),           strsSize);
+
+    const bool isValid =
+        pInfo && subsets && aabbs && verts && idxs && strs &&
+        (numInfos == 1) &&
+        (numSubsets == pInfo->numSubsets) &&
+        (numAABBs   == pInfo->numSubsets + 1) &&
+        (numVerts   == pInfo->numVertices) &&
+        (numIdxs    == pInfo->numIndices) &&
+        (strsSize > 0) && (strs[strsSize - 1] == '\0');
+
+    if (!isValid)
+    {
+        LogErr(LOG, "invalid chunks of binary model file: %s", path);
+        return false;
+    }
+
+    // check that subsets ranges are inside of the vertex/index buffers
+    for (uint32 i = 0; i < numSubsets; ++i)
+    {
+        const ModelBinSubset& s = subsets[i];
+
+        if (((uint64)s.vertexStart + s.vertexCount > numVerts) ||
+            ((uint64)s.indexStart  + s.indexCount  > numIdxs))
+        {
+            LogErr(LOG, "subset %u is out of range in binary model file: %s", i, path);
+            return false;
+        }
+    }
+
+    // check that each index refers to an existing vertex
+    // (mapped pages of indices aren't touched if we don't need geometry)
+    if (withGeometry)
+    {
+        for (uint32 i = 0; i < numIdxs; ++i)
+        {
+            if (idxs[i] >= numVerts)
+            {
+                LogErr(LOG, "index %u is out of range in binary model file: %s", i, path);
+                return false;
+            }
+        }
+    }
+
+    // get a string from the string table by offset
+    auto getString = [strs, strsSize](const uint32 offset) -> const char*
+    {
+        return (offset < strsSize) ? strs + offset : "";
+    };
+
+
+    // alloc memory and setup model's data
+    model.SetName(getString(pInfo->nameOffset));
+
+    if (!model.AllocMem(numVerts, numIdxs, numSubsets))
+        return false;
+
+    // materials are bound later (look at BindMaterials)
+    strncpy(outMats.modelPath,   path,                             sizeof(outMats.modelPath) - 1);
+    strncpy(outMats.matFileName, getString(pInfo->matFileOffset),  sizeof(outMats.matFileName) - 1);
+    outMats.subsetsMatNames.resize(numSubsets);
+
+    Subset* modelSubsets = model.GetSubsets();
+
+    for (uint32 i = 0; i < numSubsets; ++i)
+    {
+        const ModelBinSubset& src = subsets[i];
+        Subset&               dst = modelSubsets[i];
+
+        dst.vertexStart = src.vertexStart;
+        dst.vertexCount = src.vertexCount;
+        dst.indexStart  = src.indexStart;
+        dst.indexCount  = src.indexCount;
+        dst.id          = src.id;
+
+        strncpy(outMats.subsetsMatNames[i].name, getString(src.matNameOffset), MAX_LEN_MAT_NAME - 1);
+
+        strncpy(dst.name, getString(src.nameOffset), MAX_LEN_MESH_NAME - 1);
+        dst.name[MAX_LEN_MESH_NAME - 1] = '\0';
+    }
+
+    // setup boundings
+    model.SetModelAABB(DirectX::BoundingBox(aabbs[0].center, aabbs[0].extents));
+
+    DirectX::BoundingSphere sphere;
+    DirectX::BoundingSphere::CreateFromBoundingBox(sphere, model.GetModelAABB());
+    model.SetModelBoundSphere(sphere);
+
+    for (uint32 i = 0; i < numSubsets; ++i)
+        model.SetSubsetAABB((SubsetID)i, DirectX::BoundingBox(aabbs[i + 1].center, aabbs[i + 1].extents));
+
+    // geometry (the mapped pages of vertices/indices aren't touched if we don't need them)
+    if (!withGeometry)
+    {
+        model.ReleaseGeometry();
+        return true;
+    }
+
+    memcpy(model.GetVertices(), verts, sizeof(Vertex3D) * numVerts);
+    memcpy(model.GetIndices(),  idxs,  sizeof(UINT) * numIdxs);
+
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:   check if binary version of the model exists and
+//         it isn't older than the .de3d file
+//---------------------------------------------------------
+bool IsBinaryUpToDate(const char* de3dPath, const char* binPath)
+{
+    std::error_code ec;
+
+    if (!fs::exists(binPath, ec))
+        return false;
+
+    // there is only binary file
+    if (!fs::exists(de3dPath, ec))
+        return true;
+
+    const auto binTime  = fs::last_write_time(binPath, ec);
+    if (ec)
+        return false;
+
+    const auto de3dTime = fs::last_write_time(de3dPath, ec);
+    if (ec)
+        return false;
+
+    return binTime >= de3dTime;
+}
+
+//---------------------------------------------------------
+// Desc:   store just loaded model into .de3db file; materials aren't bound yet
+//         so names of subsets materials are taken from the materials info
+//---------------------------------------------------------
+bool ExportLoadedIntoBinary(const Model& model, const ModelMaterialsInfo& mats, const char* binPath)
+{
+    const int numSubsets = model.GetNumSubsets();
+    const int numNames   = (int)mats.subsetsMatNames.size();
+
+    cvector<const char*> matNames(numSubsets, "");
+
+    for (int i = 0; i < numSubsets && i < numNames; ++i)
+        matNames[i] = mats.subsetsMatNames[i].name;
+
+    ModelExporter exporter;
+    return exporter.ExportIntoBinary(&model, mats.matFileName, binPath, matNames.data());
+}
+
 //---------------------------------------------------------
 // Desc:   read common params for this model
 //         and allocate memory for model's vertices, indices, and meshes (subsets)
@@ -86,11 +471,14 @@ void ReadHeaderAndAllocMem(FILE* pFile, Model& model)
 
     int numVertices, numIndices, numSubsets;
 
+    // NOTE: we don't use global buffers since models can be loaded in parallel
+    char buf[256]{ '\0' };
+
     // skip chunk/block header
-    fscanf(pFile, "%s", g_String);
+    fscanf(pFile, "%255s", buf);
 
-    fscanf(pFile, "\nName: %s", g_String);
-    model.SetName(g_String);
+    fscanf(pFile, "\nName: %255s", buf);
+    model.SetName(buf);
 
     fscanf(pFile, "\nMeshes:   %d", &numSubsets);
     fscanf(pFile, "\nVertices: %d", &numVertices);
@@ -102,47 +490,36 @@ void ReadHeaderAndAllocMem(FILE* pFile, Model& model)
 }
 
 //---------------------------------------------------------
-// Desc:   load materials from file and bind them to this model
+// Desc:   read a name of the materials file and names of
+//         materials of each subset (they are bound later)
 //---------------------------------------------------------
-void ReadMaterials(FILE* pFile, Model& model, const char* relFilePath)
+void ReadMaterials(FILE* pFile, Model& model, ModelMaterialsInfo& outMats)
 {
     assert(pFile);
-    assert(!StrHelper::IsEmpty(relFilePath));
 
-    char relMatFilePath[256]{ '\0' };
-    char matFileName[128]{'\0'};
-    char matName[MAX_LEN_MAT_NAME]{ '\0' };
+    char buf[256]{ '\0' };
     int meshIdx = 0;
     int numMats = 0;
     int count = 0;
 
     // skip chunk/block header
-    fgets(g_String, sizeof(g_String), pFile);
+    fgets(buf, sizeof(buf), pFile);
 
     
-    count = fscanf(pFile, "MatFile: %s\n", matFileName);
+    count = fscanf(pFile, "MatFile: %127s\n", outMats.matFileName);
     assert(count == 1);
 
-    // generate a relative path to the materials file
-    FileSys::GetParentPath(relFilePath, relMatFilePath);
-    strcat(relMatFilePath, matFileName);
-
-    // read materials from file and add them into the material manager
-    MaterialReader matReader;
-    matReader.Read(relMatFilePath);
-
-    // setup material ID for each subset (mesh)
+    // read names of subsets materials
     count = fscanf(pFile, "NumMaterials: %d\n", &numMats);
     assert(count == 1);
 
-    Subset* subsets = model.GetSubsets();
+    numMats = min(numMats, model.GetNumSubsets());
+    outMats.subsetsMatNames.resize(numMats);
 
     for (int i = 0; i < numMats; ++i)
     {
-        count = fscanf(pFile, "Subset%d_MatName: %s\n", &meshIdx, matName);
+        count = fscanf(pFile, "Subset%d_MatName: %31s\n", &meshIdx, outMats.subsetsMatNames[i].name);
         assert(count == 2);
-
-        subsets[i].materialId = g_MaterialMgr.GetMatIdByName(matName);
     }
 
     fscanf(pFile, "\n\n");
@@ -243,7 +620,8 @@ void ReadIndices(FILE* pFile, Model& model)
 {
     assert(pFile);
 
-    fscanf(pFile, "%s\n", g_String);     // skip chunk/block header
+    char buf[256]{ '\0' };
+    fscanf(pFile, "%255s\n", buf);       // skip chunk/block header
 
     UINT*  indices = model.GetIndices();
     int numIndices = model.GetNumIndices();
@@ -255,4 +633,98 @@ void ReadIndices(FILE* pFile, Model& model)
     }
 }
 
+//---------------------------------------------------------
+// Desc:   load BVH of the model from a cache file (look at GetCachePath);
+//         if there is no cache or it is out of date we build BVH
+//         and write it into the cache
+//---------------------------------------------------------
+void LoadOrBuildBVH(const char* modelPath, Model& model)
+{
+    assert(!StrHelper::IsEmpty(modelPath));
+
+    char bvhPath[512]{ '\0' };
+    GetCachePath(modelPath, ".bvh", bvhPath, sizeof(bvhPath));
+
+    if (model.LoadBVH(bvhPath))
+        return;
+
+    model.BuildBVH();
+
+    if (CreateCacheDirFor(bvhPath))
+        model.SaveBVH(bvhPath);
+}
+
+//---------------------------------------------------------
+// Desc:   generate a path to the cache file of the source asset; caches are
+//         kept apart from the assets in the cache dir which mirrors the source
+//         tree (data/models/assets/box.de3d => data/cache/models/assets/box.bvh)
+// Args:   - srcPath:  a path to the source file (relatively to the working dir)
+//         - ext:      extension of the cache file (with dot)
+//         - outSize:  size of the output buffer
+//---------------------------------------------------------
+void GetCachePath(const char* srcPath, const char* ext, char* outPath, const int outSize)
+{
+    assert(!StrHelper::IsEmpty(srcPath));
+    assert(outPath);
+
+    // don't duplicate the data dir in the cache path
+    const char*  dataDir    = "data/";
+    const size_t dataDirLen = strlen(dataDir);
+
+    if (strncmp(srcPath, dataDir, dataDirLen) == 0)
+        srcPath += dataDirLen;
+
+    char path[512]{ '\0' };
+    snprintf(path, sizeof(path), "%s%s", g_RelPathCacheDir, srcPath);
+
+    ReplaceFileExt(path, ext, outPath, outSize);
+}
+
+//---------------------------------------------------------
+// Desc:   create (if necessary) the parent directory of the cache file
+// NOTE:   can be called from worker threads (if some other thread has just
+//         created the same directory it isn't an error)
+//---------------------------------------------------------
+bool CreateCacheDirFor(const char* cachePath)
+{
+    assert(!StrHelper::IsEmpty(cachePath));
+
+    std::error_code ec;
+    const fs::path  dir = fs::path(cachePath).parent_path();
+
+    fs::create_directories(dir, ec);
+
+    if (!fs::is_directory(dir, ec))
+    {
+        LogErr(LOG, "can't create a cache directory for: %s", cachePath);
+        return false;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:   replace extension of the file in path (model.de3d => model.bvh)
+// Args:   - ext:      a new extension (with dot)
+//         - outSize:  size of the output buffer
+//---------------------------------------------------------
+void ReplaceFileExt(const char* path, const char* ext, char* outPath, const int outSize)
+{
+    assert(!StrHelper::IsEmpty(path));
+    assert(ext && outPath);
+
+    const int extLen = (int)strlen(ext);
+    assert(outSize > extLen);
+
+    strncpy(outPath, path, outSize - extLen - 1);
+    outPath[outSize - extLen - 1] = '\0';
+
+    // cut off the current extension (if the last dot is in the file name)
+    char* dot = strrchr(outPath, '.');
+    if (dot && !strchr(dot, '/') && !strchr(dot, '\\'))
+        *dot = '\0';
+
+    strcat(outPath, ext);
+}
+
 } // namespace
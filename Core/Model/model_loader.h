@@ -9,22 +9,71 @@
     ******     ******    ******   **    **  ********
 
     Filename: model_loader.h
-    Desc:     load model from internal format file
+    Desc:     load model from internal format file:
+
+              - .de3db: binary format which is memory mapped and used in place
+                        (for the layout look at model_bin_format.h);
+              - .de3d:  old text format (with binary vertices/indices);
+                        when we load a .de3d file we prefer its cached binary
+                        version (data/cache/.../model.de3db) if it is up to date,
+                        otherwise the .de3d is parsed and converted into .de3db
+                        which is written into the cache dir (not next to the .de3d)
+
+              loading is split into two steps so models can be loaded in parallel:
+              - LoadGeometry:  read/decode the file, doesn't touch any global
+                               managers (can be called from worker threads);
+              - BindMaterials: read the model's materials and bind them
+                               to subsets (only on the owner thread)
+
+              LoadMetadata is the same as LoadGeometry but vertices/indices
+              aren't loaded (is used when geometry is streamed later)
 
     Created:  19.10.2025  by DimaSkup
 \**********************************************************************************/
 #pragma once
 
+#include <Types.h>
+#include <cvector.h>
+
 namespace Core
 {
 
 // forward declaration (pointer use only)
 class Model;
 
+//---------------------------------------------------------
+// materials of a loaded model which must be bound on the owner thread
+//---------------------------------------------------------
+struct ModelMatName
+{
+    char name[MAX_LEN_MAT_NAME]{ '\0' };
+};
+
+struct ModelMaterialsInfo
+{
+    char                  matFileName[128]{ '\0' };   // .demat file next to the model's file
+    char                  modelPath[512]{ '\0' };     // relatively to the working dir
+    cvector<ModelMatName> subsetsMatNames;
+};
+
+//---------------------------------------------------------
+
 class ModelLoader
 {
 public:
     bool Load(const char* filePath, Model* pModel);
+
+    bool LoadGeometry (const char* filePath, Model& model, ModelMaterialsInfo& outMats);
+    bool LoadMetadata (const char* filePath, Model& model, ModelMaterialsInfo& outMats);
+    void BindMaterials(Model& model, const ModelMaterialsInfo& mats);
+
+    // convert .de3d file into .de3db (which is placed next to the .de3d)
+    bool ConvertIntoBinary(const char* filePath);
+
+private:
+    bool LoadFile  (const char* filePath, Model& model, ModelMaterialsInfo& outMats, const bool withGeometry);
+    bool LoadDE3D  (const char* path, Model& model, ModelMaterialsInfo& outMats);
+    bool LoadBinary(const char* path, Model& model, ModelMaterialsInfo& outMats, const bool withGeometry);
 };
 
 } // namespace
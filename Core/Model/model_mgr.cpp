@@ -20,7 +20,6 @@ namespace Core
 
 
 // static arrays for internal purposes
-static cvector<index>         s_Idxs;
 static cvector<VertexDecal3D> s_VertsDecals;
 
 // init a global instance of the model manager
@@ -40,6 +39,7 @@ ModelMgr::ModelMgr()
     ids_.reserve(reserve);
     models_.reserve(reserve);
     names_.reserve(reserve);
+    idsByNames_.Reserve(reserve);
 }
 
 //---------------------------------------------------------
@@ -109,6 +109,7 @@ void ModelMgr::Shutdown()
     ids_.purge();
     models_.purge();
     names_.purge();
+    idsByNames_.Clear();
 
     sky_.Shutdown();
     terrainGeomip_.Shutdown();
@@ -232,6 +233,7 @@ ModelID ModelMgr::AddModel(Model&& model)
 
     ids_.insert_before(idx, model.GetId());
     models_.insert_before(idx, std::move(model));
+    idsByNames_.Insert(HashStr(names_[idx].name), id);
     
     if (id >= lastModelID_)
         lastModelID_ = id + 1;
@@ -257,6 +259,7 @@ Model& ModelMgr::AddEmptyModel()
     // setup a name stored in the manager
     ModelName& name = names_.back();
     strcpy(name.name, "inv");
+    idsByNames_.Insert(HashStr(name.name), id);
 
     return models_.back();
 }
@@ -281,18 +284,19 @@ void ModelMgr::GetModelsByIds(
     }
 
     // get idxs by IDs
-    ids_.get_idxs(ids, numModels, s_Idxs);
+    ScratchVec<index> idxs;
+    ids_.get_idxs(ids, numModels, idxs);
 
     // check idxs
 #if _DEBUG | DEBUG
-    for (const index idx : s_Idxs)
+    for (const index idx : idxs)
         assert(models_.is_valid_index(idx));
 #endif
 
     // get pointers by idxs
     outModels.resize(numModels);
 
-    for (int i = 0; const index idx : s_Idxs)
+    for (int i = 0; const index idx : idxs)
         outModels[i++] = &models_[idx];
 }
 
@@ -320,11 +324,10 @@ Model& ModelMgr::GetModelByName(const char* name)
         return models_[INVALID_MODEL_ID];
     }
 
-    for (index i = 0; i < names_.size(); ++i)
-    {
-        if (strcmp(names_[i].name, name) == 0)
-            return models_[i];
-    }
+    const index idx = FindIdxByName(name);
+
+    if (idx != -1)
+        return models_[idx];
 
     // return an empty model if we didn't find any
     LogErr(LOG, "no model by name: %s", name);
@@ -342,11 +345,10 @@ ModelID ModelMgr::GetModelIdByName(const char* name)
         return ids_[0];                     // return empty model (actually cube)
     }
 
-    for (index i = 0; i < names_.size(); ++i)
-    {
-        if (strcmp(names_[i].name, name) == 0)
-            return ids_[i];
-    }
+    const index idx = FindIdxByName(name);
+
+    if (idx != -1)
+        return ids_[idx];
 
     // return an empty model ID if we didn't find any
     LogErr(LOG, "no model by name: %s", name);
@@ -364,14 +366,26 @@ bool ModelMgr::HasModelByName(const char* name)
         return false;
     }
 
-    bool bHasModel = false;
+    return FindIdxByName(name) != -1;
+}
+
+//---------------------------------------------------------
+// Desc:   find an idx of model by input name using the hash index
+// Ret:    idx or -1 if there is no such a name
+//---------------------------------------------------------
+index ModelMgr::FindIdxByName(const char* name) const
+{
+    ModelID id = INVALID_MODEL_ID;
 
-    for (index i = 0; i < names_.size(); ++i)
+    auto isEqual = [this, name](const ModelID modelId)
     {
-        bHasModel |= (strcmp(names_[i].name, name) == 0);
-    }
+        return strcmp(names_[ids_.get_idx(modelId)].name, name) == 0;
+    };
+
+    if (!idsByNames_.Find(HashStr(name), isEqual, id))
+        return -1;
 
-    return bHasModel;
+    return ids_.get_idx(id);
 }
 
 //---------------------------------------------------------
@@ -413,9 +427,13 @@ void ModelMgr::SetModelName(const ModelID id, const char* name)
     // update model's name
     models_[idx].SetName(name);
 
-    // update arr of names
+    // update arr of names (and the hash index as well)
+    idsByNames_.Erase(HashStr(names_[idx].name), id);
+
     strncpy(names_[idx].name, name, len);
     names_[idx].name[len] = '\0';
+
+    idsByNames_.Insert(HashStr(names_[idx].name), id);
 }
 
 //---------------------------------------------------------
@@ -16,6 +16,7 @@
 #include <math/vec2.h>
 #include <math/vec3.h>
 #include <cvector.h>
+#include <str_hash_index.h>
 
 namespace Core
 {
@@ -96,6 +97,8 @@ public:
 
 
 private:
+    index FindIdxByName(const char* name) const;
+
     bool InitBillboardsVB();
     bool InitDecalsBuffers();
 
@@ -114,6 +117,7 @@ private:
     cvector<ModelID>    ids_;
     cvector<Model>      models_;
     cvector<ModelName>  names_;
+    StrHashIndex        idsByNames_;    // hash index [name => model ID]
 
     SkyModel            sky_;
     SkyPlane            skyPlane_;
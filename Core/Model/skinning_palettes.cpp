@@ -0,0 +1,116 @@
+// =================================================================================
+// Filename:   skinning_palettes.cpp
+// Desc:       parallel sampling of bones palettes of animated entities
+//
+// Created:    17.10.2026  by DimaSkup
+// =================================================================================
+#include <CoreCommon/pch.h>
+#include "skinning_palettes.h"
+
+#include "animation_mgr.h"
+#include <Entity/EntityMgr.h>
+#include <job_system.h>
+
+using namespace DirectX;
+
+
+namespace Core
+{
+
+// sampling of a single pose is cheap so don't create
+// jobs for less than this number of entities
+constexpr int MIN_NUM_PALETTES_PER_JOB = 2;
+
+//---------------------------------------------------------
+// Desc:   sample poses of animated entities in range [start, end)
+//---------------------------------------------------------
+void SkinningPalettes::SampleRange(void* pArgs, const int start, const int end)
+{
+    SkinningPalettes& palettes = *(SkinningPalettes*)pArgs;
+
+    for (int i = start; i < end; ++i)
+    {
+        const AnimSkeleton* pSkeleton = palettes.skeletons_[i];
+
+        if (!pSkeleton)
+            continue;
+
+        pSkeleton->SamplePalette(
+            palettes.animIds_[i],
+            palettes.timePoses_[i],
+            palettes.palettes_.data() + palettes.firstMatrix_[i]);
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   gather animation data of entities and sample their poses
+//         (each entity is sampled independently so it is done in parallel)
+//---------------------------------------------------------
+void SkinningPalettes::Update(const ECS::AnimationSystem& animSys)
+{
+    const cvector<EntityID>&      ids        = animSys.GetEnttsIds();
+    const cvector<ECS::AnimData>& animData   = animSys.GetAnimData();
+    const int                     numRecords = (int)ids.size();
+
+    enttsIds_.resize(numRecords);
+    skeletons_.resize(numRecords);
+    animIds_.resize(numRecords);
+    timePoses_.resize(numRecords);
+    firstMatrix_.resize(numRecords);
+    numBones_.resize(numRecords);
+
+    uint32 numMatrices = 0;
+    numSampled_        = 0;
+
+    // record 0 is the "invalid" (dummy) animation so skip it
+    for (int i = 0; i < numRecords; ++i)
+    {
+        const ECS::AnimData& data     = animData[i];
+        const AnimSkeleton&  skeleton = g_AnimationMgr.GetSkeleton(data.skeletonId);
+        const int            numBones = (int)skeleton.GetNumBones();
+        const bool           isValid  =
+            (i > 0) &&
+            (numBones > 0 && numBones <= MAX_NUM_BONES_PER_CHARACTER) &&
+            ((size)data.currAnimId < skeleton.GetNumAnimations());
+
+        enttsIds_[i]    = ids[i];
+        skeletons_[i]   = (isValid) ? &skeleton : nullptr;
+        animIds_[i]     = data.currAnimId;
+        timePoses_[i]   = data.timePos;
+        firstMatrix_[i] = numMatrices;
+        numBones_[i]    = (isValid) ? (uint16)numBones : 0;
+
+        numMatrices    += numBones_[i];
+        numSampled_    += (int)isValid;
+    }
+
+    palettes_.resize(numMatrices);
+
+    g_JobSystem.ParallelFor(numRecords, MIN_NUM_PALETTES_PER_JOB, SampleRange, this);
+}
+
+//---------------------------------------------------------
+// Desc:   get a palette of entity sampled during the last update
+// Out:    - outNumBones:  number of matrices in the palette
+// Ret:    ptr to transposed bones matrices or nullptr
+//---------------------------------------------------------
+const XMMATRIX* SkinningPalettes::GetPalette(
+    const ECS::AnimationSystem& animSys,
+    const EntityID id,
+    int& outNumBones) const
+{
+    const index idx = animSys.GetRecordIdx(id);
+    outNumBones     = 0;
+
+    // records could be changed after the update
+    if ((idx == 0) || (idx >= enttsIds_.size()) || (enttsIds_[idx] != id))
+        return nullptr;
+
+    if (numBones_[idx] == 0)
+        return nullptr;
+
+    outNumBones = numBones_[idx];
+    return palettes_.data() + firstMatrix_[idx];
+}
+
+} // namespace
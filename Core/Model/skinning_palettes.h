@@ -0,0 +1,75 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: skinning_palettes.h
+    Desc:     per-frame buffer of bones palettes (final bones transformations)
+              of all the animated entities:
+
+              - is updated once per frame (after the ECS update): poses of
+                entities are sampled in parallel by the job system;
+              - palettes of all entities are stored one after another in
+                a single array in order of records of the AnimationSystem;
+              - matrices are already transposed so they can be copied
+                into the const buffer for skinning as is
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <Types.h>
+#include <cvector.h>
+#include <DirectXMath.h>
+
+
+// forward declarations (pointer use only)
+namespace ECS
+{
+class AnimationSystem;
+}
+
+namespace Core
+{
+
+// forward declaration (pointer use only)
+class AnimSkeleton;
+
+//---------------------------------------------------------
+
+class SkinningPalettes
+{
+public:
+    SkinningPalettes() {}
+
+    // sample poses of all the animated entities for this frame
+    void Update(const ECS::AnimationSystem& animSys);
+
+    // get palette of entity (or nullptr if there is no palette for it)
+    const DirectX::XMMATRIX* GetPalette(
+        const ECS::AnimationSystem& animSys,
+        const EntityID id,
+        int& outNumBones) const;
+
+    inline int GetNumSampled() const { return numSampled_; }
+
+private:
+    static void SampleRange(void* pArgs, const int start, const int end);
+
+    cvector<EntityID>            enttsIds_;         // per record: entity ID (to check if records weren't changed since the update)
+    cvector<const AnimSkeleton*> skeletons_;        // per record: skeleton (nullptr if there is nothing to sample)
+    cvector<AnimationID>         animIds_;          // per record: current animation
+    cvector<float>               timePoses_;        // per record: current time of animation
+    cvector<uint32>              firstMatrix_;      // per record: idx of the first matrix in the palettes arr
+    cvector<uint16>              numBones_;         // per record: number of bones
+
+    cvector<DirectX::XMMATRIX>   palettes_;
+    int                          numSampled_ = 0;
+};
+
+} // namespace
@@ -17,11 +17,13 @@
 #include <Render/r_states.h>          // Render module
 #include <Shaders/Shader.h>           // Render module
 #include <geometry/frustum.h>
+#include <geometry/frustum_culling.h>
 #include <QuadTree/scene_object.h>
 #include <QuadTree/quad_tree.h>
 #include <Model/grass_mgr.h>
 #include <Mesh/material.h>
 #include <Model/animation_mgr.h>
+#include <Model/asset_streamer.h>
 
 
 using namespace DirectX;
@@ -48,9 +50,6 @@ struct LightTempData
     cvector<ECS::PointLight>    activePointLights;
 } s_LightTmpData;
 
-// static arrays for internal purposes
-static cvector<XMMATRIX> s_BoneTransforms;
-
 
 //---------------------------------------------------------
 
@@ -59,12 +58,15 @@ struct FrustumCullingTmpData
     void Resize(const size numRenderableEntts)
     {
         boundSpheres.resize(numRenderableEntts);
+        spheres.Resize(numRenderableEntts);
         idxsToVisEntts.resize(numRenderableEntts);
         enttsWorlds.resize(numRenderableEntts);
     }
 
     cvector<BoundingSphere> boundSpheres;
-    cvector<index>          idxsToVisEntts;
+    SpheresSoA              spheres;            // bound volumes in SoA form for batch culling
+    AABBsSoA                boxes;
+    cvector<int>            idxsToVisEntts;
     cvector<XMMATRIX>       enttsWorlds;
     cvector<XMFLOAT3>       positions;
 };
@@ -72,6 +74,72 @@ struct FrustumCullingTmpData
 static FrustumCullingTmpData s_tmpFrustumCullData;
 
 
+//---------------------------------------------------------
+// Desc:  arguments for the per-frame update jobs (see CGraphics::Update)
+//---------------------------------------------------------
+struct UpdateJobsArgs
+{
+    CameraParams               camParams;
+    const Frustum*             pWorldFrustum = nullptr;
+    float                      distFogged    = 0;
+    XMFLOAT3                   camPos;                  // position of camera used for culling
+    XMFLOAT3                   viewPos;                 // position of the current (rendering) camera
+
+    RenderDataPreparator*      pPreparator   = nullptr;
+    ECS::EntityMgr*            pEnttMgr      = nullptr;
+    Render::RenderDataStorage* pStorage      = nullptr;
+    SkinningPalettes*          pSkinPalettes = nullptr;
+};
+
+//---------------------------------------------------------
+// Desc:  update LOD and visibility for each terrain's patch
+//---------------------------------------------------------
+void UpdateTerrainJob(void* pArgs)
+{
+    const UpdateJobsArgs& args = *(const UpdateJobsArgs*)pArgs;
+    g_ModelMgr.GetTerrain().Update(args.camParams, *args.pWorldFrustum, args.distFogged);
+}
+
+//---------------------------------------------------------
+// Desc:  update visibility of grass patches (without updating of GPU buffers)
+//---------------------------------------------------------
+void CalcVisibleGrassJob(void* pArgs)
+{
+    const UpdateJobsArgs& args = *(const UpdateJobsArgs*)pArgs;
+    const Vec3 camPos = { args.camPos.x, args.camPos.y, args.camPos.z };
+
+    g_GrassMgr.CalcVisibleGrass(camPos, args.pWorldFrustum);
+}
+
+//---------------------------------------------------------
+// Desc:  sample poses of all the animated entities (per-entity jobs inside)
+//---------------------------------------------------------
+void UpdateSkinningJob(void* pArgs)
+{
+    const UpdateJobsArgs& args = *(const UpdateJobsArgs*)pArgs;
+    args.pSkinPalettes->Update(args.pEnttMgr->animationSys_);
+}
+
+//---------------------------------------------------------
+// Desc:  prepare instances data of visible entities (without updating of GPU buffers)
+//---------------------------------------------------------
+void PrepareRenderInstancesJob(void* pArgs)
+{
+    const UpdateJobsArgs& args = *(const UpdateJobsArgs*)pArgs;
+    cvector<EntityID>& visibleEntts = args.pEnttMgr->renderSys_.GetAllVisibleEntts();
+
+    if (visibleEntts.size() == 0)
+        return;
+
+    // gather entts data for rendering
+    args.pPreparator->PrepareEnttsDataForRendering(
+        visibleEntts,
+        args.viewPos,
+        args.pEnttMgr,
+        *args.pStorage);
+}
+
+
 //---------------------------------------------------------
 // Desc:  default constructor and destructor
 //---------------------------------------------------------
@@ -343,6 +411,20 @@ void CGraphics::Update(const float deltaTime, const float gameTime)
     }
 
 
+    // streaming: request assets around the camera, load/unload them
+    // (before the jobs since they read geometry and textures of models);
+    // cached render batches refer to buffers/views of streamed assets
+    // so the render list is rebuilt when any of them is loaded/unloaded
+    const XMFLOAT3 streamCamPos = { camParams.posX, camParams.posY, camParams.posZ };
+    g_AssetStreamer.Update(streamCamPos, pEnttMgr_->renderSys_.GetAllVisibleEntts(), *pEnttMgr_);
+
+    if (streamResidencyVersion_ != g_AssetStreamer.GetResidencyVersion())
+    {
+        streamResidencyVersion_ = g_AssetStreamer.GetResidencyVersion();
+        prep_.InvalidateRenderList();
+    }
+
+
     // after this distance all the objects are completely fogged
     if (pRender_->IsFogEnabled())
         distFogged = pRender_->GetDistFogged();
@@ -350,24 +432,55 @@ void CGraphics::Update(const float deltaTime, const float gameTime)
         distFogged = FLT_MAX;
 
 
-    // update LOD and visibility for each terrain's patch
-    g_ModelMgr.GetTerrain().Update(camParams, worldFrustum, distFogged);
+    //
+    // these stages are independent from each other so run them as jobs:
+    // terrain LODs, grass visibility, preparation of instances data and skinning
+    // (GPU buffers are updated later on the main thread)
+    //
+    UpdateJobsArgs jobsArgs;
+    jobsArgs.camParams     = camParams;
+    jobsArgs.pWorldFrustum = &worldFrustum;
+    jobsArgs.distFogged    = distFogged;
+    jobsArgs.camPos        = { camParams.posX, camParams.posY, camParams.posZ };
+    jobsArgs.viewPos       = pSysState_->cameraPos;
+    jobsArgs.pPreparator   = &prep_;
+    jobsArgs.pEnttMgr      = pEnttMgr_;
+    jobsArgs.pStorage      = &pRender_->dataStorage_;
+    jobsArgs.pSkinPalettes = &skinPalettes_;
+
+    const Job jobs[] =
+    {
+        { UpdateTerrainJob,          &jobsArgs },
+        { CalcVisibleGrassJob,       &jobsArgs },
+        { PrepareRenderInstancesJob, &jobsArgs },
+        { UpdateSkinningJob,         &jobsArgs },
+    };
 
-    // update visibility of grass patches
-    Vec3 camPos = { camParams.posX, camParams.posY, camParams.posZ };
-    g_GrassMgr.Update(camPos, &worldFrustum);
+    JobCounter jobsCounter;
+    g_JobSystem.Run(jobs, _countof(jobs), &jobsCounter);
 
 
-    // update clouds positions
+    // meanwhile on the main thread: update clouds positions and particles VB
     skyPlane.Update(deltaTime);
+    UpdateParticlesVB();
+
+    g_JobSystem.Wait(&jobsCounter);
+
+    pSysState_->numReusedRenderItems  = prep_.GetNumReusedItems();
+    pSysState_->numRebuiltRenderItems = prep_.GetNumRebuiltItems();
+
+    const GrassStreamingStats& grassStats = g_GrassMgr.GetStats();
+    pSysState_->numDrawnGrassInstances = grassStats.numRenderedInst;
+    pSysState_->grassResidentMemKB     = (uint32)(grassStats.memResident >> 10);
 
+    // debug shapes use results of terrain update
     if (g_DebugDrawMgr.IsRenderable())
         AddDebugShapesToRender();
 
-    UpdateParticlesVB();
+    g_GrassMgr.UpdateGrassInstancedBuf();
 
-    // prepare data for each entity
-    PrepareRenderInstances(pSysState_->cameraPos);
+    // push prepared data of each entity into the instances buffer
+    UpdateInstancesBuf();
 
     // Update shaders common data for this frame
     UpdateShadersDataPerFrame(deltaTime, gameTime);
@@ -632,6 +745,9 @@ void CGraphics::Push2dSpritesToRender(void)
 void CGraphics::UpdateParticlesVB()
 {
     ECS::ParticleSystem& particleSys = pEnttMgr_->particleSys_;
+
+    // particles of visible emitters are written into render instances once per frame
+    particleSys.PrepareParticlesToRender();
     const ECS::ParticlesRenderData& particlesData = particleSys.GetParticlesToRender();
 
     // prepare updated particles data for rendering
@@ -653,22 +769,16 @@ void CGraphics::UpdateParticlesVB()
 }
 
 // --------------------------------------------------------
-// Desc:   prepare rendering data of entts which have default render states
+// Desc:   update instances buffer with rendering data of entts which have
+//         default render states (the data is prepared by PrepareRenderInstancesJob)
 // --------------------------------------------------------
-void CGraphics::PrepareRenderInstances(const DirectX::XMFLOAT3& cameraPos)
+void CGraphics::UpdateInstancesBuf()
 {
-    cvector<EntityID>& visibleEntts = pEnttMgr_->renderSys_.GetAllVisibleEntts();
+    const cvector<EntityID>& visibleEntts = pEnttMgr_->renderSys_.GetAllVisibleEntts();
 
     if (visibleEntts.size() == 0)
         return;
 
-    // gather entts data for rendering
-    prep_.PrepareEnttsDataForRendering(
-        visibleEntts,
-        cameraPos,
-        pEnttMgr_,
-        pRender_->dataStorage_);
-
     pRender_->UpdateInstancedBuffer(pRender_->dataStorage_.instancesBuf);
 }
 
@@ -735,8 +845,6 @@ void CGraphics::FrustumCullingEntts(const Frustum& worldFrustum)
     const cvector<EntityID>& rendEntts = renderSys.GetAllEnttsIDs();
     cvector<EntityID>&       visEntts  = renderSys.GetAllVisibleEntts();
 
-    size numVisEntts = 0;                                        // the number of currently visible entts
-
     if (rendEntts.size() == 0)
         return;
 
@@ -749,17 +857,19 @@ void CGraphics::FrustumCullingEntts(const Frustum& worldFrustum)
         rendEntts.size(),
         tmpData.boundSpheres);
 
-    // go through each entity and define if it is visible
     for (index idx = 0; idx < rendEntts.size(); ++idx)
     {
-        tmpData.idxsToVisEntts[numVisEntts] = idx;
-
         const XMFLOAT3& c = tmpData.boundSpheres[idx].Center;
-        const float     r = tmpData.boundSpheres[idx].Radius;
-
-        numVisEntts += worldFrustum.TestSphere(Sphere(c.x, c.y, c.z, r));
+        tmpData.spheres.Set(idx, c.x, c.y, c.z, tmpData.boundSpheres[idx].Radius);
     }
 
+    // define which entities are visible (the number of currently visible entts)
+    const int numVisEntts = CullSpheres(
+        worldFrustum,
+        tmpData.spheres,
+        (int)rendEntts.size(),
+        tmpData.idxsToVisEntts.data());
+
     // store ids of visible entts
     visEntts.resize(numVisEntts);
 
@@ -779,13 +889,27 @@ void CGraphics::FrustumCullingParticles(const Frustum& worldFrustum)
     cvector<EntityID>&       visEmitters = particleSys.visEmitters_;
     const cvector<EntityID>& allEmitters = particleSys.GetAllEmitters();
 
+    const int                numEmitters = (int)allEmitters.size();
+    AABBsSoA&                boxes       = s_tmpFrustumCullData.boxes;
+    cvector<int>&            visIdxs     = s_tmpFrustumCullData.idxsToVisEntts;
+
     visEmitters.clear();
 
-    for (index i = 0; i < allEmitters.size(); ++i)
-    {
-        if (worldFrustum.TestRect(particleSys.GetEmitterWorldAABB(allEmitters[i])))
-            visEmitters.push_back(allEmitters[i]);
-    }
+    if (numEmitters == 0)
+        return;
+
+    boxes.Resize(numEmitters);
+    visIdxs.resize(numEmitters);
+
+    for (index i = 0; i < numEmitters; ++i)
+        boxes.Set(i, particleSys.GetEmitterWorldAABB(allEmitters[i]));
+
+    const int numVisEmitters = CullAABBs(worldFrustum, boxes, numEmitters, visIdxs.data());
+
+    visEmitters.resize(numVisEmitters);
+
+    for (index i = 0; i < numVisEmitters; ++i)
+        visEmitters[i] = allEmitters[visIdxs[i]];
 }
 
 //---------------------------------------------------------
@@ -802,29 +926,31 @@ void CGraphics::FrustumCullingPointLights(const Frustum& worldFrustum)
 
     cvector<EntityID>&          visPointLights    = renderSys.GetVisiblePointLights();
     cvector<DirectX::XMFLOAT3>& positions         = s_tmpFrustumCullData.positions;
-    size                        numVisiblePointL  = 0;
+    SpheresSoA&                 spheres           = s_tmpFrustumCullData.spheres;
+    cvector<int>&               visIdxs           = s_tmpFrustumCullData.idxsToVisEntts;
 
     pEnttMgr_->transformSys_.GetPositions(
         pointLights.ids.data(),
         pointLights.ids.size(),
         positions);
 
-    // define if we see point light if so we store its id
-    visPointLights.resize(numAllPointLights);
+    spheres.Resize(numAllPointLights);
+    visIdxs.resize(numAllPointLights);
 
     for (index i = 0; i < numAllPointLights; ++i)
-    {
-        const Sphere sphere(
-            positions[i].x,
-            positions[i].y,
-            positions[i].z,
-            pointLights.data[i].range);
-
-        if (worldFrustum.TestSphere(sphere))
-            visPointLights[numVisiblePointL++] = pointLights.ids[i];
-    }
+        spheres.Set(i, positions[i].x, positions[i].y, positions[i].z, pointLights.data[i].range);
+
+    // define if we see point light if so we store its id
+    const int numVisiblePointL = CullSpheres(
+        worldFrustum,
+        spheres,
+        (int)numAllPointLights,
+        visIdxs.data());
 
     visPointLights.resize(numVisiblePointL);
+
+    for (index i = 0; i < numVisiblePointL; ++i)
+        visPointLights[i] = pointLights.ids[visIdxs[i]];
 }
 
 //---------------------------------------------------------
@@ -1569,6 +1695,11 @@ void CGraphics::RenderSkinnedModel(const EntityID enttId)
     // prepare model's instance
     const ModelID      modelId = enttMgr.modelSys_.GetModelIdRelatedToEntt(enttId);
     const Model&         model = g_ModelMgr.GetModelById(modelId);
+
+    // geometry isn't streamed in yet
+    if (!model.IsGeometryLoaded())
+        return;
+
     const MeshGeometry& meshes = model.GetMeshes();
 
     const XMVECTOR quatRotZ = QuatRotAxis({ 0,0,1 }, +PIDIV2/2);
@@ -1579,22 +1710,20 @@ void CGraphics::RenderSkinnedModel(const EntityID enttId)
 
     //---------------------------------
 
-    // get animation data for current entity
-    SkeletonID skeletonId = 0;
-    AnimationID animationId = 0;
-    float timePos = 0;
-    pEnttMgr_->animationSys_.GetData(enttId, skeletonId, animationId, timePos);
+    // get bone transformations for this frame (are sampled during the update)
+    int numBones = 0;
+    const XMMATRIX* boneTransforms = skinPalettes_.GetPalette(enttMgr.animationSys_, enttId, numBones);
 
-    // update bone transformations for this frame
-    s_BoneTransforms.resize(MAX_NUM_BONES_PER_CHARACTER, DirectX::XMMatrixIdentity());
-    AnimSkeleton& skeleton = g_AnimationMgr.GetSkeleton(skeletonId);
+    if (!boneTransforms)
+        return;
 
-    skeleton.GetFinalTransforms(animationId, timePos, s_BoneTransforms);
+    const SkeletonID    skeletonId = enttMgr.animationSys_.GetSkeletonId(enttId);
+    const AnimSkeleton& skeleton   = g_AnimationMgr.GetSkeleton(skeletonId);
 
     //---------------------------------
 
     // update constant buffers
-    pRender->UpdateCbBoneTransforms(s_BoneTransforms);
+    pRender->UpdateCbBoneTransforms(boneTransforms, numBones);
     pRender->UpdateCbWorldInvTranspose(MathHelper::InverseTranspose(W));
     pRender->UpdateCbWorldAndViewProj(W, DirectX::XMMatrixTranspose(viewProj_));
 
@@ -2356,10 +2485,29 @@ float CGraphics::GetModelPreviewParam(const uint8 param) const
 //                               COLLISIONS
 //==================================================================================
 
+//---------------------------------------------------------
+// args for the narrow phase test of quad tree ray casting
+//---------------------------------------------------------
+struct RayCastEnttArgs
+{
+    const CGraphics*  pGraphics = nullptr;
+    ECS::EntityMgr*   pEnttMgr  = nullptr;
+    EntityID          playerId  = INVALID_ENTT_ID;
+    XMVECTOR          rayOrigW;
+    XMVECTOR          rayDirW;
+
+    // data of the nearest intersection
+    IntersectionData* pData     = nullptr;
+    XMVECTOR          rayOrigL;
+    XMVECTOR          rayDirL;
+    float             distL     = 0;
+};
+
 //---------------------------------------------------------
 // Desc:  calculate intersection between a ray and some entity or terrain;
 //        the ray goes from camera pos to coordinate calculated
 //        by input screen sx, sy pixel coordinate;
+//        entities are searched along the ray using the quad tree
 //
 // Out:   - outData:  output container for calculated intersection data
 //---------------------------------------------------------
@@ -2371,33 +2519,89 @@ bool CGraphics::TestRayIntersectEntts(
     using namespace DirectX;
 
     ECS::EntityMgr& enttMgr   = *pEnttMgr_;
-    const EntityID  playerId  = enttMgr.nameSys_.GetIdByName("player");
-
-    // ...and in local space
-    XMVECTOR rayOrigL = {0,0,0};
-    XMVECTOR rayDirL  = {0,0,1};
+    QuadTree&       quadTree  = enttMgr.GetQuadTree();
+
+    RayCastEnttArgs args;
+    args.pGraphics = this;
+    args.pEnttMgr  = pEnttMgr_;
+    args.playerId  = enttMgr.nameSys_.GetIdByName("player");
+    args.rayOrigW  = rayOrigW;
+    args.rayDirW   = XMVector3Normalize(rayDirW);
+    args.pData     = &outData;
+    args.rayOrigL  = { 0,0,0 };
+    args.rayDirL   = { 0,0,1 };
 
     // the distance along the ray where the intersection occurs
-    float tmin = FLT_MAX;  
+    float tmin = FLT_MAX;
 
-
-    // go through each visible entt and check if we have an intersection with it
-    for (const EntityID enttId : enttMgr.renderSys_.GetAllVisibleEntts())
+    if (quadTree.IsReady())
     {
-        if (enttId == playerId)
-            continue;
+        // walk through the quad tree along the ray (so entities
+        // out of the camera view are tested as well)
+        quadTree.RayCast(
+            ToVec3(args.rayOrigW),
+            ToVec3(args.rayDirW),
+            FLT_MAX,
+            tmin,
+            RayCastEnttTest,
+            &args);
+    }
+    else
+    {
+        // go through each visible entt and check if we have an intersection with it
+        for (const EntityID enttId : enttMgr.renderSys_.GetAllVisibleEntts())
+        {
+            if (enttId == args.playerId)
+                continue;
 
-        RayEnttTest(enttId, rayOrigW, rayDirW, tmin, outData, rayOrigL, rayDirL);
+            RayEnttTest(enttId, args.rayOrigW, args.rayDirW, tmin, outData, args.rayOrigL, args.rayDirL, args.distL);
+        }
     }
 
     // if we didn't intersect any entity...
     if (outData.enttId == 0)
         return false;
 
-    GatherIntersectionData(rayOrigL, rayDirL, rayOrigW, rayDirW, tmin, outData);
+    GatherIntersectionData(args.rayOrigL, args.rayDirL, rayOrigW, rayDirW, args.distL, outData);
     return true;
 }
 
+//---------------------------------------------------------
+// Desc:  narrow phase test for quad tree ray casting:
+//        test ray against triangles of entity's model
+//---------------------------------------------------------
+bool CGraphics::RayCastEnttTest(
+    void* pArgs,
+    const SceneObject* pObj,
+    const Vec3& rayOrig,
+    const Vec3& rayDir,
+    float& inOutDist)
+{
+    assert(pArgs);
+    assert(pObj);
+
+    RayCastEnttArgs& args  = *(RayCastEnttArgs*)pArgs;
+    const EntityID   id    = pObj->GetId();
+    const u32Flags   flags = args.pEnttMgr->GetAddedComponentsByEntt(id);
+
+    // lights, particle emitters, etc. are also members of the quad tree
+    if (!flags.TestBit(ECS::ModelComponent) || !flags.TestBit(ECS::RenderedComponent))
+        return false;
+
+    if (id == args.playerId)
+        return false;
+
+    return args.pGraphics->RayEnttTest(
+        id,
+        args.rayOrigW,
+        args.rayDirW,
+        inOutDist,
+        *args.pData,
+        args.rayOrigL,
+        args.rayDirL,
+        args.distL);
+}
+
 //---------------------------------------------------------
 // Desc:  calculate a normal vector by 3 input positions
 //---------------------------------------------------------
@@ -2417,44 +2621,64 @@ Vec3 CalcNormalVec(const XMFLOAT3& p0, const XMFLOAT3& p1, const XMFLOAT3& p2)
 
 //---------------------------------------------------------
 // Desc:  ray/entity test (test ray agains each mesh of entity's model)
-//---------------------------------------------------------
-void CGraphics::RayEnttTest(
+// Args:  - rayOrigW, rayDirW:  the ray in world space (direction is normalized)
+//        - tmin:               the distance (in world space) to the nearest
+//                              intersection which is already found
+// Out:   - outRayOrigL,
+//          outRayDirL:         the ray in model's local space
+//        - outDistL:           the distance to intersection in local space
+// Ret:   true if there is an intersection closer than input tmin
+//---------------------------------------------------------
+bool CGraphics::RayEnttTest(
     const EntityID enttId,
     const XMVECTOR& rayOrigW,
     const XMVECTOR& rayDirW,
     float& tmin,
     IntersectionData& outData,
     XMVECTOR& outRayOrigL,
-    XMVECTOR& outRayDirL) const
+    XMVECTOR& outRayDirL,
+    float& outDistL) const
 {
     const ModelID modelId = pEnttMgr_->modelSys_.GetModelIdRelatedToEntt(enttId);
     const Model&    model = g_ModelMgr.GetModelById(modelId);
 
-    // transform ray to model's local space
+    // transform ray to model's local space; since the world matrix can
+    // have scaling we need a ratio between local and world distances
     const XMMATRIX& invWorld = pEnttMgr_->transformSys_.GetInvWorld(enttId);
     const XMVECTOR  rayOrigL = XMVector3Transform(rayOrigW, invWorld);
-    const XMVECTOR  rayDirL  = XMVector3Normalize(XMVector3TransformNormal(rayDirW, invWorld));
+    const XMVECTOR  dirL     = XMVector3TransformNormal(rayDirW, invWorld);
+    const float     scale    = XMVectorGetX(XMVector3Length(dirL));
+    const XMVECTOR  rayDirL  = dirL / scale;
 
     // the length of the ray from origin to the intersection point with the AABB
     float dist = 0;
 
     // ray/AABB test
     if (!model.GetModelAABB().Intersects(rayOrigL, rayDirL, dist))
-        return;
+        return false;
 
     // ray/model test (test ray agains each mesh of the model)
-    if (!RayModelTest(&model, rayOrigL, rayDirL, tmin, outData.triangleIdx))
-        return;
+    float tminL = (tmin < FLT_MAX) ? tmin * scale : FLT_MAX;
+
+    if (!RayModelTest(&model, rayOrigL, rayDirL, tminL, outData.triangleIdx))
+        return false;
+
+    tmin = tminL / scale;
 
     outData.enttId = enttId;
     outData.modelId = modelId;
 
     outRayOrigL = rayOrigL;
     outRayDirL = rayDirL;
+    outDistL = tminL;
+
+    return true;
 }
  
 //---------------------------------------------------------
-// Desc:  execute ray/model test
+// Desc:  execute ray/model test: find the nearest intersected triangle
+//        which is closer than input tmin (the model's BVH is used if it is built,
+//        otherwise we test each triangle)
 //---------------------------------------------------------
 bool CGraphics::RayModelTest(
     const Model* pModel,
@@ -2469,6 +2693,20 @@ bool CGraphics::RayModelTest(
     const UINT*     indices  = pModel->GetIndices();
     bool           intersect = false;
 
+    const ModelBVH& bvh = pModel->GetBVH();
+
+    if (bvh.IsBuilt())
+    {
+        return bvh.Intersect(
+            &vertices[0].pos,
+            sizeof(Vertex3D),
+            indices,
+            rayOrigin,
+            rayDir,
+            tmin,
+            intersectedTriangleIdx);
+    }
+
     // ray/triangle tests
     for (int i = 0; i < pModel->GetNumIndices() / 3; ++i)
     {
@@ -2684,35 +2922,15 @@ int CGraphics::TestEnttSelection(const int sx, const int sy)
         if (!model.GetModelAABB().Intersects(rayOrigin, rayDir, dist))
             continue;
 
-        const Vertex3D* verts = model.GetVertices();
-        const UINT*   indices = model.GetIndices();
-
         // execute ray/triangle tests
-        for (int i = 0; i < model.GetNumIndices() / 3; ++i)
-        {
-            // indices for this triangle
-            const UINT i0 = indices[i*3 + 0];
-            const UINT i1 = indices[i*3 + 1];
-            const UINT i2 = indices[i*3 + 2];
+        uint triangleIdx = 0;
 
-            // vertices for this triangle
-            const XMVECTOR v0 = XMLoadFloat3(&verts[i0].pos);
-            const XMVECTOR v1 = XMLoadFloat3(&verts[i1].pos);
-            const XMVECTOR v2 = XMLoadFloat3(&verts[i2].pos);
-
-            float t = 0.0f;
-
-            if (!DirectX::TriangleTests::Intersects(rayOrigin, rayDir, v0, v1, v2, t))
-                continue;
-
-            if (t > tmin)
-                continue;
+        if (!RayModelTest(&model, rayOrigin, rayDir, tmin, triangleIdx))
+            continue;
 
-            // this is the new nearest picked entt and its triangle
-            tmin = t;
-            selectedTriangleIdx = i;
-            selectedEnttId = enttId;
-        }
+        // this is the new nearest picked entt and its triangle
+        selectedTriangleIdx = (int)triangleIdx;
+        selectedEnttId = enttId;
     }
 
     // print a msg about selection of the entity
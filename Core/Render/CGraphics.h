@@ -22,6 +22,7 @@
 
 #include "r_data_preparator.h"
 #include "frame_buffer.h"               // for rendering to some particular texture
+#include "../Model/skinning_palettes.h"  // bones transformations of animated entities
 
 // ECS
 #include "Entity/EntityMgr.h"
@@ -191,6 +192,9 @@ public:
     void LockFrustumCulling(const bool onOff);
     bool IsLockedFrustumCulling(void) const;
 
+    // rebuild the retained render list (after changing of materials/models of entities)
+    void InvalidateRenderList(void);
+
 
     //---------------------------------
     // material binding
@@ -280,7 +284,7 @@ private:
     void UpdateParticlesVB        (void);
     void UpdateShadersDataPerFrame(const float dt, const float gameTime);
     void AddFrustumToRender       (const EntityID camId);
-    void PrepareRenderInstances   (const DirectX::XMFLOAT3& cameraPos);
+    void UpdateInstancesBuf       (void);
     void SetupLightsForFrame      (Render::PerFrameData& perFrameData);
 
     void ResetRenderStats       (void);
@@ -333,14 +337,22 @@ private:
     //---------------------------------
     // collision helpers:  ray/entities tests
     //---------------------------------
-    void RayEnttTest(
+    bool RayEnttTest(
         const EntityID enttId,
         const DirectX::XMVECTOR& rayOrigW,
         const DirectX::XMVECTOR& rayDirW,
         float& tmin,
         IntersectionData& outData,
         DirectX::XMVECTOR& outRayOrigL,
-        DirectX::XMVECTOR& outRayDirL) const;
+        DirectX::XMVECTOR& outRayDirL,
+        float& outDistL) const;
+
+    static bool RayCastEnttTest(
+        void* pArgs,
+        const SceneObject* pObj,
+        const Vec3& rayOrig,
+        const Vec3& rayDir,
+        float& inOutDist);
 
     bool RayModelTest(
         const Model* pModel,
@@ -370,6 +382,8 @@ public:
     SystemState*            pSysState_      = nullptr;                                
 
     RenderDataPreparator    prep_;
+    uint32                  streamResidencyVersion_ = 0;          // to rebuild the render list when streamed assets are loaded/unloaded
+    SkinningPalettes        skinPalettes_;                        // sampled poses of animated entities for the current frame
     FrameBuffer             frameBuffer_;                         // for rendering to some texture
     EntityID                currCameraId_   = 0;
     
@@ -474,4 +488,9 @@ inline bool CGraphics::IsLockedFrustumCulling(void) const
     return bLockFrustumCull_;
 }
 
+inline void CGraphics::InvalidateRenderList(void)
+{
+    prep_.InvalidateRenderList();
+}
+
 } // namespace Core
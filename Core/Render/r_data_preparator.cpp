@@ -9,6 +9,9 @@
 #include "../Mesh/material_mgr.h"
 #include "../Texture/texture_mgr.h"
 #include <Render/CRender.h>
+#include <scratch_arena.h>
+#include <radix_sort.h>
+#include <algorithm>
 
 #define PRINT_DBG_DATA 0
 
@@ -19,79 +22,94 @@ namespace Core
 {
 
 //---------------------------------------------------------
-
-struct EntityDataAndPos
+// render key layout (from high bits to low):
+//
+//   masked/opaque:   | group: 2 | shader: 12 | material: 16 | model: 16 | subset: 8 | depth: 10 |
+//   blended:         | group: 2 | depth: 24 (inverted)      | material: 16 | model: 16 | subset: 6 |
+//
+// so a single sort of keys splits items by geometry groups (in rendering order),
+// sorts opaque items by states (to get less batches) and front-to-back inside
+// each batch, and sorts blended items back-to-front;
+// NOTE: ids are truncated to the field size so different ids may have the same
+//       field, it can only split a batch but doesn't break rendering since batches
+//       are built by comparison of full ids
+//---------------------------------------------------------
+enum RenderGroupType : uint64
 {
-    EntityDataAndPos() {}
-
-    EntityDataAndPos(
-        const EntityID inEnttId,
-        const MaterialID inMatId,
-        const ModelID inModelId,
-        const SubmeshID inSubsetId)
-        :
-        enttId(inEnttId),
-        matId(inMatId),
-        modelId(inModelId),
-        subsetId(inSubsetId) {}
-
-
-    EntityID   enttId = INVALID_ENTT_ID;
-    MaterialID matId = INVALID_MAT_ID;
-    ModelID    modelId = INVALID_MODEL_ID;
-    SubmeshID  subsetId = 0;
-    float      sqrDistToCamera = 0;
+    RENDER_GROUP_MASKED,
+    RENDER_GROUP_OPAQUE,
+    RENDER_GROUP_BLENDED,
+    RENDER_GROUP_BLENDED_TRANSPARENT,
 };
 
+constexpr int NUM_RENDER_GROUPS      = 4;
+constexpr int RENDER_KEY_GROUP_SHIFT = 62;
+
 //---------------------------------------------------------
 
 // static pointer to ECS entity manager (for internal purposes)
 ECS::EntityMgr* s_pEnttMgr = nullptr;
 
 
-// static arrays for internal purposes
-static cvector<ECS::MaterialData> s_MaterialsDataPerEntt;
-static cvector<DirectX::XMMATRIX> s_Worlds;
-static cvector<ModelID>           s_ModelsIds;      
-static cvector<bool>              s_IsLod;          // flags to define if model by responsible index is some kind of lod or it is an original model
-
-static cvector<EntityModelMesh>   s_Data;
-static cvector<EntityModelMesh>   s_MaskedGroup;
-static cvector<EntityModelMesh>   s_OpaqueGroup;
-static cvector<EntityModelMesh>   s_BlendGroup;
-static cvector<EntityModelMesh>   s_BlendTransparentGroup;
-
-// for sorting by distance
-static cvector<EntityID>          s_TempEnttsIds;
-static cvector<EntityDataAndPos>  s_TempData;
-static cvector<XMFLOAT3>          s_Positions;
-
-static cvector<EntityID>          s_VisEntts;
-static cvector<EntityID>          s_EnttsIdPerInstance;
-
-static cvector<float>             s_SqrDistances;   // array of squared distanced from camera to entity
-
-
 //----------------------------------------------------------------------------------
 // forward declaration of private helpers
 //----------------------------------------------------------------------------------
 
-void LodsStuff(const XMFLOAT3& camPos, cvector<EntityID>& enttsIds, cvector<ModelID>& modelsIds);
-
-vsize PrepareCommonIds(const EntityID* enttsIds, const vsize numEntts);
+void LodsStuff(
+    const XMFLOAT3& camPos,
+    cvector<EntityID>& enttsIds,
+    cvector<ModelID>& modelsIds,
+    cvector<bool>& outIsLod,
+    cvector<float>& outSqrDists);
 
-void SortEnttsByMaterials (cvector<EntityModelMesh>& data);
-void GroupEnttsByGeomTypes(const vsize numRenderItems);
-void SortByDistance       (const XMFLOAT3& camPos, cvector<EntityModelMesh>& data);
+vsize PrepareCommonIds(
+    const EntityID* enttsIds,
+    const vsize numEntts,
+    const cvector<ModelID>& modelsIds,
+    const cvector<bool>& isLod,
+    const cvector<float>& sqrDists,
+    cvector<EntityModelMesh>& outData,
+    cvector<float>& outSqrDists);
+
+void BuildRenderKeys(
+    const EntityModelMesh* items,
+    const float* sqrDists,
+    const int numItems,
+    uint64* outKeys);
+
+void SortRenderItems(
+    EntityModelMesh* items,
+    uint64* keys,
+    const int numItems);
 
 void PrepareMaterials(
     int& instanceMatIdx,
-    const cvector<EntityModelMesh>& renderGroup,
+    const EntityModelMesh* renderGroup,
+    const int numItems,
     Render::InstancesBuf& instancesBuf,
     cvector<Render::InstanceBatch>& instanceBatches);
 
 void PrepareBuffers(cvector<Render::InstanceBatch>& instanceBatches);
 
+//---------------------------------------------------------
+// Desc:  helpers for render keys and entries of the render list
+//---------------------------------------------------------
+inline int GetRenderGroup(const uint64 key)
+{
+    return (int)(key >> RENDER_KEY_GROUP_SHIFT);
+}
+
+inline uint64 MakeRenderEntry(const EntityID enttId, const ModelID modelId)
+{
+    return ((uint64)enttId << 32) | modelId;
+}
+
+inline void SetFirstChangedGroup(int& firstChangedGroup, const int group)
+{
+    if (group < firstChangedGroup)
+        firstChangedGroup = group;
+}
+
 
 //----------------------------------------------------------------------------------
 // Desc:   prepare instances data and instances buffer for rendering
@@ -111,98 +129,375 @@ void RenderDataPreparator::PrepareEnttsDataForRendering(
     assert(pEnttMgr);
     s_pEnttMgr = pEnttMgr;
 
+    numReusedItems_  = 0;
+    numRebuiltItems_ = 0;
+
     //------------------------------------------------
 
-    // clear the render data storage before filling it with data
-    storage.Clear();
+    // scratch arrays of the calling thread
+    ScratchVec<EntityID>        visEntts;
+    ScratchVec<ModelID>         modelsIds;
+    ScratchVec<bool>            isLod;          // flags to define if model by responsible index is some kind of lod or it is an original model
+    ScratchVec<float>           enttsSqrDists;  // squared distances from camera to entities
 
-    s_VisEntts.reserve(visibleEntts.size());
-    s_VisEntts.clear();
+    visEntts.resize(visibleEntts.size());
 
 
     // separate visible entities with animation component from others
     // since we will render such entities in a separate way
-    const cvector<EntityID>& animatedEntts = pEnttMgr->animationSys_.GetEnttsIds();
+    // (NOTE: IDs of the animation component aren't sorted so check by sparse set)
+    const ECS::AnimationSystem& animSys = pEnttMgr->animationSys_;
 
     size numNotAnimEntts = 0;
 
     for (const EntityID enttId : visibleEntts)
     {
-        s_VisEntts[numNotAnimEntts] = enttId;
-        numNotAnimEntts += (!animatedEntts.binary_search(enttId));
+        visEntts[numNotAnimEntts] = enttId;
+        numNotAnimEntts += (!animSys.HasAnimation(enttId));
     }
-    s_VisEntts.resize(numNotAnimEntts);
+    visEntts.resize(numNotAnimEntts);
 
     // if we have no non-animated visible entities
-    if (s_VisEntts.empty())
+    if (visEntts.empty())
+    {
+        storage.Clear();
+        ResetRenderList();
         return;
+    }
 
     //------------------------------------------------
 
     pEnttMgr->modelSys_.GetModelsIdsPerEntts(
-        s_VisEntts.data(),
-        s_VisEntts.size(),
-        s_ModelsIds);
+        visEntts.data(),
+        visEntts.size(),
+        modelsIds);
 
     // change lod of model if necessary
-    LodsStuff(cameraPos, s_VisEntts, s_ModelsIds);
+    LodsStuff(cameraPos, visEntts, modelsIds, isLod, enttsSqrDists);
+
+    // while geometry of a streamed model isn't loaded we render the default
+    // model instead (like a LOD: only its single subset with its own material)
+    for (index i = 0; i < modelsIds.size(); ++i)
+    {
+        if (!g_ModelMgr.GetModelById(modelsIds[i]).IsGeometryLoaded())
+        {
+            modelsIds[i] = INVALID_MODEL_ID;
+            isLod[i]     = true;
+        }
+    }
+
+    // the first render group which batches must be rebuilt
+    int firstChangedGroup = NUM_RENDER_GROUPS;
+
+    // in immediate mode (or after invalidation) we rebuild the whole list
+    if (!retainedMode_ || !isListValid_)
+    {
+        ResetRenderList();
+        firstChangedGroup = 0;
+    }
+
+    // insert new render items and remove ones which aren't visible anymore;
+    // items are kept sorted by render keys: so they are grouped by geometry type
+    // (masked, opaque, blended, etc.) and sorted by states (later we will
+    // split them into batches by materials)
+    UpdateRenderList(visEntts, modelsIds, isLod, enttsSqrDists, firstChangedGroup);
+
+    // blended items are sorted by distance from the camera each frame
+    UpdateBlendedItems(cameraPos, firstChangedGroup);
+
+    isListValid_ = true;
+
+    //------------------------------------------------
 
+    const int numRenderItems = (int)items_.size();
 
-    const vsize numRenderItems = PrepareCommonIds(s_VisEntts.data(), s_VisEntts.size());
-    storage.instancesBuf.Resize((int)numRenderItems);
+    // find a range of render items for each geometry group
+    int groupsStarts[NUM_RENDER_GROUPS + 1] = { 0 };
+
+    for (const uint64 key : keys_)
+        groupsStarts[GetRenderGroup(key) + 1]++;
+
+    for (int i = 1; i <= NUM_RENDER_GROUPS; ++i)
+        groupsStarts[i] += groupsStarts[i-1];
+
+    // if the instances buffer was reallocated we lost materials of all the groups
+    const Render::MaterialColors* pPrevMaterials = storage.instancesBuf.materials_;
+
+    storage.instancesBuf.Resize(numRenderItems);
+
+    if (storage.instancesBuf.materials_ != pPrevMaterials)
+        firstChangedGroup = 0;
 
     //------------------------------------------------
 
-    // sort entities by materials (later we will split them into batches by materials)
-    SortEnttsByMaterials(s_Data);
+    // batches of groups before the first changed one are reused as is;
+    // for others we prepare materials for the instances buffer and each
+    // instances batch, and vertex/index buffers data for each instance batch
+    cvector<Render::InstanceBatch>* groupsBatches[NUM_RENDER_GROUPS] =
+    {
+        &storage.masked,
+        &storage.opaque,
+        &storage.blended,
+        &storage.blendedTransparent,
+    };
+
+    for (int group = firstChangedGroup; group < NUM_RENDER_GROUPS; ++group)
+    {
+        const int start          = groupsStarts[group];
+        const int numItems       = groupsStarts[group + 1] - start;
+        int       instanceMatIdx = start;
+
+        groupsBatches[group]->clear();
+
+        PrepareMaterials(instanceMatIdx, items_.data() + start, numItems, storage.instancesBuf, *groupsBatches[group]);
+        PrepareBuffers(*groupsBatches[group]);
+    }
 
     //------------------------------------------------
 
-    // group entities by geometry type (masked, opaque, blended, etc.)
-    GroupEnttsByGeomTypes(numRenderItems);
-    
-    // sort both blending groups elements by distance from the camera
-    SortByDistance(cameraPos, s_BlendGroup);
-    SortByDistance(cameraPos, s_BlendTransparentGroup);
+    // prepare world matrix for each instance
+    PrepareInstancesWorldMatrices(storage);
+}
+
+//---------------------------------------------------------
+// Desc:  turn on/off the retained mode of the render list
+//---------------------------------------------------------
+void RenderDataPreparator::SetRetainedMode(const bool onOff)
+{
+    retainedMode_ = onOff;
+    isListValid_  = false;
+}
+
+//---------------------------------------------------------
+// Desc:  clear the render list so all the visible items will be rebuilt
+//---------------------------------------------------------
+void RenderDataPreparator::ResetRenderList()
+{
+    entries_.clear();
+    items_.clear();
+    keys_.clear();
+    isListValid_ = false;
+}
+
+//---------------------------------------------------------
+// Desc:   compare visible pairs [entity, model] with ones of the previous frame:
+//         remove items of pairs which aren't visible anymore and insert items
+//         for new pairs (only new pairs are processed: materials, keys, sorting)
+//
+// Args:   - enttsIds, modelsIds:   visible pairs of this frame (after LODs switching)
+//         - isLod:                 is model of pair a LOD
+//         - sqrDists:              squared distance from camera to entity of pair
+//         - outFirstChangedGroup:  the first render group which was changed
+//---------------------------------------------------------
+void RenderDataPreparator::UpdateRenderList(
+    const cvector<EntityID>& enttsIds,
+    const cvector<ModelID>& modelsIds,
+    const cvector<bool>& isLod,
+    const cvector<float>& sqrDists,
+    int& outFirstChangedGroup)
+{
+    const int numEntries = (int)enttsIds.size();
+    const int numPrev    = (int)entries_.size();
+
+    ScratchVec<uint64> entries;
+    ScratchVec<uint32> entriesIdxs;
+    ScratchVec<uint64> tmpEntries;
+    ScratchVec<uint32> tmpIdxs;
+
+    entries.resize(numEntries);
+    entriesIdxs.resize(numEntries);
+    tmpEntries.resize(numEntries);
+    tmpIdxs.resize(numEntries);
+
+    for (int i = 0; i < numEntries; ++i)
+    {
+        entries[i]     = MakeRenderEntry(enttsIds[i], modelsIds[i]);
+        entriesIdxs[i] = (uint32)i;
+    }
+
+    // entries are almost sorted (by entity) so most of passes are skipped
+    RadixSort64(entries.data(), entriesIdxs.data(), tmpEntries.data(), tmpIdxs.data(), numEntries);
 
     //------------------------------------------------
 
-    // prepare materials for the instances buffer and each instances batch
-    int instanceMatIdx = 0;
-    PrepareMaterials(instanceMatIdx, s_MaskedGroup,           storage.instancesBuf, storage.masked);
-    PrepareMaterials(instanceMatIdx, s_OpaqueGroup,           storage.instancesBuf, storage.opaque);
-    PrepareMaterials(instanceMatIdx, s_BlendGroup,            storage.instancesBuf, storage.blended);
-    PrepareMaterials(instanceMatIdx, s_BlendTransparentGroup, storage.instancesBuf, storage.blendedTransparent);
+    // define which entries were added/removed since the previous frame
+    ScratchVec<uint32> addedIdxs;
+    ScratchVec<uint64> removedEntries;
+    int i = 0;
+    int j = 0;
+
+    while (i < numEntries || j < numPrev)
+    {
+        if ((j == numPrev) || ((i < numEntries) && (entries[i] < entries_[j])))
+            addedIdxs.push_back(entriesIdxs[i++]);
+
+        else if ((i == numEntries) || (entries_[j] < entries[i]))
+            removedEntries.push_back(entries_[j++]);
+
+        else
+        {
+            ++i;
+            ++j;
+        }
+    }
+
+    entries_ = entries.get();
 
     //------------------------------------------------
 
-    // prepare vertex/index buffers data for each instance batch
-    PrepareBuffers(storage.masked);
-    PrepareBuffers(storage.opaque);
-    PrepareBuffers(storage.blended);
-    PrepareBuffers(storage.blendedTransparent);
+    // remove items of invisible entries (order of others is kept)
+    if (!removedEntries.empty())
+    {
+        int numKept = 0;
+
+        for (int k = 0; k < (int)items_.size(); ++k)
+        {
+            const EntityModelMesh& item = items_[k];
+
+            if (removedEntries.get().binary_search(MakeRenderEntry(item.enttId, item.modelId)))
+            {
+                SetFirstChangedGroup(outFirstChangedGroup, GetRenderGroup(keys_[k]));
+                continue;
+            }
+
+            items_[numKept] = items_[k];
+            keys_[numKept]  = keys_[k];
+            numKept++;
+        }
+
+        items_.resize(numKept);
+        keys_.resize(numKept);
+    }
+
+    numReusedItems_ = (uint32)items_.size();
+
+    if (addedIdxs.empty())
+        return;
 
     //------------------------------------------------
 
-    // gather entts ids from each render group into a single array
-    s_EnttsIdPerInstance.resize(numRenderItems);
-    int instanceIdx = 0;
+    // prepare items for new entries
+    const int numAdded = (int)addedIdxs.size();
 
-    for (const EntityModelMesh& data : s_MaskedGroup)
-        s_EnttsIdPerInstance[instanceIdx++] = data.enttId;
+    ScratchVec<EntityID>        addedEntts;
+    ScratchVec<ModelID>         addedModels;
+    ScratchVec<bool>            addedIsLod;
+    ScratchVec<float>           addedSqrDists;
+    ScratchVec<EntityModelMesh> newItems;
+    ScratchVec<float>           newItemsSqrDists;
+    ScratchVec<uint64>          newKeys;
 
-    for (const EntityModelMesh & data : s_OpaqueGroup)
-        s_EnttsIdPerInstance[instanceIdx++] = data.enttId;
+    addedEntts.resize(numAdded);
+    addedModels.resize(numAdded);
+    addedIsLod.resize(numAdded);
+    addedSqrDists.resize(numAdded);
 
-    for (const EntityModelMesh& data : s_BlendGroup)
-        s_EnttsIdPerInstance[instanceIdx++] = data.enttId;
+    for (int k = 0; k < numAdded; ++k)
+    {
+        const uint32 idx = addedIdxs[k];
 
-    for (const EntityModelMesh& data : s_BlendTransparentGroup)
-        s_EnttsIdPerInstance[instanceIdx++] = data.enttId;
+        addedEntts[k]    = enttsIds[idx];
+        addedModels[k]   = modelsIds[idx];
+        addedIsLod[k]    = isLod[idx];
+        addedSqrDists[k] = sqrDists[idx];
+    }
 
+    const int numNewItems = (int)PrepareCommonIds(
+        addedEntts.data(),
+        numAdded,
+        addedModels,
+        addedIsLod,
+        addedSqrDists,
+        newItems,
+        newItemsSqrDists);
 
-    // prepare world matrix for each instance
-    PrepareInstancesWorldMatrices(s_EnttsIdPerInstance, storage);
+    newKeys.resize(numNewItems);
+    BuildRenderKeys(newItems.data(), newItemsSqrDists.data(), numNewItems, newKeys.data());
+    SortRenderItems(newItems.data(), newKeys.data(), numNewItems);
+
+    numRebuiltItems_ = (uint32)numNewItems;
+
+    if (numNewItems == 0)
+        return;
+
+    SetFirstChangedGroup(outFirstChangedGroup, GetRenderGroup(newKeys[0]));
+
+    //------------------------------------------------
+
+    // merge new items into the sorted list
+    const int numOld = (int)items_.size();
+
+    ScratchVec<EntityModelMesh> mergedItems;
+    ScratchVec<uint64>          mergedKeys;
+
+    mergedItems.resize(numOld + numNewItems);
+    mergedKeys.resize(numOld + numNewItems);
+
+    int oldIdx = 0;
+    int newIdx = 0;
+
+    for (int k = 0; k < numOld + numNewItems; ++k)
+    {
+        const bool takeOld = (newIdx == numNewItems) ||
+                             ((oldIdx < numOld) && (keys_[oldIdx] <= newKeys[newIdx]));
+
+        if (takeOld)
+        {
+            mergedItems[k] = items_[oldIdx];
+            mergedKeys[k]  = keys_[oldIdx++];
+        }
+        else
+        {
+            mergedItems[k] = newItems[newIdx];
+            mergedKeys[k]  = newKeys[newIdx++];
+        }
+    }
+
+    items_ = mergedItems.get();
+    keys_  = mergedKeys.get();
+}
+
+//---------------------------------------------------------
+// Desc:   blended items are rendered back-to-front so we recompute
+//         their keys (by current distances) and sort them again;
+//         NOTE: depth of opaque items isn't updated since it only
+//               defines order of instances inside a batch
+//---------------------------------------------------------
+void RenderDataPreparator::UpdateBlendedItems(
+    const XMFLOAT3& camPos,
+    int& outFirstChangedGroup)
+{
+    // blended groups are at the end of the list
+    const uint64 firstBlendedKey = (uint64)RENDER_GROUP_BLENDED << RENDER_KEY_GROUP_SHIFT;
+    const int    start           = (int)(std::lower_bound(keys_.begin(), keys_.end(), firstBlendedKey) - keys_.begin());
+    const int    numBlended      = (int)keys_.size() - start;
+
+    if (numBlended == 0)
+        return;
+
+    EntityModelMesh* items = items_.data() + start;
+
+    ScratchVec<EntityID> enttsIds;
+    ScratchVec<XMFLOAT3> positions;
+    ScratchVec<float>    sqrDists;
+
+    enttsIds.resize(numBlended);
+    sqrDists.resize(numBlended);
+
+    for (int i = 0; i < numBlended; ++i)
+        enttsIds[i] = items[i].enttId;
+
+    s_pEnttMgr->transformSys_.GetPositions(enttsIds.data(), numBlended, positions);
+
+    for (int i = 0; const XMFLOAT3& p : positions)
+    {
+        sqrDists[i++] = (SQR(p.x-camPos.x) + SQR(p.y-camPos.y) + SQR(p.z-camPos.z));
+    }
+
+    BuildRenderKeys(items, sqrDists.data(), numBlended, keys_.data() + start);
+    SortRenderItems(items, keys_.data() + start, numBlended);
+
+    SetFirstChangedGroup(outFirstChangedGroup, GetRenderGroup(keys_[start]));
 }
 
 //----------------------------------------------------------------------------------
@@ -214,7 +509,9 @@ void RenderDataPreparator::PrepareEnttsDataForRendering(
 void LodsStuff(
     const XMFLOAT3& camPos,
     cvector<EntityID>& enttsIds,
-    cvector<ModelID>& modelsIds)
+    cvector<ModelID>& modelsIds,
+    cvector<bool>& outIsLod,
+    cvector<float>& outSqrDists)
 {
     if (enttsIds.empty())
         return;
@@ -222,29 +519,28 @@ void LodsStuff(
     assert(s_pEnttMgr);
     assert(enttsIds.size() == modelsIds.size());
 
-#if PRINT_DBG_DATA
-    PrintEnttModelData(enttsIds, numEntts, s_ModelsIds, "BEFORE SORTING BY LODS");
-#endif
-
     const vsize numEntts = enttsIds.size();
 
-    cvector<EntityID> enttsIdsTmp;
-    cvector<ModelID>  modelsIdsTmp;
+    ScratchVec<EntityID> enttsIdsTmp;
+    ScratchVec<ModelID>  modelsIdsTmp;
+    ScratchVec<XMFLOAT3> positions;
+    ScratchVec<float>    sqrDistances;      // squared distances from camera to entities
 
     enttsIdsTmp.reserve(numEntts + 100);
     modelsIdsTmp.reserve(numEntts + 100);
 
     // reset flags to define if we need to render
     // entity using model with lower detail level (higher LOD)
-    s_IsLod.clear();
+    outIsLod.clear();
+    outSqrDists.clear();
 
     // compute squared distances from camera to entities
-    s_SqrDistances.resize(numEntts, FLT_MAX);
-    s_pEnttMgr->transformSys_.GetPositions(enttsIds.data(), numEntts, s_Positions);
+    sqrDistances.resize(numEntts);
+    s_pEnttMgr->transformSys_.GetPositions(enttsIds.data(), numEntts, positions);
 
-    for (index i = 0; const XMFLOAT3& p : s_Positions)
+    for (index i = 0; const XMFLOAT3& p : positions)
     {
-        s_SqrDistances[i++] = (SQR(p.x-camPos.x) + SQR(p.y-camPos.y) + SQR(p.z-camPos.z));
+        sqrDistances[i++] = (SQR(p.x-camPos.x) + SQR(p.y-camPos.y) + SQR(p.z-camPos.z));
     }
 
     ModelID modelId = -1;
@@ -262,6 +558,9 @@ void LodsStuff(
     // for each entity: check if we need to switch models lods
     for (index i = 0; i < numEntts; ++i)
     {
+        // sqr distance to entity
+        const float sqrDist = sqrDistances[i];
+
         // if need to switch model
         if (modelId != modelsIds[i])
         {
@@ -287,20 +586,19 @@ void LodsStuff(
         {
             enttsIdsTmp.push_back(enttsIds[i]);
             modelsIdsTmp.push_back(modelsIds[i]);
-            s_IsLod.push_back(false);
+            outIsLod.push_back(false);
+            outSqrDists.push_back(sqrDist);
             continue;
         }
     
 
-        // sqr distance to entity
-        const float sqrDist = s_SqrDistances[i];
-
         // if currently don't need to use any LOD
         if (sqrDist < sqrDistLodAppear)
         {
             enttsIdsTmp.push_back(enttsIds[i]);
             modelsIdsTmp.push_back(modelsIds[i]);
-            s_IsLod.push_back(false);
+            outIsLod.push_back(false);
+            outSqrDists.push_back(sqrDist);
             continue;
         }
             
@@ -310,7 +608,8 @@ void LodsStuff(
         {
             enttsIdsTmp.push_back(enttsIds[i]);
             modelsIdsTmp.push_back(modelsIds[i]);
-            s_IsLod.push_back(false);
+            outIsLod.push_back(false);
+            outSqrDists.push_back(sqrDist);
         }
 
         // if we need to use LOD2...
@@ -318,7 +617,8 @@ void LodsStuff(
         {
             enttsIdsTmp.push_back(enttsIds[i]);
             modelsIdsTmp.push_back(lod2);
-            s_IsLod.push_back(true);
+            outIsLod.push_back(true);
+            outSqrDists.push_back(sqrDist);
         }
 
         // use LOD1...
@@ -326,16 +626,17 @@ void LodsStuff(
         {
             enttsIdsTmp.push_back(enttsIds[i]);
             modelsIdsTmp.push_back(lod1);
-            s_IsLod.push_back(true);
+            outIsLod.push_back(true);
+            outSqrDists.push_back(sqrDist);
         }
     }
 
-    enttsIds = enttsIdsTmp;
-    modelsIds = modelsIdsTmp;
+    enttsIds  = enttsIdsTmp.get();
+    modelsIds = modelsIdsTmp.get();
 
 
 #if PRINT_DBG_DATA
-    PrintEnttModelData(enttsIds, numEntts, s_ModelsIds, "AFTER SORTING BY LODS");
+    PrintEnttModelData(enttsIds.data(), enttsIds.size(), modelsIds, outIsLod, "AFTER SORTING BY LODS");
 #endif
 }
 
@@ -344,7 +645,14 @@ void LodsStuff(
 //        for our render items (each separate instance of geometry)
 // Ret:   number of render items
 //---------------------------------------------------------
-vsize PrepareCommonIds(const EntityID* enttsIds, const vsize numEntts)
+vsize PrepareCommonIds(
+    const EntityID* enttsIds,
+    const vsize numEntts,
+    const cvector<ModelID>& modelsIds,
+    const cvector<bool>& isLod,
+    const cvector<float>& sqrDists,
+    cvector<EntityModelMesh>& outData,
+    cvector<float>& outSqrDists)
 {
     assert(enttsIds);
     assert(numEntts > 0);
@@ -355,49 +663,48 @@ vsize PrepareCommonIds(const EntityID* enttsIds, const vsize numEntts)
 
     ECS::MaterialSystem& matSys = s_pEnttMgr->materialSys_;
 
-    s_Data.clear();
+    outData.clear();
+    outSqrDists.clear();
 
-    // get materials ids for each subset of each input entity
-    s_pEnttMgr->materialSys_.GetDataByEnttsIds(enttsIds, numEntts, s_MaterialsDataPerEntt);
-    
     for (int i = 0; i < numEntts; ++i)
     {
         // is this entity a LOD (lod1, lod2, etc.) ?
-        if (s_IsLod[i])
+        if (isLod[i])
         {
-            if (modelId != s_ModelsIds[i])
+            if (modelId != modelsIds[i])
             {
-                modelId = s_ModelsIds[i];
+                modelId = modelsIds[i];
                 pModel = &g_ModelMgr.GetModelById(modelId);
             }
 
-            s_Data.push_back(EntityModelMesh());
-            EntityModelMesh& data = s_Data.back();
+            outData.push_back(EntityModelMesh());
+            EntityModelMesh& data = outData.back();
 
             data.enttId     = enttsIds[i];
             data.matId      = pModel->GetSubsets()[0].materialId;
             data.subsetId   = 0;
-            data.modelId    = s_ModelsIds[i];
+            data.modelId    = modelsIds[i];
 
+            outSqrDists.push_back(sqrDists[i]);
             instanceIdx++;
             continue;
         }
 
 
         // this entity is a usual geometry (not a LOD)
-        //const ECS::MaterialData& matData = s_MaterialsDataPerEntt[i];
         const ECS::MaterialData& matData = matSys.GetDataByEnttId(enttsIds[i]);
 
         for (int matIdx = 0; const MaterialID matId : matData.materialsIds)
         {
-            s_Data.push_back(EntityModelMesh());
-            EntityModelMesh& data = s_Data.back();
+            outData.push_back(EntityModelMesh());
+            EntityModelMesh& data = outData.back();
 
             data.enttId     = enttsIds[i];
             data.matId      = matId;
             data.subsetId   = matIdx;
-            data.modelId    = s_ModelsIds[i];
+            data.modelId    = modelsIds[i];
 
+            outSqrDists.push_back(sqrDists[i]);
             matIdx++;
             instanceIdx++;
         }
@@ -407,68 +714,116 @@ vsize PrepareCommonIds(const EntityID* enttsIds, const vsize numEntts)
 }
 
 //---------------------------------------------------------
-// Desc:   sort input data elements by distance from the camera
-// Args:   - camPos:  camera's current position
-//         - data:    in/out container of data to sort
+// Desc:   make a sorting key for each render item (see layout of keys above)
+// Args:   - items:     render items
+//         - sqrDists:  squared distance from camera to each item
+//         - numItems:  how many items we have
+//         - outKeys:   output arr of keys
 //---------------------------------------------------------
-void SortByDistance(const XMFLOAT3& camPos, cvector<EntityModelMesh>& data)
+void BuildRenderKeys(
+    const EntityModelMesh* items,
+    const float* sqrDists,
+    const int numItems,
+    uint64* outKeys)
 {
-    const vsize numElems = data.size();
+    assert(items && sqrDists && outKeys);
 
-    s_TempEnttsIds.resize(numElems, INVALID_ENTT_ID);
-    s_TempData.resize(numElems);
-    s_Positions.resize(numElems);
+    MaterialID                      matId = INVALID_MAT_ID;
+    const Material*                  pMat = &g_MaterialMgr.GetMatById(matId);
+    const Render::RenderStates& rndStates = Render::g_Render.GetRenderStates();
+    uint64                          group = RENDER_GROUP_OPAQUE;
 
-    // gather entities ids
-    for (index i = 0; i < numElems; ++i)
-        s_TempEnttsIds[i] = data[i].enttId;
+    for (int i = 0; i < numItems; ++i)
+    {
+        const EntityModelMesh& item = items[i];
 
-    // gather entities positions
-    s_pEnttMgr->transformSys_.GetPositions(s_TempEnttsIds.data(), numElems, s_Positions);
+        // if current material differs from the previous one we get another material
+        // and define to which rendering group does this instance belongs to
+        if (item.matId != matId)
+        {
+            pMat  = &g_MaterialMgr.GetMatById(item.matId);
+            matId = item.matId;
 
-    // convert to transient data
-    for (index i = 0; i < numElems; ++i)
-    {
-        s_TempData[i] = {
-            data[i].enttId,
-            data[i].matId,
-            data[i].modelId,
-            data[i].subsetId };
-    }
+            bool isBlended = false;
+            bool isTransparent = false;
 
-    for (index i = 0; const XMFLOAT3& p : s_Positions)
-    {
-        s_TempData[i++].sqrDistToCamera =
-            SQR(p.x-camPos.x) +
-            SQR(p.y-camPos.y) +
-            SQR(p.z-camPos.z);
-    }
+            rndStates.IsBlendEnabled(pMat->bsId, isTransparent, isBlended);
+
+            if (isBlended)
+                group = (isTransparent) ? RENDER_GROUP_BLENDED_TRANSPARENT : RENDER_GROUP_BLENDED;
+
+            else if (pMat->HasAlphaClip())
+                group = RENDER_GROUP_MASKED;
 
+            else
+                group = RENDER_GROUP_OPAQUE;
+        }
+
+        // bits of non-negative float have the same order as the float itself
+        // so we just take high bits (excluding the sign) as quantized depth
+        const uint64 depth = FloatToSortableUint(sqrDists[i]);
+
+        const uint64 mat    = item.matId    & 0xFFFF;
+        const uint64 model  = item.modelId  & 0xFFFF;
 
-    // sort by square of distance to camera
-    std::qsort(
-        s_TempData.data(),
-        s_TempData.size(),
-        sizeof(EntityDataAndPos),
-        [](const void* x, const void* y)
+        if (group >= RENDER_GROUP_BLENDED)
         {
-            const EntityDataAndPos& arg1 = *(EntityDataAndPos*)(x);
-            const EntityDataAndPos& arg2 = *(EntityDataAndPos*)(y);
+            // back-to-front
+            const uint64 invDepth = 0xFFFFFF - ((depth >> 7) & 0xFFFFFF);
+
+            outKeys[i] =
+                (group    << RENDER_KEY_GROUP_SHIFT) |
+                (invDepth << 38) |
+                (mat      << 22) |
+                (model    << 6)  |
+                (item.subsetId & 0x3F);
+        }
+        else
+        {
+            const uint64 shader = pMat->shaderId & 0xFFF;
+
+            outKeys[i] =
+                (group    << RENDER_KEY_GROUP_SHIFT) |
+                (shader   << 50) |
+                (mat      << 34) |
+                (model    << 18) |
+                ((uint64)(item.subsetId & 0xFF) << 10) |
+                ((depth >> 21) & 0x3FF);
+        }
+    }
+}
 
-            if (arg1.sqrDistToCamera > arg2.sqrDistToCamera)
-                return -1;
+//---------------------------------------------------------
+// Desc:   sort render items by their keys (in place)
+//---------------------------------------------------------
+void SortRenderItems(
+    EntityModelMesh* items,
+    uint64* keys,
+    const int numItems)
+{
+    if (numItems <= 1)
+        return;
 
-            if (arg1.sqrDistToCamera < arg2.sqrDistToCamera)
-                return 1;
+    ScratchVec<uint32>          idxs;
+    ScratchVec<uint64>          tmpKeys;
+    ScratchVec<uint32>          tmpIdxs;
+    ScratchVec<EntityModelMesh> tmpItems;
 
-            return 0;
-        });
+    idxs.resize(numItems);
+    tmpKeys.resize(numItems);
+    tmpIdxs.resize(numItems);
+    tmpItems.resize(numItems);
 
-    // store sorted data into the output array
-    for (int i = 0; EntityDataAndPos& elem : s_TempData)
+    for (int i = 0; i < numItems; ++i)
     {
-        data[i++] = { elem.enttId, elem.matId, elem.modelId, elem.subsetId };
+        idxs[i]     = (uint32)i;
+        tmpItems[i] = items[i];
     }
+
+    RadixSort64(keys, idxs.data(), tmpKeys.data(), tmpIdxs.data(), numItems);
+
+    for (int i = 0; i < numItems; ++i)
+        items[i] = tmpItems[idxs[i]];
 }
 
 //----------------------------------------------------------------------------------
@@ -478,6 +833,7 @@ void PrintEnttModelData(
     const EntityID* enttsIds,
     const vsize numEntts,
     const cvector<ModelID>& modelsIds,
+    const cvector<bool>& isLod,
     const char* msg)
 {
     assert(msg != nullptr);
@@ -500,7 +856,7 @@ void PrintEnttModelData(
     printf("%slod changed: ", GREEN);
     for (index i = 0; i < numEntts; ++i)
     {
-        printf("%2d ", (int)s_IsLod[i]);
+        printf("%2d ", (int)isLod[i]);
     }
     printf("\n");
 
@@ -564,14 +920,16 @@ void PrintData(const cvector<EntityModelMesh>& data, const char* msg)
 
 //----------------------------------------------------------------------------------
 // Desc:  prepare materials for the instances buffer and instances batches
-// Args:  - renderGroup:    container for ids of particular rendering group
+// Args:  - renderGroup:    ids of items of particular rendering group
 //                          (masked, opaque, blended, etc.)
+//        - numItems:       the number of items in the group
 //        - instancesBuf:   buffer for instances data
 //        - instaceBatches: output a container for instance batches
 //----------------------------------------------------------------------------------
 void PrepareMaterials(
     int& instanceMatIdx,
-    const cvector<EntityModelMesh>& renderGroup,
+    const EntityModelMesh* renderGroup,
+    const int numItems,
     Render::InstancesBuf& instancesBuf,
     cvector<Render::InstanceBatch>& instanceBatches)
 {
@@ -582,8 +940,10 @@ void PrepareMaterials(
     Render::InstanceBatch* pInstances = nullptr;
 
 
-    for (const EntityModelMesh& data : renderGroup)
+    for (int i = 0; i < numItems; ++i)
     {
+        const EntityModelMesh& data = renderGroup[i];
+
         // if current material differs from the previous one we get another material
         // if model OR submesh was changed to another one
         const bool sameMaterial = data.matId == matId;
@@ -684,146 +1044,33 @@ void PrepareBuffers(cvector<Render::InstanceBatch>& instanceBatches)
 }
 
 
-//----------------------------------------------------------------------------------
-// Desc:   push world matrices into instances buffer for input instance batches
-//----------------------------------------------------------------------------------
-void PushWorldsIntoInstanceBuf(
-    int& instanceIdx,
-    const cvector<Render::InstanceBatch>& instancesBatches,
-    const cvector<DirectX::XMMATRIX>& inWorlds,
-    DirectX::XMMATRIX* outWorlds)
-{
-    for (const Render::InstanceBatch& instances : instancesBatches)
-    {
-        memcpy(
-            &(outWorlds[instanceIdx]),
-            &(s_Worlds[instanceIdx]),
-            sizeof(DirectX::XMMATRIX) * instances.numInstances);
-
-        instanceIdx += instances.numInstances;
-    }
-}
-
 //---------------------------------------------------------
 // Desc:   prepare world matrix for each instance
+//         (instances go in the same order as items of the render list)
 //---------------------------------------------------------
-void RenderDataPreparator::PrepareInstancesWorldMatrices(
-    const cvector<EntityID>& enttIdPerInstance,
-    Render::RenderDataStorage& storage)
+void RenderDataPreparator::PrepareInstancesWorldMatrices(Render::RenderDataStorage& storage)
 {
+    const int numInstances = (int)items_.size();
+
     // if we have no entities to render
-    if (enttIdPerInstance.empty())
+    if (numInstances == 0)
         return;
 
-    s_Worlds.clear();
+    ScratchVec<EntityID> enttIdPerInstance;
+    ScratchVec<XMMATRIX> worlds;
+
+    enttIdPerInstance.resize(numInstances);
+
+    for (int i = 0; i < numInstances; ++i)
+        enttIdPerInstance[i] = items_[i].enttId;
 
     // get world matrices
     s_pEnttMgr->transformSys_.GetWorlds(
         enttIdPerInstance.data(),
         enttIdPerInstance.size(),
-        s_Worlds);
-
-    int instanceIdx = 0;
-    DirectX::XMMATRIX* outWorlds = storage.instancesBuf.worlds_;
-
-    // prepare world matrices for each rendering group (masked, opaque, blended, etc.)
-    PushWorldsIntoInstanceBuf(instanceIdx, storage.masked, s_Worlds, outWorlds);
-    PushWorldsIntoInstanceBuf(instanceIdx, storage.opaque, s_Worlds, outWorlds);
-    PushWorldsIntoInstanceBuf(instanceIdx, storage.blended, s_Worlds, outWorlds);
-    PushWorldsIntoInstanceBuf(instanceIdx, storage.blendedTransparent, s_Worlds, outWorlds);
-}
-
-//---------------------------------------------------------
-// Desc:  group entities by geometry type (masked, opaque, blended, etc.)
-//---------------------------------------------------------
-void RenderDataPreparator::GroupEnttsByGeomTypes(const vsize numRenderItems)
-{
-    MaterialID                      matId = INVALID_MAT_ID;
-    const Material*                  pMat = &g_MaterialMgr.GetMatById(matId);
-    const Render::RenderStates& rndStates = Render::g_Render.GetRenderStates();
-
-    s_MaskedGroup.clear();
-    s_OpaqueGroup.clear();
-    s_BlendGroup.clear();
-    s_BlendTransparentGroup.clear();
-
-
-    for (index i = 0; i < numRenderItems; ++i)
-    {
-        // if current material differs from the previous one we get another material
-        if (s_Data[i].matId != matId)
-        {
-            pMat = &g_MaterialMgr.GetMatById(s_Data[i].matId);
-            matId = s_Data[i].matId;
-        }
-
-        //
-        // define to which rendering group does this instance belongs to:
-        //
-        bool isBlended = false;
-        bool isTransparent = false;
-
-        rndStates.IsBlendEnabled(pMat->bsId, isTransparent, isBlended);
-
-        // 1. blending
-        if (isBlended)
-        {
-            if (isTransparent)
-                s_BlendTransparentGroup.push_back(s_Data[i]);
-            else
-                s_BlendGroup.push_back(s_Data[i]);
-        }
-
-        // 2. masked / alpha clipping group
-        else if (pMat->HasAlphaClip())
-            s_MaskedGroup.push_back(s_Data[i]);
-
-        // 3. opaque group
-        else
-            s_OpaqueGroup.push_back(s_Data[i]);
-    }
-
-#if PRINT_DBG_DATA
-    PrintData(s_MaskedGroup,           "MASKED");
-    PrintData(s_OpaqueGroup,           "OPAQUE");
-    PrintData(s_BlendGroup,            "BLEND");
-    PrintData(s_BlendTransparentGroup, "BLEND (TRANSPARENT)");
-#endif
-}
+        worlds);
 
-//----------------------------------------------------------------------------------
-// Desc:   sort input data by material id
-// Args:   - data: in/out container of data to sort
-//----------------------------------------------------------------------------------
-void SortEnttsByMaterials(cvector<EntityModelMesh>& data)
-{
-
-#if PRINT_DBG_DATA
-    PrintData(s_Data, "BEFORE SORTING BY MATERIALS");
-#endif
-
-    std::qsort(
-        data.data(),
-        data.size(),
-        sizeof(EntityModelMesh),
-        [](const void* x, const void* y)
-        {
-            const EntityModelMesh& arg1 = *(EntityModelMesh*)(x);
-            const EntityModelMesh& arg2 = *(EntityModelMesh*)(y);
-
-            if (arg1.matId < arg2.matId)
-                return -1;
-
-            if (arg1.matId > arg2.matId)
-                return 1;
-
-            return 0;
-        });
-
-
-#if PRINT_DBG_DATA
-    PrintData(s_Data, "AFTER SORTING BY MATERIALS");
-#endif
+    memcpy(storage.instancesBuf.worlds_, worlds.data(), sizeof(XMMATRIX) * numInstances);
 }
 
 
@@ -27,14 +27,45 @@ public:
         ECS::EntityMgr* pEnttMgr,
         Render::RenderDataStorage& storage);
 
+    // retained mode: the render list is kept between frames and only
+    // inserted/removed items are processed (otherwise it is rebuilt each frame)
+    void SetRetainedMode(const bool onOff);
+
+    // force a full rebuild of the render list for the next frame
+    // (call it when materials/models of entities are changed)
+    inline void InvalidateRenderList()              { isListValid_ = false; }
+
+    inline bool   IsRetainedMode()            const { return retainedMode_; }
+    inline uint32 GetNumReusedItems()         const { return numReusedItems_; }
+    inline uint32 GetNumRebuiltItems()        const { return numRebuiltItems_; }
+
 private:
-    void PrepareInstancesWorldMatrices(
-        const cvector<EntityID>& enttIdPerInstance,
-        Render::RenderDataStorage& storage);
+    void ResetRenderList();
+
+    void UpdateRenderList(
+        const cvector<EntityID>& enttsIds,
+        const cvector<ModelID>& modelsIds,
+        const cvector<bool>& isLod,
+        const cvector<float>& sqrDists,
+        int& outFirstChangedGroup);
+
+    void UpdateBlendedItems(
+        const DirectX::XMFLOAT3& cameraPos,
+        int& outFirstChangedGroup);
+
+    void PrepareInstancesWorldMatrices(Render::RenderDataStorage& storage);
+
+private:
+    // render list of the previous frame
+    cvector<uint64>          entries_;              // sorted (entt id << 32 | model id) of each rendered pair
+    cvector<EntityModelMesh> items_;                // render items in order of instances
+    cvector<uint64>          keys_;                 // sorting key of each render item
 
-    void GroupEnttsByGeomTypes(const vsize numRenderItems);
+    bool                     retainedMode_    = true;
+    bool                     isListValid_     = false;
 
-    //vsize PrepareCommonIds(const EntityID* enttsIds, const vsize numEntts);
+    uint32                   numReusedItems_  = 0;  // stats for the last frame
+    uint32                   numRebuiltItems_ = 0;
 };
 
 } // namespace Core
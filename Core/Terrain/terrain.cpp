@@ -27,6 +27,10 @@ namespace Core
 // 2 - hard smoothing
 constexpr int TERRAIN_SMOOTHING_LEVEL = 2;
 
+// ray tests: level of heights mip chain where we stop going through the quadtree
+// and walk through the cells (2D DDA); 3 --> blocks of 8x8 cells
+constexpr int HEIGHT_MIP_BLOCK_LEVEL = 3;
+
 
 //---------------------------------------------------------
 // Desc:   release memory from the vertices/indices buffers
@@ -48,6 +52,8 @@ void Terrain::Shutdown()
 {
     vertices_.purge();
     indices_.purge();
+    heightMips_.purge();
+    numHeightMips_ = 0;
 
     ReleaseBuffers();
     ClearMemoryFromMaps();
@@ -110,6 +116,7 @@ bool Terrain::InitGeomipmapping(const int patchSize)
     PopulateBuffers();
 
     ComputeBoundings();
+    ComputeHeightMips();
 
     LogMsg("Geomipmapping system successfully initialized");
     return true;
@@ -128,6 +135,7 @@ void Terrain::ComputeBoundings()
     const int numAllPatches = SQR(numPatchesPerSide);
     patchesAABBs_.resize(numAllPatches);
     patchesBoundSpheres_.resize(numAllPatches);
+    patchesSpheresSoA_.Resize(numAllPatches);
 
     const Vec3 colorYellow(1, 1, 0);
 
@@ -163,6 +171,7 @@ void Terrain::ComputeBoundings()
 
             patchesAABBs_[idx] = aabb;
             patchesBoundSpheres_[idx] = sphere;
+            patchesSpheresSoA_.Set(idx, center.x, center.y, center.z, radius);
 
             const Vec3 aabbMinPoint = aabb.MinPoint();
             const Vec3 aabbMaxPoint = aabb.MaxPoint();
@@ -172,6 +181,96 @@ void Terrain::ComputeBoundings()
     }
 }
 
+//---------------------------------------------------------
+// Desc:   compute min/max heights mip chain: level 0 keeps a range of heights
+//         for each cell (quad between 4 neighbour vertices), each next level
+//         keeps ranges for 2x2 nodes of the previous level; the last level
+//         is a single node for the whole terrain
+//---------------------------------------------------------
+void Terrain::ComputeHeightMips()
+{
+    const int terrainLen = GetTerrainLength();
+    const int numCells   = terrainLen - 1;
+
+    numHeightMips_ = 0;
+    heightMips_.clear();
+
+    if (numCells <= 0)
+    {
+        LogErr(LOG, "terrain has no cells (terrain length: %d)", terrainLen);
+        return;
+    }
+
+    // define the number of nodes per side and offset for each level
+    int numNodes = 0;
+
+    for (int size = numCells; ; size = (size + 1) / 2)
+    {
+        if (numHeightMips_ == MAX_NUM_HEIGHT_MIPS)
+        {
+            LogErr(LOG, "terrain is too big for heights mip chain (terrain length: %d)", terrainLen);
+            numHeightMips_ = 0;
+            return;
+        }
+
+        heightMipOffsets_[numHeightMips_] = numNodes;
+        heightMipSizes_[numHeightMips_]   = size;
+        numHeightMips_++;
+        numNodes += SQR(size);
+
+        if (size == 1)
+            break;
+    }
+
+    heightMips_.resize(numNodes);
+
+    // level 0: heights range of each cell
+    for (int z = 0; z < numCells; ++z)
+    {
+        for (int x = 0; x < numCells; ++x)
+        {
+            const int   idx = z * terrainLen + x;
+            const float h00 = vertices_[idx].position.y;
+            const float h10 = vertices_[idx + 1].position.y;
+            const float h01 = vertices_[idx + terrainLen].position.y;
+            const float h11 = vertices_[idx + terrainLen + 1].position.y;
+
+            HeightRange& range = heightMips_[z * numCells + x];
+            range.minH = min(min(h00, h10), min(h01, h11));
+            range.maxH = max(max(h00, h10), max(h01, h11));
+        }
+    }
+
+    // next levels: merge ranges of 2x2 nodes of the previous level
+    for (int level = 1; level < numHeightMips_; ++level)
+    {
+        const int          prevSize = heightMipSizes_[level - 1];
+        const int          size     = heightMipSizes_[level];
+        const HeightRange* prev     = &heightMips_[heightMipOffsets_[level - 1]];
+        HeightRange*       curr     = &heightMips_[heightMipOffsets_[level]];
+
+        for (int z = 0; z < size; ++z)
+        {
+            for (int x = 0; x < size; ++x)
+            {
+                HeightRange range = { FLT_MAX, -FLT_MAX };
+
+                for (int cz = z * 2; cz < min(z * 2 + 2, prevSize); ++cz)
+                {
+                    for (int cx = x * 2; cx < min(x * 2 + 2, prevSize); ++cx)
+                    {
+                        const HeightRange& child = prev[cz * prevSize + cx];
+                        range.minH = min(range.minH, child.minH);
+                        range.maxH = max(range.maxH, child.maxH);
+                    }
+                }
+
+                curr[z * size + x] = range;
+            }
+        }
+    }
+}
+
 //---------------------------------------------------------
 // Desc:   initialize DirectX vertex/index buffers
 //---------------------------------------------------------
@@ -477,7 +576,44 @@ Vec3 CompNormalVec(const XMFLOAT3& p0, const XMFLOAT3& p1, const XMFLOAT3& p2)
 }
 
 //---------------------------------------------------------
-// Desc:  execute ray/terrain intersection test
+// Desc:   (helper) ray vs axis-aligned box (slab test)
+// Args:   - invDir:  1 / ray direction (per component)
+//         - tmax:    max distance along the ray
+// Out:    - tEnter, tExit: distances where the ray enters/exits the box
+//---------------------------------------------------------
+static inline bool IntersectRayBox(
+    const float x0, const float x1,
+    const float y0, const float y1,
+    const float z0, const float z1,
+    const Vec3& rayOrig,
+    const Vec3& invDir,
+    const float tmax,
+    float& tEnter,
+    float& tExit)
+{
+    const float tx0 = (x0 - rayOrig.x) * invDir.x;
+    const float tx1 = (x1 - rayOrig.x) * invDir.x;
+    const float ty0 = (y0 - rayOrig.y) * invDir.y;
+    const float ty1 = (y1 - rayOrig.y) * invDir.y;
+    const float tz0 = (z0 - rayOrig.z) * invDir.z;
+    const float tz1 = (z1 - rayOrig.z) * invDir.z;
+
+    tEnter = max(0.0f, max(min(tx0, tx1), max(min(ty0, ty1), min(tz0, tz1))));
+    tExit  = min(tmax, min(max(tx0, tx1), min(max(ty0, ty1), max(tz0, tz1))));
+
+    return tEnter <= tExit;
+}
+
+//---------------------------------------------------------
+// Desc:   execute ray/terrain intersection test:
+//         we go front-to-back through the min/max heights mip chain
+//         (a quadtree over the height cells) and skip each node which box
+//         isn't crossed by the ray; inside of small enough nodes (blocks)
+//         we walk through the cells along the ray (2D DDA) and test
+//         only triangles of cells which heights range is crossed by the ray
+//
+//         NOTE: all the patches are tested (not only visible ones)
+//
 // Args:  - rayOrig:  origin of the ray
 //        - rayDir:   direction of the ray
 // 
@@ -492,106 +628,315 @@ bool Terrain::TestRayIntersection(
     // ray direction must be normalized
     assert(FloatEqual(Vec3Length(rayDir), 1.0f) == true);
 
-    //
-    // ray/bounding_spheres tests (broad phase)
-    //
-    cvector<int> patchesToTest;
-    patchesToTest.reserve(16);
+    if (numHeightMips_ == 0)
+        return false;
+
+    struct HeightNode
+    {
+        int   level;
+        int   x;
+        int   z;
+        float tEnter;
+        float tExit;
+    };
+
+    // 3 siblings per level can wait on the stack + currently processed children
+    constexpr int maxStackSize = 4 * MAX_NUM_HEIGHT_MIPS;
+    HeightNode    stack[maxStackSize];
+    int           stackSize = 0;
+
+    const int   numCells   = heightMipSizes_[0];
+    const int   topLevel   = numHeightMips_ - 1;
+    const int   blockLevel = min(HEIGHT_MIP_BLOCK_LEVEL, topLevel);
+
+    // avoid division by zero for axis-aligned rays
+    const Vec3 invDir(
+        1.0f / ((rayDir.x != 0) ? rayDir.x : 1e-20f),
+        1.0f / ((rayDir.y != 0) ? rayDir.y : 1e-20f),
+        1.0f / ((rayDir.z != 0) ? rayDir.z : 1e-20f));
 
-    float dist = 0;
+    float tmin = FLT_MAX;
+    int   cellX = -1;
+    int   cellZ = -1;
+    int   triIdx = 0;
+
+    // test the root node (the whole terrain)
+    {
+        const HeightRange& root = heightMips_[heightMipOffsets_[topLevel]];
+        HeightNode node = { topLevel, 0, 0, 0, 0 };
+
+        if (!IntersectRayBox(
+            0, (float)numCells,
+            root.minH, root.maxH,
+            0, (float)numCells,
+            rayOrig, invDir, tmin,
+            node.tEnter, node.tExit))
+        {
+            return false;
+        }
+
+        stack[stackSize++] = node;
+    }
 
-    // test only visible terrain patches (sectors)
-    for (const int i : GetAllVisiblePatches())
+    while (stackSize > 0)
     {
-        if (!IntersectRaySphere(patchesBoundSpheres_[i], rayOrig, rayDir, dist))
+        const HeightNode node = stack[--stackSize];
+
+        // we already have an intersection which is closer than this node
+        if (node.tEnter >= tmin)
+            continue;
+
+        if (node.level == blockLevel)
+        {
+            TestRayHeightBlock(
+                node.x << blockLevel,
+                node.z << blockLevel,
+                1 << blockLevel,
+                rayOrig,
+                rayDir,
+                node.tEnter,
+                min(node.tExit, tmin),
+                tmin,
+                cellX,
+                cellZ,
+                triIdx);
+
             continue;
+        }
+
+        // test children and push them so the nearest will be processed first
+        const int          level    = node.level - 1;
+        const int          size     = heightMipSizes_[level];
+        const HeightRange* ranges   = &heightMips_[heightMipOffsets_[level]];
+        const int          nodeLen  = 1 << level;
+        HeightNode         children[4];
+        int                numChildren = 0;
+
+        for (int z = node.z * 2; z < min(node.z * 2 + 2, size); ++z)
+        {
+            for (int x = node.x * 2; x < min(node.x * 2 + 2, size); ++x)
+            {
+                const HeightRange& range = ranges[z * size + x];
+                HeightNode child = { level, x, z, 0, 0 };
+
+                const float x0 = (float)(x * nodeLen);
+                const float z0 = (float)(z * nodeLen);
+                const float x1 = (float)min((x + 1) * nodeLen, numCells);
+                const float z1 = (float)min((z + 1) * nodeLen, numCells);
+
+                if (!IntersectRayBox(
+                    x0, x1,
+                    range.minH, range.maxH,
+                    z0, z1,
+                    rayOrig, invDir, tmin,
+                    child.tEnter, child.tExit))
+                {
+                    continue;
+                }
+
+                // insertion sort by distance (the farthest goes first)
+                int i = numChildren++;
+
+                for (; (i > 0) && (children[i-1].tEnter < child.tEnter); --i)
+                    children[i] = children[i-1];
+
+                children[i] = child;
+            }
+        }
 
-        // ray intersects this sphere
-        patchesToTest.push_back(i);
+        assert(stackSize + numChildren <= maxStackSize);
+
+        for (int i = 0; i < numChildren; ++i)
+            stack[stackSize++] = children[i];
     }
 
+    if (cellX < 0)
+        return false;
+
+    XMVECTOR v0, v1, v2;
+    GetCellTriangle(cellX, cellZ, triIdx, v0, v1, v2);
+    FillIntersectionData(rayOrig, rayDir, tmin, v0, v1, v2, outData);
 
-    // ray/AABB test
-    //if (patchesAABBs_)
+    return true;
+}
 
+//---------------------------------------------------------
+// Desc:   walk through cells of the block along the ray (2D DDA) and
+//         test the ray against triangles of each crossed cell
+// Args:   - blockX, blockZ:  the first cell of the block
+//         - blockSize:       the number of cells per side of the block
+//         - tEnter, tExit:   a part of the ray which is inside the block
+// Out:    - inOutTMin:       distance to the nearest intersection (is updated only if closer)
+//         - outCellX/Z:      intersected cell
+//         - outTriIdx:       intersected triangle of the cell (0 or 1)
+// Ret:    true if there is a new nearest intersection
+//---------------------------------------------------------
+bool Terrain::TestRayHeightBlock(
+    const int blockX,
+    const int blockZ,
+    const int blockSize,
+    const Vec3& rayOrig,
+    const Vec3& rayDir,
+    const float tEnter,
+    const float tExit,
+    float& inOutTMin,
+    int& outCellX,
+    int& outCellZ,
+    int& outTriIdx) const
+{
+    constexpr float heightEps = 0.001f;
 
-    //
-    // ray/triangle tests for each terrain patch (narrow phase)
-    //
-    const int   terrainLen           = GetTerrainLength();
-    const int   numPatchesPerSide    = GetNumPatchesPerSide();
-    const float invNumPatchesPerSide = 1.0f / numPatchesPerSide;
-    const int   patchSize            = lodMgr_.GetPatchSize();
+    const int          numCells = heightMipSizes_[0];
+    const HeightRange* ranges   = heightMips_.data();      // level 0: per cell
+    const int          endX     = min(blockX + blockSize, numCells);
+    const int          endZ     = min(blockZ + blockSize, numCells);
 
     const XMVECTOR rayOrigW = { rayOrig.x, rayOrig.y, rayOrig.z };
     const XMVECTOR rayDirW  = { rayDir.x, rayDir.y, rayDir.z };
 
-    float tmin = FLT_MAX;
-    int triangleIdx = 0;
-    bool bIntersect = false;
-    int intersectedPatchIdx = -1;
-    XMVECTOR p0, p1, p2;         // intersected triangle
+    // start cell (clamp it because of floating point errors at the block's borders)
+    int cx = (int)floorf(rayOrig.x + rayDir.x * tEnter);
+    int cz = (int)floorf(rayOrig.z + rayDir.z * tEnter);
+    cx = Clamp(cx, blockX, endX - 1);
+    cz = Clamp(cz, blockZ, endZ - 1);
+
+    const int   stepX   = (rayDir.x >= 0) ? 1 : -1;
+    const int   stepZ   = (rayDir.z >= 0) ? 1 : -1;
+    const float tDeltaX = (rayDir.x != 0) ? fabsf(1.0f / rayDir.x) : FLT_MAX;
+    const float tDeltaZ = (rayDir.z != 0) ? fabsf(1.0f / rayDir.z) : FLT_MAX;
+
+    // distances to the next vertical cell borders along x and z
+    float tMaxX = FLT_MAX;
+    float tMaxZ = FLT_MAX;
 
-    for (const int patchIdx : patchesToTest)
+    if (rayDir.x != 0)
+        tMaxX = ((float)(cx + (stepX > 0)) - rayOrig.x) / rayDir.x;
+
+    if (rayDir.z != 0)
+        tMaxZ = ((float)(cz + (stepZ > 0)) - rayOrig.z) / rayDir.z;
+
+    bool  bIntersect = false;
+    float t          = tEnter;
+
+    while ((t <= tExit) && (t < inOutTMin))
     {
-        // set maximal lod (detalization for the geometry)
-        TerrainLodMgr::PatchLod plod = {0,0,0,0,0};
+        const float tNext = min(tExit, min(tMaxX, tMaxZ));
 
-        UINT baseIndex = 0;
-        UINT indexCount = 0;
-        GetLodInfoByPatch(plod, baseIndex, indexCount);
+        // heights of the ray where it enters/exits the cell
+        const float y0 = rayOrig.y + rayDir.y * t;
+        const float y1 = rayOrig.y + rayDir.y * tNext;
+        const HeightRange& range = ranges[cz * numCells + cx];
 
-        const int patchZ = (int)(patchIdx * invNumPatchesPerSide);  // const int patchZ = idx / numPatchesPerSide;
-        const int patchX = patchIdx & (numPatchesPerSide - 1);      // const int patchX = idx % numPatchesPerSide;
-        const int z      = patchZ * (patchSize - 1);
-        const int x      = patchX * (patchSize - 1);
+        if ((max(y0, y1) >= range.minH - heightEps) &&
+            (min(y0, y1) <= range.maxH + heightEps))
+        {
+            for (int i = 0; i < 2; ++i)
+            {
+                XMVECTOR v0, v1, v2;
+                GetCellTriangle(cx, cz, i, v0, v1, v2);
+
+                float dist = 0;
+
+                if (!DirectX::TriangleTests::Intersects(rayOrigW, rayDirW, v0, v1, v2, dist))
+                    continue;
+
+                if (dist >= inOutTMin)
+                    continue;
 
-        const UINT baseVertex = (UINT)(z * terrainLen + x);
+                inOutTMin  = dist;
+                outCellX   = cx;
+                outCellZ   = cz;
+                outTriIdx  = i;
+                bIntersect = true;
+            }
+        }
 
-        const Vertex3dTerrain* verts = &vertices_[baseVertex];
-        const UINT*          indices = &indices_[baseIndex];
+        // go to the next cell
+        if (tMaxX < tMaxZ)
+        {
+            cx += stepX;
+            t = tMaxX;
+            tMaxX += tDeltaX;
 
-        // exec ray/triangle tests for this patch (its mesh)
-        for (int i = 0; i < (int)indexCount / 3; ++i)
+            if ((cx < blockX) || (cx >= endX))
+                break;
+        }
+        else
         {
-            // indices for this triangle
-            const UINT i0 = indices[i*3 + 0];
-            const UINT i1 = indices[i*3 + 1];
-            const UINT i2 = indices[i*3 + 2];
-
-            // vertices of this triangle
-            const XMVECTOR v0 = XMLoadFloat3(&verts[i0].position);
-            const XMVECTOR v1 = XMLoadFloat3(&verts[i1].position);
-            const XMVECTOR v2 = XMLoadFloat3(&verts[i2].position);
-
-            float t = 0;
-
-            if (!DirectX::TriangleTests::Intersects(rayOrigW, rayDirW, v0, v1, v2, t))
-                continue;
-
-            if (t > tmin)
-                continue;
-
-            // this is a new nearest intersected triangle
-            tmin = t;
-            triangleIdx = i;
-            p0 = v0;
-            p1 = v1;
-            p2 = v2;
-            intersectedPatchIdx = patchIdx;
-            bIntersect = true;
+            cz += stepZ;
+            t = tMaxZ;
+            tMaxZ += tDeltaZ;
+
+            if ((cz < blockZ) || (cz >= endZ))
+                break;
         }
     }
 
-    if (!bIntersect)
-        return false;
+    return bIntersect;
+}
 
+//---------------------------------------------------------
+// Desc:   get vertices of triangle of a cell (quad between 4 neighbour vertices);
+//         the diagonal goes the same way as in the triangle fans of LOD0
+//         (from the fan's center with odd coords to the fan's corner)
+// Args:   - cellX, cellZ:  the cell coords (coords of its lower-left vertex)
+//         - triIdx:        0 or 1
+//---------------------------------------------------------
+void Terrain::GetCellTriangle(
+    const int cellX,
+    const int cellZ,
+    const int triIdx,
+    XMVECTOR& outV0,
+    XMVECTOR& outV1,
+    XMVECTOR& outV2) const
+{
+    const int terrainLen = GetTerrainLength();
+    const int idx00      = cellZ * terrainLen + cellX;
+    const int idx10      = idx00 + 1;
+    const int idx01      = idx00 + terrainLen;
+    const int idx11      = idx01 + 1;
+
+    const XMVECTOR v00 = XMLoadFloat3(&vertices_[idx00].position);
+    const XMVECTOR v10 = XMLoadFloat3(&vertices_[idx10].position);
+    const XMVECTOR v01 = XMLoadFloat3(&vertices_[idx01].position);
+    const XMVECTOR v11 = XMLoadFloat3(&vertices_[idx11].position);
+
+    // diagonal: (x,z) -- (x+1,z+1)
+    if (((cellX + cellZ) & 1) == 0)
+    {
+        outV0 = v00;
+        outV1 = (triIdx == 0) ? v10 : v01;
+        outV2 = v11;
+    }
+    // diagonal: (x+1,z) -- (x,z+1)
+    else
+    {
+        outV0 = (triIdx == 0) ? v00 : v11;
+        outV1 = v10;
+        outV2 = v01;
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   store data of the ray/terrain intersection
+// Args:   - dist:        distance from the ray origin to the intersection point
+//         - v0, v1, v2:  endpoints of the intersected triangle
+//---------------------------------------------------------
+void Terrain::FillIntersectionData(
+    const Vec3& rayOrig,
+    const Vec3& rayDir,
+    const float dist,
+    const XMVECTOR& v0,
+    const XMVECTOR& v1,
+    const XMVECTOR& v2,
+    IntersectionData& outData) const
+{
     // store endpoints of the intersected triangle
     XMFLOAT3 pos0, pos1, pos2;
 
-    XMStoreFloat3(&pos0, p0);
-    XMStoreFloat3(&pos1, p1);
-    XMStoreFloat3(&pos2, p2);
+    XMStoreFloat3(&pos0, v0);
+    XMStoreFloat3(&pos1, v1);
+    XMStoreFloat3(&pos2, v2);
 
     outData.vx0 = pos0.x;
     outData.vy0 = pos0.y;
@@ -612,16 +957,12 @@ bool Terrain::TestRayIntersection(
     outData.rayOrigZ = rayOrig.z;
 
     // store intersection point
-    const XMVECTOR vIntersect = rayOrigW + rayDirW * tmin;
-    XMFLOAT3 intersectP;
-    XMStoreFloat3(&intersectP, vIntersect);
-
-    outData.px = intersectP.x;
-    outData.py = intersectP.y;
-    outData.pz = intersectP.z;
+    outData.px = rayOrig.x + rayDir.x * dist;
+    outData.py = rayOrig.y + rayDir.y * dist;
+    outData.pz = rayOrig.z + rayDir.z * dist;
 
     // store a distance to the intersection point
-    outData.distToIntersect = tmin;
+    outData.distToIntersect = dist;
 
     // store normal vec of intersected triangle
     Vec3 normal = CompNormalVec(pos0, pos1, pos2);
@@ -632,9 +973,6 @@ bool Terrain::TestRayIntersection(
     outData.nx = normal.x;
     outData.ny = normal.y;
     outData.nz = normal.z;
-
-
-    return true;
 }
 
 //---------------------------------------------------------
@@ -649,28 +987,18 @@ void Terrain::Update(
     const Frustum& worldFrustum,
     const float distFogged)
 {
-    const int patchSize         = lodMgr_.patchSize_ - 1;
     const int numPatchesPerSide = lodMgr_.numPatchesPerSide_;
-    int       numVisPatches     = 0;
-
-
-    // go through each patch and test if it is visible
-    int idx = -1;
+    const int numAllPatches     = SQR(numPatchesPerSide);
 
-    for (int pz = 0; pz < numPatchesPerSide; ++pz)
-    {
-        for (int px = 0; px < numPatchesPerSide; ++px)
-        {
-            ++idx;
-
-            // check if we see this patch
-            if (!IsPatchInsideViewFrustum(idx, worldFrustum))
-                continue;
+    // test all the patches at once and store numbers (idxs) of visible ones
+    // so we will render them (idx == pz * numPatchesPerSide + px)
+    visiblePatches_.resize(numAllPatches);
 
-            // store number (idx) of this patch so we will render it
-            visiblePatches_[numVisPatches++] = (pz * numPatchesPerSide) + px;
-        }
-    }
+    const int numVisPatches = CullSpheres(
+        worldFrustum,
+        patchesSpheresSoA_,
+        numAllPatches,
+        visiblePatches_.data());
 
     visiblePatches_.resize(numVisPatches);
     highDetailedPatches_.resize(numVisPatches);
@@ -45,6 +45,7 @@
 #pragma once
 #include <math/math_helpers.h>
 #include <geometry/frustum.h>
+#include <geometry/frustum_culling.h>
 #include <geometry/rect3d.h>
 #include <camera_params.h>
 
@@ -110,6 +111,7 @@ public:
         IntersectionData& outData) const;
 
     void ComputeBoundings();
+    void ComputeHeightMips();
 
 
     // ------------------------------------------
@@ -199,6 +201,36 @@ private:
         const int x,
         const int z);
 
+    bool TestRayHeightBlock(
+        const int blockX,
+        const int blockZ,
+        const int blockSize,
+        const Vec3& rayOrig,
+        const Vec3& rayDir,
+        const float tEnter,
+        const float tExit,
+        float& inOutTMin,
+        int& outCellX,
+        int& outCellZ,
+        int& outTriIdx) const;
+
+    void GetCellTriangle(
+        const int cellX,
+        const int cellZ,
+        const int triIdx,
+        DirectX::XMVECTOR& outV0,
+        DirectX::XMVECTOR& outV1,
+        DirectX::XMVECTOR& outV2) const;
+
+    void FillIntersectionData(
+        const Vec3& rayOrig,
+        const Vec3& rayDir,
+        const float dist,
+        const DirectX::XMVECTOR& v0,
+        const DirectX::XMVECTOR& v1,
+        const DirectX::XMVECTOR& v2,
+        IntersectionData& outData) const;
+
     bool InitBuffers(
         const Vertex3dTerrain* vertices,
         const UINT* indices,
@@ -246,10 +278,26 @@ private:
 
     cvector<Rect3d>  patchesAABBs_;
     cvector<Sphere>  patchesBoundSpheres_;
+    SpheresSoA       patchesSpheresSoA_;        // the same spheres for batch frustum culling
 
     cvector<LodInfo> lodInfo_;
     TerrainLodMgr    lodMgr_;
 
+    // min/max heights mip chain (for ray tests): level 0 - per cell (quad between
+    // 4 neighbour vertices), each next level - per 2x2 nodes of the previous one
+    struct HeightRange
+    {
+        float minH;
+        float maxH;
+    };
+
+    #define MAX_NUM_HEIGHT_MIPS 16
+
+    cvector<HeightRange> heightMips_;
+    int              heightMipOffsets_[MAX_NUM_HEIGHT_MIPS]{0};
+    int              heightMipSizes_[MAX_NUM_HEIGHT_MIPS]{0};     // number of nodes per side
+    int              numHeightMips_ = 0;
+
     cvector<int>     visiblePatches_;
     cvector<int>     highDetailedPatches_;
     cvector<int>     midDetailedPatches_;
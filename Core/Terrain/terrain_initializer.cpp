@@ -97,7 +97,6 @@ bool TerrainInitializer::Init(const char* cfgFilepath)
     // compute terrain's axis-aligned bounding box
     terrain.CalcAABB();
 
-
     LogMsg(LOG, "terrain is created!");
     return true;
 }
@@ -9,6 +9,7 @@
 
 #include <Timers/game_timer.h>
 #include <Render/d3dclass.h>    // for using global pointers to DX11 device and context
+#include <Model/asset_streamer.h>
 #include "ImageReader.h"        // from Image module
 
 
@@ -33,6 +34,7 @@ TextureMgr::TextureMgr()
     names_.reserve(reserve);
     textures_.reserve(reserve);
     shaderResourceViews_.reserve(reserve);
+    idsByNames_.Reserve(reserve);
 }
 
 ///////////////////////////////////////////////////////////
@@ -69,6 +71,73 @@ void TextureMgr::PrintDump() const
 // Public API: initialization/adding/loading/creation
 // =================================================================================
 
+//---------------------------------------------------------
+// Desc:   a texture which is loaded from file during initialization
+//---------------------------------------------------------
+struct TexLoadTask
+{
+    char    name[MAX_LEN_TEX_NAME]{ '\0' };
+    char    path[256]{ '\0' };              // relatively to the working dir
+    Texture tex;
+    float   durationMs = 0;
+    bool    isDeferred = false;             // must be loaded on the owner thread
+};
+
+//---------------------------------------------------------
+// Desc:   check if a texture by input path is loaded using WIC (png/jpg/jpeg);
+//         such textures require the immediate context (for mipmaps generation)
+//         so they can't be loaded by worker threads
+//---------------------------------------------------------
+static bool IsLoadedWithContext(const char* path)
+{
+    const char*  exts[] = { ".png", ".jpg", ".jpeg" };
+    const size_t len    = strlen(path);
+
+    for (const char* ext : exts)
+    {
+        const size_t extLen = strlen(ext);
+
+        if ((len >= extLen) && (strcmp(path + len - extLen, ext) == 0))
+            return true;
+    }
+
+    return false;
+}
+
+//---------------------------------------------------------
+// Desc:   load a texture and measure the duration of loading
+//---------------------------------------------------------
+static void LoadTexTask(TexLoadTask& task)
+{
+    const TimePoint start = GetTimePoint();
+
+    task.tex = Texture(task.path, task.name);
+
+    const TimeDurationMs dur = GetTimePoint() - start;
+    task.durationMs = dur.count();
+}
+
+//---------------------------------------------------------
+// Desc:   load textures in range [start, end) by worker threads;
+//         only the device is used here (it is free-threaded)
+//---------------------------------------------------------
+static void LoadTexturesRange(void* pArgs, const int start, const int end)
+{
+    TexLoadTask* tasks = (TexLoadTask*)pArgs;
+
+    for (int i = start; i < end; ++i)
+    {
+        if (!tasks[i].isDeferred)
+            LoadTexTask(tasks[i]);
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   load all the textures from the config file:
+//         1. read in the list of textures
+//         2. load (read/decode/create resources) in parallel
+//         3. register textures in order of the list (so IDs are deterministic)
+//---------------------------------------------------------
 bool TextureMgr::Init(const char* texturesCfg)
 {
     assert(texturesCfg && texturesCfg[0] != '\0');
@@ -81,6 +150,7 @@ bool TextureMgr::Init(const char* texturesCfg)
     int count = 0;
     int texCountInit = 0;
     int texCountAll = 0;
+    cvector<TexLoadTask> tasks;
     
 
     SetConsoleColor(YELLOW);
@@ -114,10 +184,10 @@ bool TextureMgr::Init(const char* texturesCfg)
     }
 
 
-    // load textures
+    // read in the list of textures
     while (!feof(pFile) && fgets(buf, sizeof(buf), pFile) && buf[0] != '}')
     {
-        count = sscanf(buf, " %s %s", name, path);
+        count = sscanf(buf, " %31s %127s", name, path);
         if (count != 2)
         {
             LogErr(LOG, "can't read in a texture from: %s", texturesCfg);
@@ -125,25 +195,60 @@ bool TextureMgr::Init(const char* texturesCfg)
             exit(0);
         }
 
-        if (!IsTexNameUnique(name))
+        printf("\tname: %-32s  path: %s\n", name, path);
+
+        tasks.push_back(TexLoadTask());
+        TexLoadTask& task = tasks.back();
+
+        // create a full path to the texture (relatively to the project working directory)
+        strcpy(task.name, name);
+        snprintf(task.path, sizeof(task.path), "%s%s", g_RelPathTexDir, path);
+
+        task.isDeferred = IsLoadedWithContext(task.path);
+    }
+
+    fclose(pFile);
+
+
+    // if streaming is enabled we only create records of textures:
+    // texels are loaded on demand (look at AssetStreamer)
+    const bool isStreamed = g_AssetStreamer.IsEnabled();
+
+    // load textures in parallel (except of ones which require the context)
+    if (!isStreamed)
+        g_JobSystem.ParallelFor((int)tasks.size(), 1, LoadTexturesRange, tasks.data());
+
+    const TimeDurationMs parallelDur = GetTimePoint() - start;
+
+
+    // load the rest of textures and register all of them in order of the list
+    for (TexLoadTask& task : tasks)
+    {
+        if (!IsTexNameUnique(task.name))
         {
-            LogErr(LOG, "there is already a texture with name: %s", name);
+            LogErr(LOG, "there is already a texture with name: %s", task.name);
             PrintDump();
             exit(0);
         }
 
-        printf("\tname: %-32s  path: %s\n", name, path);
+        if (task.isDeferred && !isStreamed)
+            LoadTexTask(task);
 
+        const TexID id = Add(task.name, std::move(task.tex));
 
-        // create a full path to the texture (relatively to the project working directory)
-        memset(g_String, 0, LOG_BUF_SIZE);
-        strcat(g_String, g_RelPathTexDir);
-        strcat(g_String, path);
+        if (id != INVALID_TEX_ID)
+        {
+            // not loaded texture uses a view of the "unloaded" one until it is streamed
+            if (isStreamed)
+                UnloadTexture(id);
 
-        if (LoadFromFile(name, g_String))
+            g_AssetStreamer.RegisterTexture(id, task.path, !isStreamed);
             texCountInit++;
+        }
 
         texCountAll++;
+
+        LogMsg("texture loaded: %-32s (%.3f ms)", task.name, task.durationMs);
     }
 
     const TimeDurationMs dur = GetTimePoint() - start;
@@ -152,10 +257,10 @@ bool TextureMgr::Init(const char* texturesCfg)
     LogMsg("--------------------------------------");
     LogMsg("Init: %d / %d textures", texCountInit, texCountAll);
     LogMsg("Init of textures took: %.3f ms", dur.count());
+    LogMsg("  parallel loading:    %.3f ms", parallelDur.count());
     LogMsg("--------------------------------------\n");
     SetConsoleColor(RESET);
 
-    fclose(pFile);
     return true;
 }
 
@@ -171,13 +276,7 @@ bool TextureMgr::IsTexNameUnique(const char* texName) const
         return false;
     }
 
-    bool bUnique = true;
-
-    // check all the names
-    for (const std::string& name : names_)
-    {
-        bUnique &= (strcmp(name.c_str(), texName) != 0);
-    }
+    const bool bUnique = (FindIdxByName(texName) == -1);
 
     return bUnique;
 }
@@ -414,7 +513,7 @@ void TextureMgr::SetTexName(const TexID id, const char* inName)
     sz = (sz > MAX_LEN_TEX_NAME) ? MAX_LEN_TEX_NAME : sz;  
 
     // update name
-    names_[idx] = inName;
+    SetNameByIdx(idx, inName);
     textures_[idx].SetName(inName);
 }
 
@@ -445,6 +544,7 @@ TexID TextureMgr::Add(const char* name, Texture&& tex)
     // store texture into the manager
     ids_.push_back(id);
     names_.push_back(name);
+    idsByNames_.Insert(HashStr(names_.back().c_str()), id);
     textures_.push_back(std::move(tex));
     shaderResourceViews_.push_back(textures_.back().GetResourceView());
 
@@ -484,12 +584,51 @@ TexID TextureMgr::LoadFromFile(const char* name, const char* path)
     // store texture into the manager
     ids_.push_back(id);
     names_.push_back(name);
+    idsByNames_.Insert(HashStr(names_.back().c_str()), id);
     textures_.push_back(std::move(tex));
     shaderResourceViews_.push_back(textures_.back().GetResourceView());
         
     return id;	
 }
 
+//---------------------------------------------------------
+// Desc:   release GPU resources of the texture by id; its shader resource view
+//         is replaced with the view of the "unloaded" texture (placeholder)
+//---------------------------------------------------------
+void TextureMgr::UnloadTexture(const TexID id)
+{
+    const index idx = ids_.get_idx(id);
+
+    if (!ids_.is_valid_index(idx) || (id == INVALID_TEX_ID))
+    {
+        LogErr(LOG, "can't unload texture by id: %" PRIu32, id);
+        return;
+    }
+
+    textures_[idx].Release();
+    textures_[idx].SetName(names_[idx].c_str());
+    shaderResourceViews_[idx] = shaderResourceViews_[INVALID_TEX_ID];
+}
+
+//---------------------------------------------------------
+// Desc:   replace data of the texture by id with input texture
+//         (the name of the texture is kept)
+//---------------------------------------------------------
+void TextureMgr::ReplaceTexture(const TexID id, Texture&& tex)
+{
+    const index idx = ids_.get_idx(id);
+
+    if (!ids_.is_valid_index(idx) || (id == INVALID_TEX_ID))
+    {
+        LogErr(LOG, "can't replace texture by id: %" PRIu32, id);
+        return;
+    }
+
+    textures_[idx] = std::move(tex);
+    textures_[idx].SetName(names_[idx].c_str());
+    shaderResourceViews_[idx] = textures_[idx].GetResourceView();
+}
+
 //---------------------------------------------------------
 // Desc:   reinit a texture object by id with a new texture resource
 //         (load another texture from file)
@@ -527,7 +666,7 @@ bool TextureMgr::ReloadFromFile(const TexID id, const char* path)
     tex.SetName(name);
 
     // update data
-    names_[idx] = name;
+    SetNameByIdx(idx, name);
     shaderResourceViews_[idx] = tex.GetResourceView();
 
     return true;
@@ -561,6 +700,7 @@ TexID TextureMgr::CreateCubeMap(const char* name, const CubeMapInitParams& param
     // store cubemap into the manager
     ids_.push_back(id);
     names_.push_back(name);
+    idsByNames_.Insert(HashStr(names_.back().c_str()), id);
     textures_.push_back(std::move(cubeMap));
     shaderResourceViews_.push_back(textures_.back().GetResourceView());
 
@@ -596,6 +736,7 @@ TexID TextureMgr::LoadTextureArray(
         // store texture into the manager
         ids_.push_back(id);
         names_.push_back(texArr.GetName());
+        idsByNames_.Insert(HashStr(names_.back().c_str()), id);
         shaderResourceViews_.push_back(texArr.GetResourceView());
         textures_.push_back(std::move(texArr));
 
@@ -639,7 +780,7 @@ Texture* TextureMgr::GetTexPtrByName(const char* name)
         return &textures_[INVALID_TEX_ID];
     }
 
-    const index idx = names_.find(name);
+    const index idx = FindIdxByName(name);
 
     if (textures_.is_valid_index(idx))
         return &textures_[idx];
@@ -659,15 +800,45 @@ TexID TextureMgr::GetTexIdByName(const char* name)
         return INVALID_TEX_ID;
     }
 
-    for (index i = 0; i < names_.size(); ++i)
-    {
-        if (strcmp(names_[i].c_str(), name) == 0)
-            return ids_[i];
-    }
+    const index idx = FindIdxByName(name);
+
+    if (idx != -1)
+        return ids_[idx];
 
     return INVALID_TEX_ID;
 }
 
+//---------------------------------------------------------
+// Desc:   find an idx of texture by input name using the hash index
+// Ret:    idx or -1 if there is no such a name
+//---------------------------------------------------------
+index TextureMgr::FindIdxByName(const char* name) const
+{
+    TexID id = INVALID_TEX_ID;
+
+    auto isEqual = [this, name](const TexID texId)
+    {
+        return strcmp(names_[ids_.get_idx(texId)].c_str(), name) == 0;
+    };
+
+    if (!idsByNames_.Find(HashStr(name), isEqual, id))
+        return -1;
+
+    return ids_.get_idx(id);
+}
+
+//---------------------------------------------------------
+// Desc:   change a name of texture by idx (and update the hash index)
+//---------------------------------------------------------
+void TextureMgr::SetNameByIdx(const index idx, const char* name)
+{
+    const TexID id = ids_[idx];
+
+    idsByNames_.Erase(HashStr(names_[idx].c_str()), id);
+    names_[idx] = name;
+    idsByNames_.Insert(HashStr(name), id);
+}
+
 //---------------------------------------------------------
 // Desc:    get SRV (shader resource view) of each input texture by its ID
 // Args:    - texIds:  textures identifiers
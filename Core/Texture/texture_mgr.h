@@ -12,6 +12,7 @@
 #include "texture.h"
 
 #include <cvector.h>
+#include <str_hash_index.h>
 #include <d3d11.h>
 #include <string>
 
@@ -68,6 +69,11 @@ public:
     TexID       LoadFromFile   (const char* name, const char* path);
     TexID       CreateCubeMap  (const char* name, const CubeMapInitParams& params);
     TexID       CreateWithColor(const Color& textureColor);
+
+    // streaming: texture data is released/replaced while its ID and name are kept
+    // (while unloaded the view of the "unloaded" texture (id: 0) is used instead)
+    void        UnloadTexture  (const TexID id);
+    void        ReplaceTexture (const TexID id, Texture&& tex);
     
 	// getters...
     Texture&    GetTexById     (const TexID id);
@@ -95,8 +101,10 @@ public:
 
 	
 private:
-    int  GenId          (void);
-    bool IsTexNameUnique(const char* texName) const;
+    int   GenId          (void);
+    bool  IsTexNameUnique(const char* texName) const;
+    index FindIdxByName  (const char* name) const;
+    void  SetNameByIdx   (const index idx, const char* name);
 
 private:
     static TexID         lastTexID_;
@@ -104,6 +112,7 @@ private:
     cvector<TexID>       ids_;                 // SORTED array of unique IDs
     cvector<SRV*>        shaderResourceViews_;
     cvector<std::string> names_;               // name which is used for searching of texture
+    StrHashIndex         idsByNames_;          // hash index [name => texture ID]
     cvector<Texture>     textures_;
 
 
@@ -438,6 +438,10 @@ void TextStore::UpdateDynDbgText(const Core::SystemState& sysState)
     UpdateStrByKey("rnd_tris",        "%u", sysState.numDrawnAllTris);
     UpdateStrByKey("rnd_inst",        "%u", sysState.numDrawnEnttsInstances);
     UpdateStrByKey("inst_draw_calls", "%u", sysState.numDrawCallsEnttsInstances);
+    UpdateStrByKey("items_reused",    "%u", sysState.numReusedRenderItems);
+    UpdateStrByKey("items_rebuilt",   "%u", sysState.numRebuiltRenderItems);
+    UpdateStrByKey("rnd_grass_inst",  "%u", sysState.numDrawnGrassInstances);
+    UpdateStrByKey("grass_mem",       "%uKB", sysState.grassResidentMemKB);
 
     // lights info
     UpdateStrByKey("num_vis_pointL", "%u", sysState.numVisiblePointLights);
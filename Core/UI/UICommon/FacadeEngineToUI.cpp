@@ -1521,6 +1521,8 @@ bool FacadeEngineToUI::SetMaterialRenderState(const RenderStateSetup& params)
             return false;
     }
 
+    // render group and batches of entities with this material may be changed
+    pGraphics_->InvalidateRenderList();
     return true;
 }
 
@@ -1553,6 +1555,7 @@ bool FacadeEngineToUI::SetMaterialTexture(
     const TexID texId,
     const uint texType) const
 {
+    pGraphics_->InvalidateRenderList();
     return g_MaterialMgr.SetMatTexture(matId, texId, texType);
 }
 
@@ -1566,6 +1569,7 @@ bool FacadeEngineToUI::SetMaterialColorData(
     const Vec4& spec,          // specular = vec3(specular_color) + float(specular_power)
     const Vec4& refl)          // reflect
 {
+    pGraphics_->InvalidateRenderList();
     return g_MaterialMgr.SetMatColorData(id, amb, diff, spec, refl);
 }
 
@@ -1647,6 +1651,7 @@ bool FacadeEngineToUI::SetEnttMaterial(
     const MaterialID matId)
 {
     pEnttMgr_->materialSys_.SetMaterial(enttId, subsetId, matId);
+    pGraphics_->InvalidateRenderList();
     return true;
 }
 
@@ -1978,6 +1983,7 @@ bool FacadeEngineToUI::SetMaterialShaderId(
     Material& mat = g_MaterialMgr.GetMatById(matId);
     mat.shaderId = shaderId;
 
+    pGraphics_->InvalidateRenderList();
     return true;
 }
 
@@ -6,9 +6,35 @@
 // *********************************************************************************
 #pragma once
 
+#include <Types.h>
+
 namespace ECS
 {
 
+//---------------------------------------------------------
+// entity ID is packed as: [ generation (8 bits) | index (24 bits) ];
+// when entity is destroyed its index can be reused by a new entity but with
+// the next generation, so old (stale) IDs don't match the new entity
+//---------------------------------------------------------
+constexpr int      ENTT_ID_INDEX_BITS = 24;
+constexpr EntityID ENTT_ID_INDEX_MASK = (1u << ENTT_ID_INDEX_BITS) - 1;
+constexpr uint32   ENTT_ID_MAX_GEN    = (1u << (32 - ENTT_ID_INDEX_BITS)) - 1;
+
+inline uint32 GetEnttIndex(const EntityID id)
+{
+    return id & ENTT_ID_INDEX_MASK;
+}
+
+inline uint32 GetEnttGeneration(const EntityID id)
+{
+    return id >> ENTT_ID_INDEX_BITS;
+}
+
+inline EntityID MakeEnttID(const uint32 enttIdx, const uint32 generation)
+{
+    return (generation << ENTT_ID_INDEX_BITS) | (enttIdx & ENTT_ID_INDEX_MASK);
+}
+
 
 // for detailed (I hope) description of each component
 // you need to look for responsible component's header file
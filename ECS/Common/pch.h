@@ -16,6 +16,8 @@
 #include "mem_helpers.h"
 #include "StrHelper.h"
 #include "cvector.h"
+#include "scratch_arena.h"
+#include "job_system.h"
 #include "types.h"
 #include "UtilsFilesystem.h"
 #include "ECSTypes.h"
@@ -0,0 +1,246 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: sparse_set.h
+
+    Desc:     a sparse set of entities IDs which is shared by ECS components:
+              - dense part:  packed array of IDs (parallel to component's data arrays);
+              - sparse part: paged table [entity_index => dense_idx]
+
+              so search of record by ID is O(1), and adding of a new record
+              is just a push back into the dense arrays (no sorted insertion)
+
+              the sparse table is addressed by the index part of ID (without
+              generation) while the dense array stores full IDs, so a stale ID
+              of destroyed entity never matches a record of a new one
+
+              NOTE: if there is no record by ID we return index 0 since
+                    by convention components keep an "invalid" record by this idx
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include "ECSTypes.h"
+#include <cvector.h>
+#include <assert.h>
+
+
+namespace ECS
+{
+
+//---------------------------------------------------------
+// constants for paging of the sparse table
+//---------------------------------------------------------
+constexpr int SPARSE_PAGE_SHIFT = 10;
+constexpr int SPARSE_PAGE_SIZE  = 1 << SPARSE_PAGE_SHIFT;     // 1024 slots per page
+constexpr int SPARSE_PAGE_MASK  = SPARSE_PAGE_SIZE - 1;
+
+
+//---------------------------------------------------------
+// Class name:  SparseSet
+//---------------------------------------------------------
+class SparseSet
+{
+public:
+    SparseSet() {}
+
+    // dense part (array of IDs)
+    inline EntityID        operator[](const index i)     const { return dense_[i]; }
+    inline const EntityID* data()                        const { return dense_.data(); }
+    inline const EntityID* begin()                       const { return dense_.begin(); }
+    inline const EntityID* end()                         const { return dense_.end(); }
+    inline EntityID        back()                        const { return dense_.back(); }
+    inline vsize           size()                        const { return dense_.size(); }
+    inline bool            empty()                       const { return dense_.empty(); }
+    inline bool            is_valid_index(const index i) const { return dense_.is_valid_index(i); }
+    inline void            reserve(const vsize capacity)       { dense_.reserve(capacity); }
+
+    inline const cvector<EntityID>& dense()              const { return dense_; }
+
+    // search
+    bool  has     (const EntityID id) const;
+    bool  has_any (const EntityID* ids, const vsize numIds) const;
+    index get_idx (const EntityID id) const;
+    void  get_idxs(const EntityID* ids, const vsize numIds, cvector<index>& outIdxs) const;
+    void  get_idxs(const cvector<EntityID>& ids, cvector<index>& outIdxs) const;
+
+    // add a new record (at the end of the dense array)
+    index push_back(const EntityID id);
+
+    // remove a record (the last record is moved into its place)
+    index swap_remove(const EntityID id);
+
+    // move records [middle, last) in front of records [first, middle)
+    // (the same as std::rotate, so the caller can rotate its data arrays)
+    void  rotate(const index first, const index middle, const index last);
+
+private:
+    uint32 get_slot(const EntityID id) const;
+
+private:
+    cvector<EntityID>        dense_;
+    cvector<cvector<uint32>> pages_;      // each slot stores (dense_idx + 1), so 0 means "empty"
+};
+
+
+//==================================================================================
+// inline functions
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:  get a value from the sparse table by input ID or 0 if there is no such
+//---------------------------------------------------------
+inline uint32 SparseSet::get_slot(const EntityID id) const
+{
+    const uint32 enttIdx = GetEnttIndex(id);
+    const vsize  page    = (vsize)(enttIdx >> SPARSE_PAGE_SHIFT);
+
+    if (page >= pages_.size() || pages_[page].empty())
+        return 0;
+
+    return pages_[page][enttIdx & SPARSE_PAGE_MASK];
+}
+
+//---------------------------------------------------------
+// Desc:  check if we have a record by input ID
+//---------------------------------------------------------
+inline bool SparseSet::has(const EntityID id) const
+{
+    const uint32 slot = get_slot(id);
+    return (slot != 0) && (dense_[slot - 1] == id);
+}
+
+//---------------------------------------------------------
+// Desc:  check if we have a record by ANY of input IDs
+//---------------------------------------------------------
+inline bool SparseSet::has_any(const EntityID* ids, const vsize numIds) const
+{
+    assert(ids && numIds >= 0);
+
+    bool hasAny = false;
+
+    for (index i = 0; i < numIds; ++i)
+        hasAny |= has(ids[i]);
+
+    return hasAny;
+}
+
+//---------------------------------------------------------
+// Desc:  get an index into the dense array by input ID;
+//        or return 0 if there is no record by such ID
+//---------------------------------------------------------
+inline index SparseSet::get_idx(const EntityID id) const
+{
+    const uint32 slot = get_slot(id);
+
+    if ((slot != 0) && (dense_[slot - 1] == id))
+        return (index)(slot - 1);
+
+    return 0;
+}
+
+//---------------------------------------------------------
+// Desc:  get an index into the dense array for each input ID
+//        (0 for IDs which don't have any record)
+//---------------------------------------------------------
+inline void SparseSet::get_idxs(
+    const EntityID* ids,
+    const vsize numIds,
+    cvector<index>& outIdxs) const
+{
+    assert(ids && numIds >= 0);
+
+    outIdxs.resize(numIds);
+
+    for (index i = 0; i < numIds; ++i)
+        outIdxs[i] = get_idx(ids[i]);
+}
+
+inline void SparseSet::get_idxs(const cvector<EntityID>& ids, cvector<index>& outIdxs) const
+{
+    get_idxs(ids.data(), ids.size(), outIdxs);
+}
+
+//---------------------------------------------------------
+// Desc:  add a new ID at the end of the dense array and map it in the sparse table
+// Ret:   index of the new record in the dense array
+//---------------------------------------------------------
+inline index SparseSet::push_back(const EntityID id)
+{
+    // NOTE: checking slot (not has()) also catches a record of an older generation
+    assert(get_slot(id) == 0 && "there is already a record by such entity index");
+
+    const uint32 enttIdx = GetEnttIndex(id);
+    const vsize  page    = (vsize)(enttIdx >> SPARSE_PAGE_SHIFT);
+
+    // alloc pages lazily (so a big ID doesn't cost us memory for all the smaller ones)
+    if (page >= pages_.size())
+        pages_.resize(page + 1);
+
+    if (pages_[page].empty())
+        pages_[page].resize(SPARSE_PAGE_SIZE, 0);
+
+    const index idx = dense_.size();
+    dense_.push_back(id);
+    pages_[page][enttIdx & SPARSE_PAGE_MASK] = (uint32)(idx + 1);
+
+    return idx;
+}
+
+//---------------------------------------------------------
+// Desc:  remove a record by ID: the last record of the dense array
+//        is moved into the place of removed one
+// Ret:   index of the removed record (so the caller has to do the same
+//        "swap and pop" for its data arrays) or -1 if there is no such record
+//---------------------------------------------------------
+inline index SparseSet::swap_remove(const EntityID id)
+{
+    if (!has(id))
+        return -1;
+
+    const index    idx      = (index)(get_slot(id) - 1);
+    const index    last     = dense_.size() - 1;
+    const EntityID lastId   = dense_[last];
+    const uint32   enttIdx  = GetEnttIndex(id);
+    const uint32   lastIdx  = GetEnttIndex(lastId);
+
+    // move the last record into the place of removed one
+    dense_[idx] = lastId;
+    pages_[lastIdx >> SPARSE_PAGE_SHIFT][lastIdx & SPARSE_PAGE_MASK] = (uint32)(idx + 1);
+
+    // unmap removed ID
+    pages_[enttIdx >> SPARSE_PAGE_SHIFT][enttIdx & SPARSE_PAGE_MASK] = 0;
+    dense_.pop_back();
+
+    return idx;
+}
+
+//---------------------------------------------------------
+// Desc:  rotate a range of the dense array so the element by idx "middle"
+//        becomes the first one, and remap all the moved IDs
+//---------------------------------------------------------
+inline void SparseSet::rotate(const index first, const index middle, const index last)
+{
+    assert(0 <= first && first <= middle && middle <= last && last <= dense_.size());
+
+    if (first == middle || middle == last)
+        return;
+
+    std::rotate(dense_.begin() + first, dense_.begin() + middle, dense_.begin() + last);
+
+    for (index i = first; i < last; ++i)
+    {
+        const uint32 enttIdx = GetEnttIndex(dense_[i]);
+        pages_[enttIdx >> SPARSE_PAGE_SHIFT][enttIdx & SPARSE_PAGE_MASK] = (uint32)(i + 1);
+    }
+}
+
+} // namespace ECS
@@ -9,6 +9,7 @@
 #include <types.h>
 #include <cvector.h>
 #include <DirectXCollision.h>
+#include "../Common/sparse_set.h"
 
 namespace ECS
 {
@@ -53,7 +54,7 @@ struct Bounding
         data.push_back(BoundData());
     }
 
-    cvector<EntityID>  ids;
+    SparseSet          ids;
     cvector<BoundData> data;
 };
 
@@ -3,40 +3,40 @@
 // Description:  ECS component to hold entities hierarchy data:
 //               entity can have only one "parent" and have multiple "children"
 //
+//               records are stored in depth-first order: each entity is followed
+//               by all of its descendants, so a subtree of record by idx is
+//               a contiguous range [idx, idx + subtreeSizes[idx])
+//
 // Created:      24.04.2025 by DimaSkup
 // =================================================================================
 #pragma once
 
 #include <Types.h>
-#include <map>
-#include <set>
+#include <cvector.h>
 #include <DirectXMath.h>
+#include "../Common/sparse_set.h"
 
 namespace ECS
 {
 
-struct HierarchyNode
-{
-    HierarchyNode() {}
-
-    EntityID parentID = 0;
-    std::set<EntityID> children{};
-
-    // position of entity relatively to its parent (offset from parent to child)
-    DirectX::XMFLOAT3 relativePos{0,0,0};
-};
-
-///////////////////////////////////////////////////////////
-
 // ECS component
 struct Hierarchy
 {
     Hierarchy()
     {
-        data.emplace(0, HierarchyNode());
+        // add invalid data; this data is returned when we ask for wrong entity
+        ids.push_back(INVALID_ENTT_ID);
+        parentIds.push_back(INVALID_ENTT_ID);
+        subtreeSizes.push_back(1);
+        relativePos.push_back({ 0,0,0 });
     }
 
-    std::map<EntityID, HierarchyNode> data;
+    SparseSet                  ids;             // entities in depth-first order
+    cvector<EntityID>          parentIds;       // INVALID_ENTT_ID for roots
+    cvector<int>               subtreeSizes;    // number of records in subtree (including the entity itself)
+
+    // position of entity relatively to its parent (offset from parent to child)
+    cvector<DirectX::XMFLOAT3> relativePos;
 };
 
 } // namespace ECS
@@ -8,6 +8,7 @@
 
 #include <cvector.h>
 #include <Types.h>
+#include "../Common/sparse_set.h"
 
 namespace ECS
 {
@@ -19,7 +20,7 @@ struct InventoryData
 
 struct Inventory
 {
-    cvector<EntityID>      ownersIds;
+    SparseSet              ownersIds;
     cvector<InventoryData> inventories;
 };
 
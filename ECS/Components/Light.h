@@ -9,6 +9,7 @@
 #include "../Common/ECSTypes.h"
 #include <Types.h>
 #include <cvector.h>
+#include "../Common/sparse_set.h"
 #include <DirectXMath.h>
 
 
@@ -207,19 +208,19 @@ struct SpotLight
 
 __declspec(align(16)) struct DirLights
 {
-    cvector<EntityID> ids;
+    SparseSet         ids;
     cvector<DirLight> data;
 };
 
 __declspec(align(16)) struct PointLights
 {
-    cvector<EntityID> ids;
+    SparseSet           ids;
     cvector<PointLight> data;
 };
 
 __declspec(align(16)) struct SpotLights
 {
-    cvector<EntityID> ids;
+    SparseSet          ids;
     cvector<SpotLight> data;
 };
 
@@ -238,7 +239,7 @@ __declspec(align(16)) struct PosAndRange
 
 struct Light
 {
-    cvector<EntityID>   ids;
+    SparseSet           ids;
     cvector<LightType>  types;
     cvector<bool>       isActive;
     DirLights           dirLights;
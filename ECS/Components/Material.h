@@ -11,6 +11,7 @@
 
 #include <Types.h>
 #include <cvector.h>
+#include "../Common/sparse_set.h"
 
 namespace ECS
 {
@@ -39,7 +40,7 @@ struct MaterialData
 //---------------------------------------------------------
 struct Material
 {
-    cvector<EntityID>     enttsIds;
+    SparseSet             enttsIds;
     cvector<MaterialData> data;
 };
 
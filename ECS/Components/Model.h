@@ -9,13 +9,14 @@
 
 #include <Types.h>
 #include <cvector.h>
+#include "../Common/sparse_set.h"
 
 namespace ECS
 {
 
 struct Model
 {
-    cvector<EntityID> enttsIDs_;   // primary keys (can have only unique values)
+    SparseSet         enttsIDs_;   // primary keys (can have only unique values)
     cvector<ModelID>  modelIDs_;   // there can be multiple the same values
 };
 
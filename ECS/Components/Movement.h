@@ -8,6 +8,7 @@
 
 #include <types.h>
 #include <cvector.h>
+#include "../Common/sparse_set.h"
 #include <DirectXMath.h>
 
 namespace ECS
@@ -15,7 +16,7 @@ namespace ECS
 
 struct Movement
 {
-	cvector<EntityID> ids_;                              // entities IDs
+	SparseSet                  ids_;                     // entities IDs
 	cvector<DirectX::XMFLOAT4> translationAndUniScales_; // translation (x,y,z); uniform scale (w)
 	cvector<DirectX::XMVECTOR> rotationQuats_;           // rotation quatertion {0, pitch, yaw, roll}
 };
@@ -9,6 +9,8 @@
 #include <types.h>
 #include <cvector.h>
 #include <string>
+#include <str_hash_index.h>
+#include "../Common/sparse_set.h"
 
 namespace ECS
 {
@@ -24,8 +26,11 @@ struct Name
 
 	// both vectors have the same length because 
 	// there is one to one records ['entity_id' => 'entity_name']
-	cvector<EntityID> ids_;
+	SparseSet            ids_;
 	cvector<std::string> names_;
+
+	// hash index [name => entity ID] for search by name
+	StrHashIndex         idsByNames_;
 };
 
 }
@@ -8,6 +8,7 @@
 
 #include <Types.h>
 #include <cvector.h>
+#include "../Common/sparse_set.h"
 #include <DirectXMath.h>
 
 
@@ -55,6 +56,7 @@ enum eEmitterPropType : uint8
     EMITTER_VEL_INIT_MAG,                   // velocity init magnitude
 
     EMITTER_SPAWN_RATE,
+    EMITTER_MAX_PARTICLES,                  // capacity of the particles pool
     EMITTER_PARTICLE_LIFETIME_SEC,
     EMITTER_PARTICLE_START_COLOR,
     EMITTER_PARTICLE_END_COLOR,
@@ -80,20 +82,68 @@ enum eEmitterPropType : uint8
 
 //---------------------------------------------------------
 
-struct Particle
+// particles are updated by blocks of this size (one SIMD register of floats)
+constexpr vsize PARTICLES_BLOCK_SIZE = 4;
+
+//---------------------------------------------------------
+// alive particles of a single emitter (structure of arrays):
+// each attribute is stored in its own array so the update kernel processes
+// a block of particles at once; arrays are padded up to the multiple of block
+// size (padding particles are never rendered);
+//
+// memory is allocated once for a fixed number of particles (pool) so spawning
+// never causes reallocations; alive particles are always packed in [0, count)
+// so a new particle is just taken from the tail;
+//
+// color, alpha, size, and texture coords aren't stored: they depend on age
+// only so they are computed right when we write render instances
+//---------------------------------------------------------
+struct ParticlesSoA
 {
-    DirectX::XMVECTOR pos   = { 0,0,0 };    // current position: this is the particle's current position in 2D/3D space
-    DirectX::XMVECTOR vel   = { 1,1,1 };    // velocity: this is the particle's direction and speed
-    DirectX::XMFLOAT3 color = { 1,1,1 };    // the current color of the particle (RGB triplet)
-    DirectX::XMFLOAT2 size  = { 1,1 };      // particle's visual size by X and Y in world
-
-    // uv0, uv1 - are used for texture animation (if anim is disabled then these values are remains default)
-    DirectX::XMFLOAT2 uv0   = { 0,0 };      // texture coords: upper left
-    DirectX::XMFLOAT2 uv1   = { 1,1 };      // texture coords: bottom right
-    int frameRandOffset = 0;
-
-    float alpha = 0;                        // current alpha value (transparency) of the particle
-    float ageMs = 0;                        // how long the particle will live
+    // alloc memory for the pool (it can only grow)
+    void reserve(const vsize newCapacity)
+    {
+        const vsize paddedSize = (newCapacity + PARTICLES_BLOCK_SIZE - 1) & ~(PARTICLES_BLOCK_SIZE - 1);
+
+        if (paddedSize <= capacity)
+            return;
+
+        posX.resize(paddedSize);
+        posY.resize(paddedSize);
+        posZ.resize(paddedSize);
+        velX.resize(paddedSize);
+        velY.resize(paddedSize);
+        velZ.resize(paddedSize);
+        age.resize(paddedSize);
+        frameRandOffset.resize(paddedSize);
+        isReflected.resize(paddedSize);
+
+        capacity = paddedSize;
+    }
+
+    inline void resize(const vsize newSize)
+    {
+        assert(newSize >= 0 && newSize <= capacity);
+        count = newSize;
+    }
+
+    inline vsize size()        const { return count; }
+    inline vsize GetCapacity() const { return capacity; }
+    inline vsize GetNumFree()  const { return capacity - count; }
+    inline bool  empty()       const { return count == 0; }
+
+    inline DirectX::XMFLOAT3 GetPos(const index i) const
+    {
+        return { posX[i], posY[i], posZ[i] };
+    }
+
+    cvector<float> posX, posY, posZ;        // current position
+    cvector<float> velX, velY, velZ;        // velocity: direction and speed
+    cvector<float> age;                     // how long the particle will live (in seconds)
+    cvector<int>   frameRandOffset;         // random offset of texture animation frame
+    cvector<uint8> isReflected;             // particle hit its emitter's bounding box (if hit event is REFLECT)
+    vsize          count    = 0;            // number of alive particles
+    vsize          capacity = 0;            // max number of particles in the pool
 };
 
 //-----------------------------------------------
@@ -129,10 +179,10 @@ struct ParticlesRenderData
 
 struct EmitterData
 {
-     MaterialID       materialId = INVALID_MAT_ID;
+    MaterialID        materialId = INVALID_MAT_ID;
 
     // alive particles
-    cvector<Particle> particles;                            
+    ParticlesSoA      particles;
 
     // initial values for each particles of this emitter
     DirectX::XMVECTOR position          = { 0,0,0 };
@@ -150,6 +200,7 @@ struct EmitterData
     float             mass              = 1.0f;             // mass of particle
     float             size              = 0.1f;             // size of particle in world
     float             time              = 0.0f;             // need for particles generation (to be independent from fps)
+    float             pendingTime       = 0.0f;             // time since the last update of particles (emitters out of view are updated by turn)
     float             startAlpha        = 1.0f;
     float             endAlpha          = 0.0f;
     float             texAnimDurationSec = 0.0f;            // duration of the texture animation (in seconds)
@@ -158,7 +209,9 @@ struct EmitterData
 
     int               spawnRate  = 0;                       // number of particles generated per 1 second
     int               numSpawned = 0;
+    int               maxParticles = 0;                     // capacity of particles pool (if 0 it is computed by spawn rate and lifetime)
     bool              isActive = true;
+    bool              isVisible = false;                    // is in the list of visible emitters during the last update
 
     bool              hasTexAnimations = false;
     uint8             numTexFramesByX = 1;
@@ -181,7 +234,7 @@ struct ParticleEmitter
         data.push_back(EmitterData());
     }
 
-    cvector<EntityID>    ids;
+    SparseSet            ids;
     cvector<EmitterData> data;
 };
 
@@ -8,13 +8,14 @@
 
 #include <types.h>
 #include <cvector.h>
+#include "../Common/sparse_set.h"
 
 namespace ECS
 {
 
 struct Rendered
 {
-    cvector<EntityID> ids;                    // renderable entities (can be visible)
+    SparseSet         ids;                    // renderable entities (can be visible)
     cvector<EntityID> visibleEnttsIDs;        // currently visible entts (models) for this frame
     cvector<EntityID> visiblePointLightsIDs;  // currently visible point light sources
 };
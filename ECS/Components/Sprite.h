@@ -16,6 +16,7 @@
 #pragma once
 
 #include <types.h>
+#include "../Common/sparse_set.h"
 
 namespace ECS
 {
@@ -41,7 +42,7 @@ struct Sprite
         data.push_back(SpriteData());
     }
 
-    cvector<EntityID>   ids;
+    SparseSet           ids;
     cvector<SpriteData> data;
 };
 
@@ -9,10 +9,22 @@
 #include <Types.h>
 #include <cvector.h>
 #include <DirectXMath.h>
+#include "../Common/sparse_set.h"
 
 namespace ECS
 {
 
+// what must be recomputed for a changed transform
+enum eTransformDirtyFlags : uint8
+{
+    TRANSFORM_DIRTY_INV_WORLD = (1 << 0),   // inverse world matrix
+    TRANSFORM_DIRTY_BOUNDS    = (1 << 1),   // world bounding shapes (and related data)
+
+    TRANSFORM_DIRTY_ALL       = TRANSFORM_DIRTY_INV_WORLD | TRANSFORM_DIRTY_BOUNDS,
+};
+
+///////////////////////////////////////////////////////////
+
 __declspec(align(16)) struct Transform
 {
     Transform()
@@ -28,14 +40,20 @@ __declspec(align(16)) struct Transform
 
         worlds.push_back(nanMatrix);
         invWorlds.push_back(nanMatrix);
+        dirtyFlags.push_back(0);
     }
 
 
-    cvector<EntityID> ids;
+    SparseSet                  ids;
     cvector<DirectX::XMMATRIX> worlds;
     cvector<DirectX::XMMATRIX> invWorlds;    // inverse world matrices
     cvector<DirectX::XMFLOAT4> posAndScale;  // pos (x,y,z); uniform scale (w)
     cvector<DirectX::XMVECTOR> directions;   // normalized direction vector
+    cvector<uint8>             dirtyFlags;   // what must be recomputed (see eTransformDirtyFlags)
+
+    // entities which were changed since the last update of dirty transforms
+    // (an entity is added only once: when it becomes dirty)
+    cvector<EntityID>          dirtyIds;
 };
 
 }
@@ -10,6 +10,7 @@
 #include <types.h>
 #include <cvector.h>
 #include <math/vec3.h>
+#include "../Common/sparse_set.h"
 
 namespace ECS
 {
@@ -39,7 +40,7 @@ struct TriggerOnce
 
 struct TriggersOnce
 {
-    cvector<EntityID>    ids;
+    SparseSet            ids;
     cvector<TriggerOnce> triggers;
 };
 
@@ -58,7 +59,7 @@ struct TriggerMultiple
 
 struct TriggersMultiple
 {
-    cvector<EntityID>        ids;
+    SparseSet                ids;
     cvector<TriggerMultiple> triggers;
 };
 
@@ -7,6 +7,7 @@
 #pragma once
 #include <types.h>
 #include <cvector.h>
+#include "../Common/sparse_set.h"
 
 namespace ECS
 {
@@ -84,15 +85,15 @@ struct WeaponComp
 {
     WeaponComp()
     {
-        ids.resize(8);
-        weapons.resize(8);
+        ids.reserve(8);
+        weapons.reserve(8);
 
         // create "dummy" weapon
         ids.push_back(INVALID_ENTT_ID);
         weapons.push_back(Weapon());
     }
 
-    cvector<EntityID> ids;
+    SparseSet         ids;
     cvector<Weapon>   weapons;
 };
 
@@ -16,6 +16,7 @@
 #pragma once
 #include <types.h>
 #include <cvector.h>
+#include "../Common/sparse_set.h"
 
 namespace ECS
 {
@@ -54,7 +55,7 @@ struct Animations
         data.push_back(AnimData());
     }
 
-    cvector<EntityID> ids;      // ids will serve us as keys to records
+    SparseSet         ids;      // ids will serve us as keys to records
     cvector<AnimData> data;
 };
 
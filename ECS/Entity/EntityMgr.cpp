@@ -23,12 +23,9 @@
 namespace ECS
 {
 
-// after creation of each new entity this value is increased by 1
-int EntityMgr::lastEntityID_ = 1;
-
-// static array of entities IDs for internal purposes
-static cvector<EntityID> s_Ids;
-static cvector<index>    s_Idxs;
+// after creation of each new entity (if there is no index for reuse)
+// this value is increased by 1
+uint32 EntityMgr::lastEnttIdx_ = 1;
 
 
 //---------------------------------------------------------
@@ -104,7 +101,7 @@ EntityMgr::EntityMgr() :
     ids_.push_back(INVALID_ENTT_ID);
     componentFlags_.push_back(0);
 
-    sceneObjectsIds_.push_back(0);
+    sceneObjectsIds_.push_back(INVALID_ENTT_ID);
     sceneObjects_.push_back(SceneObject());
 
     LogDbg(LOG, "entity mgr is initialized");
@@ -178,7 +175,7 @@ std::string GetErrMsgNoEntt(const EntityID id)
 //---------------------------------------------------------
 EntityID EntityMgr::CreateEntity()
 {
-    EntityID id = lastEntityID_++;
+    const EntityID id = GenerateEnttID();
     ids_.push_back(id);
     componentFlags_.push_back(0);
 
@@ -207,7 +204,8 @@ EntityID EntityMgr::CreateEntity(const char* enttName)
 // Desc:   create a batch of new empty entities, generate for each entity 
 //         unique ID and set that it hasn't any component by default;
 // Args:   - newEnttsCount:  how many entitties we want to create
-// Ret:    SORTED array of IDs of just created entities;
+// Ret:    array of IDs of just created entities
+//         (NOTE: isn't sorted since IDs of destroyed entities can be reused)
 //---------------------------------------------------------
 cvector<EntityID> EntityMgr::CreateEntities(const int newEnttsCount)
 {
@@ -217,30 +215,157 @@ cvector<EntityID> EntityMgr::CreateEntities(const int newEnttsCount)
         return cvector<EntityID>();
     }
 
-    s_Ids.resize(newEnttsCount);
+    cvector<EntityID> newIds(newEnttsCount);
 
-    // "generate" consistent IDs
-    for (EntityID& id : s_Ids)
-        id = lastEntityID_++;
+    for (EntityID& id : newIds)
+        id = GenerateEnttID();
 
     // store ids and components flags of entities into the manager
-    ids_.append_vector(s_Ids);
+    // (NOTE: flags are pushed one by one since resize() doesn't reset
+    //  the memory of destroyed entities which is still in the buffer)
+    const size newSize = ids_.size() + newEnttsCount;
+    ids_.reserve(newSize);
+    componentFlags_.reserve(newSize);
+
+    for (const EntityID id : newIds)
+        ids_.push_back(id);
 
-    const size newSize = componentFlags_.size() + newEnttsCount;
-    componentFlags_.resize(newSize, 0);
+    for (index i = 0; i < newEnttsCount; ++i)
+        componentFlags_.push_back(0);
 
-    return s_Ids;
+    return newIds;
 }
 
 //---------------------------------------------------------
-// Desc:  remove entities from the manager and remove records from components as well
+// Desc:  remove entities from the manager and remove records from components as well;
+//        indices of destroyed entities will be reused by new entities
+//        (but with the next generation so old IDs become invalid)
 //---------------------------------------------------------
 void EntityMgr::DestroyEntities(const EntityID* ids, const size numEntts)
 {
-    //CAssert::True(ids != nullptr, "input ptr to enitites IDs arr == nullptr");
-    //CAssert::True(numEntts > 0, "input number of entts must be > 0");
+    if (!ids || numEntts <= 0)
+    {
+        LogErr(LOG, "invalid input args (ids arr: %p, num entts: %d)", ids, (int)numEntts);
+        return;
+    }
+
+    ScratchVec<EntityID> destroyedIds;
+    ScratchVec<u32Flags> destroyedFlags;
+    ScratchVec<EntityID> compIds;
+
+    // remove entities from the manager (but remember which components they had)
+    for (index i = 0; i < numEntts; ++i)
+    {
+        const EntityID id = ids[i];
+
+        // also skips duplicates since an entity is removed right away
+        if (id == INVALID_ENTT_ID || !ids_.has(id))
+        {
+            LogErr(LOG, "can't destroy entity: there is no entity by id: %" PRIu32, id);
+            continue;
+        }
+
+        const index idx = ids_.get_idx(id);
+
+        destroyedIds.push_back(id);
+        destroyedFlags.push_back(componentFlags_[idx]);
+
+        ids_.swap_remove(id);
+        componentFlags_.swap_pop(idx);
+
+        // recycle index of the entity (if its generation isn't exhausted yet)
+        const uint32 generation = GetEnttGeneration(id);
+
+        if (generation < ENTT_ID_MAX_GEN)
+            freeIds_.push_back(MakeEnttID(GetEnttIndex(id), generation + 1));
+    }
+
+    if (destroyedIds.empty())
+        return;
+
+    // unlink from the quad tree and hierarchies
+    RemoveQuadTreeObjects(destroyedIds.data(), destroyedIds.size());
+    hierarchySys_.RemoveRecords(destroyedIds.data(), destroyedIds.size());
+
+    // remove records from each component (only entities which have it)
+    for (int comp = 0; comp < NUM_COMPONENTS; ++comp)
+    {
+        compIds.clear();
 
-    assert("TODO: IMPLEMENT IT!" && 0);
+        for (index i = 0; i < destroyedIds.size(); ++i)
+        {
+            if (destroyedFlags[i].TestBit(comp))
+                compIds.push_back(destroyedIds[i]);
+        }
+
+        if (!compIds.empty())
+            RemoveEnttsFromComponents(comp, compIds.data(), compIds.size());
+    }
+}
+
+//---------------------------------------------------------
+// Desc:  return an ID for a new entity: reuse an index of some destroyed
+//        entity (if any) or take a new one
+//---------------------------------------------------------
+EntityID EntityMgr::GenerateEnttID()
+{
+    if (!freeIds_.empty())
+    {
+        const EntityID id = freeIds_.back();
+        freeIds_.pop_back();
+        return id;
+    }
+
+    CAssert::True(lastEnttIdx_ <= ENTT_ID_INDEX_MASK, "limit of entities indices is exceeded");
+
+    return MakeEnttID(lastEnttIdx_++, 0);
+}
+
+//---------------------------------------------------------
+// Desc:  remove records of input entities from a component by type
+//---------------------------------------------------------
+void EntityMgr::RemoveEnttsFromComponents(
+    const int compType,
+    const EntityID* ids,
+    const size numEntts)
+{
+    switch (compType)
+    {
+        case NameComponent:         nameSys_.RemoveRecords(ids, numEntts);          break;
+        case TransformComponent:    transformSys_.RemoveRecords(ids, numEntts);     break;
+        case MoveComponent:         moveSys_.RemoveRecords(ids, numEntts);          break;
+        case RenderedComponent:     renderSys_.RemoveRecords(ids, numEntts);        break;
+        case ModelComponent:        modelSys_.RemoveRecords(ids, numEntts);         break;
+        case MaterialComponent:     materialSys_.RemoveRecords(ids, numEntts);      break;
+        case LightComponent:        lightSys_.RemoveRecords(ids, numEntts);         break;
+        case BoundingComponent:     boundingSys_.RemoveRecords(ids, numEntts);      break;
+        case ParticlesComponent:    particleSys_.RemoveEmitters(ids, numEntts);     break;
+        case InventoryComponent:    inventorySys_.RemoveRecords(ids, numEntts);     break;
+        case AnimationComponent:    animationSys_.RemoveRecords(ids, numEntts);     break;
+        case SpriteComponent:       spriteSys_.RemoveRecords(ids, numEntts);        break;
+        case WeaponComponent:       weaponSys_.RemoveRecords(ids, numEntts);        break;
+
+        case CameraComponent:
+        {
+            for (index i = 0; i < numEntts; ++i)
+                cameraSys_.RemoveRecord(ids[i]);
+            break;
+        }
+        case PlayerComponent:
+        {
+            for (index i = 0; i < numEntts; ++i)
+            {
+                if (playerSys_.GetPlayerID() == ids[i])
+                    playerSys_.SetPlayer(INVALID_ENTT_ID);
+            }
+            break;
+        }
+        default:
+        {
+            // there is no data of this component type in the manager
+            break;
+        }
+    }
 }
 
 
@@ -259,38 +384,20 @@ void EntityMgr::Update(const float gameTime, const float dt)
         {
             case EVENT_TRANSLATE:
             {
-                // make an arr of entt and all its children's ids
-                hierarchySys_.GetChildrenArr(e.enttID, s_Ids);
-                s_Ids.push_back(e.enttID);
+                // make an arr of entt and all its descendants ids
+                ScratchVec<EntityID> movedIds;
+                hierarchySys_.GetSubtreeArr(e.enttID, movedIds);
+                movedIds.push_back(e.enttID);
 
                 const DirectX::XMFLOAT3 prevPos  = transformSys_.GetPosition(e.enttID);
                 const DirectX::XMFLOAT3 adjustBy = { e.x-prevPos.x, e.y-prevPos.y, e.z-prevPos.z };
 
                 // adjust position for entt and all its children
-                transformSys_.AdjustPositions(s_Ids.data(), s_Ids.size(), adjustBy);
+                // (world boundings and quad tree are updated after all the events)
+                transformSys_.AdjustPositions(movedIds.data(), movedIds.size(), adjustBy);
 
                 // update relative position (relatively to parent if we have any)
                 hierarchySys_.UpdateRelativePos(e.enttID);
-
-                // update bounding component: world AABB of entity and all its children
-                boundingSys_.UpdateWorldBoundings(s_Ids.data(), s_Ids.size());
-
-           
-                 // don't update those entities which for some reason aren't in the quad tree
-                for (index i = 0; i < s_Ids.size();)
-                {
-                    if (!sceneObjectsIds_.binary_search(s_Ids[i]))
-                    {
-                        // swap n pop
-                        s_Ids[i] = s_Ids.back();
-                        s_Ids.pop_back();
-                        continue;
-                    }
-                    ++i;
-                }
-
-                UpdateQuadTreeMembership(s_Ids.data(), s_Ids.size());
-               
                 break;
             }
             case EVENT_ROTATE:
@@ -316,6 +423,44 @@ void EntityMgr::Update(const float gameTime, const float dt)
 
     // we handled all the events so reset the events list
     currNumEvents_ = 0;
+
+    UpdateDirtyTransforms();
+}
+
+//---------------------------------------------------------
+// Desc:   a single batched pass over entities which transforms were changed
+//         since the previous pass (no matter how many times): recompute
+//         inverse worlds, world bounding shapes and quad tree membership
+//---------------------------------------------------------
+void EntityMgr::UpdateDirtyTransforms()
+{
+    if (!transformSys_.HasDirtyTransforms())
+        return;
+
+    ScratchVec<EntityID> changedIds;
+    transformSys_.UpdateDirtyTransforms(changedIds);
+
+    if (changedIds.empty())
+        return;
+
+    // update bounding component: world AABB and sphere of each changed entity
+    boundingSys_.UpdateWorldBoundings(changedIds.data(), changedIds.size());
+
+    // don't update those entities which for some reason aren't in the quad tree
+    for (index i = 0; i < changedIds.size();)
+    {
+        if (!sceneObjectsIds_.has(changedIds[i]))
+        {
+            // swap n pop
+            changedIds[i] = changedIds.back();
+            changedIds.pop_back();
+            continue;
+        }
+        ++i;
+    }
+
+    if (!changedIds.empty())
+        UpdateQuadTreeMembership(changedIds.data(), changedIds.size());
 }
 
 //---------------------------------------------------------
@@ -423,6 +568,41 @@ void EntityMgr::CreateQuadTreeObjects(const EntityID* ids, const size numEntts)
     }
 }
 
+//---------------------------------------------------------
+// remove objects of input entities from the quad tree; the last scene object
+// is moved into the place of removed one so we re-attach it to the tree
+// (since the tree nodes store pointers to scene objects)
+//---------------------------------------------------------
+void EntityMgr::RemoveQuadTreeObjects(const EntityID* ids, const size numEntts)
+{
+    assert(ids);
+
+    for (index i = 0; i < numEntts; ++i)
+    {
+        const EntityID id = ids[i];
+
+        // entity isn't a member of the quad tree
+        if (!sceneObjectsIds_.has(id))
+            continue;
+
+        const index idx  = sceneObjectsIds_.get_idx(id);
+        const index last = sceneObjects_.size() - 1;
+
+        sceneObjects_[idx].Shutdown();
+
+        if (idx != last)
+        {
+            sceneObjects_[last].DetachFromQuadTree();
+            sceneObjects_[idx] = sceneObjects_[last];
+            sceneObjects_[idx].ClearSearchResults();
+            sceneObjects_[idx].AttachToQuadTree(&quadTree_);
+        }
+
+        sceneObjectsIds_.swap_remove(id);
+        sceneObjects_.pop_back();
+    }
+}
+
 //---------------------------------------------------------
 // update entity's (scene object) location within the quad tree
 //---------------------------------------------------------
@@ -436,12 +616,13 @@ void EntityMgr::UpdateQuadTreeMembership(const EntityID* ids, const size count)
     assert(ids);
     assert(count > 0);
 
-    sceneObjectsIds_.get_idxs(ids, count, s_Idxs);
+    ScratchVec<index> idxs;
+    sceneObjectsIds_.get_idxs(ids, count, idxs);
 
-    for (int i = 0; const index idx : s_Idxs)
+    for (int i = 0; const index idx : idxs)
     {
-        const Sphere worldSphere = boundingSys_.GetWorldSphere(s_Ids[i]);
-        const Rect3d worldBox    = boundingSys_.GetWorldBoxRect3d(s_Ids[i]);
+        const Sphere worldSphere = boundingSys_.GetWorldSphere(ids[i]);
+        const Rect3d worldBox    = boundingSys_.GetWorldBoxRect3d(ids[i]);
 
         sceneObjects_[idx].UpdateWorldBounds(worldSphere, worldBox);
 
@@ -471,10 +652,11 @@ void EntityMgr::SetEnttsHaveComponent(
     const size numEntts,
     const eComponentType compType)
 {
-    ids_.get_idxs(ids, numEntts, s_Idxs);
+    ScratchVec<index> idxs;
+    ids_.get_idxs(ids, numEntts, idxs);
 
     // generate hash mask by input component type
-    for (const index idx : s_Idxs)
+    for (const index idx : idxs)
         componentFlags_[idx].SetBit(compType);
 }
 
@@ -94,6 +94,7 @@ public:
     EntityID            CreateEntity(const char* enttName);
 
     void                Update(const float gameTime, const float dt);
+    void                UpdateDirtyTransforms();
     void                PushEvent(const Event& e);
 
     void                RemoveComponent(const EntityID id, eComponentType component);
@@ -238,7 +239,11 @@ public:
 
 
 private:
-    index GetEnttIdx(const EntityID id) const;
+    index    GetEnttIdx(const EntityID id) const;
+    EntityID GenerateEnttID();
+
+    void RemoveEnttsFromComponents(const int compType, const EntityID* ids, const size numEntts);
+    void RemoveQuadTreeObjects(const EntityID* ids, const size numEntts);
 
     void CreateQuadTreeObjects(const EntityID* ids, const size numEntts);
 
@@ -254,7 +259,7 @@ public:
     // public data...
     QuadTree                quadTree_;
 
-    cvector<EntityID>       sceneObjectsIds_;
+    SparseSet               sceneObjectsIds_;
     cvector<SceneObject>    sceneObjects_;
 
     // systems...
@@ -275,8 +280,11 @@ public:
     SpriteSystem            spriteSys_;
     WeaponSystem            weaponSys_;
     
-    // "ID" of an entity is just a numeral index
-    cvector<EntityID> ids_;
+    // "ID" of an entity is a numeral index + generation (see ECSTypes.h)
+    SparseSet         ids_;
+
+    // IDs (with already increased generation) which can be reused by new entities
+    cvector<EntityID> freeIds_;
 
     // bit flags for every component, indicating whether this object "has it"
     cvector<u32Flags> componentFlags_;
@@ -290,7 +298,7 @@ private:
     Event       eventsList_[MAX_NUM_EVENTS];
     int         currNumEvents_ = 0;
 
-    static int  lastEntityID_;
+    static uint32 lastEnttIdx_;
 
     // components
     Transform       transform_;
@@ -320,9 +328,8 @@ private:
 //---------------------------------------------------------
 inline index EntityMgr::GetEnttIdx(const EntityID id) const
 {
-    const index idx = ids_.get_idx(id);
-    assert(idx > 0 && idx < ids_.size());
-    return idx;
+    assert(ids_.has(id));
+    return ids_.get_idx(id);
 }
 
 //---------------------------------------------------------
@@ -346,7 +353,7 @@ inline const size EntityMgr::GetNumAllEntts() const
 //---------------------------------------------------------
 inline const cvector<EntityID>& EntityMgr::GetAllEnttsIDs() const
 {
-    return ids_;
+    return ids_.dense();
 }
 
 //---------------------------------------------------------
@@ -362,12 +369,17 @@ inline u32Flags EntityMgr::GetAddedComponentsByEntt(const EntityID id) const
 //---------------------------------------------------------
 inline bool EntityMgr::CheckEnttExist(const EntityID id) const
 {
-    return ids_.binary_search(id);
+    return ids_.has(id);
 }
 
 inline bool EntityMgr::CheckEnttsExist(const EntityID* ids, const size numEntts) const
 {
-    return ids_.binary_search(ids, numEntts);
+    bool allExist = true;
+
+    for (index i = 0; i < numEntts; ++i)
+        allExist &= ids_.has(ids[i]);
+
+    return allExist;
 }
 
 };
@@ -20,6 +20,7 @@
 #include "../Common/pch.h"
 #include "quad_tree.h"
 #include "scene_object.h"
+#include <geometry/intersection_tests.h>
 
 
 void QuadTree::Init(const Rect3d& worldAABB, const int depth)
@@ -135,6 +136,16 @@ u32Flags QuadTree::AddOrUpdateSceneObject(SceneObject* pObj)
     QuadTreeRect byteRect;
     byteRect.Convert(pObj->GetWorldBox(), worldOffset_, worldScale_);
 
+    // objects which are out of the world are clamped to the edge nodes,
+    // so remember how far they go out (is used by ray casting)
+    const Rect3d& box = pObj->GetWorldBox();
+    const float overhangX = Max(-worldOffset_.x - box.x0, box.x1 + worldOffset_.x - worldExtents_.x);
+    const float overhangZ = Max(-worldOffset_.z - box.z0, box.z1 + worldOffset_.z - worldExtents_.z);
+    const float overhangY = Max(-worldOffset_.y - box.y0, box.y1 + worldOffset_.y - worldExtents_.y);
+
+    maxOverhang_  = Max(maxOverhang_, Max(overhangX, overhangZ));
+    maxOverhangY_ = Max(maxOverhangY_, overhangY);
+
     QuadTreeNode* pNode = FindTreeNode(byteRect);
     assert(pNode && "failed to locate quad tree node");
 
@@ -222,3 +233,251 @@ SceneObject* QuadTree::Search(
 
     return pResultListBeg;
 }
+
+//---------------------------------------------------------
+// a scene object which AABB is intersected by the ray
+//---------------------------------------------------------
+struct RayCastCandidate
+{
+    float        tEnter;   // the distance along the ray where it enters the AABB
+    SceneObject* pObj;
+};
+
+inline bool CompareRayCastCandidates(const RayCastCandidate& a, const RayCastCandidate& b)
+{
+    return a.tEnter > b.tEnter;   // min-heap by entry distance
+}
+
+//---------------------------------------------------------
+// Desc:  execute narrow phase tests for candidates which the ray enters
+//        before the input distance (candidates are tested front-to-back)
+// Args:  - heap:      min-heap of candidates
+//        - tLimit:    test only candidates which are entered before it
+// Out:   - bestDist:  the distance to the nearest confirmed intersection
+//        - pHitObj:   the nearest intersected object
+//---------------------------------------------------------
+static void TestRayCastCandidates(
+    cvector<RayCastCandidate>& heap,
+    const float tLimit,
+    const Vec3& rayOrig,
+    const Vec3& rayDir,
+    RayCastTestFunc narrowTest,
+    void* pArgs,
+    float& bestDist,
+    SceneObject*& pHitObj)
+{
+    while (!heap.empty() && heap[0].tEnter <= tLimit)
+    {
+        std::pop_heap(heap.begin(), heap.end(), CompareRayCastCandidates);
+        const RayCastCandidate cand = heap.back();
+        heap.pop_back();
+
+        // all the rest candidates are farther than confirmed intersection
+        if (cand.tEnter > bestDist)
+        {
+            heap.clear();
+            return;
+        }
+
+        float dist = bestDist;
+
+        // without narrow test the AABB intersection is enough
+        if (!narrowTest)
+            dist = cand.tEnter;
+
+        else if (!narrowTest(pArgs, cand.pObj, rayOrig, rayDir, dist))
+            continue;
+
+        if (dist < bestDist)
+        {
+            bestDist = dist;
+            pHitObj  = cand.pObj;
+        }
+    }
+}
+
+//---------------------------------------------------------
+// Desc:  find the nearest scene object intersected by the ray:
+//        we walk through the finest level cells along the ray (2D DDA)
+//        and visit each node which contains the current cell on each level,
+//        so nodes are visited front-to-back; nodes and members which
+//        are out of Y range of the ray are skipped by yMask;
+//        members are tested by world AABB and then by narrow test (if any)
+//
+// Args:  - rayOrig, rayDir:  the ray in world space (direction is normalized)
+//        - maxDist:          max distance of the ray
+//        - narrowTest:       optional exact test (for instance, ray/triangles)
+//        - pArgs:            arguments for the narrow test
+// Out:   - outDist:          the distance to intersection
+// Ret:   a ptr to the nearest intersected object or nullptr
+//---------------------------------------------------------
+SceneObject* QuadTree::RayCast(
+    const Vec3& rayOrig,
+    const Vec3& rayDir,
+    const float maxDist,
+    float& outDist,
+    RayCastTestFunc narrowTest,
+    void* pArgs)
+{
+    assert(IsReady() && "the quad tree has not been created");
+
+    outDist = maxDist;
+
+    if (maxDist <= 0.0f)
+        return nullptr;
+
+    // replace zero components to avoid NaNs in ray/AABB tests
+    constexpr float eps = 1e-20f;
+    const Vec3 invDir(
+        1.0f / ((fabsf(rayDir.x) > eps) ? rayDir.x : eps),
+        1.0f / ((fabsf(rayDir.y) > eps) ? rayDir.y : eps),
+        1.0f / ((fabsf(rayDir.z) > eps) ? rayDir.z : eps));
+
+    // clip the ray by the world bounds (including parts of objects which
+    // are out of the world); the box is finite by each axis so the clipped
+    // segment is finite as well even for a vertical ray with maxDist == FLT_MAX
+    const float  overhang  = maxOverhang_;
+    const float  overhangY = maxOverhangY_;
+    const Rect3d worldRect(
+        -worldOffset_.x - overhang,  -worldOffset_.x + worldExtents_.x + overhang,
+        -worldOffset_.y - overhangY, -worldOffset_.y + worldExtents_.y + overhangY,
+        -worldOffset_.z - overhang,  -worldOffset_.z + worldExtents_.z + overhang);
+
+    float tStart = 0;
+
+    if (!IntersectRayRect3d(worldRect, rayOrig, invDir, maxDist, tStart))
+        return nullptr;
+
+    const float txExit = Max((worldRect.x0 - rayOrig.x) * invDir.x, (worldRect.x1 - rayOrig.x) * invDir.x);
+    const float tyExit = Max((worldRect.y0 - rayOrig.y) * invDir.y, (worldRect.y1 - rayOrig.y) * invDir.y);
+    const float tzExit = Max((worldRect.z0 - rayOrig.z) * invDir.z, (worldRect.z1 - rayOrig.z) * invDir.z);
+    const float tEnd   = Min(Min(Min(txExit, tyExit), tzExit), maxDist);
+
+    // build yMask by the clipped segment of the ray (Y is clamped
+    // to the box to be safe against rounding at its faces)
+    const Vec3 p0 = rayOrig + rayDir * tStart;
+    const Vec3 p1 = rayOrig + rayDir * tEnd;
+
+    const float y0 = Clamp(Min(p0.y, p1.y), worldRect.y0, worldRect.y1);
+    const float y1 = Clamp(Max(p0.y, p1.y), worldRect.y0, worldRect.y1);
+
+    const Rect3d segRect(
+        Min(p0.x, p1.x), Max(p0.x, p1.x),
+        y0,              y1,
+        Min(p0.z, p1.z), Max(p0.z, p1.z));
+
+    QuadTreeRect segByteRect;
+    BuildByteRect(segRect, segByteRect);
+    const u32Flags yMask = YMASK(segByteRect.y0, segByteRect.y1);
+
+    // setup 2D DDA over cells of the finest level (in "quad tree space");
+    // cells out of the world are mapped to the edge cells
+    const int   finestLevel = depth_ - 1;
+    const int   dim         = 1 << finestLevel;
+    const float cellSize    = 256.0f / dim;
+
+    const float bx  = (p0.x + worldOffset_.x) * worldScale_.x;
+    const float bz  = (p0.z + worldOffset_.z) * worldScale_.z;
+    const float bdx = rayDir.x * worldScale_.x;
+    const float bdz = rayDir.z * worldScale_.z;
+
+    int cx = (int)floorf(bx / cellSize);
+    int cz = (int)floorf(bz / cellSize);
+
+    const int   stepX   = (bdx >= 0) ? 1 : -1;
+    const int   stepZ   = (bdz >= 0) ? 1 : -1;
+    const float tDeltaX = (bdx != 0) ? cellSize / fabsf(bdx) : FLT_MAX;
+    const float tDeltaZ = (bdz != 0) ? cellSize / fabsf(bdz) : FLT_MAX;
+
+    float tNextX = FLT_MAX;
+    float tNextZ = FLT_MAX;
+
+    if (bdx > 0) tNextX = tStart + ((cx + 1) * cellSize - bx) / bdx;
+    if (bdx < 0) tNextX = tStart + ((cx)     * cellSize - bx) / bdx;
+    if (bdz > 0) tNextZ = tStart + ((cz + 1) * cellSize - bz) / bdz;
+    if (bdz < 0) tNextZ = tStart + ((cz)     * cellSize - bz) / bdz;
+
+    // the last visited node on each level
+    int lastX[MAX_TREE_DEPTH];
+    int lastZ[MAX_TREE_DEPTH];
+
+    for (int i = 0; i < MAX_TREE_DEPTH; ++i)
+    {
+        lastX[i] = -1;
+        lastZ[i] = -1;
+    }
+
+    ScratchVec<RayCastCandidate> heap;
+    SceneObject* pHitObj  = nullptr;
+    float        bestDist = maxDist;
+
+    while (true)
+    {
+        const float tOut = Min(Min(tNextX, tNextZ), tEnd);
+
+        // gather members of nodes which contain the current cell
+        for (int level = 0; level < depth_; ++level)
+        {
+            const int shift = finestLevel - level;
+            const int x     = Clamp(cx, 0, dim - 1) >> shift;
+            const int z     = Clamp(cz, 0, dim - 1) >> shift;
+
+            QuadTreeNode* pNode = GetNodeFromLevelXZ(level, x, z);
+            assert(pNode);
+
+            // there are no members in Y range of the ray (on this level and below)
+            if (!(pNode->GetYMask() & yMask))
+                break;
+
+            // members of this node are already gathered
+            if (x == lastX[level] && z == lastZ[level])
+                continue;
+
+            lastX[level] = x;
+            lastZ[level] = z;
+
+            if (!(pNode->GetYLocalMask() & yMask))
+                continue;
+
+            for (SceneObject* pObj = pNode->pFirstMember_; pObj; pObj = pObj->GetNextTreeLink())
+            {
+                float tEnter = 0;
+
+                if (!(pObj->GetYMask() & yMask))
+                    continue;
+
+                if (!IntersectRayRect3d(pObj->GetWorldBox(), rayOrig, invDir, bestDist, tEnter))
+                    continue;
+
+                heap.push_back({ tEnter, pObj });
+                std::push_heap(heap.begin(), heap.end(), CompareRayCastCandidates);
+            }
+        }
+
+        // each object which the ray enters before leaving this cell is already
+        // gathered so we can test them
+        TestRayCastCandidates(heap, tOut, rayOrig, rayDir, narrowTest, pArgs, bestDist, pHitObj);
+
+        // the rest objects (and objects of next cells) are farther than the hit
+        if (bestDist <= tOut || tOut >= tEnd)
+            break;
+
+        // step to the next cell
+        if (tNextX < tNextZ)
+        {
+            cx     += stepX;
+            tNextX += tDeltaX;
+        }
+        else
+        {
+            cz     += stepZ;
+            tNextZ += tDeltaZ;
+        }
+    }
+
+    // test the rest of candidates (if the ray stopped at the world bounds)
+    TestRayCastCandidates(heap, FLT_MAX, rayOrig, rayDir, narrowTest, pArgs, bestDist, pHitObj);
+
+    outDist = bestDist;
+    return pHitObj;
+}
@@ -31,6 +31,18 @@
 class Frustum;
 class SceneObject;
 
+//------------------------------------------
+// narrow phase test of a ray against a scene object (for instance, ray/triangles);
+// if there is an intersection closer than inOutDist the function must
+// update inOutDist and return true
+//------------------------------------------
+typedef bool (*RayCastTestFunc)(
+    void* pArgs,
+    const SceneObject* pObj,
+    const Vec3& rayOrig,
+    const Vec3& rayDir,
+    float& inOutDist);
+
 //------------------------------------------
 // class name:  QuadTree
 //------------------------------------------
@@ -60,6 +72,14 @@ public:
 
     u32Flags AddOrUpdateSceneObject(SceneObject* pNewObj);
 
+    SceneObject* RayCast(
+        const Vec3& rayOrig,
+        const Vec3& rayDir,
+        const float maxDist,
+        float& outDist,
+        RayCastTestFunc narrowTest = nullptr,
+        void* pArgs = nullptr);
+
     // accessors...
     bool IsReady() const;
 
@@ -78,6 +98,8 @@ private:
     Vec3   worldOffset_;
     int    depth_;
     uint32 memorySize_;
+    float  maxOverhang_;   // how far objects bounds go out of the world bounds (in xz-plane)
+    float  maxOverhangY_;  // how far objects bounds go out of the world bounds (by Y)
 };
 
 
@@ -86,7 +108,9 @@ private:
 //---------------------------------------------------------
 inline QuadTree::QuadTree() :
     depth_(0),
-    memorySize_(0)
+    memorySize_(0),
+    maxOverhang_(0),
+    maxOverhangY_(0)
 {
     memset(levelNodes_, 0, sizeof(levelNodes_));
 }
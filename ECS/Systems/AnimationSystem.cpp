@@ -97,9 +97,8 @@ bool AnimationSystem::AddRecord(
     const float animEndTime)
 {
     Animations& comp = *pAnimComponent_;
-    const index idx  = comp.ids.get_insert_idx(enttId);
 
-    if (idx < comp.ids.size() && comp.ids[idx] == enttId)
+    if (comp.ids.has(enttId))
     {
         LogErr(LOG, "there is already a record by id: %" PRIu32, enttId);
         return false;
@@ -112,12 +111,40 @@ bool AnimationSystem::AddRecord(
     animData.endTime     = animEndTime;
     animData.playback    = ANIM_PLAY_LOOP;    // by default we repeat initial animation (it usually is an "idle" animation)
 
-    comp.ids.insert_before(idx, enttId);
-    comp.data.insert_before(idx, animData);
+    comp.ids.push_back(enttId);
+    comp.data.push_back(animData);
 
     return true;
 }
 
+//---------------------------------------------------------
+// Desc:  remove animation records of input entities
+//        (the last record is moved into the place of removed one)
+//---------------------------------------------------------
+void AnimationSystem::RemoveRecords(const EntityID* ids, const size numEntts)
+{
+    if (!ids || numEntts <= 0)
+    {
+        LogErr(LOG, "invalid input args (ids arr: %p, num entts: %d)", ids, (int)numEntts);
+        return;
+    }
+
+    Animations& comp = *pAnimComponent_;
+
+    for (index i = 0; i < numEntts; ++i)
+    {
+        const index idx = comp.ids.swap_remove(ids[i]);
+
+        if (idx == -1)
+        {
+            LogErr(LOG, "there is no animation record by id: %" PRIu32, ids[i]);
+            continue;
+        }
+
+        comp.data.swap_pop(idx);
+    }
+}
+
 //---------------------------------------------------------
 // Desc:  force restart of the current animation for entity by id
 //---------------------------------------------------------
@@ -212,7 +239,7 @@ const index AnimationSystem::GetIdx(const EntityID id) const
 {
     const index idx = pAnimComponent_->ids.get_idx(id);
 
-    if (idx <= 0 || idx >= pAnimComponent_->ids.size())
+    if (idx == 0)
     {
         LogErr(LOG, "there is no record by id: %" PRIu32, id);
         return 0;
@@ -30,6 +30,8 @@ public:
     bool HasAnimation(const EntityID id) const;
 
     const cvector<EntityID>& GetEnttsIds() const;
+    const cvector<AnimData>& GetAnimData() const;
+    index                    GetRecordIdx(const EntityID id) const;
 
     bool GetData(
         const EntityID enttId,
@@ -49,6 +51,8 @@ public:
         const AnimationID animId,
         const float animEndTime);
 
+    void RemoveRecords(const EntityID* ids, const size numEntts);
+
     bool SetAnimation(
         const EntityID enttId,
         const AnimationID animId,
@@ -72,7 +76,7 @@ private:
 //---------------------------------------------------------
 inline bool AnimationSystem::HasAnimation(const EntityID id) const
 {
-    return pAnimComponent_->ids.binary_search(id);
+    return pAnimComponent_->ids.has(id);
 }
 
 //---------------------------------------------------------
@@ -80,7 +84,23 @@ inline bool AnimationSystem::HasAnimation(const EntityID id) const
 //---------------------------------------------------------
 inline const cvector<EntityID>& AnimationSystem::GetEnttsIds() const
 {
-    return pAnimComponent_->ids;
+    return pAnimComponent_->ids.dense();
+}
+
+//---------------------------------------------------------
+// Desc:  get arr of animations data (parallel to the arr of entities ids)
+//---------------------------------------------------------
+inline const cvector<AnimData>& AnimationSystem::GetAnimData() const
+{
+    return pAnimComponent_->data;
+}
+
+//---------------------------------------------------------
+// Desc:  get an index of entity's record (0 if there is no record)
+//---------------------------------------------------------
+inline index AnimationSystem::GetRecordIdx(const EntityID id) const
+{
+    return pAnimComponent_->ids.get_idx(id);
 }
 
 //---------------------------------------------------------
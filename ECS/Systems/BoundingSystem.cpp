@@ -21,10 +21,6 @@ using namespace DirectX;
 namespace ECS
 {
 
-// static arrays for internal purposes
-static cvector<index> s_Idxs;
-
-
 //**********************************************************************************
 // PRIVATE INTERNAL HELPERS
 //**********************************************************************************
@@ -154,6 +150,32 @@ void BoundingSystem::UpdateWorldBoundings(const EntityID id)
     UpdateWorldBoundings(&id, 1);
 }
 
+//---------------------------------------------------------
+// Desc:   args for updating of world boundings in parallel
+//---------------------------------------------------------
+struct UpdateWorldBoundingsArgs
+{
+    BoundData*      data   = nullptr;
+    const index*    idxs   = nullptr;   // idxs of bounding records
+    const XMMATRIX* worlds = nullptr;   // world matrix for each record
+};
+
+void UpdateWorldBoundingsRange(void* pArgs, const int start, const int end)
+{
+    const UpdateWorldBoundingsArgs& args = *(const UpdateWorldBoundingsArgs*)pArgs;
+
+    for (int i = start; i < end; ++i)
+    {
+        BoundData&      data = args.data[args.idxs[i]];
+        const XMMATRIX& W    = args.worlds[i];
+
+        data.localBox.Transform(data.worldBox, W);
+        data.localSphere.Transform(data.worldSphere, W);
+    }
+}
+
+//---------------------------------------------------------
+
 void BoundingSystem::UpdateWorldBoundings(const EntityID* ids, const size count)
 {
     if (!ids || count <= 0)
@@ -162,14 +184,38 @@ void BoundingSystem::UpdateWorldBoundings(const EntityID* ids, const size count)
         return;
     }
 
+    ScratchVec<EntityID> boundIds;
+    ScratchVec<index>    idxs;
+    ScratchVec<XMMATRIX> worlds;
+
+    // skip entities which have no bounding records
+    boundIds.reserve(count);
+    idxs.reserve(count);
+
     for (index i = 0; i < count; ++i)
     {
-        ECS::BoundData& data = pBoundingComponent_->data[GetIdx(ids[i])];
-        const XMMATRIX& W    = pTransSys_->GetWorld(ids[i]);
+        const index idx = GetIdx(ids[i]);
 
-        data.localBox.Transform(data.worldBox, W);
-        data.localSphere.Transform(data.worldSphere, W);
+        if (idx != 0)
+        {
+            boundIds.push_back(ids[i]);
+            idxs.push_back(idx);
+        }
     }
+
+    if (boundIds.empty())
+        return;
+
+    pTransSys_->GetWorlds(boundIds.data(), boundIds.size(), worlds);
+
+    // transform local boundings into world space
+    UpdateWorldBoundingsArgs args;
+    args.data   = pBoundingComponent_->data.data();
+    args.idxs   = idxs.data();
+    args.worlds = worlds.data();
+
+    constexpr int numRecordsPerJob = 128;
+    g_JobSystem.ParallelFor((int)idxs.size(), numRecordsPerJob, UpdateWorldBoundingsRange, &args);
 }
 
 //---------------------------------------------------------
@@ -183,7 +229,7 @@ bool BoundingSystem::Add(
     Bounding& comp = *pBoundingComponent_;
 
     // check if we already have a record with such ID
-    if (comp.ids.binary_search(id))
+    if (comp.ids.has(id))
     {
         LogErr(LOG, "there is already a record with entity: %" PRIu32, id);
         return false;
@@ -192,20 +238,8 @@ bool BoundingSystem::Add(
     const BoundingBox localBox = CreateBoxFromSphere(localSphere);
     const BoundingBox worldBox = CreateBoxFromSphere(worldSphere);
 
-    // if we just need to push back
-    if (id > comp.ids.back())
-    {
-        comp.ids.push_back(id);
-        comp.data.push_back(BoundData(localBox, worldBox, localSphere, worldSphere));
-    }
-
-    // execute sorted insertion of ID and initial data
-    else
-    {
-        const index idx = comp.ids.get_insert_idx(id);
-        comp.ids.insert_before(idx, id);
-        comp.data.insert_before(idx, BoundData(localBox, worldBox, localSphere, worldSphere));
-    }
+    comp.ids.push_back(id);
+    comp.data.push_back(BoundData(localBox, worldBox, localSphere, worldSphere));
 
     return true;
 }
@@ -221,7 +255,7 @@ bool BoundingSystem::Add(
     Bounding& comp = *pBoundingComponent_;
 
     // check if we already have a record with such ID
-    if (comp.ids.binary_search(id))
+    if (comp.ids.has(id))
     {
         LogErr(LOG, "there is already a record with entity: %" PRIu32, id);
         return false;
@@ -230,20 +264,8 @@ bool BoundingSystem::Add(
     const BoundingSphere localSphere = CreateSphereFromBox(localBox);
     const BoundingSphere worldSphere = CreateSphereFromBox(worldBox);
 
-    // if we just need to push back
-    if (id > comp.ids.back())
-    {
-        comp.ids.push_back(id);
-        comp.data.push_back(BoundData(localBox, worldBox, localSphere, worldSphere));
-    }
-
-    // execute sorted insertion of ID and initial data
-    else
-    {
-        const index idx = comp.ids.get_insert_idx(id);
-        comp.ids.insert_before(idx, id);
-        comp.data.insert_before(idx, BoundData(localBox, worldBox, localSphere, worldSphere));
-    }
+    comp.ids.push_back(id);
+    comp.data.push_back(BoundData(localBox, worldBox, localSphere, worldSphere));
     
     return true;
 }
@@ -272,22 +294,24 @@ bool BoundingSystem::Add(
     BoundingBox worldBox;
 
     // check that there are no records with input ids yet
-    if (comp.ids.binary_search(ids, numEntts))
+    if (comp.ids.has_any(ids, numEntts))
     {
         LogErr(LOG, "there is already a record with some input id");
         return false;
     }
 
-    comp.ids.get_insert_idxs(ids, numEntts, s_Idxs);
+    // allocate additional memory ahead
+    comp.ids.reserve(comp.ids.size() + numEntts);
+    comp.data.reserve(comp.data.size() + numEntts);
 
-    // sorted intertion of IDs and initial data
+    // add IDs and initial data
     for (index i = 0; i < numEntts; ++i)
-        comp.ids.insert_before(s_Idxs[i]+i, ids[i]);
+        comp.ids.push_back(ids[i]);
 
     for (index i = 0; i < numEntts; ++i)
     {
         worldBox = CreateBoxFromSphere(worldSpheres[i]);
-        comp.data.insert_before(s_Idxs[i]+i, BoundData(localBox, worldBox, localSphere, worldSpheres[i]));
+        comp.data.push_back(BoundData(localBox, worldBox, localSphere, worldSpheres[i]));
     }
 
     return true;
@@ -317,27 +341,57 @@ bool BoundingSystem::Add(
     BoundingSphere worldSphere;
 
     // check that there are no records with input IDs yet
-    if (comp.ids.binary_search(ids, numEntts))
+    if (comp.ids.has_any(ids, numEntts))
     {
         LogErr(LOG, "there is already a record with some input ID");
         return false;
     }
 
-    comp.ids.get_insert_idxs(ids, numEntts, s_Idxs);
+    // allocate additional memory ahead
+    comp.ids.reserve(comp.ids.size() + numEntts);
+    comp.data.reserve(comp.data.size() + numEntts);
 
-    // sorted insertion of IDs and initial data
+    // add IDs and initial data
     for (index i = 0; i < numEntts; ++i)
-        comp.ids.insert_before(s_Idxs[i]+i, ids[i]);
+        comp.ids.push_back(ids[i]);
 
     for (index i = 0; i < numEntts; ++i)
     {
         worldSphere = CreateSphereFromBox(worldBoxes[i]);
-        comp.data.insert_before(s_Idxs[i]+i, BoundData(localBox, worldBoxes[i], localSphere, worldSphere));
+        comp.data.push_back(BoundData(localBox, worldBoxes[i], localSphere, worldSphere));
     }
 
     return true;
 }
 
+//--------------------------------------------------------
+// Desc:  remove bounding records of input entities
+//        (the last record is moved into the place of removed one)
+//--------------------------------------------------------
+void BoundingSystem::RemoveRecords(const EntityID* ids, const size numEntts)
+{
+    if (!ids || numEntts <= 0)
+    {
+        LogErr(LOG, "invalid input args (ids arr: %p, num entts: %d)", ids, (int)numEntts);
+        return;
+    }
+
+    Bounding& comp = *pBoundingComponent_;
+
+    for (index i = 0; i < numEntts; ++i)
+    {
+        const index idx = comp.ids.swap_remove(ids[i]);
+
+        if (idx == -1)
+        {
+            LogErr(LOG, "there is no bounding record by id: %" PRIu32, ids[i]);
+            continue;
+        }
+
+        comp.data.swap_pop(idx);
+    }
+}
+
 //--------------------------------------------------------
 // Desc:  get bounding sphere for each input entity so we will be able
 //        to execute basic frustum culling test using these sphere
@@ -352,10 +406,11 @@ void BoundingSystem::GetBoundSpheres(
 
     Bounding& comp = *pBoundingComponent_;
 
-    comp.ids.get_idxs(ids, numEntts, s_Idxs);
+    ScratchVec<index> idxs;
+    comp.ids.get_idxs(ids, numEntts, idxs);
     outSpheres.resize(numEntts);
 
-    for (int i = 0; const index idx : s_Idxs)
+    for (int i = 0; const index idx : idxs)
         outSpheres[i++] = comp.data[idx].worldSphere;
 }
 
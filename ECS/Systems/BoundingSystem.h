@@ -61,6 +61,8 @@ public:
         const DirectX::BoundingBox& localBox,
         const DirectX::BoundingBox* worldBoxes);
 
+    void RemoveRecords(const EntityID* ids, const size numEntts);
+
     const BoundData& GetBoundingData(const EntityID id) const;
 
     void GetBoundSpheres(
@@ -98,12 +100,7 @@ private:
 //-----------------------------------------------------
 inline index BoundingSystem::GetIdx(const EntityID id) const
 {
-    const index idx = pBoundingComponent_->ids.get_idx(id);
-
-    if (idx > 0 && idx < pBoundingComponent_->ids.size())
-        return idx;
-
-    return 0;
+    return pBoundingComponent_->ids.get_idx(id);
 }
 
 //--------------------------------------------------------
@@ -30,13 +30,12 @@ HierarchySystem::HierarchySystem(
         LogErr(LOG, "input ptr to the transform system == nullptr");
         return;
     }
-
-    // create "invalid" data which is used when we query for not existent entity ID
-    //pHierarchyComponent->data[0] = HierarchyNode();
 }
 
 //---------------------------------------------------------
 // Desc:  add a child for the entity by ID;
+//        the child (with all its descendants) is moved right after
+//        the last descendant of the parent
 // Args:  - id:       identifier of entity which will have a new child
 //        - childId:  identifier of entity chich will be a child 
 // Ret:   true if we managed to did it
@@ -45,8 +44,17 @@ bool HierarchySystem::AddChild(const EntityID id, const EntityID childID)
 {
     Hierarchy& comp = *pHierarchy_;
 
+    if (id == INVALID_ENTT_ID || childID == INVALID_ENTT_ID || id == childID)
+    {
+        LogErr(LOG, "invalid input args (parent: %" PRIu32 ", child: %" PRIu32 ")", id, childID);
+        return false;
+    }
+
+    index childIdx  = comp.ids.get_idx(childID);
+    index parentIdx = comp.ids.get_idx(id);
+
     // if child already has some another parent
-    if (comp.data[childID].parentID != 0)
+    if (comp.parentIds[childIdx] != INVALID_ENTT_ID)
     {
         LogErr(
             LOG,
@@ -56,6 +64,13 @@ bool HierarchySystem::AddChild(const EntityID id, const EntityID childID)
         return false;
     }
 
+    // the parent can't be a descendant of its child
+    if (childIdx && parentIdx > childIdx && parentIdx < childIdx + comp.subtreeSizes[childIdx])
+    {
+        LogErr(LOG, "can't add child (id: %" PRIu32 ") because it is an ancestor of parent (id: %" PRIu32 ")", childID, id);
+        return false;
+    }
+
     const XMFLOAT3 parentPos = pTransformSys_->GetPosition(id);
     const XMFLOAT3 childPos  = pTransformSys_->GetPosition(childID);
 
@@ -67,41 +82,93 @@ bool HierarchySystem::AddChild(const EntityID id, const EntityID childID)
         childPos.z - parentPos.z,
     };
 
+    if (parentIdx == 0)
+        parentIdx = AddRoot(id);
+
+    if (childIdx == 0)
+        childIdx = AddRoot(childID);
+
+    // move child's subtree to the end of parent's subtree
+    const int num = comp.subtreeSizes[childIdx];
+    MoveRecords(childIdx, num, parentIdx + comp.subtreeSizes[parentIdx]);
+
     // set a new parent and relative position
-    comp.data[childID].parentID = id;
-    comp.data[childID].relativePos = relPos;
+    childIdx = comp.ids.get_idx(childID);
+    comp.parentIds[childIdx]   = id;
+    comp.relativePos[childIdx] = relPos;
 
-    // add a child entity for the parent entity by ID
-    comp.data[id].children.insert(childID);
+    // parent and all its ancestors now contain child's subtree
+    AddToSubtreeSizes(id, num);
 
     return true;
 }
 
+//---------------------------------------------------------
+// Desc:  remove input entities from hierarchies: each entity is unlinked
+//        from its parent, and its children become roots (have no parent)
+//---------------------------------------------------------
+void HierarchySystem::RemoveRecords(const EntityID* ids, const size numEntts)
+{
+    if (!ids || numEntts <= 0)
+    {
+        LogErr(LOG, "invalid input args (ids arr: %p, num entts: %d)", ids, (int)numEntts);
+        return;
+    }
+
+    Hierarchy& comp = *pHierarchy_;
+
+    for (index i = 0; i < numEntts; ++i)
+    {
+        const EntityID id  = ids[i];
+        index          idx = comp.ids.get_idx(id);
+
+        // skip entities which aren't members of any hierarchy
+        if (id == INVALID_ENTT_ID || idx == 0)
+            continue;
+
+        // unlink from parent: now the subtree is at the end of arrays
+        Detach(idx);
+        idx = comp.ids.get_idx(id);
+
+        // children become roots
+        const index end = idx + comp.subtreeSizes[idx];
+
+        for (index child = idx + 1; child < end; child += comp.subtreeSizes[child])
+            comp.parentIds[child] = INVALID_ENTT_ID;
+
+        // move the entity itself (now without children) to the very end and pop it
+        comp.subtreeSizes[idx] = 1;
+        MoveRecords(idx, 1, comp.ids.size());
+
+        comp.ids.swap_remove(id);
+        comp.parentIds.pop_back();
+        comp.subtreeSizes.pop_back();
+        comp.relativePos.pop_back();
+    }
+}
+
 //---------------------------------------------------------
 // Desc:   update a position of child relatively to its parent
 //---------------------------------------------------------
 void HierarchySystem::UpdateRelativePos(const EntityID childID)
 {
-    Hierarchy& comp = *pHierarchy_;
+    Hierarchy&     comp     = *pHierarchy_;
+    const index    idx      = comp.ids.get_idx(childID);
+    const EntityID parentID = comp.parentIds[idx];
 
-    if (comp.data.contains(childID))
+    // if we have a parent of this child
+    if (idx && parentID)
     {
-        HierarchyNode& node = comp.data[childID];
+        const XMFLOAT3 posParent = pTransformSys_->GetPosition(parentID);
+        const XMFLOAT3 posChild  = pTransformSys_->GetPosition(childID);
 
-        // if we have a parent of this child
-        if (node.parentID)
+        // compute new relative position
+        comp.relativePos[idx] =
         {
-            XMFLOAT3 posParent = pTransformSys_->GetPosition(node.parentID);
-            XMFLOAT3 posChild  = pTransformSys_->GetPosition(childID);
-
-            // compute new relative position
-            node.relativePos =
-            {
-                posChild.x - posParent.x,
-                posChild.y - posParent.y,
-                posChild.z - posParent.z
-            };
-        }
+            posChild.x - posParent.x,
+            posChild.y - posParent.y,
+            posChild.z - posParent.z
+        };
     }
 }
 
@@ -112,52 +179,52 @@ void HierarchySystem::UpdateRelativePos(const EntityID childID)
 //---------------------------------------------------------
 void HierarchySystem::SetRelativePos(const EntityID childID, const XMFLOAT3& newRelPos)
 {
-    Hierarchy& comp = *pHierarchy_;
-
-    if (comp.data.contains(childID))
-    {
-        HierarchyNode& node = comp.data[childID];
+    Hierarchy&  comp = *pHierarchy_;
+    const index idx  = comp.ids.get_idx(childID);
 
-        // if we have a parent of this child
-        if (node.parentID)
-            node.relativePos = newRelPos;
-    }
+    // if we have a parent of this child
+    if (idx && comp.parentIds[idx])
+        comp.relativePos[idx] = newRelPos;
 }
 
 //---------------------------------------------------------
 
 void HierarchySystem::SetRelativePos(const EntityID childId, const XMVECTOR& newRelPos)
 {
-    Hierarchy& comp = *pHierarchy_;
-
-    if (comp.data.contains(childId))
-    {
-        HierarchyNode& node = comp.data[childId];
+    Hierarchy&  comp = *pHierarchy_;
+    const index idx  = comp.ids.get_idx(childId);
 
-        // if we have a parent of this child
-        if (node.parentID)
-        {
-            XMStoreFloat3(&node.relativePos, newRelPos);
-        }
-    }
+    // if we have a parent of this child
+    if (idx && comp.parentIds[idx])
+        XMStoreFloat3(&comp.relativePos[idx], newRelPos);
 }
 
 //---------------------------------------------------------
 // Desc:  set a new parent to child entity;
 //        if necessary we detach this child from its previous parent
+//        (if input parent == INVALID_ENTT_ID the child just becomes a root)
 //---------------------------------------------------------
 void HierarchySystem::SetParent(const EntityID childID, const EntityID parentID)
 {
-
-    Hierarchy& comp = *pHierarchy_;
+    Hierarchy&  comp = *pHierarchy_;
+    const index idx  = comp.ids.get_idx(childID);
 
     // if there is already a record with this child entity 
-    if (comp.data.contains(childID))
-    {
-        // detach this child from its previous parent
-        EntityID prevParentID = comp.data[childID].parentID;
-        comp.data[prevParentID].children.erase(childID);
-    }
+    // we detach this child from its previous parent
+    if (idx && comp.parentIds[idx])
+        Detach(idx);
+
+    if (parentID != INVALID_ENTT_ID)
+        AddChild(parentID, childID);
+}
+
+//---------------------------------------------------------
+// Desc:  return ID of the parent or INVALID_ENTT_ID if there is no parent
+//---------------------------------------------------------
+EntityID HierarchySystem::GetParent(const EntityID childID) const
+{
+    const Hierarchy& comp = *pHierarchy_;
+    return comp.parentIds[comp.ids.get_idx(childID)];
 }
 
 //---------------------------------------------------------
@@ -166,16 +233,15 @@ void HierarchySystem::SetParent(const EntityID childID, const EntityID parentID)
 XMFLOAT3 HierarchySystem::GetRelativePos(const EntityID childID) const
 {
     const Hierarchy& comp = *pHierarchy_;
+    const index      idx  = comp.ids.get_idx(childID);
 
-    if (comp.data.contains(childID))
-    {
-        return comp.data.at(childID).relativePos;
-    }
-    else
+    if (idx == 0)
     {
         LogErr(LOG, "there is no hierarchy data for entity: %" PRIu32, childID);
         return { 0,0,0 };
     }
+
+    return comp.relativePos[idx];
 }
 
 //---------------------------------------------------------
@@ -191,21 +257,117 @@ void HierarchySystem::GetRelativePositions(
         return;
     }
 
-
     const Hierarchy& comp = *pHierarchy_;
 
     for (index i = 0; i < numEntts; ++i)
     {
         const EntityID childId = ids[i];
+        const index    idx     = comp.ids.get_idx(childId);
 
-        if (comp.data.contains(childId))
-            outPositions[i] = comp.data.at(childId).relativePos;
-
-        else
-        {
+        if (idx == 0)
             LogErr(LOG, "there is no hierarchy data for entity: %" PRIu32, childId);
-            outPositions[i] = { 0,0,0 };
-        }
+
+        // for invalid idx we output zero relative position
+        outPositions[i] = comp.relativePos[idx];
+    }
+}
+
+
+// =================================================================================
+//                            PRIVATE HELPERS
+// =================================================================================
+
+//---------------------------------------------------------
+// Desc:  add a record of entity without parent and children
+//        (at the end of arrays)
+// Ret:   index of the new record
+//---------------------------------------------------------
+index HierarchySystem::AddRoot(const EntityID id)
+{
+    Hierarchy& comp = *pHierarchy_;
+
+    comp.parentIds.push_back(INVALID_ENTT_ID);
+    comp.subtreeSizes.push_back(1);
+    comp.relativePos.push_back({ 0,0,0 });
+
+    return comp.ids.push_back(id);
+}
+
+//---------------------------------------------------------
+// Desc:  unlink a record by idx from its parent: the subtree of this record
+//        is moved to the end of arrays so it doesn't split parent's range
+//---------------------------------------------------------
+void HierarchySystem::Detach(const index idx)
+{
+    Hierarchy&     comp     = *pHierarchy_;
+    const EntityID parentID = comp.parentIds[idx];
+    const int      num      = comp.subtreeSizes[idx];
+    const index    end      = comp.ids.size();
+
+    if (parentID == INVALID_ENTT_ID)
+        return;
+
+    comp.parentIds[idx]   = INVALID_ENTT_ID;
+    comp.relativePos[idx] = { 0,0,0 };
+
+    MoveRecords(idx, num, end);
+    AddToSubtreeSizes(parentID, -num);
+}
+
+//---------------------------------------------------------
+// Desc:  move a range of num records (a subtree) so it will be placed right
+//        before the record by idx dst (dst == size of arrays means the end);
+//        records between the range and dst are shifted to fill the gap
+//---------------------------------------------------------
+void HierarchySystem::MoveRecords(const index first, const int num, const index dst)
+{
+    Hierarchy&  comp = *pHierarchy_;
+    const index last = first + num;
+
+    index rotFirst  = 0;
+    index rotMiddle = 0;
+    index rotLast   = 0;
+
+    // move records forward: shift [last, dst) back
+    if (dst > last)
+    {
+        rotFirst  = first;
+        rotMiddle = last;
+        rotLast   = dst;
+    }
+    // move records backward: shift [dst, first) forward
+    else if (dst < first)
+    {
+        rotFirst  = dst;
+        rotMiddle = first;
+        rotLast   = last;
+    }
+    // records are already in place
+    else
+    {
+        return;
+    }
+
+    comp.ids.rotate(rotFirst, rotMiddle, rotLast);
+
+    std::rotate(comp.parentIds.begin()    + rotFirst, comp.parentIds.begin()    + rotMiddle, comp.parentIds.begin()    + rotLast);
+    std::rotate(comp.subtreeSizes.begin() + rotFirst, comp.subtreeSizes.begin() + rotMiddle, comp.subtreeSizes.begin() + rotLast);
+    std::rotate(comp.relativePos.begin()  + rotFirst, comp.relativePos.begin()  + rotMiddle, comp.relativePos.begin()  + rotLast);
+}
+
+//---------------------------------------------------------
+// Desc:  add num to the subtree size of entity by ID and each its ancestor
+//---------------------------------------------------------
+void HierarchySystem::AddToSubtreeSizes(const EntityID id, const int num)
+{
+    Hierarchy& comp = *pHierarchy_;
+
+    for (EntityID ancestor = id; ancestor != INVALID_ENTT_ID;)
+    {
+        const index idx = comp.ids.get_idx(ancestor);
+
+        comp.subtreeSizes[idx] += num;
+        ancestor = comp.parentIds[idx];
     }
 }
 
@@ -1,7 +1,11 @@
 // =================================================================================
 // Filename:     HierarchySystem.h
 // Description:  ECS system to handle entities hierarchy data:
-//               entity can have only one "parent" and have multiple "children"
+//               entity can have only one "parent" and have multiple "children";
+//
+//               the hierarchy is flat (depth-first order), so iteration over
+//               a subtree is a contiguous scan and re-parenting is a rotation
+//               of the subtree range within arrays
 //
 // Created:      24.04.2025 by DimaSkup
 // =================================================================================
@@ -21,8 +25,11 @@ public:
     HierarchySystem(Hierarchy* pHierarchyComponent, TransformSystem* pTransformSys);
 
     bool AddChild(const EntityID id, const EntityID childID);
+    void RemoveRecords(const EntityID* ids, const size numEntts);
     void SetParent(const EntityID childID, const EntityID parentID);
 
+    EntityID GetParent(const EntityID childID) const;
+
     void UpdateRelativePos(const EntityID childID);
     void SetRelativePos(const EntityID childId, const DirectX::XMFLOAT3& newRelPos);
     void SetRelativePos(const EntityID childId, const DirectX::XMVECTOR& newRelPos);
@@ -39,32 +46,47 @@ public:
     //---------------------------------------------------------
     inline bool HasChildren(const EntityID id) const
     {
-        return !GetChildrenSet(id).empty();
+        const Hierarchy& comp = *pHierarchy_;
+        return comp.subtreeSizes[comp.ids.get_idx(id)] > 1;
     }
 
     //---------------------------------------------------------
-    // output:  an array of children Ids
+    // output:  an array of direct children Ids
     //---------------------------------------------------------
     inline void GetChildrenArr(const EntityID id, cvector<EntityID>& outChildren) const
     {
-        const std::set<EntityID>& children = GetChildrenSet(id);
-        outChildren.resize(children.size());
+        const Hierarchy& comp = *pHierarchy_;
+        const index      idx  = comp.ids.get_idx(id);
+        const index      end  = idx + comp.subtreeSizes[idx];
+
+        outChildren.resize(0);
 
-        for (int i = 0; const EntityID childID : children)
-            outChildren[i++] = childID;
+        // jump from child to child over their own subtrees
+        for (index i = idx + 1; i < end; i += comp.subtreeSizes[i])
+            outChildren.push_back(comp.ids[i]);
     }
 
     //---------------------------------------------------------
-    // Desc:  return all the children of input entity
+    // output:  an array of all the descendants Ids (in depth-first order)
     //---------------------------------------------------------
-    inline const std::set<EntityID>& GetChildrenSet(const EntityID id) const
+    inline void GetSubtreeArr(const EntityID id, cvector<EntityID>& outDescendants) const
     {
-        Hierarchy& comp  = *pHierarchy_;
-        const bool exist = comp.data.contains(id);
+        const Hierarchy& comp = *pHierarchy_;
+        const index      idx  = comp.ids.get_idx(id);
+        const int        num  = comp.subtreeSizes[idx] - 1;
 
-        return comp.data[id * exist].children;      // if not exist we return empty set of children (of entity which ID == 0)
+        outDescendants.resize(num);
+
+        for (int i = 0; i < num; ++i)
+            outDescendants[i] = comp.ids[idx + 1 + i];
     }
 
+private:
+    index AddRoot    (const EntityID id);
+    void  Detach     (const index idx);
+    void  MoveRecords(const index first, const int num, const index dst);
+    void  AddToSubtreeSizes(const EntityID id, const int num);
+
 private:
     Hierarchy*       pHierarchy_    = nullptr;
     TransformSystem* pTransformSys_ = nullptr;
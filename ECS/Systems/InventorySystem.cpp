@@ -26,16 +26,40 @@ void InventorySystem::AddInventory(const EntityID id)
     Inventory& comp = *pInventory_;
 
     // check if input entity already has an inventory
-    if (comp.ownersIds.binary_search(id))
+    if (comp.ownersIds.has(id))
         return;
 
+    // add an empty inventory for entity
+    comp.ownersIds.push_back(id);
+    comp.inventories.push_back(InventoryData());
+}
 
-    // find a place for sorted insertion
-    const index idx = comp.ownersIds.get_insert_idx(id);
+//---------------------------------------------------------
+// Desc:  remove inventory records of input entities
+//        (the last record is moved into the place of removed one)
+//---------------------------------------------------------
+void InventorySystem::RemoveRecords(const EntityID* ids, const size numEntts)
+{
+    if (!ids || numEntts <= 0)
+    {
+        LogErr(LOG, "invalid input args (ids arr: %p, num entts: %d)", ids, (int)numEntts);
+        return;
+    }
 
-    // add an empty inventory for entity
-    comp.ownersIds.insert_before(idx, id);
-    comp.inventories.insert_before(idx, InventoryData());
+    Inventory& comp = *pInventory_;
+
+    for (index i = 0; i < numEntts; ++i)
+    {
+        const index idx = comp.ownersIds.swap_remove(ids[i]);
+
+        if (idx == -1)
+        {
+            LogErr(LOG, "there is no inventory record by id: %" PRIu32, ids[i]);
+            continue;
+        }
+
+        comp.inventories.swap_pop(idx);
+    }
 }
 
 //---------------------------------------------------------
@@ -44,15 +68,16 @@ void InventorySystem::AddInventory(const EntityID id)
 void InventorySystem::AddItem(const EntityID ownerId, const EntityID itemId)
 {
     Inventory& comp = *pInventory_;
-    const index idx = comp.ownersIds.get_idx(ownerId);
 
     // check if entity has inventory
-    if (comp.ownersIds[idx] != ownerId)
+    if (!comp.ownersIds.has(ownerId))
     {
         LogErr(LOG, "there is no inventory related to entity: %" PRIu32, ownerId);
         return;
     }
 
+    const index idx = comp.ownersIds.get_idx(ownerId);
+
     // prevent double adding
     InventoryData& inventory = comp.inventories[idx];
 
@@ -94,15 +119,16 @@ void InventorySystem::MoveItem(
 EntityID InventorySystem::GetItemByIdx(const EntityID ownerId, const index itemIdx)
 {
     Inventory& comp = *pInventory_;
-    const index ownerIdx = comp.ownersIds.get_idx(ownerId);
 
     // check if entity has inventory
-    if (comp.ownersIds[ownerIdx] != ownerId)
+    if (!comp.ownersIds.has(ownerId))
     {
         LogErr(LOG, "there is no inventory related to entity: %" PRIu32, ownerId);
         return INVALID_ENTT_ID;
     }
 
+    const index ownerIdx = comp.ownersIds.get_idx(ownerId);
+
     InventoryData& inventory = comp.inventories[ownerIdx];
     const size numItems = inventory.items.size();
 
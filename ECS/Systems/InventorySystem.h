@@ -18,6 +18,7 @@ public:
     ~InventorySystem();
 
     void AddInventory(const EntityID id);
+    void RemoveRecords(const EntityID* ids, const size numEntts);
 
     void AddItem(const EntityID ownerId, const EntityID itemId);
     void DropItem(const EntityID ownerId, const EntityID itemId);
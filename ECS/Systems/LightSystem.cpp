@@ -11,13 +11,6 @@ using namespace DirectX;
 namespace ECS
 {
 
-//---------------------------------------------------------
-// static arrays for internal purposes
-//---------------------------------------------------------
-static cvector<EntityID> s_Ids;
-static cvector<index>    s_Idxs;
-
-
 //---------------------------------------------------------
 // Desc:  light system constructo/destructor
 //---------------------------------------------------------
@@ -80,19 +73,23 @@ void LightSystem::AddDirLight(const EntityID id, const DirLight& initData)
     }
 
     Light& comp = *pLightComp_;
-    index idx = comp.ids.get_insert_idx(id);
 
-    // exec sorted insertion of a new record into each data array
-    comp.ids.insert_before(idx, id);
-    comp.types.insert_before(idx, LightType::DIRECTED);
-    comp.isActive.insert_before(idx, true);
+    if (comp.ids.has(id))
+    {
+        LogErr(LOG, "there is already a light source bound to entity: %" PRIu32, id);
+        return;
+    }
+
+    // append a new record into each data array
+    comp.ids.push_back(id);
+    comp.types.push_back(LightType::DIRECTED);
+    comp.isActive.push_back(true);
 
     // add data into the lights container
     DirLights& lights = GetDirLights();
 
-    idx = lights.ids.get_insert_idx(id);
-    lights.ids.insert_before(idx, id);
-    lights.data.insert_before(idx, initData);
+    lights.ids.push_back(id);
+    lights.data.push_back(initData);
 }
 
 //---------------------------------------------------------
@@ -109,19 +106,23 @@ void LightSystem::AddPointLight(const EntityID id, const PointLight& initData)
     }
 
     Light& comp = *pLightComp_;
-    index idx = comp.ids.get_insert_idx(id);
 
-    // exec sorted insertion of a new record into each data array
-    comp.ids.insert_before(idx, id);
-    comp.types.insert_before(idx, LightType::POINT);
-    comp.isActive.insert_before(idx, true);
+    if (comp.ids.has(id))
+    {
+        LogErr(LOG, "there is already a light source bound to entity: %" PRIu32, id);
+        return;
+    }
+
+    // append a new record into each data array
+    comp.ids.push_back(id);
+    comp.types.push_back(LightType::POINT);
+    comp.isActive.push_back(true);
 
     // add data into the lights container
     PointLights& lights = GetPointLights();
 
-    idx = lights.ids.get_insert_idx(id);
-    lights.ids.insert_before(idx, id);
-    lights.data.insert_before(idx, initData);
+    lights.ids.push_back(id);
+    lights.data.push_back(initData);
 }
 
 //---------------------------------------------------------
@@ -138,19 +139,79 @@ void LightSystem::AddSpotLight(const EntityID id, const SpotLight& initData)
     }
 
     Light& comp = *pLightComp_;
-    index idx = comp.ids.get_insert_idx(id);
 
-    // exec sorted insertion of a new record into each data array
-    comp.ids.insert_before(idx, id);
-    comp.types.insert_before(idx, LightType::SPOT);
-    comp.isActive.insert_before(idx, true);
+    if (comp.ids.has(id))
+    {
+        LogErr(LOG, "there is already a light source bound to entity: %" PRIu32, id);
+        return;
+    }
+
+    // append a new record into each data array
+    comp.ids.push_back(id);
+    comp.types.push_back(LightType::SPOT);
+    comp.isActive.push_back(true);
 
     // add data into the lights container
     SpotLights& lights = GetSpotLights();
 
-    idx = lights.ids.get_insert_idx(id);
-    lights.ids.insert_before(idx, id);
-    lights.data.insert_before(idx, initData);
+    lights.ids.push_back(id);
+    lights.data.push_back(initData);
+}
+
+//---------------------------------------------------------
+// Desc:   remove light sources of input entities: from the common arrays
+//         and from the container of specific light type as well
+//         (the last record is moved into the place of removed one)
+//---------------------------------------------------------
+void LightSystem::RemoveRecords(const EntityID* ids, const size numEntts)
+{
+    if (!ids || numEntts <= 0)
+    {
+        LogErr(LOG, "invalid input args (ids arr: %p, num entts: %d)", ids, (int)numEntts);
+        return;
+    }
+
+    Light& comp = *pLightComp_;
+
+    for (index i = 0; i < numEntts; ++i)
+    {
+        const EntityID id  = ids[i];
+        const index    idx = comp.ids.swap_remove(id);
+
+        if (idx == -1)
+        {
+            LogErr(LOG, "there is no light source by id: %" PRIu32, id);
+            continue;
+        }
+
+        const LightType type = comp.types[idx];
+        comp.types.swap_pop(idx);
+        comp.isActive.swap_pop(idx);
+
+        switch (type)
+        {
+            case LightType::DIRECTED:
+            {
+                const index dataIdx = comp.dirLights.ids.swap_remove(id);
+                comp.dirLights.data.swap_pop(dataIdx);
+                break;
+            }
+            case LightType::POINT:
+            {
+                const index dataIdx = comp.pointLights.ids.swap_remove(id);
+                comp.pointLights.data.swap_pop(dataIdx);
+                break;
+            }
+            case LightType::SPOT:
+            {
+                const index dataIdx = comp.spotLights.ids.swap_remove(id);
+                comp.spotLights.data.swap_pop(dataIdx);
+                break;
+            }
+            default:
+                LogErr(LOG, "unknown light type (%d) of entity: %" PRIu32, (int)type, id);
+        }
+    }
 }
 
 // =================================================================================
@@ -303,15 +364,18 @@ void LightSystem::GetPointLightsData(
     }
 
 
-    pLightComp_->ids.get_idxs(ids, numEntts, s_Idxs);
-    s_Ids.resize(numEntts);
+    ScratchVec<index>    idxs;
+    ScratchVec<EntityID> activeIds;
+
+    pLightComp_->ids.get_idxs(ids, numEntts, idxs);
+    activeIds.resize(numEntts);
 
     // get only ACTIVE lights
     size numActive = 0;
 
-    for (const index idx : s_Idxs)
+    for (const index idx : idxs)
     {
-        s_Ids[numActive] = pLightComp_->ids[idx];
+        activeIds[numActive] = pLightComp_->ids[idx];
         numActive       += pLightComp_->isActive[idx];
     }
 
@@ -320,13 +384,13 @@ void LightSystem::GetPointLightsData(
 
     // get data of lights
     PointLights& lights = GetPointLights();
-    lights.ids.get_idxs(s_Ids.data(), numActive, s_Idxs);
+    lights.ids.get_idxs(activeIds.data(), numActive, idxs);
 
-    for (int i = 0; const index idx : s_Idxs)
+    for (int i = 0; const index idx : idxs)
         outData[i++] = lights.data[idx];
 
     // get point light positions (are stored separatedly in the Transform component)
-    pTransformSys_->GetPositions(s_Ids.data(), numActive, outPositions);
+    pTransformSys_->GetPositions(activeIds.data(), numActive, outPositions);
 }
 
 //---------------------------------------------------------
@@ -352,15 +416,18 @@ void LightSystem::GetSpotLightsData(
         return;
     }
 
-    pLightComp_->ids.get_idxs(ids, numEntts, s_Idxs);
-    s_Ids.resize(numEntts);
+    ScratchVec<index>    idxs;
+    ScratchVec<EntityID> activeIds;
+
+    pLightComp_->ids.get_idxs(ids, numEntts, idxs);
+    activeIds.resize(numEntts);
 
     // get only ACTIVE lights
     size numActive = 0;
 
-    for (const index idx : s_Idxs)
+    for (const index idx : idxs)
     {
-        s_Ids[numActive] = pLightComp_->ids[idx];
+        activeIds[numActive] = pLightComp_->ids[idx];
         numActive       += pLightComp_->isActive[idx];
     }
     
@@ -369,13 +436,13 @@ void LightSystem::GetSpotLightsData(
 
     // get data of lights
     SpotLights& lights = GetSpotLights();
-    lights.ids.get_idxs(s_Ids.data(), numActive, s_Idxs);
+    lights.ids.get_idxs(activeIds.data(), numActive, idxs);
 
-    for (int i = 0; const index idx : s_Idxs)
+    for (int i = 0; const index idx : idxs)
         outData[i++] = lights.data[idx];
 
     // get spotlights positions and directions
-    pTransformSys_->GetPositionsAndDirections(s_Ids.data(), numActive, outPositions, outDirections);
+    pTransformSys_->GetPositionsAndDirections(activeIds.data(), numActive, outPositions, outDirections);
 }
 
 //---------------------------------------------------------
@@ -737,13 +804,14 @@ bool LightSystem::GetPointLightsPositionAndRange(
     pTransformSys_->GetPositions(ids, numEntts, outPositions);
 
     // get range of each point light by ID
-    const cvector<PointLight>& lights = GetPointLights().data;
-    pLightComp_->ids.get_idxs(ids, numEntts, s_Idxs);
+    const PointLights& lights = GetPointLights();
+    ScratchVec<index> idxs;
+    lights.ids.get_idxs(ids, numEntts, idxs);
 
     outRanges.resize(numEntts);
 
-    for (int i = 0; const index idx : s_Idxs)
-        outRanges[i++] = lights[idx].range;
+    for (int i = 0; const index idx : idxs)
+        outRanges[i++] = lights.data[idx].range;
 
     return true;
 }
@@ -29,6 +29,8 @@ public:
     void AddPointLight(const EntityID id, const PointLight& initData);
     void AddSpotLight (const EntityID id, const SpotLight& initData);
 
+    void RemoveRecords(const EntityID* ids, const size numEntts);
+
     //
     // Public update API
     //
@@ -117,10 +119,8 @@ private:
 //---------------------------------------------------------
 inline index LightSystem::GetIdxById(const EntityID id) const
 {
-    const index idx = pLightComp_->ids.get_idx(id);
-
-    if (pLightComp_->ids.is_valid_index(idx))
-        return idx;
+    if (pLightComp_->ids.has(id))
+        return pLightComp_->ids.get_idx(id);
 
     return -1;
 }
@@ -128,12 +128,10 @@ inline index LightSystem::GetIdxById(const EntityID id) const
 //---------------------------------------------------------
 // get index of particular light type withing its specific structure
 //---------------------------------------------------------
-inline index GetIdxFromArrById(const cvector<EntityID>& ids, const EntityID id)
+inline index GetIdxFromArrById(const SparseSet& ids, const EntityID id)
 {
-    const index idx = ids.get_idx(id);
-
-    if (ids.is_valid_index(idx))
-        return idx;
+    if (ids.has(id))
+        return ids.get_idx(id);
 
     return -1;
 }
@@ -176,22 +174,22 @@ inline size LightSystem::GetNumSpotLights(void) const
 //---------------------------------------------------------
 inline bool LightSystem::IsLightSource(const EntityID id) const
 {
-    return pLightComp_->ids.binary_search(id);
+    return pLightComp_->ids.has(id);
 }
 
 inline bool LightSystem::IsDirLight(const EntityID id) const
 {
-    return pLightComp_->dirLights.ids.binary_search(id);
+    return pLightComp_->dirLights.ids.has(id);
 }
 
 inline bool LightSystem::IsPointLight(const EntityID id) const
 {
-    return pLightComp_->pointLights.ids.binary_search(id);
+    return pLightComp_->pointLights.ids.has(id);
 }
 
 inline bool LightSystem::IsSpotLight(const EntityID id) const
 {
-    return pLightComp_->spotLights.ids.binary_search(id);
+    return pLightComp_->spotLights.ids.has(id);
 }
 
 //---------------------------------------------------------
@@ -13,10 +13,6 @@
 namespace ECS
 {
 
-// static array for internal purposes
-static cvector<index> s_Idxs;
-
-
 //---------------------------------------------------------
 // constructor
 //---------------------------------------------------------
@@ -54,17 +50,43 @@ void MaterialSystem::AddRecord(
 
     Material& comp = *pMaterialComponent_;
 
-    if (comp.enttsIds.binary_search(enttId))
+    if (comp.enttsIds.has(enttId))
     {
         LogErr(LOG, "there is already an entity by ID: %" PRIu32, enttId);
         return;
     }
 
-    // add a record (here we execute sorted insertion into the data arrays)
-    const index idx = comp.enttsIds.get_insert_idx(enttId);
+    // add a record
+    comp.enttsIds.push_back(enttId);
+    comp.data.push_back(MaterialData(materialsIds, numSubmeshes));
+}
+
+//---------------------------------------------------------
+// Desc:  remove material records of input entities
+//        (the last record is moved into the place of removed one)
+//---------------------------------------------------------
+void MaterialSystem::RemoveRecords(const EntityID* ids, const size numEntts)
+{
+    if (!ids || numEntts <= 0)
+    {
+        LogErr(LOG, "invalid input args (ids arr: %p, num entts: %d)", ids, (int)numEntts);
+        return;
+    }
 
-    comp.enttsIds.insert_before(idx, enttId);
-    comp.data.insert_before(idx, MaterialData(materialsIds, numSubmeshes));
+    Material& comp = *pMaterialComponent_;
+
+    for (index i = 0; i < numEntts; ++i)
+    {
+        const index idx = comp.enttsIds.swap_remove(ids[i]);
+
+        if (idx == -1)
+        {
+            LogErr(LOG, "there is no material record by id: %" PRIu32, ids[i]);
+            continue;
+        }
+
+        comp.data.swap_pop(idx);
+    }
 }
 
 //---------------------------------------------------------
@@ -76,7 +98,6 @@ void MaterialSystem::SetMaterial(
     const MaterialID matId)
 {
     Material& comp = *pMaterialComponent_;
-    const cvector<EntityID>& ids = comp.enttsIds;
 
     const index idx = GetIdx(enttId);
     if (idx == 0)
@@ -110,15 +131,16 @@ void MaterialSystem::GetDataByEnttsIds(
 
     const Material& comp = *pMaterialComponent_;
 
-    comp.enttsIds.get_idxs(ids, numEntts, s_Idxs);
+    ScratchVec<index> idxs;
+    comp.enttsIds.get_idxs(ids, numEntts, idxs);
 
 #if DEBUG || _DEBUG
-    CheckEnttsHaveMaterialComponent(ids, s_Idxs.data(), numEntts);
+    CheckEnttsHaveMaterialComponent(ids, idxs.data(), numEntts);
 #endif
 
     outMatsDataPerEntt.resize(numEntts);
 
-    for (int i = 0; const index idx : s_Idxs)
+    for (int i = 0; const index idx : idxs)
     {
         outMatsDataPerEntt[i++] = comp.data[idx];
     }
@@ -25,6 +25,8 @@ public:
         const MaterialID* materialsIDs,
         const size numSubmeshes);
 
+    void RemoveRecords(const EntityID* ids, const size numEntts);
+
     void SetMaterial(
         const EntityID enttID,
         const SubmeshID enttSubmeshID,
@@ -57,10 +59,9 @@ private:
 //---------------------------------------------------------
 inline index MaterialSystem::GetIdx(const EntityID id) const
 {
-    const Material& comp = *pMaterialComponent_;
-    const index idx = comp.enttsIds.get_idx(id);
+    const index idx = pMaterialComponent_->enttsIds.get_idx(id);
 
-    if (comp.enttsIds.is_valid_index(idx))
+    if (idx != 0)
         return idx;
 
     LogErr(LOG, "there is no entity by ID: %d", (int)id);
@@ -7,9 +7,6 @@
 namespace ECS
 {
 
-// static cvectors for transient data
-static cvector<index> s_Idxs;
-
 //---------------------------------------------------------
 
 ModelSystem::ModelSystem(Model* pModelComponent) : pModelComponent_(pModelComponent)
@@ -19,7 +16,6 @@ ModelSystem::ModelSystem(Model* pModelComponent) : pModelComponent_(pModelCompon
 
 //---------------------------------------------------------
 // Desc:   make relations one to one: 'entity_id' => 'model_id'
-//         NOTE: enttsIDs are supposed to be SORTED!
 //---------------------------------------------------------
 void ModelSystem::AddRecords(
     const EntityID* enttsIDs,
@@ -29,25 +25,46 @@ void ModelSystem::AddRecords(
     CAssert::True((enttsIDs != nullptr) && (numEntts > 0), "invalid input args");
 
     Model& comp = *pModelComponent_;
-    const vsize newCapacity = comp.enttsIDs_.size() + numEntts;
 
-    comp.enttsIDs_.get_insert_idxs(enttsIDs, numEntts, s_Idxs);
+    CAssert::True(!comp.enttsIDs_.has_any(enttsIDs, numEntts), "there is already a model record for some input entity");
+
+    const vsize newCapacity = comp.enttsIDs_.size() + numEntts;
     comp.enttsIDs_.reserve(newCapacity);
+    comp.modelIDs_.reserve(newCapacity);
 
-    // sort insert of entities IDs (primary keys)
+    // relate each input entity to the model
     for (index i = 0; i < numEntts; ++i)
-        comp.enttsIDs_.insert_before(s_Idxs[i] + i, enttsIDs[i]);
+        comp.enttsIDs_.push_back(enttsIDs[i]);
 
-    // insert of model ID
     for (index i = 0; i < numEntts; ++i)
-        comp.modelIDs_.insert_before(s_Idxs[i] + i, modelID);
+        comp.modelIDs_.push_back(modelID);
 }
 
 ///////////////////////////////////////////////////////////
 
 void ModelSystem::RemoveRecords(const EntityID* ids, const size numEntts)
 {
-    CAssert::True(false, "TODO: IMPLEMENT IT!");
+    if (!ids || numEntts <= 0)
+    {
+        LogErr(LOG, "invalid input args (ids arr: %p, num entts: %d)", ids, (int)numEntts);
+        return;
+    }
+
+    Model& comp = *pModelComponent_;
+
+    // swap n pop records of each input entity
+    for (index i = 0; i < numEntts; ++i)
+    {
+        const index idx = comp.enttsIDs_.swap_remove(ids[i]);
+
+        if (idx == -1)
+        {
+            LogErr(LOG, "there is no model record by entt id: %" PRIu32, ids[i]);
+            continue;
+        }
+
+        comp.modelIDs_.swap_pop(idx);
+    }
 }
 
 //---------------------------------------------------------
@@ -55,13 +72,10 @@ void ModelSystem::RemoveRecords(const EntityID* ids, const size numEntts)
 //---------------------------------------------------------
 ModelID ModelSystem::GetModelIdRelatedToEntt(const EntityID enttID)
 {
-
     Model& comp = *pModelComponent_;
 
-    // 1. check if we have such entity ID;
-    // 2. get idx by value (or get 0 if there is no such)
-    const bool has = comp.enttsIDs_.binary_search(enttID);
-    const index idx = comp.enttsIDs_.get_idx(enttID) * has;
+    // get idx by value (or get 0 if there is no such)
+    const index idx = comp.enttsIDs_.get_idx(enttID);
 
     return comp.modelIDs_[idx];
 }
@@ -86,11 +100,12 @@ void ModelSystem::GetModelsIdsPerEntts(
     outModelsIds.resize(numEntts);
 
     const Model& comp = *pModelComponent_;
-    comp.enttsIDs_.get_idxs(enttsIds, numEntts, s_Idxs);
+    ScratchVec<index> idxs;
+    comp.enttsIDs_.get_idxs(enttsIds, numEntts, idxs);
 
     for (index i = 0; i < numEntts; ++i)
     {
-        outModelsIds[i] = comp.modelIDs_[s_Idxs[i]];
+        outModelsIds[i] = comp.modelIDs_[idxs[i]];
     }
 }
 
@@ -115,14 +130,15 @@ void ModelSystem::GetModelsIdsRelatedToEntts(
     const Model& comp = *pModelComponent_;
     std::map<ModelID, cvector<EntityID>> modelToEntts;
 
-    comp.enttsIDs_.get_idxs(enttsIDs, numEntts, s_Idxs);
+    ScratchVec<index> idxs;
+    comp.enttsIDs_.get_idxs(enttsIDs, numEntts, idxs);
 
     // get related models IDs and use them as keys
     // and group entities by these models IDs
     for (int i = 0; i < numEntts; ++i)
     {
-        const ModelID modelID = comp.modelIDs_[s_Idxs[i]];
-        const EntityID enttID = comp.enttsIDs_[s_Idxs[i]];
+        const ModelID modelID = comp.modelIDs_[idxs[i]];
+        const EntityID enttID = comp.enttsIDs_[idxs[i]];
         modelToEntts[modelID].push_back(enttID);
     }
 
@@ -43,7 +43,7 @@ void MoveSystem::UpdateAllMoves(
     const float deltaTime,
     TransformSystem& transformSys)
 {
-    const cvector<EntityID>& enttsToMove = pMoveComponent_->ids_;
+    const SparseSet& enttsToMove = pMoveComponent_->ids_;
 
     // if we don't have any entities to move we just go out
     if (enttsToMove.size() == 0)
@@ -82,9 +82,11 @@ void MoveSystem::AddRecords(
         normRotQuats[i] = DirectX::XMQuaternionNormalize(rotationQuats[i]);
 
 
-    cvector<index> idxs;
-    comp.ids_.get_insert_idxs(ids, numEntts, idxs);
-
+    if (comp.ids_.has_any(ids, numEntts))
+    {
+        LogErr(LOG, "there is already a movement record for some input entity");
+        return;
+    }
 
     // allocate ahead more memory
     const size newCapacity = comp.ids_.size() + numEntts;
@@ -93,22 +95,42 @@ void MoveSystem::AddRecords(
     comp.rotationQuats_.reserve(newCapacity);
 
 
-    // execute sorted insertion into the data arrays
+    // append records into the data arrays
     for (index i = 0; i < numEntts; ++i)
-        comp.ids_.insert_before(idxs[i] + i, ids[i]);
+        comp.ids_.push_back(ids[i]);
 
     for (index i = 0; i < numEntts; ++i)
-        comp.translationAndUniScales_.insert_before(idxs[i] + i, packedTrScales[i]);
+        comp.translationAndUniScales_.push_back(packedTrScales[i]);
 
     for (index i = 0; i < numEntts; ++i)
-        comp.rotationQuats_.insert_before(idxs[i] + i, normRotQuats[i]);
+        comp.rotationQuats_.push_back(normRotQuats[i]);
 }
 
 ///////////////////////////////////////////////////////////
 
-void MoveSystem::RemoveRecords(const cvector<EntityID>& enttsIDs)
+void MoveSystem::RemoveRecords(const EntityID* ids, const size numEntts)
 {
-    throw EngineException("TODO: IMPLEMENT IT!");
+    if (!ids || numEntts <= 0)
+    {
+        LogErr(LOG, "invalid input args (ids arr: %p, num entts: %d)", ids, (int)numEntts);
+        return;
+    }
+
+    Movement& comp = *pMoveComponent_;
+
+    for (index i = 0; i < numEntts; ++i)
+    {
+        const index idx = comp.ids_.swap_remove(ids[i]);
+
+        if (idx == -1)
+        {
+            LogErr(LOG, "there is no movement record by id: %" PRIu32, ids[i]);
+            continue;
+        }
+
+        comp.translationAndUniScales_.swap_pop(idx);
+        comp.rotationQuats_.swap_pop(idx);
+    }
 }
 
 }
@@ -37,9 +37,9 @@ public:
         const float* uniformScaleFactors,
         const size numEntts);
 
-	void RemoveRecords(const cvector<EntityID>& enttsIDs);
+	void RemoveRecords(const EntityID* ids, const size numEntts);
 
-	inline void GetEnttsIDsFromMoveComponent(cvector<EntityID>& outEnttsIDs) { outEnttsIDs = pMoveComponent_->ids_; }
+	inline void GetEnttsIDsFromMoveComponent(cvector<EntityID>& outEnttsIDs) { outEnttsIDs = pMoveComponent_->ids_.dense(); }
 
 private:
 	Transform*   pTransformComponent_ = nullptr;
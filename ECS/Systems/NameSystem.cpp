@@ -10,9 +10,6 @@
 namespace ECS
 {
 
-// static arrays for internal purposes
-static cvector<index> s_Idxs;
-
 //---------------------------------------------------------
 // Desc:  internal private helper to check if input arr of names is completely valid
 //---------------------------------------------------------
@@ -87,11 +84,16 @@ bool NameSystem::AddRecord(const EntityID id, const char* name)
 
 
     Name& comp = *pNameComponent_;
-    const index idx = comp.ids_.get_insert_idx(id);
 
-    // execute sorted insertion of IDs
-    comp.ids_.insert_before(idx, id);
-    comp.names_.insert_before(idx, name);
+    if (comp.ids_.has(id))
+    {
+        LogErr(LOG, "entity (%" PRIu32 ") already has a name: %s", id, GetNameById(id));
+        return false;
+    }
+
+    comp.ids_.push_back(id);
+    comp.names_.push_back(name);
+    comp.idsByNames_.Insert(HashStr(name), id);
 
     return true;
 }
@@ -122,6 +124,14 @@ bool NameSystem::AddRecords(
         return false;
     }
 
+    Name& comp = *pNameComponent_;
+    ScratchVec<uint64> hashes;
+    hashes.resize(numEntts);
+
+    // index of input names (by idx) to check there are no duplicates among them
+    StrHashIndex inputNames;
+    inputNames.Reserve((int)numEntts);
+
     // check if each input name is not empty and is unique
     for (index i = 0; i < numEntts; ++i)
     {
@@ -133,40 +143,81 @@ bool NameSystem::AddRecords(
             return false;
         }
 
-        if (!IsUnique(name))
+        hashes[i] = HashStr(name);
+        uint32 dupIdx = 0;
+
+        const bool isDuplicate = inputNames.Find(hashes[i], [&](const uint32 idx) { return names[idx] == name; }, dupIdx);
+
+        if (isDuplicate || FindIdxByName(name, hashes[i]) != -1)
         {
             LogErr(LOG, "name by idx[%td] isn't unique (entt_id: %" PRIu32 ", name: %s)", i, ids[i], name);
             return false;
         }
+
+        inputNames.Insert(hashes[i], (uint32)i);
     }
 
     //*******************************
 
-    Name& comp = *pNameComponent_;
-
-    cvector<index>& idxs = s_Idxs;
-    comp.ids_.get_insert_idxs(ids, numEntts, idxs);
+    if (comp.ids_.has_any(ids, numEntts))
+    {
+        LogErr(LOG, "some input entity already has a name");
+        return false;
+    }
 
     // allocate additional memory ahead
     const size newCapacity = comp.ids_.size() + numEntts;
     comp.ids_.reserve(newCapacity);
     comp.names_.reserve(newCapacity);
+    comp.idsByNames_.Reserve((int)newCapacity);
 
-    // execute sorted insertion of IDs
     for (index i = 0; i < numEntts; ++i)
-        comp.ids_.insert_before(idxs[i] + i, ids[i]);
+        comp.ids_.push_back(ids[i]);
 
     for (index i = 0; i < numEntts; ++i)
-        comp.names_.insert_before(idxs[i] + i, names[i]);
+        comp.names_.push_back(names[i]);
+
+    for (index i = 0; i < numEntts; ++i)
+        comp.idsByNames_.Insert(hashes[i], ids[i]);
 
     return true;
 }
 
+//---------------------------------------------------------
+// Desc:  remove names of input entities
+//        (the last record is moved into the place of removed one)
+//---------------------------------------------------------
+void NameSystem::RemoveRecords(const EntityID* ids, const size numEntts)
+{
+    if (!ids || numEntts <= 0)
+    {
+        LogErr(LOG, "invalid input args (ids arr: %p, num entts: %d)", ids, (int)numEntts);
+        return;
+    }
+
+    Name& comp = *pNameComponent_;
+
+    for (index i = 0; i < numEntts; ++i)
+    {
+        const index idx = comp.ids_.get_idx(ids[i]);
+
+        if (idx == 0)
+        {
+            LogErr(LOG, "there is no name for entity: %" PRIu32, ids[i]);
+            continue;
+        }
+
+        comp.idsByNames_.Erase(HashStr(comp.names_[idx].c_str()), ids[i]);
+        comp.ids_.swap_remove(ids[i]);
+        comp.names_.swap_pop(idx);
+    }
+}
+
 //---------------------------------------------------------
 // Desc:  get entity ID by input name
 //        (if there is no record with such name we return 0)
 //---------------------------------------------------------
-EntityID NameSystem::GetIdByName(const char* name) const
+EntityID NameSystem::GetIdByName(const char* name, const uint64 nameHash) const
 {
     if (StrHelper::IsEmpty(name))
     {
@@ -175,7 +226,7 @@ EntityID NameSystem::GetIdByName(const char* name) const
     }
 
     const Name& comp = *pNameComponent_;
-    const index idx  = comp.names_.find(name);
+    const index idx  = FindIdxByName(name, nameHash);
 
     if (comp.ids_.is_valid_index(idx))
         return comp.ids_[idx];
@@ -213,19 +264,18 @@ void NameSystem::GetIdsByNames(
     }
 
     const Name& comp = *pNameComponent_;
-    s_Idxs.resize(numNames, 0);
+    ScratchVec<index> idxs;
+    idxs.resize(numNames);
 
-    // find idxs by names
+    // find idxs by names (or 0 if there is no such name)
     for (uint i = 0; i < numNames; ++i)
     {
-        const index idx = comp.names_.find(names[i]);
-
-        if (comp.ids_.is_valid_index(idx))
-            s_Idxs[i] = idx;
+        const index idx = FindIdxByName(names[i], HashStr(names[i]));
+        idxs[i] = (comp.ids_.is_valid_index(idx)) ? idx : 0;
     }
 
     // gather IDs by idxs
-    for (uint i = 0; const index idx : s_Idxs)
+    for (uint i = 0; const index idx : idxs)
         outIdsArr[i++] = comp.ids_[idx];
 }
 
@@ -234,13 +284,9 @@ void NameSystem::GetIdsByNames(
 //---------------------------------------------------------
 const char* NameSystem::GetNameById(const EntityID id) const
 {
+    // if there is no such entity we get idx == 0 ("invalid" name)
     const Name& comp = *pNameComponent_;
-    index        idx = comp.ids_.get_idx(id);
-
-    if (!comp.names_.is_valid_index(idx))
-        idx = 0;
-
-    return comp.names_[idx].c_str();
+    return comp.names_[comp.ids_.get_idx(id)].c_str();
 }
 
 //-----------------------------------------------------
@@ -255,7 +301,27 @@ bool NameSystem::IsUnique(const char* name) const
     }
 
     // if there is no such a name its idx == -1 (so it is a unique name)
-    return pNameComponent_->names_.find(name) == -1;
+    return FindIdxByName(name, HashStr(name)) == -1;
+}
+
+//-----------------------------------------------------
+// Desc:   find an idx of record by input name using the hash index
+// Ret:    idx or -1 if there is no such a name
+//-----------------------------------------------------
+index NameSystem::FindIdxByName(const char* name, const uint64 nameHash) const
+{
+    const Name& comp = *pNameComponent_;
+    EntityID    id   = INVALID_ENTT_ID;
+
+    auto isEqual = [&comp, name](const EntityID enttId)
+    {
+        return strcmp(comp.names_[comp.ids_.get_idx(enttId)].c_str(), name) == 0;
+    };
+
+    if (!comp.idsByNames_.Find(nameHash, isEqual, id))
+        return -1;
+
+    return comp.ids_.get_idx(id);
 }
 
 }
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <Types.h>
+#include <str_hash_index.h>
 #include "../Components/Name.h"
 
 namespace ECS
@@ -26,15 +27,25 @@ public:
         const std::string* names,
         const size numEntts);
 
-    EntityID    GetIdByName(const char* name) const;
+    void RemoveRecords(const EntityID* ids, const size numEntts);
+
+    // hash of name can be precomputed (for instance: for string literals)
+    EntityID    GetIdByName(const char* name, const uint64 nameHash) const;
     const char* GetNameById(const EntityID id) const;
 
+    inline EntityID GetIdByName(const char* name) const
+    {
+        return GetIdByName(name, HashStr(name ? name : ""));
+    }
+
     void GetIdsByNames(const char** names, const size numNames, cvector<EntityID>& outIds) const;
     void GetIdsByNames(const char** names, const size numNames, EntityID* outIdsArr)       const;
 
     bool IsUnique(const char* name) const;
 
 private:
+    index FindIdxByName(const char* name, const uint64 nameHash) const;
+
     Name* pNameComponent_ = nullptr;
 };
 
@@ -10,7 +10,18 @@
 namespace ECS
 {
 
+// if particles weren't updated for longer than this time we catch them up
+// in closed form with steps of the reference size (instead of a single step)
+constexpr float PARTICLES_MAX_STEP_SEC = 0.1f;
+constexpr float PARTICLES_REF_STEP_SEC = 1.0f / 60.0f;
 
+// default capacity of particles pool of "splash" emitters (in number of bursts)
+constexpr int   PARTICLES_POOL_NUM_SPLASHES = 16;
+
+// default capacity of particles pool is a bit more than the number of
+// particles alive at once (spawn rate * lifetime)
+constexpr float PARTICLES_POOL_RESERVE = 1.25f;
+constexpr int   PARTICLES_POOL_MAX_SIZE = 1 << 20;
 
 //---------------------------------------------------------
 // Desc:  default constructor
@@ -46,186 +57,390 @@ void ParticleSystem::AddEmitter(const EntityID id)
         return;
     }
 
+    if (pParticleComponent_->ids.has(id))
+    {
+        LogErr(LOG, "there is already an emitter bound to entity: %" PRIu32, id);
+        return;
+    }
+
     // push a new emitter and set related entity ID
     pParticleComponent_->ids.push_back(id);
     pParticleComponent_->data.push_back(EmitterData());
 }
 
-
-
 //---------------------------------------------------------
-// Desc:  update all the particles of the input emitter
-// Args:  - emitter:  particles emitter by itself
-//        - dt:       delta time
-//        - aabb:     emitter's axis-aligned bounding box
+// Desc:    remove emitters (with all their particles) of input entities
+//          (the last emitter is moved into the place of removed one)
 //---------------------------------------------------------
-void UpdateParticleEmitter(EmitterData& emitter, const float dt, const Rect3d& aabb)
+void ParticleSystem::RemoveEmitters(const EntityID* ids, const size numEntts)
 {
-    using namespace DirectX;
+    if (!ids || numEntts <= 0)
+    {
+        LogErr(LOG, "invalid input args (ids arr: %p, num entts: %d)", ids, (int)numEntts);
+        return;
+    }
 
-    const float invLife = 1.0f / emitter.life;
-    const float delta   = dt * 200;
+    ParticleEmitter& comp = *pParticleComponent_;
 
-    for (Particle& particle : emitter.particles)
+    for (index i = 0; i < numEntts; ++i)
     {
-        // update particle's age
-        particle.ageMs -= dt;
+        const index idx = comp.ids.swap_remove(ids[i]);
 
-        // if this particle is already dead we remove it
-        if (particle.ageMs <= 0.0f)
+        if (idx == -1)
         {
-            // swap n pop
-            particle = emitter.particles.back();
-            emitter.particles.pop_back();
+            LogErr(LOG, "there is no emitter by id: %" PRIu32, ids[i]);
+            continue;
         }
-    }
 
-    // if all are dead...
-    if (emitter.particles.empty())
-        return;
+        comp.data.swap_pop(idx);
 
+        // removed emitter can't be visible anymore
+        for (index j = 0; j < visEmitters_.size(); ++j)
+        {
+            if (visEmitters_[j] == ids[i])
+            {
+                visEmitters_.swap_pop(j);
+                break;
+            }
+        }
+    }
+}
 
-    // update particles positions
-    const float velChangeFactor = emitter.mass * delta;
 
-    for (Particle& particle : emitter.particles)
-        particle.pos += (particle.vel * velChangeFactor);
 
+//---------------------------------------------------------
+// integration of particles over a number of steps:
+// pos = pos + vel*posByVel + posByForce
+// vel =       vel*velByVel + velByForce
+//---------------------------------------------------------
+struct ParticlesStep
+{
+    float             ageDt      = 0;
+    float             posByVel   = 0;
+    float             velByVel   = 0;
+    DirectX::XMFLOAT3 posByForce = { 0,0,0 };
+    DirectX::XMFLOAT3 velByForce = { 0,0,0 };
+};
 
-    // 1. if particle still in AABB we do nothing
-    // 2. according to emitter's hit event:
-    //    a) kill particle if it is out of AABB
-    //    b) reflect particle from AABB (so it remains withing AABB)
-    for (Particle& particle : emitter.particles)
-    {
-        const float posX = XMVectorGetX(particle.pos);
-        const float posY = XMVectorGetY(particle.pos);
-        const float posZ = XMVectorGetZ(particle.pos);
+//---------------------------------------------------------
+// Desc:  calc integration coefficients for numSteps steps of size stepDt;
+//        a single step is: (pos += vel*k; vel = vel*a + f) so after n steps
+//        (sums of geometric series):
+//          vel_n = vel*a^n + f*S                       where S = (1 - a^n) / (1 - a)
+//          pos_n = pos + k*(vel*S + f*(n - S) / (1 - a))
+//        so particles out of view are caught up in a single pass
+//---------------------------------------------------------
+ParticlesStep CalcParticlesStep(const EmitterData& emitter, const float stepDt, const float numSteps)
+{
+    using namespace DirectX;
 
-        const bool outX = (posX < aabb.x0) || (posX > aabb.x1);
-        const bool outY = (posY < aabb.y0) || (posY > aabb.y1);
-        const bool outZ = (posZ < aabb.z0) || (posZ > aabb.z1);
+    const float delta = stepDt * 200;
+    const float k     = emitter.mass * delta;
+    const float a     = 1 - emitter.friction * delta;
 
-        if (outX || outY || outZ)
-        {
-            // kill particle
-            if (emitter.hitEvent == EVENT_PARTICLE_HIT_BOX_DIE)
-            {
-                particle = emitter.particles.back();
-                emitter.particles.pop_back();
-            }
+    XMFLOAT3 f;
+    XMStoreFloat3(&f, emitter.forces * delta);
 
-            // reflect particle
-            else if (emitter.hitEvent == EVENT_PARTICLE_HIT_BOX_REFLECT)
-            {
-                const float reflectX = (outX) ? -1.0f : 1.0f;
-                const float reflectY = (outY) ? -1.0f : 1.0f;
-                const float reflectZ = (outZ) ? -1.0f : 1.0f;
+    float an      = a;         // a^n
+    float sumVel  = 1;         // S
+    float sumF    = 0;         // (n - S) / (1 - a)
 
-                particle.vel *= XMVECTOR{ reflectX, reflectY, reflectZ };
-                particle.color = emitter.colorAfterReflect;
-            }
+    if (numSteps != 1.0f)
+    {
+        an = (a > 0) ? powf(a, numSteps) : 0.0f;
+
+        // no friction: S = n, sum of forces = n*(n-1)/2
+        if (fabsf(1 - a) < 1e-6f)
+        {
+            sumVel = numSteps;
+            sumF   = numSteps * (numSteps - 1) * 0.5f;
+        }
+        else
+        {
+            sumVel = (1 - an) / (1 - a);
+            sumF   = (numSteps - sumVel) / (1 - a);
         }
     }
 
-    // now it's time for the external forces to take their toll
-    const float    friction = (1 - emitter.friction * delta);
-    const XMVECTOR forces   = emitter.forces * delta;
+    ParticlesStep step;
+    step.ageDt      = stepDt * numSteps;
+    step.posByVel   = k * sumVel;
+    step.velByVel   = an;
+    step.posByForce = { f.x * k * sumF,  f.y * k * sumF,  f.z * k * sumF };
+    step.velByForce = { f.x * sumVel,    f.y * sumVel,    f.z * sumVel };
 
-    for (Particle& particle : emitter.particles)
-    {
-        particle.vel *= friction;
-        particle.vel += forces;
-    }
+    return step;
+}
 
+//---------------------------------------------------------
+// Desc:  update all the particles of the input emitter in a single pass:
+//        age, integrate position, test against the AABB, apply external forces;
+//        particles are processed by blocks (one SIMD register per attribute)
+//        and dead particles are removed by stream compaction (alive particles
+//        are moved to the front and keep their order)
+// Args:  - emitter:  particles emitter by itself
+//        - step:     integration coefficients (look at CalcParticlesStep)
+//        - aabb:     emitter's axis-aligned bounding box
+//---------------------------------------------------------
+void UpdateParticleEmitter(EmitterData& emitter, const ParticlesStep& step, const Rect3d& aabb)
+{
+    using namespace DirectX;
 
-    // change transparency during life
-    if (emitter.startAlpha != emitter.endAlpha)
+    ParticlesSoA& p            = emitter.particles;
+    const vsize   numParticles = p.size();
+
+    // if all are dead...
+    if (numParticles == 0)
+        return;
+
+    // what to do with particle when it goes out of AABB:
+    // a) kill particle
+    // b) reflect particle from AABB (so it remains withing AABB)
+    const bool     dieOnHit     = (emitter.hitEvent == EVENT_PARTICLE_HIT_BOX_DIE);
+    const bool     reflectOnHit = (emitter.hitEvent == EVENT_PARTICLE_HIT_BOX_REFLECT);
+
+    const XMVECTOR ageDt        = XMVectorReplicate(step.ageDt);
+    const XMVECTOR posByVel     = XMVectorReplicate(step.posByVel);
+    const XMVECTOR velByVel     = XMVectorReplicate(step.velByVel);
+    const XMVECTOR posByForceX  = XMVectorReplicate(step.posByForce.x);
+    const XMVECTOR posByForceY  = XMVectorReplicate(step.posByForce.y);
+    const XMVECTOR posByForceZ  = XMVectorReplicate(step.posByForce.z);
+    const XMVECTOR velByForceX  = XMVectorReplicate(step.velByForce.x);
+    const XMVECTOR velByForceY  = XMVectorReplicate(step.velByForce.y);
+    const XMVECTOR velByForceZ  = XMVectorReplicate(step.velByForce.z);
+
+    const XMVECTOR minX         = XMVectorReplicate(aabb.x0);
+    const XMVECTOR minY         = XMVectorReplicate(aabb.y0);
+    const XMVECTOR minZ         = XMVectorReplicate(aabb.z0);
+    const XMVECTOR maxX         = XMVectorReplicate(aabb.x1);
+    const XMVECTOR maxY         = XMVectorReplicate(aabb.y1);
+    const XMVECTOR maxZ         = XMVectorReplicate(aabb.z1);
+
+    vsize numAlive = 0;
+
+    for (vsize i = 0; i < numParticles; i += PARTICLES_BLOCK_SIZE)
     {
-        const float startAlpha = emitter.startAlpha;
-        const float endAlpha   = emitter.endAlpha;
+        // update age and positions
+        const XMVECTOR age  = XMVectorSubtract(XMLoadFloat4((const XMFLOAT4*)&p.age[i]), ageDt);
+
+        XMVECTOR velX = XMLoadFloat4((const XMFLOAT4*)&p.velX[i]);
+        XMVECTOR velY = XMLoadFloat4((const XMFLOAT4*)&p.velY[i]);
+        XMVECTOR velZ = XMLoadFloat4((const XMFLOAT4*)&p.velZ[i]);
+
+        const XMVECTOR posX = XMVectorMultiplyAdd(velX, posByVel, XMVectorAdd(XMLoadFloat4((const XMFLOAT4*)&p.posX[i]), posByForceX));
+        const XMVECTOR posY = XMVectorMultiplyAdd(velY, posByVel, XMVectorAdd(XMLoadFloat4((const XMFLOAT4*)&p.posY[i]), posByForceY));
+        const XMVECTOR posZ = XMVectorMultiplyAdd(velZ, posByVel, XMVectorAdd(XMLoadFloat4((const XMFLOAT4*)&p.posZ[i]), posByForceZ));
+
+        // test against the emitter's AABB
+        const XMVECTOR outX = XMVectorOrInt(XMVectorLess(posX, minX), XMVectorGreater(posX, maxX));
+        const XMVECTOR outY = XMVectorOrInt(XMVectorLess(posY, minY), XMVectorGreater(posY, maxY));
+        const XMVECTOR outZ = XMVectorOrInt(XMVectorLess(posZ, minZ), XMVectorGreater(posZ, maxZ));
+        const XMVECTOR out  = XMVectorOrInt(outX, XMVectorOrInt(outY, outZ));
 
-        for (Particle& particle : emitter.particles)
+        XMVECTOR isDead = XMVectorLessOrEqual(age, XMVectorZero());
+
+        if (dieOnHit)
         {
-            const float lerpFactor = particle.ageMs * invLife;
-            particle.alpha         = lerp(startAlpha, endAlpha, lerpFactor);
+            isDead = XMVectorOrInt(isDead, out);
+        }
+        else if (reflectOnHit)
+        {
+            velX = XMVectorSelect(velX, XMVectorNegate(velX), outX);
+            velY = XMVectorSelect(velY, XMVectorNegate(velY), outY);
+            velZ = XMVectorSelect(velZ, XMVectorNegate(velZ), outZ);
         }
-    }
 
+        // now it's time for the external forces to take their toll
+        velX = XMVectorMultiplyAdd(velX, velByVel, velByForceX);
+        velY = XMVectorMultiplyAdd(velY, velByVel, velByForceY);
+        velZ = XMVectorMultiplyAdd(velZ, velByVel, velByForceZ);
 
-    // change particle color during life
-    // (if hit box reflect then particle can have only 2 colors: before and after hit, so we don't update them here)
-    if (emitter.hitEvent != EVENT_PARTICLE_HIT_BOX_REFLECT)
-    {
-        const Vec3 colorStart(&emitter.startColor.x);
-        const Vec3 colorEnd(&emitter.endColor.x);
 
-        for (Particle& particle : emitter.particles)
+        // padding particles of the last block are dead as well
+        const vsize numLanes = (numParticles - i < PARTICLES_BLOCK_SIZE) ? numParticles - i : PARTICLES_BLOCK_SIZE;
+
+        uint32 deadMask[PARTICLES_BLOCK_SIZE];
+        uint32 outMask [PARTICLES_BLOCK_SIZE];
+        XMStoreInt4(deadMask, isDead);
+        XMStoreInt4(outMask,  out);
+
+        const bool isWholeBlockAlive =
+            (numLanes == PARTICLES_BLOCK_SIZE) &&
+            !(deadMask[0] | deadMask[1] | deadMask[2] | deadMask[3]);
+
+        // fast path: nothing was removed so far so write the block in place
+        if (isWholeBlockAlive && (numAlive == i))
         {
-            const float lerpFactor = particle.ageMs * invLife;
-            Vec3 color;
+            XMStoreFloat4((XMFLOAT4*)&p.posX[i], posX);
+            XMStoreFloat4((XMFLOAT4*)&p.posY[i], posY);
+            XMStoreFloat4((XMFLOAT4*)&p.posZ[i], posZ);
+            XMStoreFloat4((XMFLOAT4*)&p.velX[i], velX);
+            XMStoreFloat4((XMFLOAT4*)&p.velY[i], velY);
+            XMStoreFloat4((XMFLOAT4*)&p.velZ[i], velZ);
+            XMStoreFloat4((XMFLOAT4*)&p.age[i],  age);
+
+            if (reflectOnHit)
+            {
+                for (vsize k = 0; k < PARTICLES_BLOCK_SIZE; ++k)
+                    p.isReflected[i + k] |= (outMask[k] != 0);
+            }
 
-            Vec3Lerp(colorStart, colorEnd, lerpFactor, color);
-            particle.color = XMFLOAT3(color.x, color.y, color.z);
+            numAlive += PARTICLES_BLOCK_SIZE;
+            continue;
         }
-    }
 
+        // stream compaction: move alive particles of the block to the front
+        // (numAlive <= i so we never overwrite particles which aren't processed yet)
+        XMFLOAT4 block[7];
+        XMStoreFloat4(&block[0], posX);
+        XMStoreFloat4(&block[1], posY);
+        XMStoreFloat4(&block[2], posZ);
+        XMStoreFloat4(&block[3], velX);
+        XMStoreFloat4(&block[4], velY);
+        XMStoreFloat4(&block[5], velZ);
+        XMStoreFloat4(&block[6], age);
+
+        for (vsize k = 0; k < numLanes; ++k)
+        {
+            if (deadMask[k])
+                continue;
+
+            const vsize src = i + k;
+            const vsize dst = numAlive++;
+
+            p.posX[dst]            = (&block[0].x)[k];
+            p.posY[dst]            = (&block[1].x)[k];
+            p.posZ[dst]            = (&block[2].x)[k];
+            p.velX[dst]            = (&block[3].x)[k];
+            p.velY[dst]            = (&block[4].x)[k];
+            p.velZ[dst]            = (&block[5].x)[k];
+            p.age[dst]             = (&block[6].x)[k];
+            p.frameRandOffset[dst] = p.frameRandOffset[src];
+            p.isReflected[dst]     = p.isReflected[src] | (reflectOnHit && outMask[k]);
+        }
+    }
 
-    // change particle size during life
-    const Vec2 sizeStart(&emitter.startSize.x);
-    const Vec2 sizeEnd(&emitter.endSize.x);
+    p.resize(numAlive);
+}
 
-    if (sizeStart != sizeEnd)
+//---------------------------------------------------------
+// Desc:  write render instances of all the particles of the emitter;
+//        color, alpha, size, and texture coords are computed by age right here
+//        so they aren't stored per particle
+// Out:   - instances:  output arr (the number of elements == number of particles)
+//---------------------------------------------------------
+void WriteParticlesInstances(const EmitterData& emitter, ParticleRenderInstance* instances)
+{
+    const ParticlesSoA& p            = emitter.particles;
+    const vsize         numParticles = p.size();
+    const float         invLife      = 1.0f / emitter.life;
+
+    // if hit box reflect then particle can have only 2 colors: before and after hit
+    const bool          reflectOnHit = (emitter.hitEvent == EVENT_PARTICLE_HIT_BOX_REFLECT);
+
+    const DirectX::XMFLOAT3 startColor  = emitter.startColor;
+    const DirectX::XMFLOAT3 endColor    = emitter.endColor;
+    const DirectX::XMFLOAT3 hitColor    = emitter.colorAfterReflect;
+    const DirectX::XMFLOAT2 startSize   = emitter.startSize;
+    const DirectX::XMFLOAT2 endSize     = emitter.endSize;
+    const float             startAlpha  = emitter.startAlpha;
+    const float             endAlpha    = emitter.endAlpha;
+
+    for (vsize i = 0; i < numParticles; ++i)
     {
-        for (Particle& particle : emitter.particles)
+        ParticleRenderInstance& instance   = instances[i];
+        const float             lerpFactor = p.age[i] * invLife;
+
+        if (reflectOnHit)
         {
-            const float lerpFactor = particle.ageMs * invLife;
-            Vec2 size;
+            const DirectX::XMFLOAT3& color = (p.isReflected[i]) ? hitColor : startColor;
 
-            Vec2Lerp(sizeStart, sizeEnd, lerpFactor, size);
-            particle.size = XMFLOAT2(size.x, size.y);
+            instance.color.x = color.x;
+            instance.color.y = color.y;
+            instance.color.z = color.z;
+        }
+        else
+        {
+            instance.color.x = lerp(startColor.x, endColor.x, lerpFactor);
+            instance.color.y = lerp(startColor.y, endColor.y, lerpFactor);
+            instance.color.z = lerp(startColor.z, endColor.z, lerpFactor);
         }
-    }
 
+        instance.color.w = lerp(startAlpha, endAlpha, lerpFactor);
+        instance.pos     = { p.posX[i], p.posY[i], p.posZ[i] };
+        instance.size    = { lerp(startSize.x, endSize.x, lerpFactor), lerp(startSize.y, endSize.y, lerpFactor) };
+        instance.uv0     = { 0,0 };
+        instance.uv1     = { 1,1 };
+    }
 
-    // update particles texture animation (if necessary)
+    // texture animation: select a frame of spritesheet by lifespan of particle
     if (emitter.hasTexAnimations)
     {
-        const int  numFramesX = emitter.numTexFramesByX;
-        const int  numFramesY = emitter.numTexFramesByY;
+        const int   numFramesX   = emitter.numTexFramesByX;
+        const int   numFramesY   = emitter.numTexFramesByY;
 
-        const int   numFrames = numFramesX * numFramesY;
+        const int   numFrames    = numFramesX * numFramesY;
         const float frameTimeSec = emitter.texAnimDurationSec / (float)numFrames;
 
         const float dtu = 1.0f / (float)numFramesX;
         const float dtv = 1.0f / (float)numFramesY;
 
-
-        for (int i = 0; Particle& particle : emitter.particles)
+        for (vsize i = 0; i < numParticles; ++i)
         {
-            const float lifespan = emitter.life - particle.ageMs;
-            int currFrame = (int)floorf(lifespan / frameTimeSec);
+            const float lifespan  = emitter.life - p.age[i];
+            int         currFrame = (int)floorf(lifespan / frameTimeSec);
 
-            currFrame += particle.frameRandOffset;
+            currFrame += p.frameRandOffset[i];
             currFrame %= numFrames;
 
             const int rowIdx = currFrame / numFramesX;
             const int colIdx = currFrame % numFramesX;
 
-            const float tu0 = dtu * colIdx;
-            const float tv0 = dtv * rowIdx;
+            instances[i].uv0 = { dtu * colIdx,       dtv * rowIdx };
+            instances[i].uv1 = { dtu * (colIdx + 1), dtv * (rowIdx + 1) };
+        }
+    }
+}
 
-            const float tu1 = dtu * (colIdx + 1);
-            const float tv1 = dtv * (rowIdx + 1);
+//---------------------------------------------------------
+// Desc:   args for updating of emitters range in parallel
+//---------------------------------------------------------
+struct UpdateEmittersArgs
+{
+    ParticleSystem* pSys = nullptr;
+    const EntityID* ids  = nullptr;
+};
 
-            particle.uv0 = { tu0, tv0 };
-            particle.uv1 = { tu1, tv1 };
-        }
+void UpdateEmittersRange(void* pArgs, const int start, const int end)
+{
+    const UpdateEmittersArgs& args = *(const UpdateEmittersArgs*)pArgs;
+    ParticleSystem&           sys  = *args.pSys;
+
+    for (int i = start; i < end; ++i)
+    {
+        const EntityID id      = args.ids[i];
+        EmitterData&   emitter = sys.GetEmitterData(id);
+        const float    elapsed = emitter.pendingTime;
+
+        emitter.pendingTime = 0;
+
+        if (emitter.particles.empty() || elapsed <= 0)
+            continue;
+
+        // visible emitters are updated each frame by a single step;
+        // emitters out of view are caught up in closed form
+        const ParticlesStep step = (elapsed < PARTICLES_MAX_STEP_SEC)
+            ? CalcParticlesStep(emitter, elapsed, 1.0f)
+            : CalcParticlesStep(emitter, PARTICLES_REF_STEP_SEC, elapsed / PARTICLES_REF_STEP_SEC);
+
+        UpdateParticleEmitter(emitter, step, sys.GetEmitterWorldAABB(id));
     }
 }
 
 //---------------------------------------------------------
-// Desc:   update each particle emitter
+// Desc:   update each particle emitter: visible emitters are updated each
+//         frame, emitters out of view are updated by turn within the budget
+//         (so they don't freeze and then "pop" when they are seen again)
 // Args:   - dt:  delta time
 //---------------------------------------------------------
 void ParticleSystem::Update(const float dt)
@@ -238,27 +453,110 @@ void ParticleSystem::Update(const float dt)
     if (pParticleComponent_->ids.empty())
         return;
 
-    // update only visible emitters
+    // each emitter accumulates time since its last update
+    for (EmitterData& emitter : pParticleComponent_->data)
+    {
+        emitter.pendingTime += dt;
+        emitter.isVisible    = false;
+
+        // inactive emitters don't spawn particles
+        if (emitter.isActive && emitter.srcType != EMITTER_SRC_TYPE_SPLASH)
+            emitter.time += dt;
+    }
+
     for (const EntityID id : visEmitters_)
+        GetEmitterData(id).isVisible = true;
+
+    updateEmitters_.clear();
+    updateEmitters_.append_vector(visEmitters_);
+    SelectOffscreenEmitters();
+
+    // each emitter has its own particles so emitters are updated in parallel
+    UpdateEmittersArgs args;
+    args.pSys = this;
+    args.ids  = updateEmitters_.data();
+
+    constexpr int numEmittersPerJob = 4;
+    g_JobSystem.ParallelFor((int)updateEmitters_.size(), numEmittersPerJob, UpdateEmittersRange, &args);
+
+    // generate particles for each updated emitter
+    CreateNewParticles();
+}
+
+//---------------------------------------------------------
+// Desc:   select emitters out of view which will be updated during this frame;
+//         emitters are visited by turn until the budget of particles is spent
+//         (at least one emitter is updated so each of them is updated eventually)
+//---------------------------------------------------------
+void ParticleSystem::SelectOffscreenEmitters()
+{
+    const cvector<EntityID>& ids        = pParticleComponent_->ids.dense();
+    cvector<EmitterData>&    data       = pParticleComponent_->data;
+    const index              numRecords = ids.size();
+
+    // record 0 is the "invalid" emitter
+    if (numRecords <= 1)
+        return;
+
+    int budget = offscreenBudget_;
+
+    for (index n = 1; (n < numRecords) && (budget > 0); ++n)
     {
-        UpdateParticleEmitter(GetEmitterData(id), dt, GetEmitterWorldAABB(id));
+        offscreenCursor_ = (offscreenCursor_ % (numRecords - 1)) + 1;
+        EmitterData& emitter = data[offscreenCursor_];
+
+        if (emitter.isVisible)
+            continue;
+
+        const bool canSpawn = emitter.isActive && (emitter.srcType != EMITTER_SRC_TYPE_SPLASH) && (emitter.spawnRate > 0);
+
+        // nothing to simulate
+        if (emitter.particles.empty() && !canSpawn)
+        {
+            emitter.pendingTime = 0;
+            continue;
+        }
+
+        // cost: the number of particles to update and to spawn
+        const float spawnTime = (emitter.time < emitter.life) ? emitter.time : emitter.life;
+        const int   numSpawn  = (canSpawn) ? (int)(spawnTime * emitter.spawnRate) : 0;
+
+        updateEmitters_.push_back(ids[offscreenCursor_]);
+        budget -= (int)emitter.particles.size() + numSpawn;
     }
+}
 
-    // generate particles for each active emitter
-    CreateNewParticles(dt);
+//---------------------------------------------------------
+// Desc:   args for writing of particles render instances in parallel
+//---------------------------------------------------------
+struct WriteInstancesArgs
+{
+    const EmitterData* const* emitters     = nullptr;
+    const UINT*               baseInstance = nullptr;
+    ParticleRenderInstance*   instances    = nullptr;
+};
+
+void WriteInstancesRange(void* pArgs, const int start, const int end)
+{
+    const WriteInstancesArgs& args = *(const WriteInstancesArgs*)pArgs;
+
+    for (int i = start; i < end; ++i)
+        WriteParticlesInstances(*args.emitters[i], args.instances + args.baseInstance[i]);
 }
 
 //---------------------------------------------------------
-// Desc:   push into output array rendering data of currently alive particles
-// Out:    - outInstances:   array of particles rendering data
-// Ret:    the number of added particles for rendering
+// Desc:   write rendering data of currently alive particles of visible emitters;
+//         each emitter writes its particles directly into its own range
+//         of instances so emitters are processed in parallel
 //---------------------------------------------------------
-ParticlesRenderData& ParticleSystem::GetParticlesToRender()
+void ParticleSystem::PrepareParticlesToRender()
 {
-    renderData_.particles.resize(0);                    // clear particles from the prev frame
     renderData_.Reset();
+    renderEmitters_.clear();
+
+    vsize numInstances = 0;
 
-    // go through each active particle emitter and gather alive particles
+    // go through each active particle emitter and compute ranges of instances
     for (const EntityID id : visEmitters_)
     {
         const EmitterData& emitter = GetEmitterData(id);
@@ -266,46 +564,33 @@ ParticlesRenderData& ParticleSystem::GetParticlesToRender()
         if (!emitter.isActive)
             continue;
 
-
-        const vsize prevNumInstances      = renderData_.particles.size();
-        const vsize numParticlesInEmitter = emitter.particles.size();
-        index i                           = prevNumInstances;
-
         //
         // for this emitter...
         // 
 
         // ... we start rendering particles from this "baseInstance" idx
-        renderData_.baseInstance.push_back((UINT)renderData_.particles.size());
+        renderData_.baseInstance.push_back((UINT)numInstances);
 
         // ... we will render "numInstances" particles
-        renderData_.numInstances.push_back((UINT)numParticlesInEmitter);
+        renderData_.numInstances.push_back((UINT)emitter.particles.size());
 
         // ... and use a material by this id
         renderData_.materialIds.push_back(emitter.materialId);
 
+        renderEmitters_.push_back(&emitter);
+        numInstances += emitter.particles.size();
+    }
 
-        // store data of each alive particle
-        renderData_.particles.resize(prevNumInstances + numParticlesInEmitter);
-
-        for (const Particle& particle : emitter.particles)
-        {
-            renderData_.particles[i].color.x = particle.color.x;
-            renderData_.particles[i].color.y = particle.color.y;
-            renderData_.particles[i].color.z = particle.color.z;
-            renderData_.particles[i].color.w = particle.alpha;
-
-            DirectX::XMStoreFloat3(&renderData_.particles[i].pos, particle.pos);
-
-            renderData_.particles[i].uv0     = particle.uv0;
-            renderData_.particles[i].uv1     = particle.uv1;
-            renderData_.particles[i].size    = particle.size;
+    renderData_.particles.resize(numInstances);
 
-            ++i;
-        }
-    }
+    // store data of each alive particle
+    WriteInstancesArgs args;
+    args.emitters     = renderEmitters_.data();
+    args.baseInstance = renderData_.baseInstance.data();
+    args.instances    = renderData_.particles.data();
 
-    return renderData_;
+    constexpr int numEmittersPerJob = 2;
+    g_JobSystem.ParallelFor((int)renderEmitters_.size(), numEmittersPerJob, WriteInstancesRange, &args);
 }
 
 //-----------------------------------------------------
@@ -326,16 +611,24 @@ void ParticleSystem::PushNewParticles(const EntityID id, const uint numNewPartic
 {
     EmitterData& data = GetEmitterData(id);
 
+    if (data.particles.GetCapacity() == 0)
+        InitParticlesPool(id);
+
+    // if the pool is full we generate only as many particles as we can
+    const vsize numFree = data.particles.GetNumFree();
+    const uint  numNew  = ((vsize)numNewParticles < numFree) ? numNewParticles : (uint)numFree;
+
+    if (numNew == 0)
+        return;
+
     // force update emitter's position
     data.position = pTransformSys_->GetPositionVec(id);
 
-    // alloc memory for new particles and generate them
-    size currNumParticles = data.particles.size();
-    data.particles.resize(currNumParticles + numNewParticles);
-
-    Particle* newParticles = &data.particles[currNumParticles];
+    // take new particles from the pool and generate them
+    const vsize currNumParticles = data.particles.size();
+    data.particles.resize(currNumParticles + numNew);
 
-    SetupNewParticles(id, data, newParticles, numNewParticles);
+    SetupNewParticles(id, data, data.particles, currNumParticles, numNew);
 }
 
 //-----------------------------------------------------
@@ -343,7 +636,12 @@ void ParticleSystem::PushNewParticles(const EntityID id, const uint numNewPartic
 //-----------------------------------------------------
 void ParticleSystem::SetSpawnRate(const EntityID id, const uint spawnRate)
 {
-    GetEmitterData(id).spawnRate = spawnRate;
+    EmitterData& emitter = GetEmitterData(id);
+    emitter.spawnRate = spawnRate;
+
+    // the pool can only grow
+    if (emitter.particles.GetCapacity() > 0)
+        InitParticlesPool(id);
 }
 
 //-----------------------------------------------------
@@ -365,7 +663,12 @@ void ParticleSystem::SetLife(const EntityID id, const float lifeMs)
         return;
     }
 
-    GetEmitterData(id).life = lifeMs * 0.001f;
+    EmitterData& emitter = GetEmitterData(id);
+    emitter.life = lifeMs * 0.001f;
+
+    // the pool can only grow
+    if (emitter.particles.GetCapacity() > 0)
+        InitParticlesPool(id);
 }
 
 //-----------------------------------------------------
@@ -435,19 +738,84 @@ void ParticleSystem::ResetNumSpawnedParticles(const EntityID id)
     GetEmitterData(id).numSpawned = 0;
 }
 
+//-----------------------------------------------------
+// Desc:  set max number of particles of emitters out of view
+//        which can be updated per frame
+//-----------------------------------------------------
+void ParticleSystem::SetOffscreenBudget(const int numParticles)
+{
+    if (numParticles <= 0)
+    {
+        LogErr(LOG, "budget of particles must be > 0 (input: %d)", numParticles);
+        return;
+    }
+
+    offscreenBudget_ = numParticles;
+}
+
 //---------------------------------------------------------
-// Desc:   generate new particles for each active emitter
-// Args:   - dt: delta time
+// Desc:   alloc a fixed pool of particles for emitter; if max_particles isn't
+//         set in config, the pool is sized by the number of particles which
+//         are alive at once (for "splash" emitters: by a number of bursts)
 //---------------------------------------------------------
-void ParticleSystem::CreateNewParticles(const float dt)
+void ParticleSystem::InitParticlesPool(const EntityID id)
 {
-    // prevent generation of too big amount of particles after game pauses
-    if (dt >= 0.1f)
-        return;
+    EmitterData& emitter = GetEmitterData(id);
+    int          capacity = emitter.maxParticles;
 
+    if (capacity <= 0)
+    {
+        if (emitter.srcType == EMITTER_SRC_TYPE_SPLASH)
+            capacity = emitter.spawnRate * PARTICLES_POOL_NUM_SPLASHES;
+        else
+            capacity = (int)ceilf(emitter.spawnRate * emitter.life * PARTICLES_POOL_RESERVE);
+    }
 
-    // update only visible particle emitters
-    for (const EntityID id : visEmitters_)
+    if (capacity > PARTICLES_POOL_MAX_SIZE)
+    {
+        LogErr(LOG, "too big pool of particles (%d) for entt: %" PRIu32 " (clamped to %d)", capacity, id, PARTICLES_POOL_MAX_SIZE);
+        capacity = PARTICLES_POOL_MAX_SIZE;
+    }
+
+    emitter.particles.reserve(capacity);
+}
+
+//---------------------------------------------------------
+// Desc:   new particles of emitter out of view were born during the elapsed
+//         time window so spread their ages over this window and move them
+//         into the state they have now (in closed form as well)
+//---------------------------------------------------------
+void AdvanceNewParticles(EmitterData& emitter, const vsize startIdx, const uint numParticles, const float window)
+{
+    ParticlesSoA& p       = emitter.particles;
+    const float   invNum  = 1.0f / (float)numParticles;
+
+    for (uint i = 0; i < numParticles; ++i)
+    {
+        const vsize         idx     = startIdx + i;
+        const float         bornAgo = window * ((float)i + 0.5f) * invNum;
+        const ParticlesStep step    = CalcParticlesStep(emitter, PARTICLES_REF_STEP_SEC, bornAgo / PARTICLES_REF_STEP_SEC);
+
+        p.posX[idx] += p.velX[idx] * step.posByVel + step.posByForce.x;
+        p.posY[idx] += p.velY[idx] * step.posByVel + step.posByForce.y;
+        p.posZ[idx] += p.velZ[idx] * step.posByVel + step.posByForce.z;
+
+        p.velX[idx]  = p.velX[idx] * step.velByVel + step.velByForce.x;
+        p.velY[idx]  = p.velY[idx] * step.velByVel + step.velByForce.y;
+        p.velZ[idx]  = p.velZ[idx] * step.velByVel + step.velByForce.z;
+
+        p.age[idx]  -= bornAgo;
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   generate new particles for each active emitter updated during
+//         this frame; the number of particles is limited by the free space
+//         in the emitter's pool (so bursts never cause reallocations)
+//---------------------------------------------------------
+void ParticleSystem::CreateNewParticles()
+{
+    for (const EntityID id : updateEmitters_)
     {
         EmitterData& emitter = GetEmitterData(id);
 
@@ -457,9 +825,11 @@ void ParticleSystem::CreateNewParticles(const float dt)
         if (emitter.srcType == EMITTER_SRC_TYPE_SPLASH)
             continue;
 
-        emitter.time += dt;
+        // particles which were born earlier than lifetime ago are already dead
+        const bool  isCatchUp = (emitter.time >= PARTICLES_MAX_STEP_SEC);
+        const float window    = (emitter.time < emitter.life) ? emitter.time : emitter.life;
 
-        const uint numNewParticles = (uint)(emitter.time * emitter.spawnRate);
+        uint numNewParticles = (uint)(window * emitter.spawnRate);
 
         // if too little time spent for generation of any particles
         if (numNewParticles == 0)
@@ -467,38 +837,58 @@ void ParticleSystem::CreateNewParticles(const float dt)
 
         emitter.time = 0;
 
+        if (emitter.particles.GetCapacity() == 0)
+            InitParticlesPool(id);
+
+        // the pool is full
+        if ((vsize)numNewParticles > emitter.particles.GetNumFree())
+            numNewParticles = (uint)emitter.particles.GetNumFree();
+
+        if (numNewParticles == 0)
+            continue;
+
         // maybe TEMP: update position of emitter
         emitter.position = pTransformSys_->GetPositionVec(id);
 
-        // alloc mem for new amount of particles and init them
-        const uint newStartIdx = (uint)emitter.particles.size();
+        // take new particles from the pool and init them
+        const vsize newStartIdx = emitter.particles.size();
         emitter.particles.resize(newStartIdx + numNewParticles);
 
-        Particle* newParticles = emitter.particles.data() + newStartIdx;
+        SetupNewParticles(id, emitter, emitter.particles, newStartIdx, numNewParticles);
 
-        SetupNewParticles(id, emitter, newParticles, numNewParticles);
+        if (isCatchUp)
+            AdvanceNewParticles(emitter, newStartIdx, numNewParticles, window);
     }
 }
 
 //---------------------------------------------------------
 // Desc:    generate data for new particles of input emitter
 // Args:    - emitter:       get from here inital params for particles
-//          - particles:     init particles from this arr
+//          - particles:     particles of the emitter
+//          - startIdx:      init particles starting from this idx
 //          - numParticles:  how many particles to init
 //---------------------------------------------------------
 void ParticleSystem::SetupNewParticles(
     const EntityID emitterId,
     const EmitterData& initData,
-    Particle* particles,
+    ParticlesSoA& particles,
+    const vsize startIdx,
     const uint numParticles)
 {
     // check input args
-    if (!particles)
+    if (startIdx + numParticles > particles.size())
     {
-        LogErr(LOG, "input arr of particles == NULL");
+        LogErr(LOG, "out of range of particles (start: %d, num: %u)", (int)startIdx, numParticles);
         return;
     }
 
+    float* velX = particles.velX.data() + startIdx;
+    float* velY = particles.velY.data() + startIdx;
+    float* velZ = particles.velZ.data() + startIdx;
+    float* posX = particles.posX.data() + startIdx;
+    float* posY = particles.posY.data() + startIdx;
+    float* posZ = particles.posZ.data() + startIdx;
+
     // init velocity: particles move in random directions
     if (initData.velDirInitType == PARTICLE_VELOCITY_DIR_RANDOM)
     {
@@ -508,12 +898,10 @@ void ParticleSystem::SetupNewParticles(
             const float yaw   = RandF(0.0f, 1.0f) * PI;
             const float pitch = DEG_TO_RAD(RandF(0.0f, 360.0f));
 
-            // set the particle's position and velocity
-            particles[i].vel = {
-                cosf(pitch)             * initData.velInitMag * RandF(), // velocity X
-                sinf(pitch) * cosf(yaw) * initData.velInitMag * RandF(), // velocity Y
-                sinf(pitch) * sinf(yaw) * initData.velInitMag * RandF()  // velocity Z
-            };
+            // set the particle's velocity
+            velX[i] = cosf(pitch)             * initData.velInitMag * RandF();
+            velY[i] = sinf(pitch) * cosf(yaw) * initData.velInitMag * RandF();
+            velZ[i] = sinf(pitch) * sinf(yaw) * initData.velInitMag * RandF();
         }
     }
 
@@ -529,11 +917,9 @@ void ParticleSystem::SetupNewParticles(
                 const float randOffsetX = RandF(0.0f, 100.0f) * PI * 0.005f - 0.5f;
                 const float randOffsetZ = RandF(0.0f, 100.0f) * PI * 0.005f - 0.5f;
 
-                particles[i].vel = {
-                    (dir.x + randOffsetX) * initData.velInitMag,
-                    (dir.y              ) * initData.velInitMag,
-                    (dir.z + randOffsetZ) * initData.velInitMag,
-                };
+                velX[i] = (dir.x + randOffsetX) * initData.velInitMag;
+                velY[i] = (dir.y              ) * initData.velInitMag;
+                velZ[i] = (dir.z + randOffsetZ) * initData.velInitMag;
             }
         }
         // src type: plane/volume
@@ -546,27 +932,38 @@ void ParticleSystem::SetupNewParticles(
 
             for (index i = 0; i < numParticles; ++i)
             {
-                particles[i].vel = { vx, vy, vz };
+                velX[i] = vx;
+                velY[i] = vy;
+                velZ[i] = vz;
             }
         }
     }
 
 
-    // init color, size, alpha, etc. for each particle
+    // init age, etc. for each particle
+    // (color, size, and alpha are computed by age when we write render instances)
     for (uint i = 0; i < numParticles; ++i)
     {
-        particles[i].color = initData.startColor;
-        particles[i].size  = initData.startSize;
-        particles[i].alpha = initData.startAlpha;
-        particles[i].ageMs = initData.life;
+        particles.age[startIdx + i]             = initData.life;
+        particles.isReflected[startIdx + i]     = 0;
+        particles.frameRandOffset[startIdx + i] = 0;
     }
    
 
     // particles spawn from a single point
-    if (initData.srcType == EMITTER_SRC_TYPE_POINT)
+    // or generate multiple particles at once and then stop generation
+    if (initData.srcType == EMITTER_SRC_TYPE_POINT ||
+        initData.srcType == EMITTER_SRC_TYPE_SPLASH)
     {
+        DirectX::XMFLOAT3 pos;
+        DirectX::XMStoreFloat3(&pos, initData.position);
+
         for (uint i = 0; i < numParticles; ++i)
-            particles[i].pos = initData.position;
+        {
+            posX[i] = pos.x;
+            posY[i] = pos.y;
+            posZ[i] = pos.z;
+        }
     }
 
     // particles spawn equally on plane's area
@@ -574,15 +971,13 @@ void ParticleSystem::SetupNewParticles(
     else if (initData.srcType == EMITTER_SRC_TYPE_PLANE)
     {
         const Rect3d aabb = GetEmitterWorldAABB(emitterId);
-        const float  posY = DirectX::XMVectorGetY(initData.position) + initData.srcPlaneHeight;
+        const float  posYPlane = DirectX::XMVectorGetY(initData.position) + initData.srcPlaneHeight;
 
         for (uint i = 0; i < numParticles; ++i)
         {
-            particles[i].pos = {
-                RandF(aabb.x0, aabb.x1),
-                posY,
-                RandF(aabb.z0, aabb.z1),
-            };
+            posX[i] = RandF(aabb.x0, aabb.x1);
+            posY[i] = posYPlane;
+            posZ[i] = RandF(aabb.z0, aabb.z1);
         }
     }
 
@@ -593,20 +988,11 @@ void ParticleSystem::SetupNewParticles(
 
         for (uint i = 0; i < numParticles; ++i)
         {
-            particles[i].pos = {
-                RandF(aabb.x0, aabb.x1),
-                RandF(aabb.y0, aabb.y1),
-                RandF(aabb.z0, aabb.z1),
-            };
+            posX[i] = RandF(aabb.x0, aabb.x1);
+            posY[i] = RandF(aabb.y0, aabb.y1);
+            posZ[i] = RandF(aabb.z0, aabb.z1);
         }
     }
-
-    // generate multiple particles at once and then stop generation
-    else if (initData.srcType == EMITTER_SRC_TYPE_SPLASH)
-    {
-        for (uint i = 0; i < numParticles; ++i)
-            particles[i].pos = initData.position;
-    }
     else
     {
         LogErr(LOG, "can't generate positions: unknown source type: %d", (int)initData.srcType);
@@ -616,15 +1002,8 @@ void ParticleSystem::SetupNewParticles(
 
     if (initData.hasTexAnimations)
     {
-        // calc initial tex coords
-        const float tu = 1.0f / (float)initData.numTexFramesByX;
-        const float tv = 1.0f / (float)initData.numTexFramesByY;
-
         for (uint i = 0; i < numParticles; ++i)
-        {
-            particles[i].uv1             = { tu, tv };
-            particles[i].frameRandOffset = (int)RandUint(0, 1000);
-        }
+            particles.frameRandOffset[startIdx + i] = (int)RandUint(0, 1000);
     }
 }
 
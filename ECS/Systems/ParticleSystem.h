@@ -35,10 +35,14 @@ public:
     //-----------------------------------------------------
 
     void                      AddEmitter     (const EntityID id);
+    void                      RemoveEmitters (const EntityID* ids, const size numEntts);
     void                      Update         (const float dt);
 
-    ParticlesRenderData&      GetParticlesToRender();
-    const cvector<Particle>&  GetParticlesOfEmitter(const EntityID id);
+    // write render instances of particles of visible emitters (once per frame
+    // after visibility is computed) and then get them as many times as we need
+    void                       PrepareParticlesToRender();
+    const ParticlesRenderData& GetParticlesToRender() const;
+    const ParticlesSoA&        GetParticlesOfEmitter(const EntityID id);
 
     const cvector<EntityID>&  GetAllEmitters() const;
     const EmitterData&        GetEmitterData(const EntityID id) const;
@@ -50,6 +54,10 @@ public:
 
     void                      PushNewParticles(const EntityID id, const uint number);
 
+    // alloc a fixed pool of particles for emitter (by its max_particles or
+    // by spawn rate and lifetime of particles)
+    void                      InitParticlesPool(const EntityID id);
+
     bool IsActive       (const EntityID id) const;
 
     void SetSpawnRate   (const EntityID id, const uint spawnRate);
@@ -63,15 +71,20 @@ public:
 
     void ResetNumSpawnedParticles(const EntityID id);
 
+    // max number of particles of emitters out of view which can be updated per frame
+    void SetOffscreenBudget(const int numParticles);
+
 private:
     index GetEmitterIdx(const EntityID id) const;
 
-    void  CreateNewParticles(const float dt);
+    void  SelectOffscreenEmitters();
+    void  CreateNewParticles();
 
     void SetupNewParticles(
         const EntityID emitterId,
         const EmitterData& initData,
-        Particle* particles,
+        ParticlesSoA& particles,
+        const vsize startIdx,
         const uint numParticles);
 
 public:
@@ -83,7 +96,12 @@ private:
     TransformSystem*    pTransformSys_      = nullptr;
     BoundingSystem*     pBoundingSys_       = nullptr;
 
-    ParticlesRenderData renderData_;
+    ParticlesRenderData         renderData_;
+    cvector<const EmitterData*> renderEmitters_;    // emitters which particles are in render data
+
+    cvector<EntityID>           updateEmitters_;    // emitters to update during this frame: visible + some of out of view
+    index                       offscreenCursor_ = 0;
+    int                         offscreenBudget_ = 16384;
 };
 
 //==================================================================================
@@ -91,12 +109,8 @@ private:
 //==================================================================================
 inline index ParticleSystem::GetEmitterIdx(const EntityID id) const
 {
-    const index idx = pParticleComponent_->ids.get_idx(id);
-
-    if (pParticleComponent_->ids.is_valid_index(idx))
-        return idx;
-
-    return 0;
+    // if there is no emitter by such ID we get idx == 0 ("invalid" emitter)
+    return pParticleComponent_->ids.get_idx(id);
 }
 
 inline const EmitterData& ParticleSystem::GetEmitterData(const EntityID id) const
@@ -111,7 +125,7 @@ inline EmitterData& ParticleSystem::GetEmitterData(const EntityID id)
 
 inline const cvector<EntityID>& ParticleSystem::GetAllEmitters() const
 {
-    return pParticleComponent_->ids;
+    return pParticleComponent_->ids.dense();
 }
 
 inline Rect3d ParticleSystem::GetEmitterLocalAABB(const EntityID id) const
@@ -124,11 +138,16 @@ inline Rect3d ParticleSystem::GetEmitterWorldAABB(const EntityID id) const
     return pBoundingSys_->GetWorldBoxRect3d(id);
 }
 
-inline const cvector<Particle>& ParticleSystem::GetParticlesOfEmitter(const EntityID id)
+inline const ParticlesSoA& ParticleSystem::GetParticlesOfEmitter(const EntityID id)
 {
     return GetEmitterData(id).particles;
 }
 
+inline const ParticlesRenderData& ParticleSystem::GetParticlesToRender() const
+{
+    return renderData_;
+}
+
 inline bool ParticleSystem::IsActive(const EntityID id) const
 {
     return GetEmitterData(id).isActive;
@@ -7,10 +7,6 @@ using namespace DirectX;
 namespace ECS
 {
 
-// static array for internal purposes
-static cvector<EntityID> s_Ids;
-
-
 //---------------------------------------------------------
 // just constructor
 //---------------------------------------------------------
@@ -175,9 +171,10 @@ void PlayerSystem::Update(const float deltaTime)
     pTransformSys_->SetPosition(playerID, playerPos);
 
     // compute and set new position for each child
-    pHierarchySys_->GetChildrenArr(playerID, s_Ids);
+    ScratchVec<EntityID> childrenIds;
+    pHierarchySys_->GetChildrenArr(playerID, childrenIds);
 
-    for (const EntityID childID : s_Ids)
+    for (const EntityID childID : childrenIds)
     {
         const XMFLOAT3 childRelPos = pHierarchySys_->GetRelativePos(childID);
         const float posX = playerPos.x + childRelPos.x;
@@ -331,7 +328,8 @@ void PlayerSystem::Pitch(float angle)
     const EntityID playerId = playerID_;
 
     // get arr of player's children entities
-    pHierarchySys_->GetChildrenArr(playerId, s_Ids);
+    ScratchVec<EntityID> childrenIds;
+    pHierarchySys_->GetChildrenArr(playerId, childrenIds);
 
     // adjust position of each child relatively to the player
     const XMVECTOR playerPosW = pTransformSys_->GetPositionVec(playerID_);
@@ -339,7 +337,7 @@ void PlayerSystem::Pitch(float angle)
     const XMVECTOR invQuat    = XMQuaternionConjugate(rotQuat);
 
 
-    for (int i = 0; const EntityID childID : s_Ids)
+    for (int i = 0; const EntityID childID : childrenIds)
     {
         const XMFLOAT3 oldRelPos = pHierarchySys_->GetRelativePos(childID);
         const XMVECTOR newRelPos = RotateVecByQuat({ oldRelPos.x, oldRelPos.y, oldRelPos.z, 0 }, rotQuat, invQuat);
@@ -349,8 +347,8 @@ void PlayerSystem::Pitch(float angle)
     }
 
     // adjust rotation of the player and its each child
-    s_Ids.push_back(playerId);
-    pTransformSys_->RotateLocalSpacesByQuat(s_Ids.data(), s_Ids.size(), rotQuat);
+    childrenIds.push_back(playerId);
+    pTransformSys_->RotateLocalSpacesByQuat(childrenIds.data(), childrenIds.size(), rotQuat);
 }
 
 //---------------------------------------------------------
@@ -369,13 +367,14 @@ void PlayerSystem::RotateY(float angle)
 
 
     // get arr of player's children entities
-    pHierarchySys_->GetChildrenArr(playerId, s_Ids);
+    ScratchVec<EntityID> childrenIds;
+    pHierarchySys_->GetChildrenArr(playerId, childrenIds);
 
     // adjust position of each child relatively to the player
     const XMVECTOR playerPosW   = pTransformSys_->GetPositionVec(playerId);
     const XMVECTOR invQuat      = XMQuaternionConjugate(rotQuat);
 
-    for (int i = 0; const EntityID childID : s_Ids)
+    for (int i = 0; const EntityID childID : childrenIds)
     {
         const XMFLOAT3 oldRelPos    = pHierarchySys_->GetRelativePos(childID);
         const XMVECTOR newRelPos    = RotateVecByQuat({ oldRelPos.x, oldRelPos.y, oldRelPos.z, 0 }, rotQuat, invQuat);
@@ -385,8 +384,8 @@ void PlayerSystem::RotateY(float angle)
     }
 
     // adjust rotation of the player and its each child
-    s_Ids.push_back(playerId);
-    pTransformSys_->RotateLocalSpacesByQuat(s_Ids.data(), s_Ids.size(), rotQuat);
+    childrenIds.push_back(playerId);
+    pTransformSys_->RotateLocalSpacesByQuat(childrenIds.data(), childrenIds.size(), rotQuat);
 }
 
 //---------------------------------------------------------
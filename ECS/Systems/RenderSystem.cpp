@@ -29,13 +29,13 @@ void RenderSystem::AddRecords(const EntityID* ids, const size numEntts)
     CAssert::True(numEntts > 0, "input number of entts must be > 0");
 
     Rendered& comp = *pRenderComponent_;
-    cvector<index> idxs;
 
-    comp.ids.get_insert_idxs(ids, numEntts, idxs);
+    CAssert::True(!comp.ids.has_any(ids, numEntts), "there is already a render record for some input entity");
+
+    comp.ids.reserve(comp.ids.size() + numEntts);
 
-    // execute sorted insertion of input values
     for (index i = 0; i < numEntts; ++i)
-        comp.ids.insert_before(idxs[i] + i, ids[i]);
+        comp.ids.push_back(ids[i]);
 }
 
 /////////////////////////////////////////////////
@@ -54,33 +54,19 @@ void RenderSystem::RemoveRecords(const EntityID* ids, const size numEntts)
         return;
     }
 
-
-    
-
-    // remove one record
-    if (numEntts == 1)
-        RemoveRecord(ids[0]);
-
-    // remove multiple records at once
-    else
-    {
-        Rendered& comp = *pRenderComponent_;
-        assert(0 && "TODO");
-    }
+    for (index i = 0; i < numEntts; ++i)
+        RemoveRecord(ids[i]);
 }
 
 void RenderSystem::RemoveRecord(const EntityID id)
 {
     Rendered& comp = *pRenderComponent_;
-    const index idx = comp.ids.get_idx(id);
 
-    if (idx == -1)
+    if (comp.ids.swap_remove(id) == -1)
     {
         LogErr(LOG, "can't remove a render component: there is no entity by id: %" PRIu32, id);
         return;
     }
-
-    comp.ids.erase(idx);
 }
 
 } // namespace ECS
@@ -25,7 +25,7 @@ public:
     void RemoveRecords(const EntityID* ids, const size numEntts);
     void RemoveRecord(const EntityID id);
 
-    inline bool HasEntity(const EntityID id) const { return pRenderComponent_->ids.binary_search(id); }
+    inline bool HasEntity(const EntityID id) const { return pRenderComponent_->ids.has(id); }
 
     // clear an arr of entities that were visible in the previous frame;
     // so we will be able to use it again for the current frame;
@@ -37,7 +37,7 @@ public:
 
 
     // for debug/unit-test purposes
-    inline const cvector<EntityID>& GetAllEnttsIDs()  const { return pRenderComponent_->ids; }
+    inline const cvector<EntityID>& GetAllEnttsIDs()  const { return pRenderComponent_->ids.dense(); }
     inline cvector<EntityID>& GetVisiblePointLights() const { return pRenderComponent_->visiblePointLightsIDs; }
     
 
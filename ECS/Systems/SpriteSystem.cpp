@@ -40,20 +40,46 @@ bool SpriteSystem::AddRecord(
 {
     Sprite& comp = *pSpriteComponent_;
 
-    if (comp.ids.binary_search(enttId))
+    if (comp.ids.has(enttId))
     {
         LogErr(LOG, "there is already a sprite by id: %" PRIu32, enttId);
         return false;
     }
 
-    const index idx = comp.ids.get_insert_idx(enttId);
-
-    comp.ids.insert_before(idx, enttId);
-    comp.data.insert_before(idx, SpriteData(texId, leftPos, topPos, width, height));
+    comp.ids.push_back(enttId);
+    comp.data.push_back(SpriteData(texId, leftPos, topPos, width, height));
 
     return true;
 }
 
+//---------------------------------------------------------
+// Desc:  remove sprite records of input entities
+//        (the last record is moved into the place of removed one)
+//---------------------------------------------------------
+void SpriteSystem::RemoveRecords(const EntityID* ids, const size numEntts)
+{
+    if (!ids || numEntts <= 0)
+    {
+        LogErr(LOG, "invalid input args (ids arr: %p, num entts: %d)", ids, (int)numEntts);
+        return;
+    }
+
+    Sprite& comp = *pSpriteComponent_;
+
+    for (index i = 0; i < numEntts; ++i)
+    {
+        const index idx = comp.ids.swap_remove(ids[i]);
+
+        if (idx == -1)
+        {
+            LogErr(LOG, "there is no sprite record by id: %" PRIu32, ids[i]);
+            continue;
+        }
+
+        comp.data.swap_pop(idx);
+    }
+}
+
 //---------------------------------------------------------
 //---------------------------------------------------------
 void SpriteSystem::GetData(
@@ -82,7 +108,7 @@ index SpriteSystem::GetIdx(const EntityID id) const
 {
     const index idx = pSpriteComponent_->ids.get_idx(id);
 
-    if (idx > 0 && idx < pSpriteComponent_->ids.size())
+    if (idx != 0)
         return idx;
 
     LogErr(LOG, "there is no 2D sprites by entt id: %" PRIu32, id);
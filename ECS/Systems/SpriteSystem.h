@@ -33,6 +33,8 @@ public:
         const uint16 width,
         const uint16 height);
 
+    void RemoveRecords(const EntityID* ids, const size numEntts);
+
     void GetData(
         const EntityID enttId,
         TexID& texId,
@@ -14,10 +14,6 @@ using namespace DirectX;
 namespace ECS
 {
 
-// static arrays for internal purposes
-static cvector<index> s_Idxs;
-
-
 //---------------------------------------------------------
 // Desc:  constructor and destructor
 //---------------------------------------------------------
@@ -49,9 +45,36 @@ void TransformSystem::AddRecords(
 
 ///////////////////////////////////////////////////////////
 
-void TransformSystem::RemoveRecords(const cvector<EntityID>& enttsIDs)
+//---------------------------------------------------------
+// Desc:  remove transform records of input entities
+//        (the last record is moved into the place of removed one)
+//---------------------------------------------------------
+void TransformSystem::RemoveRecords(const EntityID* ids, const size numEntts)
 {
-    assert("TODO: IMPLEMENT IT!" && 0);
+    if (!ids || numEntts <= 0)
+    {
+        LogErr(LOG, "invalid input args (ids arr: %p, num entts: %d)", ids, (int)numEntts);
+        return;
+    }
+
+    Transform& comp = *pTransform_;
+
+    for (index i = 0; i < numEntts; ++i)
+    {
+        const index idx = comp.ids.swap_remove(ids[i]);
+
+        if (idx == -1)
+        {
+            LogErr(LOG, "there is no transform record by id: %" PRIu32, ids[i]);
+            continue;
+        }
+
+        comp.posAndScale.swap_pop(idx);
+        comp.directions.swap_pop(idx);
+        comp.worlds.swap_pop(idx);
+        comp.invWorlds.swap_pop(idx);
+        comp.dirtyFlags.swap_pop(idx);
+    }
 }
 
 // =================================================================================
@@ -74,12 +97,13 @@ void TransformSystem::GetPositions(
     }
 
     Transform& comp = *pTransform_;
-    comp.ids.get_idxs(ids, numEntts, s_Idxs);
+    ScratchVec<index> idxs;
+    comp.ids.get_idxs(ids, numEntts, idxs);
 
     // get positions by idxs
     outPositions.resize(numEntts);
 
-    for (int i = 0; const index idx : s_Idxs)
+    for (int i = 0; const index idx : idxs)
     {
         XMFLOAT4& pos = comp.posAndScale[idx];
         outPositions[i++] = { pos.x, pos.y, pos.z };
@@ -102,12 +126,13 @@ void TransformSystem::GetDirections(
     }
 
     Transform& comp = *pTransform_;
-    comp.ids.get_idxs(ids, numEntts, s_Idxs);
+    ScratchVec<index> idxs;
+    comp.ids.get_idxs(ids, numEntts, idxs);
 
     // get directions by idxs
     outDirections.resize(numEntts);
 
-    for (int i = 0; const index idx : s_Idxs)
+    for (int i = 0; const index idx : idxs)
         outDirections[i++] = comp.directions[idx];
 }
 
@@ -126,12 +151,13 @@ void TransformSystem::GetUniformScales(
     }
 
     Transform& comp = *pTransform_;
-    comp.ids.get_idxs(ids, numEntts, s_Idxs);
+    ScratchVec<index> idxs;
+    comp.ids.get_idxs(ids, numEntts, idxs);
 
     // get uniform scales by idxs
     outScales.resize(numEntts);
 
-    for (int i = 0; const index idx : s_Idxs)
+    for (int i = 0; const index idx : idxs)
         outScales[i++] = comp.posAndScale[idx].w;   // uniform scale values (float) is packed into float4 in the w-component
 }
 
@@ -156,16 +182,17 @@ void TransformSystem::GetPositionsAndDirections(
     outDirections.resize(numEntts);
 
     Transform& comp = *pTransform_;
-    comp.ids.get_idxs(ids, numEntts, s_Idxs);
+    ScratchVec<index> idxs;
+    comp.ids.get_idxs(ids, numEntts, idxs);
 
     // get positions and directions by idxs
-    for (int i = 0; const index idx : s_Idxs)
+    for (int i = 0; const index idx : idxs)
     {
         const XMFLOAT4& pos = comp.posAndScale[idx];
         outPositions[i++] = { pos.x, pos.y, pos.z };
     }
 
-    for (int i = 0; const index idx : s_Idxs)
+    for (int i = 0; const index idx : idxs)
     {
         DirectX::XMStoreFloat3(&outDirections[i], comp.directions[idx]);
         ++i;
@@ -302,17 +329,18 @@ bool TransformSystem::SetPositions(
 
     // find idxs by ids
     Transform& comp = *pTransform_;
-    comp.ids.get_idxs(ids, numEntts, s_Idxs);
+    ScratchVec<index> idxs;
+    comp.ids.get_idxs(ids, numEntts, idxs);
 
 #if DEBUG || _DEBUG
-    if (!CheckEnttsHaveTransform(ids, numEntts, s_Idxs.data(), comp))
+    if (!CheckEnttsHaveTransform(ids, numEntts, idxs.data(), comp))
         return false;
 #endif
 
     // update positions and world matrices
     for (index i = 0; i < numEntts; ++i)
     {
-        const index idx = s_Idxs[i];
+        const index idx = idxs[i];
         XMFLOAT4& data = comp.posAndScale[idx];
         const XMFLOAT3& pos = positions[i];
 
@@ -325,9 +353,9 @@ bool TransformSystem::SetPositions(
         comp.worlds[idx].r[3] = { pos.x, pos.y, pos.z, 1 };
     }
 
-    // update inverse world matrices
-    for (const index idx : s_Idxs)
-        RecalcInvWorldMatrixByIdx(idx);
+    // inverse world matrices will be recomputed later
+    for (const index idx : idxs)
+        MarkDirtyByIdx(idx);
 
     return true;
 }
@@ -341,7 +369,7 @@ bool TransformSystem::SetPosition(const EntityID id, float x, float y, float z)
     Transform& comp = *pTransform_;
     const index idx = comp.ids.get_idx(id);
 
-    if (!comp.ids.is_valid_index(idx))
+    if (idx == 0)
         return false;
 
     // update position
@@ -351,10 +379,10 @@ bool TransformSystem::SetPosition(const EntityID id, float x, float y, float z)
     data.y = y;
     data.z = z;
 
-    // update world matrix and its inverse
+    // update world matrix (its inverse will be recomputed later)
     comp.worlds[idx].r[3] = { x, y, z, 1 };
 
-    RecalcInvWorldMatrixByIdx(idx);
+    MarkDirtyByIdx(idx);
 
     return true;
 }
@@ -389,16 +417,17 @@ bool TransformSystem::AdjustPositions(
 
     // get idxs by ids
     Transform& comp = *pTransform_;
-    comp.ids.get_idxs(ids, numEntts, s_Idxs);
+    ScratchVec<index> idxs;
+    comp.ids.get_idxs(ids, numEntts, idxs);
 
 #if DEBUG || _DEBUG
-    if (!CheckEnttsHaveTransform(ids, numEntts, s_Idxs.data(), comp))
+    if (!CheckEnttsHaveTransform(ids, numEntts, idxs.data(), comp))
         return false;
 #endif
 
 
     // update positions by idxs
-    for (const index idx : s_Idxs)
+    for (const index idx : idxs)
     {
         XMFLOAT4& pos = comp.posAndScale[idx];
         pos.x += offset.x;
@@ -407,7 +436,7 @@ bool TransformSystem::AdjustPositions(
     }
 
     // update worlds by idxs
-    for (const index idx : s_Idxs)
+    for (const index idx : idxs)
     {
         float* pos = comp.worlds[idx].r[3].m128_f32;
         pos[0] += offset.x;
@@ -415,9 +444,9 @@ bool TransformSystem::AdjustPositions(
         pos[2] += offset.z;
     }
 
-    // update inverse worlds by idxs
-    for (const index idx : s_Idxs)
-        RecalcInvWorldMatrixByIdx(idx);
+    // inverse worlds will be recomputed later
+    for (const index idx : idxs)
+        MarkDirtyByIdx(idx);
 
     return true;
 }
@@ -471,7 +500,7 @@ bool TransformSystem::SetScale(const EntityID id, const float scale)
     // we store uniform scale in the w-component
     comp.posAndScale[idx].w = scale;
 
-    // recompute world matrix and inverse world matrix for this entity
+    // recompute world matrix for this entity (its inverse will be recomputed later)
     XMVECTOR S, R, T;
     XMMatrixDecompose(&S, &R, &T, comp.worlds[idx]);
 
@@ -482,7 +511,7 @@ bool TransformSystem::SetScale(const EntityID id, const float scale)
         XMMatrixRotationQuaternion(R) *
         XMMatrixTranslationFromVector(T);
 
-    RecalcInvWorldMatrixByIdx(idx);
+    MarkDirtyByIdx(idx);
 
     return true;
 }
@@ -514,7 +543,7 @@ inline void TransformVecWithQuat(
 // rotate each input entity around itself using input rotation quat(axis, angle)
 // 1. rotate the direction vector
 // 2. update the world matrix using quaternion
-// 3. recompute the world inverse matrix
+// 3. mark the transform as dirty (the world inverse matrix is recomputed later)
 //---------------------------------------------------------
 bool TransformSystem::RotateLocalSpacesByQuat(
     const EntityID* ids,
@@ -528,17 +557,18 @@ bool TransformSystem::RotateLocalSpacesByQuat(
     }
 
     Transform& comp = *pTransform_;
-    comp.ids.get_idxs(ids, numEntts, s_Idxs);
+    ScratchVec<index> idxs;
+    comp.ids.get_idxs(ids, numEntts, idxs);
 
     const XMVECTOR invQuat = XMQuaternionInverse(quat);
 
-    for (const index idx : s_Idxs)
+    for (const index idx : idxs)
         TransformVecWithQuat(quat, invQuat, comp.directions[idx]);
 
     // rotate the worlds
     const XMMATRIX R = XMMatrixRotationQuaternion(quat);
 
-    for (const index idx : s_Idxs)
+    for (const index idx : idxs)
     {
         XMMATRIX& world   = comp.worlds[idx];
         const XMVECTOR tr = world.r[3];         // store translation
@@ -548,9 +578,9 @@ bool TransformSystem::RotateLocalSpacesByQuat(
         world.r[3] = tr;                        // move to original position
     }
 
-    // compute inverse matrices of updated worlds
-    for (const index idx : s_Idxs)
-        RecalcInvWorldMatrixByIdx(idx);
+    // inverse matrices of updated worlds will be recomputed later
+    for (const index idx : idxs)
+        MarkDirtyByIdx(idx);
 
     return true;
 }
@@ -559,7 +589,7 @@ bool TransformSystem::RotateLocalSpacesByQuat(
 // rotate entity around itself using input rotation quaternion (axis, angle):
 // 1. rotate the direction vector
 // 2. update the world matrix using quaternion
-// 3. recompute the world inverse matrix
+// 3. mark the transform as dirty (the world inverse matrix is recomputed later)
 //---------------------------------------------------------
 bool TransformSystem::RotateLocalSpaceByQuat(const EntityID id, const XMVECTOR& quat)
 {
@@ -581,7 +611,7 @@ bool TransformSystem::RotateLocalSpaceByQuat(const EntityID id, const XMVECTOR&
     W *= R;                             // rotate world (so entt rotates around itself)
     W.r[3] = tr;                        // move to original position
 
-    RecalcInvWorldMatrixByIdx(idx);
+    MarkDirtyByIdx(idx);
 
     return true;
 }
@@ -605,7 +635,7 @@ void TransformSystem::TransformWorld(const EntityID id, const XMMATRIX& transfor
 
     XMMATRIX& W = pTransform_->worlds[idx];
     W = DirectX::XMMatrixMultiply(W, transformation);
-    RecalcInvWorldMatrixByIdx(idx);
+    MarkDirtyByIdx(idx);
 }
 
 //---------------------------------------------------------
@@ -620,10 +650,17 @@ const DirectX::XMMATRIX& TransformSystem::GetWorld(const EntityID id) const
 //---------------------------------------------------------
 // Desc:  return an inverse world matrix of entt by ID or
 //        return a matrix of NANs if there is no such entt by ID
+//        (if the world is dirty its inverse is recomputed first)
 //---------------------------------------------------------
-const DirectX::XMMATRIX& TransformSystem::GetInvWorld(const EntityID id) const
+const DirectX::XMMATRIX& TransformSystem::GetInvWorld(const EntityID id)
 {
-    return pTransform_->invWorlds[GetIdx(id)];
+    const index idx = GetIdx(id);
+
+    // world was changed after the last update so recompute inverse right now
+    if ((idx != 0) && (pTransform_->dirtyFlags[idx] & TRANSFORM_DIRTY_INV_WORLD))
+        RecalcInvWorldMatrixByIdx(idx);
+
+    return pTransform_->invWorlds[idx];
 }
 
 //---------------------------------------------------------
@@ -641,8 +678,9 @@ void TransformSystem::GetWorlds(
         return;
     }
 
-    pTransform_->ids.get_idxs(ids, numEntts, s_Idxs);
-    pTransform_->worlds.get_data_by_idxs(s_Idxs, outWorlds);
+    ScratchVec<index> idxs;
+    pTransform_->ids.get_idxs(ids, numEntts, idxs);
+    pTransform_->worlds.get_data_by_idxs(idxs, outWorlds);
 }
 
 //---------------------------------------------------------
@@ -660,8 +698,87 @@ void TransformSystem::GetInverseWorlds(
         return;
     }
 
-    pTransform_->ids.get_idxs(ids, numEntts, s_Idxs);
-    pTransform_->invWorlds.get_data_by_idxs(s_Idxs, outInvWorlds);
+    ScratchVec<index> idxs;
+    pTransform_->ids.get_idxs(ids, numEntts, idxs);
+
+    // recompute inverses of worlds which were changed after the last update
+    for (const index idx : idxs)
+    {
+        if ((idx != 0) && (pTransform_->dirtyFlags[idx] & TRANSFORM_DIRTY_INV_WORLD))
+            RecalcInvWorldMatrixByIdx(idx);
+    }
+
+    pTransform_->invWorlds.get_data_by_idxs(idxs, outInvWorlds);
+}
+
+//---------------------------------------------------------
+// Desc:   args for recomputation of inverse worlds in parallel
+//---------------------------------------------------------
+struct UpdateInvWorldsArgs
+{
+    const index*      idxs      = nullptr;
+    const XMMATRIX*   worlds    = nullptr;
+    XMMATRIX*         invWorlds = nullptr;
+};
+
+void UpdateInvWorldsRange(void* pArgs, const int start, const int end)
+{
+    const UpdateInvWorldsArgs& args = *(const UpdateInvWorldsArgs*)pArgs;
+
+    for (int i = start; i < end; ++i)
+    {
+        const index idx = args.idxs[i];
+        args.invWorlds[idx] = XMMatrixInverse(nullptr, args.worlds[idx]);
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   recompute inverse world matrices of all the entities which were
+//         changed since the previous call (each matrix is inverted only once
+//         no matter how many times its entity was changed)
+// Out:    - outChangedIds:  IDs of changed entities
+//---------------------------------------------------------
+void TransformSystem::UpdateDirtyTransforms(cvector<EntityID>& outChangedIds)
+{
+    Transform& comp = *pTransform_;
+    outChangedIds.resize(0);
+
+    if (comp.dirtyIds.empty())
+        return;
+
+    ScratchVec<index> idxs;
+    comp.ids.get_idxs(comp.dirtyIds, idxs);
+
+    // skip entities which were removed after they had been changed;
+    // and collect idxs of worlds which inverses are still invalid
+    ScratchVec<index> invIdxs;
+    outChangedIds.reserve(idxs.size());
+    invIdxs.reserve(idxs.size());
+
+    for (int i = 0; const index idx : idxs)
+    {
+        if (idx != 0)
+        {
+            outChangedIds.push_back(comp.dirtyIds[i]);
+
+            if (comp.dirtyFlags[idx] & TRANSFORM_DIRTY_INV_WORLD)
+                invIdxs.push_back(idx);
+
+            comp.dirtyFlags[idx] = 0;
+        }
+        ++i;
+    }
+
+    comp.dirtyIds.resize(0);
+
+    // recompute inverse worlds
+    UpdateInvWorldsArgs args;
+    args.idxs      = invIdxs.data();
+    args.worlds    = comp.worlds.data();
+    args.invWorlds = comp.invWorlds.data();
+
+    constexpr int numMatricesPerJob = 256;
+    g_JobSystem.ParallelFor((int)invIdxs.size(), numMatricesPerJob, UpdateInvWorldsRange, &args);
 }
 
 
@@ -692,24 +809,25 @@ bool TransformSystem::AddRecordsHelper(
 {
     Transform& comp = *pTransform_;
 
-    if (comp.ids.binary_search(ids, numEntts))
+    if (comp.ids.has_any(ids, numEntts))
     {
         LogErr(LOG, "there is already a record with some input ID");
         DumpIds(ids, numEntts);
         return false;
     }
 
+    // allocate additional memory ahead
+    const vsize newCapacity = comp.ids.size() + numEntts;
+    comp.ids.reserve(newCapacity);
+    comp.posAndScale.reserve(newCapacity);
+    comp.directions.reserve(newCapacity);
+    comp.worlds.reserve(newCapacity);
+    comp.invWorlds.reserve(newCapacity);
+    comp.dirtyFlags.reserve(newCapacity);
 
-    cvector<index>& idxs = s_Idxs;
-    comp.ids.get_insert_idxs(ids, numEntts, idxs);
-
-    // execute indices correction (so we will insert data into proper positions)
-    for (index i = 0; i < idxs.size(); ++i)
-        idxs[i] += i;
-
-    // store ids
-    for (index i = 0; const index idx : idxs)
-        comp.ids.insert_before(idx, ids[i++]);
+    // store ids (new records are just pushed at the end of data arrays)
+    for (index i = 0; i < numEntts; ++i)
+        comp.ids.push_back(ids[i]);
 
     // store positions + uniform scales:
     // x,y,z - pos; w - scale
@@ -717,16 +835,12 @@ bool TransformSystem::AddRecordsHelper(
     {
         const XMFLOAT3& p = positions[i];
         const float     s = uniformScales[i];
-        comp.posAndScale.insert_before(idxs[i], { p.x, p.y, p.z, s });
+        comp.posAndScale.push_back({ p.x, p.y, p.z, s });
     }
 
     // normalize all the input directions and store them into the component
     for (index i = 0; i < numEntts; ++i)
-    {
-        const XMVECTOR normalizedDir = XMVector3Normalize(directions[i]);
-        comp.directions.insert_before(idxs[i], normalizedDir);
-    }
-        
+        comp.directions.push_back(XMVector3Normalize(directions[i]));
 
     // ----------------------------------------------------
 
@@ -741,10 +855,14 @@ bool TransformSystem::AddRecordsHelper(
         const XMMATRIX T = XMMatrixTranslation(p.x, p.y, p.z);
         const XMMATRIX W = S * T;
 
-        comp.worlds.insert_before(idxs[i], W);
-        comp.invWorlds.insert_before(idxs[i], XMMatrixInverse(nullptr, W));
+        comp.worlds.push_back(W);
+        comp.invWorlds.push_back(XMMatrixInverse(nullptr, W));
     }
 
+    // new records are up-to-date
+    for (index i = 0; i < numEntts; ++i)
+        comp.dirtyFlags.push_back(0);
+
     return true;
 }
 
@@ -754,10 +872,9 @@ bool TransformSystem::AddRecordsHelper(
 //---------------------------------------------------------
 index TransformSystem::GetIdx(const EntityID id) const
 {
-    const Transform& comp = *pTransform_;
-    const index       idx = comp.ids.get_idx(id);
+    const index idx = pTransform_->ids.get_idx(id);
 
-    if (idx <= 0 || idx >= comp.ids.size())
+    if (idx == 0)
     {
         LogErr(LOG, "there is no transform data for entt by id: %" PRIu32, id);
         return 0;
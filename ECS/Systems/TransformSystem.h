@@ -27,7 +27,7 @@ public:
         const float* uniformScales,
         const size numElems);
 
-    void RemoveRecords(const cvector<EntityID>& enttsIDs);
+    void RemoveRecords(const EntityID* ids, const size numEntts);
 
     // -------------------------------------------------------
 
@@ -78,7 +78,11 @@ public:
     void TransformWorld(const EntityID id, const DirectX::XMMATRIX& transformation);
 
     const DirectX::XMMATRIX& GetWorld       (const EntityID id) const;
-    const DirectX::XMMATRIX& GetInvWorld(const EntityID id) const;
+
+    // NOTE: inverse worlds of entities which were changed after the last
+    //       UpdateDirtyTransforms() are recomputed right here, so these
+    //       getters mutate the component (call them only on the ECS thread)
+    const DirectX::XMMATRIX& GetInvWorld(const EntityID id);
 
     void GetWorlds(
         const EntityID* ids,
@@ -90,6 +94,15 @@ public:
         const size numEntts,
         cvector<DirectX::XMMATRIX>& outInvWorlds);
 
+    // ---------------------------------------------
+
+    // setters only change the world matrix and mark the entity as dirty;
+    // this pass recomputes the inverse worlds of all the dirty entities at once
+    // (in parallel) and returns IDs of changed entities so their bounding shapes
+    // and related data can be updated as well; dirty flags are reset
+    void UpdateDirtyTransforms(cvector<EntityID>& outChangedIds);
+
+    inline bool HasDirtyTransforms() const { return !pTransform_->dirtyIds.empty(); }
 
 private:
     bool AddRecordsHelper(
@@ -102,6 +115,7 @@ private:
     index GetIdx(const EntityID id) const;
 
     void     RecalcInvWorldMatrixByIdx(const index idx);
+    void     MarkDirtyByIdx           (const index idx);
     DirectX::XMMATRIX GetMatTranslation        (const DirectX::XMFLOAT4& pos) const;
     DirectX::XMMATRIX GetMatRotation           (const DirectX::XMVECTOR& rotQuat) const;
     DirectX::XMMATRIX GetMatScaling            (const float scale) const;
@@ -121,6 +135,21 @@ private:
 inline void TransformSystem::RecalcInvWorldMatrixByIdx(const index idx)
 {
     pTransform_->invWorlds[idx] = DirectX::XMMatrixInverse(nullptr, pTransform_->worlds[idx]);
+    pTransform_->dirtyFlags[idx] &= ~TRANSFORM_DIRTY_INV_WORLD;
+}
+
+//-----------------------------------------------------
+// Desc:  mark transform by array idx as changed so its inverse world
+//        and bounding shapes will be recomputed later (only once per update)
+//-----------------------------------------------------
+inline void TransformSystem::MarkDirtyByIdx(const index idx)
+{
+    Transform& comp = *pTransform_;
+
+    if (comp.dirtyFlags[idx] == 0)
+        comp.dirtyIds.push_back(comp.ids[idx]);
+
+    comp.dirtyFlags[idx] = TRANSFORM_DIRTY_ALL;
 }
 
 //-----------------------------------------------------
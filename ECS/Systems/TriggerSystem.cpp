@@ -36,21 +36,18 @@ bool TriggerSystem::AddTriggerOnce(
         return false;
     }
 
-    cvector<EntityID>&    ids      = pTriggerComp_->triggersOnce.ids;
+    SparseSet&            ids      = pTriggerComp_->triggersOnce.ids;
     cvector<TriggerOnce>& triggers = pTriggerComp_->triggersOnce.triggers;
 
-    bool bUniqueTrigger = !ids.binary_search(enttId);
+    bool bUniqueTrigger = !ids.has(enttId);
     if (!bUniqueTrigger)
     {
         LogErr(LOG, "there is already a trigger by id: %d (event id: %d)", (int)enttId, (int)eventId);
         return false;
     }
 
-    // sorted insertion
-    const index idx = ids.get_insert_idx(enttId);
-
-    ids.insert_before(idx, enttId);
-    triggers.insert_before(idx, TriggerOnce());
+    const index idx = ids.push_back(enttId);
+    triggers.push_back(TriggerOnce());
 
     // setup the trigger
     TriggerOnce& trigger = triggers[idx];
@@ -90,21 +87,18 @@ bool TriggerSystem::AddTriggerMultiple(
         return false;
     }
 
-    cvector<EntityID>&        ids      = pTriggerComp_->triggersMultiple.ids;
+    SparseSet&                ids      = pTriggerComp_->triggersMultiple.ids;
     cvector<TriggerMultiple>& triggers = pTriggerComp_->triggersMultiple.triggers;
 
-    bool bUniqueTrigger = !ids.binary_search(enttId);
+    bool bUniqueTrigger = !ids.has(enttId);
     if (!bUniqueTrigger)
     {
         LogErr(LOG, "there is already a trigger by id: %d (events onEnter: %d, onCollide: %d, onLeave: %d)", (int)onEnter, (int)onCollide, (int)onEnter);
         return false;
     }
 
-    // sorted insertion
-    const index idx = ids.get_insert_idx(enttId);
-
-    ids.insert_before(idx, enttId);
-    triggers.insert_before(idx, TriggerMultiple());
+    const index idx = ids.push_back(enttId);
+    triggers.push_back(TriggerMultiple());
 
     // setup the trigger
     TriggerMultiple& trigger = triggers[idx];
@@ -41,20 +41,47 @@ bool WeaponSystem::AddRecord(const EntityID id, const ECS::Weapon& wpn)
 {
     WeaponComp& comp = *pWpnComp_;
 
-    if (comp.ids.binary_search(id))
+    if (comp.ids.has(id))
     {
         LogErr(LOG, "there is already a record by id: %" PRIu32, id);
         return false;
     }
 
     // add a new record
-    const index idx = comp.ids.get_insert_idx(id);
-    comp.ids.insert_before(idx, id);
-    comp.weapons.insert_before(idx, wpn);
+    comp.ids.push_back(id);
+    comp.weapons.push_back(wpn);
 
     return true;
 }
 
+//---------------------------------------------------------
+// Desc:  remove weapon records of input entities
+//        (the last record is moved into the place of removed one)
+//---------------------------------------------------------
+void WeaponSystem::RemoveRecords(const EntityID* ids, const size numEntts)
+{
+    if (!ids || numEntts <= 0)
+    {
+        LogErr(LOG, "invalid input args (ids arr: %p, num entts: %d)", ids, (int)numEntts);
+        return;
+    }
+
+    WeaponComp& comp = *pWpnComp_;
+
+    for (index i = 0; i < numEntts; ++i)
+    {
+        const index idx = comp.ids.swap_remove(ids[i]);
+
+        if (idx == -1)
+        {
+            LogErr(LOG, "there is no weapon record by id: %" PRIu32, ids[i]);
+            continue;
+        }
+
+        comp.weapons.swap_pop(idx);
+    }
+}
+
 //---------------------------------------------------------
 // Desc:  return weapon's data by input id
 //---------------------------------------------------------
@@ -62,7 +89,7 @@ const Weapon& WeaponSystem::GetWeaponById(const EntityID id) const
 {
     const index idx = pWpnComp_->ids.get_idx(id);
 
-    if (!pWpnComp_->ids.is_valid_index(idx))
+    if (idx == 0)
     {
         LogErr(LOG, "no weapon by id: %" PRIu32, id);
         return pWpnComp_->weapons[0];
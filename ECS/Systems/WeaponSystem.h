@@ -25,6 +25,7 @@ public:
     WeaponSystem(WeaponComp* pWeaponComp);
 
     bool AddRecord(const EntityID id, const Weapon& wpnData);
+    void RemoveRecords(const EntityID* ids, const size numEntts);
 
     const Weapon& GetWeaponById(const EntityID id) const;
 
@@ -1292,13 +1292,15 @@ void CRender::SetSkyColorApex(const XMFLOAT3& color)
 
 //---------------------------------------------------------
 // Desc:  update a const buffer which holds bone transformations for model skinning
+// Args:  - boneTransforms:  arr of already transposed matrices
+//        - numBones:        number of matrices
 //---------------------------------------------------------
-void CRender::UpdateCbBoneTransforms(const cvector<DirectX::XMMATRIX>& boneTransforms)
+void CRender::UpdateCbBoneTransforms(const DirectX::XMMATRIX* boneTransforms, const int numBones)
 {
-    assert(boneTransforms.size() <= MAX_NUM_BONES_PER_CHARACTER);
+    assert(boneTransforms);
+    assert(numBones >= 0 && numBones <= MAX_NUM_BONES_PER_CHARACTER);
 
-    for (index i = 0; i < boneTransforms.size(); ++i)
-        cbvsSkinned_.data.boneTransforms[i] = DirectX::XMMatrixTranspose(boneTransforms[i]);
+    memcpy(cbvsSkinned_.data.boneTransforms, boneTransforms, sizeof(DirectX::XMMATRIX) * numBones);
 
     cbvsSkinned_.ApplyChanges(GetContext());
 }
@@ -269,7 +269,7 @@ public:
     void SetSkyColorCenter      (const DirectX::XMFLOAT3& color);
     void SetSkyColorApex        (const DirectX::XMFLOAT3& color);
 
-    void UpdateCbBoneTransforms (const cvector<DirectX::XMMATRIX>& boneTransforms);
+    void UpdateCbBoneTransforms (const DirectX::XMMATRIX* boneTransforms, const int numBones);
 
     void UpdateCbDebug          (const uint currBoneId);
 
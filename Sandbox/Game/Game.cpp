@@ -9,6 +9,7 @@
 #include <Engine/Engine.h>
 #include <Model/model_mgr.h>
 #include <Model/grass_mgr.h>
+#include <Model/asset_streamer.h>
 #include <Render/debug_draw_manager.h>
 #include <Model/animation_mgr.h>
 #include <Input/keyboard.h>
@@ -119,6 +120,16 @@ bool Game::Init(
     GameInitPaths initPaths;
     gameInit.ReadGameInitPaths(configs.GetString("LOAD_LEVEL"), initPaths);
 
+    // streaming of models/textures around the camera: must be turned on
+    // before loading of assets so only their metadata is loaded at start
+    if (configs.GetBool("STREAMING_ENABLED"))
+    {
+        const uint64 budgetMb     = (uint64)configs.GetInt("STREAMING_BUDGET_MB");
+        const float  streamRadius = configs.GetFloat("STREAMING_RADIUS");
+
+        g_AssetStreamer.Init(budgetMb * 1024 * 1024, streamRadius);
+    }
+
     // initialize some data/resource managers
     if (!g_TextureMgr.Init(initPaths.texturesFilepath))
     {
@@ -213,7 +224,10 @@ bool Game::Init(
     LogMsg(LOG, "initialize weapons:");
     WeaponsInitializer initializer;
     initializer.Init(initPaths.weaponsFilepath, pEnttMgr_);
-    
+
+    // all the entities are created so load assets which won't be streamed
+    g_AssetStreamer.LoadAssetsNotUsedByEntts(*pEnttMgr);
+
     InitSoundsStuff();
 
     // prevent lagging when we move player for the first time
@@ -291,6 +305,7 @@ bool Game::Update(const float dt, const float gameTime)
     eventData.fz = playerPos.z;
 
     UpdateRainbowAnomaly();
+    UpdateTransientEntts(pEnttMgr_, dt);
     eventMgr_.TriggerEvent("radioactive_house", pEngine_, &eventData);
     eventMgr_.TriggerEvent("fire_anomaly",      pEngine_, &eventData);
 
@@ -696,9 +711,9 @@ void Game::UpdateRainbowAnomaly()
     const EntityID anomaly0 = nameSys.GetIdByName("anomaly_rainbow_0");
     const EntityID anomaly1 = nameSys.GetIdByName("anomaly_rainbow_1");
 
-    const cvector<ECS::Particle>& particles0 = particleSys.GetParticlesOfEmitter(anomaly0);
-    const cvector<ECS::Particle>& particles1 = particleSys.GetParticlesOfEmitter(anomaly1);
-    const size                   numRainbows = particles0.size() + particles1.size();
+    const ECS::ParticlesSoA& particles0  = particleSys.GetParticlesOfEmitter(anomaly0);
+    const ECS::ParticlesSoA& particles1  = particleSys.GetParticlesOfEmitter(anomaly1);
+    const size               numRainbows = particles0.size() + particles1.size();
 
     // we have no rainbow particles to update
     if (numRainbows == 0)
@@ -735,10 +750,10 @@ void Game::UpdateRainbowAnomaly()
 
     // gather positions of rainbows
     for (index i = 0; i < particles0.size(); ++i)
-        XMStoreFloat3(&newPositions[i], particles0[i].pos);
+        newPositions[i] = particles0.GetPos(i);
 
     for (index posIdx = particles0.size(), i = 0; posIdx < numRainbows; ++posIdx, ++i)
-        XMStoreFloat3(&newPositions[posIdx], particles1[i].pos);
+        newPositions[posIdx] = particles1.GetPos(i);
 
     // place point light in exact position of related rainbow particle
     mgr.transformSys_.SetPositions(pointLightIds, numRainbows, newPositions);
@@ -4,6 +4,7 @@
 #include <Model/animation_mgr.h>
 #include <Sound/sound_mgr.h>
 #include <Sound/sound.h>
+#include "../Initializers/quad_tree_attach_control.h"
 
 namespace Game
 {
@@ -623,75 +624,111 @@ DirectX::XMVECTOR PixelCoordToRayDir(
 }
 
 //---------------------------------------------------------
+// transient entities (shot splashes, etc.): are destroyed when
+// their lifetime is over (look at UpdateTransientEntts)
+//---------------------------------------------------------
+struct TransientEntt
+{
+    EntityID id;
+    float    lifeSec;           // remaining lifetime
+};
+
+static cvector<TransientEntt> s_TransientEntts;
+
+//---------------------------------------------------------
+// Desc:  create a new emitter entity by params of the template emitter,
+//        place it at the input position and emit a burst of particles
+// Ret:   ID of the created entity
+//---------------------------------------------------------
+EntityID SpawnSplashEmitter(
+    ECS::EntityMgr& enttMgr,
+    const EntityID templateId,
+    const Vec3& pos)
+{
+    ECS::ParticleSystem& particleSys = enttMgr.particleSys_;
+
+    const EntityID id = enttMgr.CreateEntity();
+    enttMgr.AddParticleEmitterComponent(id);
+
+    // copy params of the template (the particles pool gets the same capacity)
+    ECS::EmitterData&       emitter    = particleSys.GetEmitterData(id);
+    const ECS::EmitterData& srcEmitter = particleSys.GetEmitterData(templateId);
+
+    emitter = srcEmitter;
+    emitter.particles.resize(0);
+    emitter.numSpawned  = 0;
+    emitter.time        = 0;
+    emitter.pendingTime = 0;
+    emitter.isVisible   = false;
+
+    const DirectX::XMFLOAT3    worldPos = { pos.x, pos.y, pos.z };
+    const DirectX::BoundingBox localBox = enttMgr.boundingSys_.GetLocalBoundBox(templateId);
+    const DirectX::BoundingBox worldBox =
+    {
+        { localBox.Center.x + pos.x, localBox.Center.y + pos.y, localBox.Center.z + pos.z },
+        localBox.Extents
+    };
+
+    enttMgr.AddTransformComponent(id, worldPos);
+    enttMgr.AddBoundingComponent(id, localBox, worldBox);
+
+#if ATTACH_PARTICLE_EMITTER_TO_QUADTREE
+    enttMgr.AttachEnttToQuadTree(id);
+#endif
+
+    const ECS::EmitterData& data = particleSys.GetEmitterData(id);
+    particleSys.PushNewParticles(id, data.spawnRate);
+
+    // the entity lives until its last particle dies
+    s_TransientEntts.push_back(TransientEntt{ id, data.life });
+
+    return id;
+}
+
+//---------------------------------------------------------
+// Desc:  spawn transient splash emitters at the bullet hit point
+//        (params are taken from the "shot_splash_*" template emitters)
 //---------------------------------------------------------
 void EmitBulletHitParticles(ECS::EntityMgr* pEnttMgr, const IntersectionData& data)
 {
     assert(pEnttMgr);
 
-    ECS::NameSystem&      nameSys     = pEnttMgr->nameSys_;
-    ECS::TransformSystem& transSys    = pEnttMgr->transformSys_;
-    ECS::ParticleSystem&  particleSys = pEnttMgr->particleSys_;
-    ECS::BoundingSystem&  boundSys    = pEnttMgr->boundingSys_;
+    ECS::NameSystem&     nameSys     = pEnttMgr->nameSys_;
+    ECS::ParticleSystem& particleSys = pEnttMgr->particleSys_;
 
-    const EntityID emitShotSplash0Id = nameSys.GetIdByName("shot_splash_0");
-    const EntityID emitShotSplash1Id = nameSys.GetIdByName("shot_splash_1");
-    const EntityID emitShotSplash2Id = nameSys.GetIdByName("shot_splash_2");
-    const EntityID emitShotSplash3Id = nameSys.GetIdByName("shot_splash_3");
+    constexpr int numSplashes = 4;
+    constexpr int numSmokes   = 3;
 
-    const EntityID emitSplashSmoke0Id = nameSys.GetIdByName("shot_splash_smoke_0");
-    const EntityID emitSplashSmoke1Id = nameSys.GetIdByName("shot_splash_smoke_1");
-    const EntityID emitSplashSmoke2Id = nameSys.GetIdByName("shot_splash_smoke_2");
+    const char* splashNames[numSplashes] =
+    {
+        "shot_splash_0",
+        "shot_splash_1",
+        "shot_splash_2",
+        "shot_splash_3",
+    };
+
+    const char* smokeNames[numSmokes] =
+    {
+        "shot_splash_smoke_0",
+        "shot_splash_smoke_1",
+        "shot_splash_smoke_2",
+    };
+
+    EntityID splashTemplIds[numSplashes]{ INVALID_ENTT_ID };
+    EntityID smokeTemplIds[numSmokes]{ INVALID_ENTT_ID };
+
+    nameSys.GetIdsByNames((const char**)splashNames, numSplashes, splashTemplIds);
+    nameSys.GetIdsByNames((const char**)smokeNames,  numSmokes,   smokeTemplIds);
 
-    // relocate particle emitters
     const Vec3 intersectPoint = { data.px, data.py, data.pz };
 
-    // each new shot translates emitters to its new position
-    transSys.SetPosition(emitShotSplash0Id, intersectPoint);
-    transSys.SetPosition(emitShotSplash1Id, intersectPoint);
-    transSys.SetPosition(emitShotSplash2Id, intersectPoint);
-    transSys.SetPosition(emitShotSplash3Id, intersectPoint);
-
-    transSys.SetPosition(emitSplashSmoke0Id, intersectPoint);
-    transSys.SetPosition(emitSplashSmoke1Id, intersectPoint);
-    transSys.SetPosition(emitSplashSmoke2Id, intersectPoint);
-
-    // translate AABB of each emitter to its new position
-    boundSys.TranslateWorldBoundings(emitShotSplash0Id);
-    boundSys.TranslateWorldBoundings(emitShotSplash1Id);
-    boundSys.TranslateWorldBoundings(emitShotSplash2Id);
-    boundSys.TranslateWorldBoundings(emitShotSplash3Id);
-
-    boundSys.TranslateWorldBoundings(emitSplashSmoke0Id);
-    boundSys.TranslateWorldBoundings(emitSplashSmoke1Id);
-    boundSys.TranslateWorldBoundings(emitSplashSmoke2Id);
-
-    // update emitters location within the quadtree
-    pEnttMgr->UpdateQuadTreeMembership(emitShotSplash0Id);
-    pEnttMgr->UpdateQuadTreeMembership(emitShotSplash1Id);
-    pEnttMgr->UpdateQuadTreeMembership(emitShotSplash2Id);
-    pEnttMgr->UpdateQuadTreeMembership(emitShotSplash3Id);
-
-    pEnttMgr->UpdateQuadTreeMembership(emitSplashSmoke0Id);
-    pEnttMgr->UpdateQuadTreeMembership(emitSplashSmoke1Id);
-    pEnttMgr->UpdateQuadTreeMembership(emitSplashSmoke2Id);
-
-    const ECS::EmitterData& emitter0 = particleSys.GetEmitterData(emitShotSplash0Id);
-    const ECS::EmitterData& emitter1 = particleSys.GetEmitterData(emitShotSplash1Id);
-    const ECS::EmitterData& emitter2 = particleSys.GetEmitterData(emitShotSplash2Id);
-    const ECS::EmitterData& emitter3 = particleSys.GetEmitterData(emitShotSplash3Id);
-
-    const ECS::EmitterData& emitterSmoke0 = particleSys.GetEmitterData(emitSplashSmoke0Id);
-    const ECS::EmitterData& emitterSmoke1 = particleSys.GetEmitterData(emitSplashSmoke1Id);
-    const ECS::EmitterData& emitterSmoke2 = particleSys.GetEmitterData(emitSplashSmoke2Id);
-
-    particleSys.PushNewParticles(emitShotSplash0Id, emitter0.spawnRate);
-    particleSys.PushNewParticles(emitShotSplash1Id, emitter1.spawnRate);
-    particleSys.PushNewParticles(emitShotSplash2Id, emitter2.spawnRate);
-    particleSys.PushNewParticles(emitShotSplash3Id, emitter3.spawnRate);
-
-    particleSys.PushNewParticles(emitSplashSmoke0Id, emitterSmoke0.spawnRate);
-    particleSys.PushNewParticles(emitSplashSmoke1Id, emitterSmoke1.spawnRate);
-    particleSys.PushNewParticles(emitSplashSmoke2Id, emitterSmoke2.spawnRate);
+    for (int i = 0; i < numSplashes; ++i)
+        SpawnSplashEmitter(*pEnttMgr, splashTemplIds[i], intersectPoint);
+
+    EntityID smokeIds[numSmokes]{ INVALID_ENTT_ID };
+
+    for (int i = 0; i < numSmokes; ++i)
+        smokeIds[i] = SpawnSplashEmitter(*pEnttMgr, smokeTemplIds[i], intersectPoint);
 
     // particles will go along the normal vector of the surface (where bullet hit)
     const Vec3 forceDir = { data.nx, data.ny, data.nz };
@@ -700,9 +737,38 @@ void EmitBulletHitParticles(ECS::EntityMgr* pEnttMgr, const IntersectionData& da
     const Vec3 force1 = { extForce.x,        extForce.y * 0.7f, extForce.z };
     const Vec3 force2 = { extForce.x,        extForce.y * 0.9f, extForce.z * 1.1f };
 
-    particleSys.SetExternForces(emitSplashSmoke0Id, force0.x, force0.y, force0.z);
-    particleSys.SetExternForces(emitSplashSmoke1Id, force1.x, force1.y, force1.z);
-    particleSys.SetExternForces(emitSplashSmoke2Id, force2.x, force2.y, force2.z);
+    particleSys.SetExternForces(smokeIds[0], force0.x, force0.y, force0.z);
+    particleSys.SetExternForces(smokeIds[1], force1.x, force1.y, force1.z);
+    particleSys.SetExternForces(smokeIds[2], force2.x, force2.y, force2.z);
+}
+
+//---------------------------------------------------------
+// Desc:  decrease lifetime of transient entities and destroy
+//        the expired ones (their IDs will be reused)
+//---------------------------------------------------------
+void UpdateTransientEntts(ECS::EntityMgr* pEnttMgr, const float dt)
+{
+    assert(pEnttMgr);
+
+    cvector<EntityID> expiredIds;
+
+    for (index i = 0; i < s_TransientEntts.size(); /* no increment */)
+    {
+        TransientEntt& entt = s_TransientEntts[i];
+        entt.lifeSec -= dt;
+
+        if (entt.lifeSec > 0)
+        {
+            ++i;
+            continue;
+        }
+
+        expiredIds.push_back(entt.id);
+        s_TransientEntts.swap_pop(i);
+    }
+
+    if (!expiredIds.empty())
+        pEnttMgr->DestroyEntities(expiredIds.data(), expiredIds.size());
 }
 
 //---------------------------------------------------------
@@ -12,6 +12,7 @@ void PlayerPlayFootstepSound    (ECS::PlayerData& player, const float dt);
 
 // common
 void HandleRadiationZone        (Core::Engine* pEngine, const EventData* pData);
+void UpdateTransientEntts       (ECS::EntityMgr* pEnttMgr, const float dt);
 
 // player actions
 void PlayerMove                 (Core::Engine* pEngine, const EventData* pData);
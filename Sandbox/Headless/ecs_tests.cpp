@@ -0,0 +1,87 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: ecs_tests.cpp
+    Desc:     headless checks of the entity manager
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#include "../Common/pch.h"
+#include "headless_tests.h"
+#include <Entity/EntityMgr.h>
+
+
+namespace Game
+{
+
+//---------------------------------------------------------
+// Desc:  create -> destroy -> create entities again and check that the index
+//        of a destroyed entity is reused with the next generation, its stale
+//        ID is rejected, and other entities aren't affected
+//---------------------------------------------------------
+bool TestEnttIdsRecycling()
+{
+    using namespace ECS;
+
+    EntityMgr enttMgr;
+    bool      isValid = true;
+
+    const EntityID id0 = enttMgr.CreateEntity();
+    const EntityID id1 = enttMgr.CreateEntity();
+
+    enttMgr.AddTransformComponent(id0, { 1,2,3 });
+    enttMgr.AddTransformComponent(id1, { 4,5,6 });
+
+    enttMgr.DestroyEntities(&id0, 1);
+
+    const EntityID newId = enttMgr.CreateEntity();
+    enttMgr.AddTransformComponent(newId, { 7,8,9 });
+
+    // the index is reused but with the next generation
+    if ((GetEnttIndex(newId) != GetEnttIndex(id0)) ||
+        (GetEnttGeneration(newId) != GetEnttGeneration(id0) + 1))
+    {
+        LogErr(LOG, "index of destroyed entity isn't reused properly (old id: %" PRIu32 ", new id: %" PRIu32 ")", id0, newId);
+        isValid = false;
+    }
+
+    // the stale ID doesn't match the new entity
+    if (enttMgr.CheckEnttExist(id0))
+    {
+        LogErr(LOG, "stale entity id (%" PRIu32 ") is still accepted", id0);
+        isValid = false;
+    }
+
+    // destruction by the stale ID must not touch the new entity
+    LogMsg(LOG, "destroy entity by stale id (an error is expected):");
+    enttMgr.DestroyEntities(&id0, 1);
+
+    if (!enttMgr.CheckEnttExist(newId) || !enttMgr.CheckEnttExist(id1))
+    {
+        LogErr(LOG, "entities are destroyed by a stale id");
+        isValid = false;
+    }
+
+    // components are bound to proper entities
+    const DirectX::XMFLOAT3 pos1   = enttMgr.transformSys_.GetPosition(id1);
+    const DirectX::XMFLOAT3 newPos = enttMgr.transformSys_.GetPosition(newId);
+
+    if ((pos1.x != 4) || (pos1.y != 5) || (pos1.z != 6) ||
+        (newPos.x != 7) || (newPos.y != 8) || (newPos.z != 9))
+    {
+        LogErr(LOG, "transform data doesn't match entities after recycling");
+        isValid = false;
+    }
+
+    LogMsg(LOG, "entity ids recycling: %s", (isValid) ? "OK" : "FAILED");
+    return isValid;
+}
+
+} // namespace
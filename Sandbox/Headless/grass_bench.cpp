@@ -0,0 +1,187 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: grass_bench.cpp
+    Desc:     headless benchmark of grass cells culling on a synthetic field
+              (is compared with a brute force test of each cell)
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#include "../Common/pch.h"
+#include "headless_tests.h"
+#include <Model/grass_mgr.h>
+#include <geometry/frustum.h>
+#include <math/matrix.h>
+#include <chrono>
+
+
+namespace Game
+{
+
+//---------------------------------------------------------
+// Desc:   get distance from the point to the box (0 if point is inside)
+//---------------------------------------------------------
+static float GetDistToBox(const Vec3& p, const Rect3d& box)
+{
+    const float dx = Max(Max(box.x0 - p.x, p.x - box.x1), 0.0f);
+    const float dy = Max(Max(box.y0 - p.y, p.y - box.y1), 0.0f);
+    const float dz = Max(Max(box.z0 - p.z, p.z - box.z1), 0.0f);
+
+    return sqrtf(dx*dx + dy*dy + dz*dz);
+}
+
+//---------------------------------------------------------
+// Desc:   build a synthetic field: numCellsByAxis x numCellsByAxis
+//         resident cells with wavy heights
+//---------------------------------------------------------
+static void InitBenchGrassField(Core::GrassField& field, const int numCellsByAxis, const float fieldSize)
+{
+    const float cellSize = fieldSize / numCellsByAxis;
+    const int   numCells = numCellsByAxis * numCellsByAxis;
+
+    strcpy(field.name, "bench_grass_culling");
+    field.cellsByX    = (uint8)numCellsByAxis;
+    field.cellsByZ    = (uint8)numCellsByAxis;
+    field.numChannels = 1;
+    field.worldBox    = Rect3d(0, fieldSize, 0, 0, 0, fieldSize);
+
+    field.cells.resize(numCells);
+    field.cellsWorldBoxes.resize(numCells);
+    field.cells.fill_zeros();
+
+    for (int z = 0; z < numCellsByAxis; ++z)
+    {
+        for (int x = 0; x < numCellsByAxis; ++x)
+        {
+            const int   cellIdx = z * numCellsByAxis + x;
+            const float x0      = x * cellSize;
+            const float z0      = z * cellSize;
+            const float height  = 20.0f + 10.0f * sinf(x0 * 0.02f) * cosf(z0 * 0.03f);
+
+            field.cellsWorldBoxes[cellIdx] = Rect3d(x0, x0 + cellSize, height, height + 1.0f, z0, z0 + cellSize);
+            field.cells[cellIdx].channelInstanceCount[0] = 64;
+            field.cells[cellIdx].isResident = true;
+
+            field.worldBox.y1 = Max(field.worldBox.y1, height + 1.0f);
+        }
+    }
+
+    Core::BuildCellsTree(field);
+}
+
+//---------------------------------------------------------
+// Desc:  headless benchmark of grass cells culling: build a synthetic field
+//        1024x1024 (128x128 resident cells with wavy heights), rotate the camera
+//        at the center of the field through 360 degrees and cull the cells;
+//        per each frame print cull time and number of tested nodes/cells
+// Args:  - numFrames:  number of camera directions per full turn
+// Ret:   true if visible cells are the same as by a brute force test of each cell
+//---------------------------------------------------------
+bool BenchmarkGrassCulling(const int numFrames)
+{
+    using namespace Core;
+    using Clock = std::chrono::high_resolution_clock;
+
+    if (numFrames <= 0)
+    {
+        LogErr(LOG, "number of frames must be > 0");
+        return false;
+    }
+
+    constexpr int   numCellsByAxis = 128;
+    constexpr float fieldSize      = 1024.0f;
+    constexpr int   numCells       = numCellsByAxis * numCellsByAxis;
+    constexpr float visRange       = 400.0f;
+
+    // the manager is used only to cull cells of our own field
+    GrassMgr mgr;
+    mgr.SetGrassVisibilityRange(visRange);
+    mgr.SetGrassDistFullSize(100.0f);
+
+    GrassField field;
+    memset(&field, 0, sizeof(field));
+    InitBenchGrassField(field, numCellsByAxis, fieldSize);
+
+    // camera at the center of the field (fov 90 deg, aspect 16:9)
+    const Frustum viewFrustum(1.5708f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    const Vec3    camPos(fieldSize * 0.5f, 32.0f, fieldSize * 0.5f);
+
+    VisibleGrassField visField;
+    visField.fieldIdx = 0;
+
+    cvector<bool> isVisible(numCells);
+    bool          isValid   = true;
+    float         sumMs     = 0;
+    float         maxMs     = 0;
+
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        const float yaw = M_2PI * frame / numFrames;
+
+        Frustum frustum;
+        viewFrustum.Transform(frustum, MatrixRotationY(yaw) * MatrixTranslation(camPos.x, camPos.y, camPos.z));
+
+        visField.cellsIdxs.clear();
+        visField.cellsDensity.clear();
+
+        // the manager accumulates culling stats so take the difference
+        const uint32 numNodesBefore = mgr.GetStats().numTestedNodes;
+        const uint32 numCellsBefore = mgr.GetStats().numTestedCells;
+
+        float numInstToRender = 0;
+
+        const auto t0 = Clock::now();
+        mgr.CullGrassCells(field, camPos, &frustum, visField, numInstToRender);
+        const auto t1 = Clock::now();
+
+        const float ms = std::chrono::duration<float, std::milli>(t1 - t0).count();
+        sumMs += ms;
+        maxMs  = Max(maxMs, ms);
+
+        // reference: test each cell separately
+        int numRef = 0;
+
+        for (int i = 0; i < numCells; ++i)
+        {
+            const Rect3d& box = field.cellsWorldBoxes[i];
+
+            isVisible[i] = (GetDistToBox(camPos, box) <= visRange) && frustum.TestRect(box);
+            numRef += isVisible[i];
+        }
+
+        bool isFrameValid = (numRef == (int)visField.cellsIdxs.size());
+
+        for (const index cellIdx : visField.cellsIdxs)
+            isFrameValid &= isVisible[cellIdx];
+
+        isValid &= isFrameValid;
+
+        LogMsg(LOG, "frame %3d (yaw: %5.1f deg): %7.4f ms, tested nodes: %4u, tested cells: %5u, visible cells: %5d / %d %s",
+               frame,
+               yaw * 180.0f / PI,
+               ms,
+               mgr.GetStats().numTestedNodes - numNodesBefore,
+               mgr.GetStats().numTestedCells - numCellsBefore,
+               (int)visField.cellsIdxs.size(),
+               numCells,
+               (isFrameValid) ? "OK" : "MISMATCH");
+    }
+
+    LogMsg(LOG, "grass culling: avg %.4f ms, max %.4f ms (frames: %d, cells: %d, nodes: %d)",
+           sumMs / numFrames,
+           maxMs,
+           numFrames,
+           numCells,
+           (int)field.cellsTree.size());
+
+    return isValid;
+}
+
+} // namespace
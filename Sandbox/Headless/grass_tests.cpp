@@ -0,0 +1,79 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: grass_tests.cpp
+    Desc:     headless check of grass generation determinism
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#include "../Common/pch.h"
+#include "headless_tests.h"
+#include <Model/grass_mgr.h>
+#include <job_system.h>
+
+
+namespace Game
+{
+
+//---------------------------------------------------------
+// Desc:  generate all the grass fields by the main thread only (no workers)
+//        and then by numWorkers workers and compare hashes of the results:
+//        generation must not depend on the number of threads
+// Args:  - numWorkers:  number of workers for the second pass (-1: default)
+// Ret:   false if hashes of any field are different
+// NOTE:  restarts the job system (it stays running with numWorkers workers)
+//---------------------------------------------------------
+bool TestGrassGeneration(const int numWorkers)
+{
+    using namespace Core;
+
+    const int       numFields = (int)g_GrassMgr.GetNumGrassFields();
+    cvector<uint64> hashes(numFields);
+    bool            isValid = true;
+
+    // everything is executed by the main thread
+    g_JobSystem.Shutdown();
+    g_JobSystem.Init(0);
+
+    for (int i = 0; i < numFields; ++i)
+    {
+        g_GrassMgr.RegenerateGrassField(i);
+        hashes[i] = g_GrassMgr.CalcGrassFieldHash(i);
+    }
+
+    // the same fields by workers
+    g_JobSystem.Shutdown();
+    g_JobSystem.Init(numWorkers);
+
+    for (int i = 0; i < numFields; ++i)
+    {
+        g_GrassMgr.RegenerateGrassField(i);
+
+        const GrassField& field = g_GrassMgr.GetGrassField(i);
+        const uint64      hash  = g_GrassMgr.CalcGrassFieldHash(i);
+
+        if (hash != hashes[i])
+        {
+            LogErr(LOG, "grass field (%s): generation isn't deterministic (hash without workers: %llx, with workers: %llx)",
+                   field.name,
+                   (unsigned long long)hashes[i],
+                   (unsigned long long)hash);
+            isValid = false;
+        }
+        else
+        {
+            LogMsg(LOG, "grass field (%s): instances: %u, hash: %llx", field.name, field.grassCount, (unsigned long long)hash);
+        }
+    }
+
+    return isValid;
+}
+
+} // namespace
@@ -0,0 +1,35 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: headless_tests.h
+    Desc:     tests and benchmarks which are executed by the Sandbox in headless
+              mode (by a command line switch) instead of running the game loop;
+              each of them returns false if the check failed
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+namespace Game
+{
+
+// entities: indices of destroyed entities are reused with the next generation
+bool TestEnttIdsRecycling();
+
+// terrain: heightfield ray tests vs brute force (the level must be loaded)
+bool BenchmarkTerrainRays(const int numRays);
+
+// grass: generation of fields gives the same result with/without workers
+bool TestGrassGeneration(const int numWorkers);
+
+// grass: cells culling on a synthetic field vs brute force
+bool BenchmarkGrassCulling(const int numFrames);
+
+} // namespace
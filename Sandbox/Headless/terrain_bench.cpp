@@ -0,0 +1,195 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: terrain_bench.cpp
+    Desc:     headless benchmark of ray/terrain tests: the heightfield traversal
+              of Terrain is compared with a brute force reference
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#include "../Common/pch.h"
+#include "headless_tests.h"
+#include <Terrain/terrain.h>
+#include <geometry/intersection_tests.h>
+#include <math/random.h>
+#include <chrono>
+
+using namespace DirectX;
+
+
+namespace Game
+{
+
+//---------------------------------------------------------
+// Desc:   reference ray/terrain test by brute force: the ray is tested
+//         against LOD0 triangles of each patch which AABB is crossed by the ray
+// Out:    - outDist:  distance to the nearest intersection
+// Ret:    true if there is an intersection
+//---------------------------------------------------------
+bool TestRayTerrainBruteForce(
+    const Core::Terrain& terrain,
+    const Vec3& rayOrig,
+    const Vec3& rayDir,
+    float& outDist)
+{
+    const int terrainLen        = terrain.GetTerrainLength();
+    const int numPatchesPerSide = terrain.GetNumPatchesPerSide();
+    const int patchSize         = terrain.GetPatchSize();
+
+    const cvector<Rect3d>& patchesAABBs = terrain.GetPatchesAABBs();
+
+    const XMVECTOR rayOrigW = { rayOrig.x, rayOrig.y, rayOrig.z };
+    const XMVECTOR rayDirW  = { rayDir.x, rayDir.y, rayDir.z };
+
+    // replace zero components to avoid NaNs in ray/AABB tests
+    constexpr float eps = 1e-20f;
+    const Vec3 invDir(
+        1.0f / ((fabsf(rayDir.x) > eps) ? rayDir.x : eps),
+        1.0f / ((fabsf(rayDir.y) > eps) ? rayDir.y : eps),
+        1.0f / ((fabsf(rayDir.z) > eps) ? rayDir.z : eps));
+
+    // indices of maximal lod (detalization for the geometry)
+    const Core::TerrainLodMgr::PatchLod plod = {0,0,0,0,0};
+
+    UINT baseIndex  = 0;
+    UINT indexCount = 0;
+    terrain.GetLodInfoByPatch(plod, baseIndex, indexCount);
+
+    float tmin       = FLT_MAX;
+    bool  bIntersect = false;
+
+    for (int patchIdx = 0; patchIdx < terrain.GetNumAllPatches(); ++patchIdx)
+    {
+        float tEnter = 0;
+
+        if (!IntersectRayRect3d(patchesAABBs[patchIdx], rayOrig, invDir, tmin, tEnter))
+            continue;
+
+        const int patchZ = patchIdx / numPatchesPerSide;
+        const int patchX = patchIdx % numPatchesPerSide;
+        const int z      = patchZ * (patchSize - 1);
+        const int x      = patchX * (patchSize - 1);
+
+        const UINT baseVertex = (UINT)(z * terrainLen + x);
+
+        const Vertex3dTerrain* verts   = terrain.GetVertices() + baseVertex;
+        const UINT*            indices = terrain.indices_.data() + baseIndex;
+
+        // exec ray/triangle tests for this patch (its mesh)
+        for (int i = 0; i < (int)indexCount / 3; ++i)
+        {
+            const XMVECTOR v0 = XMLoadFloat3(&verts[indices[i*3 + 0]].position);
+            const XMVECTOR v1 = XMLoadFloat3(&verts[indices[i*3 + 1]].position);
+            const XMVECTOR v2 = XMLoadFloat3(&verts[indices[i*3 + 2]].position);
+
+            float t = 0;
+
+            if (!TriangleTests::Intersects(rayOrigW, rayDirW, v0, v1, v2, t))
+                continue;
+
+            if (t > tmin)
+                continue;
+
+            tmin       = t;
+            bIntersect = true;
+        }
+    }
+
+    outDist = tmin;
+    return bIntersect;
+}
+
+//---------------------------------------------------------
+// Desc:   generate random rays over the terrain, test them with the heightfield
+//         traversal (Terrain::TestRayIntersection) and by brute force,
+//         compare results and print timings
+// Args:   - numRays:  how many rays to generate
+// Ret:    true if both ways gave the same result
+//---------------------------------------------------------
+bool BenchmarkTerrainRays(const int numRays)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    const Core::Terrain& terrain = Core::g_ModelMgr.GetTerrain();
+
+    if (numRays <= 0)
+    {
+        LogErr(LOG, "number of rays must be > 0");
+        return false;
+    }
+
+    if (terrain.GetNumVertices() == 0)
+    {
+        LogErr(LOG, "terrain isn't initialized: load the level first");
+        return false;
+    }
+
+    const float terrainLen = (float)(terrain.GetTerrainLength() - 1);
+    const float maxHeight  = terrain.GetAABB().y1;
+
+    cvector<Vec3> origins(numRays);
+    cvector<Vec3> dirs(numRays);
+
+    // own generator so the global rand() sequence isn't affected
+    RandGen rng(12345);
+
+    for (int i = 0; i < numRays; ++i)
+    {
+        origins[i].x = rng.NextF(-0.1f * terrainLen, 1.1f * terrainLen);
+        origins[i].y = rng.NextF(maxHeight - 10.0f, maxHeight + 50.0f);
+        origins[i].z = rng.NextF(-0.1f * terrainLen, 1.1f * terrainLen);
+
+        dirs[i].x = rng.NextF(-1, 1);
+        dirs[i].y = rng.NextF(-1, -0.02f);
+        dirs[i].z = rng.NextF(-1, 1);
+        dirs[i]   = Vec3Normalize(dirs[i]);
+    }
+
+    cvector<IntersectionData> data(numRays);
+    cvector<float>            refDists(numRays, 0.0f);
+    cvector<bool>             refHits(numRays, false);
+    cvector<bool>             hits(numRays, false);
+
+    const auto t0 = Clock::now();
+
+    for (int i = 0; i < numRays; ++i)
+        refHits[i] = TestRayTerrainBruteForce(terrain, origins[i], dirs[i], refDists[i]);
+
+    const auto t1 = Clock::now();
+
+    for (int i = 0; i < numRays; ++i)
+        hits[i] = terrain.TestRayIntersection(origins[i], dirs[i], data[i]);
+
+    const auto t2 = Clock::now();
+
+    int numHits       = 0;
+    int numMismatches = 0;
+
+    for (int i = 0; i < numRays; ++i)
+    {
+        numHits += refHits[i];
+
+        if (refHits[i] != hits[i])
+            numMismatches++;
+
+        else if (hits[i] && fabsf(refDists[i] - data[i].distToIntersect) > 0.001f)
+            numMismatches++;
+    }
+
+    const float msRef = std::chrono::duration<float, std::milli>(t1 - t0).count();
+    const float ms    = std::chrono::duration<float, std::milli>(t2 - t1).count();
+
+    LogMsg(LOG, "terrain rays: %d (hits: %d), brute force: %.3f ms, heightfield: %.3f ms, mismatches: %d",
+        numRays, numHits, msRef, ms, numMismatches);
+
+    return numMismatches == 0;
+}
+
+} // namespace
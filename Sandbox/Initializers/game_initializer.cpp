@@ -22,6 +22,7 @@
 #include <Model/animation_mgr.h>
 #include <Model/animation_saver.h>
 #include <Model/animation_loader.h>
+#include <Model/asset_streamer.h>
 #include <Mesh/material_reader.h>
 #include <Terrain/terrain_initializer.h>
 
@@ -37,6 +38,7 @@
 
 #include <inttypes.h>                   // for using PRIu32, SCNu32, etc.
 #include <math/dx_math_helpers.h>
+#include <job_system.h>                 // for parallel loading of assets
 
 #include "quad_tree_attach_control.h"
 
@@ -1023,7 +1025,50 @@ EntityID CreateCubeEntt(
 }
 
 //---------------------------------------------------------
-// Desc:   read in a list of models from file and create them
+// Desc:   a model which is loaded by a worker thread
+//---------------------------------------------------------
+struct ModelLoadTask
+{
+    char               path[128]{ '\0' };   // relatively to the assets dir
+    ModelID            id       = INVALID_MODEL_ID;
+    Model*             pModel   = nullptr;
+    ModelMaterialsInfo mats;
+    float              durationMs = 0;
+    bool               isLoaded   = false;
+    bool               isStreamed = false;      // load only metadata: geometry is streamed later
+};
+
+//---------------------------------------------------------
+// Desc:   read and decode files of models in range [start, end);
+//         global managers aren't touched here
+//---------------------------------------------------------
+void LoadModelsRange(void* pArgs, const int start, const int end)
+{
+    ModelLoadTask* tasks = (ModelLoadTask*)pArgs;
+    ModelLoader    loader;
+
+    for (int i = start; i < end; ++i)
+    {
+        ModelLoadTask&  task      = tasks[i];
+        const TimePoint loadStart = GetTimePoint();
+
+        if (task.isStreamed)
+            task.isLoaded = loader.LoadMetadata(task.path, *task.pModel, task.mats);
+        else
+            task.isLoaded = loader.LoadGeometry(task.path, *task.pModel, task.mats);
+
+        const TimeDurationMs dur = GetTimePoint() - loadStart;
+        task.durationMs = dur.count();
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   read in a list of models from file and create them:
+//         1. models are registered in the manager in order of the list
+//            (so IDs don't depend on the order of loading completion)
+//         2. files of models are read/decoded in parallel on worker threads
+//         3. materials binding and GPU buffers creation are executed
+//            on the current (owner) thread in order of the list
 //---------------------------------------------------------
 void LoadModelAssets(const char* filepath, Render::CRender& render)
 {
@@ -1033,10 +1078,8 @@ void LoadModelAssets(const char* filepath, Render::CRender& render)
     const TimePoint start = GetTimePoint();
 
     char buf[256]{ '\0' };
-    char modelPath[128]{ '\0' };
     char modelName[MAX_LEN_MODEL_NAME]{ '\0' };
-    ModelID modelId = 0;
-    ModelLoader loader;
+    cvector<ModelLoadTask> tasks;
 
     // open a file for models reading
     FILE* pFile = fopen(filepath, "r");
@@ -1045,15 +1088,16 @@ void LoadModelAssets(const char* filepath, Render::CRender& render)
         LogFatal(LOG, "can't open file for models creation: %s", filepath);
     }
 
-    // read and init each model
+    // read in a path to each model and register an empty model for it
     while (fgets(buf, sizeof(buf), pFile))
     {
         // skip new lines and comments
         if (buf[0] == '\n' || buf[0] == ';')
             continue;
 
+        ModelLoadTask task;
 
-        int count = sscanf(buf, "%s", modelPath);
+        int count = sscanf(buf, "%127s", task.path);
         if (count != 1)
         {
             LogErr(LOG, "can't get a model path from str buffer: %s", buf);
@@ -1062,15 +1106,50 @@ void LoadModelAssets(const char* filepath, Render::CRender& render)
 
         // add empty model into the manager and setup its name
         Model& model = g_ModelMgr.AddEmptyModel();
-        FileSys::GetFileStem(modelPath, modelName);
+        FileSys::GetFileStem(task.path, modelName);
         g_ModelMgr.SetModelName(model.GetId(), modelName);
 
-        const bool isLoaded = loader.Load(modelPath, &model);
+        task.id = model.GetId();
+        tasks.push_back(std::move(task));
+    }
 
-        // if failed to load model...
-        if (!isLoaded)
+    fclose(pFile);
+
+    // no more models are added so now we can get stable ptrs to them
+    const bool isStreamed = g_AssetStreamer.IsEnabled();
+
+    for (ModelLoadTask& task : tasks)
+    {
+        task.pModel     = &g_ModelMgr.GetModelById(task.id);
+        task.isStreamed = isStreamed;
+    }
+
+
+    // read/decode models files in parallel
+    g_JobSystem.ParallelFor((int)tasks.size(), 1, LoadModelsRange, tasks.data());
+
+    const TimeDurationMs decodeDur = GetTimePoint() - start;
+
+
+    // bind materials and init vb/ib buffers in order of the list
+    for (ModelLoadTask& task : tasks)
+    {
+        Model& model = *task.pModel;
+
+        if (task.isLoaded)
+        {
+            ModelLoader loader;
+            loader.BindMaterials(model, task.mats);
+
+            // geometry of the model can be unloaded/reloaded by streaming
+            g_AssetStreamer.RegisterModel(task.id, task.path, !task.isStreamed);
+        }
+        else
         {
-            LogErr(LOG, "can't load model from file: %s", modelPath);
+            // failed to load model so use the default one
+            FileSys::GetFileStem(task.path, modelName);
+
+            LogErr(LOG, "can't load model from file: %s", task.path);
             LogMsg("%s Set model (%s) to default (cube)%s", YELLOW, modelName, RESET);
 
             const Model& invalidModel = g_ModelMgr.GetModelById(0);
@@ -1079,8 +1158,11 @@ void LoadModelAssets(const char* filepath, Render::CRender& render)
             g_ModelMgr.SetModelName(model.GetId(), modelName);
         }
 
-        // init vb/ib buffers
-        model.InitBuffers();
+        // geometry of streamed model isn't loaded yet
+        if (model.IsGeometryLoaded())
+            model.InitBuffers();
+
+        LogMsg("model loaded: %-40s (%.3f ms)", task.path, task.durationMs);
     }
 
 
@@ -1089,10 +1171,9 @@ void LoadModelAssets(const char* filepath, Render::CRender& render)
     SetConsoleColor(MAGENTA);
     LogMsg("-------------------------------------");
     LogMsg("Models loading duration: %f sec", elapsed.count() * 0.001f);
+    LogMsg("  read/decode (parallel): %f sec", decodeDur.count() * 0.001f);
     LogMsg("-------------------------------------\n");
     SetConsoleColor(RESET);
-
-    fclose(pFile);
 }
 
 
@@ -1422,10 +1503,42 @@ void CreateNature(const char* filename, ECS::EntityMgr& enttMgr, Render::CRender
     LogDbg(LOG, "nature initialization is finished\n");
 }
 
+//---------------------------------------------------------
+// Desc:   a skeleton (with its animations) which is loaded by a worker thread
+//---------------------------------------------------------
+struct AnimLoadTask
+{
+    char          path[256]{ '\0' };
+    AnimSkeleton* pSkeleton  = nullptr;
+    float         durationMs = 0;
+    bool          isLoaded   = false;
+};
+
+//---------------------------------------------------------
+// Desc:   parse skeletons/animations files in range [start, end)
+//---------------------------------------------------------
+void LoadAnimationsRange(void* pArgs, const int start, const int end)
+{
+    AnimLoadTask*   tasks = (AnimLoadTask*)pArgs;
+    AnimationLoader animLoader;
+
+    for (int i = start; i < end; ++i)
+    {
+        AnimLoadTask&   task      = tasks[i];
+        const TimePoint loadStart = GetTimePoint();
+
+        task.isLoaded = animLoader.LoadData(task.path, *task.pSkeleton);
+
+        const TimeDurationMs dur = GetTimePoint() - loadStart;
+        task.durationMs = dur.count();
+    }
+}
+
 //---------------------------------------------------------
 // Desc:  1. read in path to file with skeleton and animations
-//        2. load its data
-//        3. store it in the animations manager
+//        2. register a skeleton in the animations manager (in order of the list)
+//        3. load skeletons data in parallel
+//        4. init GPU data of skeletons on the current (owner) thread
 // 
 // Args:  - filepath:  a path to file where we register such skeletons/animations files
 //---------------------------------------------------------
@@ -1439,8 +1552,9 @@ void LoadAnimations(const char* filepath)
 
     const TimePoint start = GetTimePoint();
     AnimationLoader animLoader;
+    cvector<AnimLoadTask> tasks;
+    char skeletonName[MAX_LEN_SKELETON_NAME]{ '\0' };
     char buf[512];
-    int count = 0;
 
     FILE* pFile = fopen(filepath, "r");
     if (!pFile)
@@ -1456,13 +1570,37 @@ void LoadAnimations(const char* filepath)
         LogFatal(LOG, "invalid file for animations: %s", filepath);
     }
 
-    // read in each path to animation and load this animation
-    while (!feof(pFile))
+    // read in each path to animation and register a skeleton for it
+    // (skeleton has the same name as its file)
+    while (fscanf(pFile, "%255s", buf) == 1)
     {
-        count = fscanf(pFile, "%s", buf);
-        assert(count == 1);
+        AnimLoadTask task;
+        strcpy(task.path, buf);
+
+        FileSys::GetFileStem(task.path, skeletonName);
+        const SkeletonID id = g_AnimationMgr.AddSkeleton(skeletonName);
+
+        // skeletons are stored by ptrs so this ptr stays valid
+        task.pSkeleton = &g_AnimationMgr.GetSkeleton(id);
+        tasks.push_back(task);
+    }
+
+    fclose(pFile);
+
+    // parse files in parallel
+    g_JobSystem.ParallelFor((int)tasks.size(), 1, LoadAnimationsRange, tasks.data());
+
+    // init GPU data in order of the list
+    for (const AnimLoadTask& task : tasks)
+    {
+        if (!task.isLoaded)
+        {
+            LogErr(LOG, "can't load skeleton/animations from file: %s", task.path);
+            continue;
+        }
 
-        animLoader.Load(buf);
+        animLoader.InitGpuData(*task.pSkeleton);
+        LogMsg("animations loaded: %-40s (%.3f ms)", task.path, task.durationMs);
     }
 
 
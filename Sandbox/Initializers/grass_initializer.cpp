@@ -30,6 +30,7 @@ struct GrassCommonParams
 {
     int grassDistFullSize = 0;
     int grassDistVisible = 40;
+    int grassInstancesBudget = 1 << 17;
 };
 
 
@@ -91,6 +92,7 @@ bool GrassInitializer::Init(const char* filepath, ECS::EntityMgr& enttMgr)
 
             grassMgr.SetGrassVisibilityRange((float)params.grassDistVisible);
             grassMgr.SetGrassDistFullSize((float)params.grassDistFullSize);
+            grassMgr.SetGrassInstancesBudget((uint32)params.grassInstancesBudget);
         }
         else if (strncmp(buf, "grass_field", 11) == 0)
         {
@@ -128,10 +130,15 @@ void ReadCommonParams(FILE* pFile, GrassCommonParams& outParams)
     assert(count == 2);
     assert(strcmp(key, "grass_dist_visible") == 0);
 
+    count = fscanf(pFile, "%s %d\n", key, &outParams.grassInstancesBudget);
+    assert(count == 2);
+    assert(strcmp(key, "grass_instances_budget") == 0);
+
     printf("\n");
     LogMsg("Read grass common params:");
     LogMsg("grass dist full size:  %d", outParams.grassDistFullSize);
     LogMsg("grass dist visible:    %d", outParams.grassDistVisible);
+    LogMsg("grass inst budget:     %d", outParams.grassInstancesBudget);
     printf("\n");
 }
 
@@ -301,6 +308,9 @@ void ReadGrassFieldParams(
         else if (strcmp(key, "density_mask_alpha") == 0)
             ReadStrParam(buf, outData.densityMaskAlpha);
 
+        else if (strcmp(key, "seed") == 0)
+            ReadIntParam(buf, outData.seed);
+
         else
             LogFatal(LOG, "wtf? there is a wrong key: %s", key);
     }
@@ -340,6 +350,7 @@ void ReadGrassFieldParams(
     LogMsg("\tgrass count:                   %d", outData.grassCount);
     LogMsg("\tdensity mask RGB:              %s", outData.densityMaskRGB);
     LogMsg("\tdensity mask Alpha:            %s", outData.densityMaskAlpha);
+    LogMsg("\tseed:                          %d", outData.seed);
 }
 
 } // namespace
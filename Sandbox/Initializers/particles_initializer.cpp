@@ -166,6 +166,9 @@ void ParticlesInitializer::ReadAndCreateEmitter(
     enttMgr.AddNameComponent(enttId, emitterName);
     enttMgr.AddBoundingComponent(enttId, localBox, worldBox);
 
+    // alloc memory for particles once (spawn rate and lifetime are known now)
+    enttMgr.particleSys_.InitParticlesPool(enttId);
+
 #if ATTACH_PARTICLE_EMITTER_TO_QUADTREE
     enttMgr.AttachEnttToQuadTree(enttId);
 #endif
@@ -291,6 +294,7 @@ ECS::eEmitterPropType GetEmitterPropType(const char* prop)
         case 'm':
             if (strcmp(prop, "material") == 0)      return EMITTER_MATERIAL;
             if (strcmp(prop, "mass") == 0)          return EMITTER_PARTICLE_MASS;
+            if (strcmp(prop, "max_particles") == 0) return EMITTER_MAX_PARTICLES;
             break;
 
           
@@ -407,6 +411,12 @@ void HandleEmitterProperty(
             break;
         }
 
+        case EMITTER_MAX_PARTICLES:
+        {
+            ReadInt(buf, " max_particles %d", &emitter.maxParticles);
+            break;
+        }
+
         case EMITTER_PARTICLE_LIFETIME_SEC:
         {
             ReadFloat(buf, " lifetime_sec %f", &emitter.life);
@@ -2,8 +2,42 @@
 // Filename: main.cpp
 ///////////////////////////////////////////////////////////////////////////////
 #include "Game/Application.h"
+#include "Headless/headless_tests.h"
+#include <geometry/frustum_culling.h>
+#include <job_system.h>
+#include <string.h>
 
-int main()
+//---------------------------------------------------------
+// headless modes: a command line switch runs a test/benchmark
+// instead of the game loop, the exit code is 0 if it passed
+//---------------------------------------------------------
+struct HeadlessMode
+{
+    const char* flag;
+    bool        needsLevel;         // load the level before (the app owns the job system)
+    bool        needsJobs;          // start the job system (if the level isn't loaded)
+    bool        (*func)();
+};
+
+static const HeadlessMode s_HeadlessModes[] =
+{
+    // frustum culling of synthetic boxes
+    { "--bench-culling",       false, true,  []() { return BenchmarkFrustumCulling(100000); } },
+
+    // recycling of entity ids
+    { "--test-entt-ids",       false, false, []() { return Game::TestEnttIdsRecycling(); } },
+
+    // grass cells culling on a synthetic field
+    { "--bench-grass-culling", false, false, []() { return Game::BenchmarkGrassCulling(360); } },
+
+    // heightfield ray tests vs brute force ones
+    { "--bench-terrain-rays",  true,  false, []() { return Game::BenchmarkTerrainRays(100); } },
+
+    // generation of grass fields without workers and with workers
+    { "--test-grass-gen",      true,  false, []() { return Game::TestGrassGeneration(-1); } },
+};
+
+int main(int argc, char** argv)
 {
 #if defined(DEBUG) | defined(_DEBUG)
 	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
@@ -14,6 +48,28 @@ int main()
     // ATTENTION: put the declation of logger before all the others; it is necessary to create a logger text file
     InitLogger("log.txt");
 
+    // headless mode: run a test/benchmark and exit
+    for (const HeadlessMode& mode : s_HeadlessModes)
+    {
+        if ((argc < 2) || (strcmp(argv[1], mode.flag) != 0))
+            continue;
+
+        if (mode.needsLevel)
+            app.Init();
+        else if (mode.needsJobs)
+            g_JobSystem.Init();
+
+        const bool isValid = mode.func();
+
+        if (mode.needsLevel)
+            app.Close();
+        else if (mode.needsJobs)
+            g_JobSystem.Shutdown();
+
+        CloseLogger();
+        return (isValid) ? 0 : 1;
+    }
+
 	app.Init();
 	app.Run();
 	app.Close();
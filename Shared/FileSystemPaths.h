@@ -15,6 +15,7 @@ static const char* g_RelPathShadersDir      = "data/shaders/";
 static const char* g_RelPathTexDir          = "data/textures/";
 static const char* g_RelPathUIDataDir       = "data/ui/";
 static const char* g_RelPathAudioDir        = "data/audio/";
+static const char* g_RelPathCacheDir        = "data/cache/";            // generated caches (.de3db, .bvh, .animb), not tracked by git
 
 // full paths from the sys root
 //static const std::string g_BuildDir(BUILD_DIR);
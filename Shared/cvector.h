@@ -79,6 +79,7 @@ public:
     void         shrink_to_fit();
     void         purge();
     void         erase(const vsize index);
+    void         swap_pop(const vsize index);
     void         assign(std::initializer_list<T> il);
 
     void         fill_zeros();
@@ -399,6 +400,21 @@ inline void cvector<T>::erase(const index idx)
     size_--;
 }
 
+// ----------------------------------------------------
+// remove an element by idx: the last element is moved into its place
+// (O(1) but doesn't keep the order of elements)
+// ----------------------------------------------------
+template <typename T>
+inline void cvector<T>::swap_pop(const index idx)
+{
+    assert(idx >= 0 && idx < size_);
+
+    if (idx != size_ - 1)
+        data_[idx] = std::move(data_[size_ - 1]);
+
+    size_--;
+}
+
 // ----------------------------------------------------
 
 template <typename T>
@@ -4,7 +4,8 @@
 #include <math/matrix.h>
 
 
-int numTests = 0;
+// counter of tests (for debug); per thread since culling runs in parallel jobs
+static thread_local int numTests = 0;
 
 int Frustum::GetNumTests() const
 {
@@ -243,6 +244,36 @@ bool Frustum::TestRect(const Rect3d& rect) const
             (PlaneClassify(rect, farPlane_)      != PLANE_BACK);
 }
 
+//---------------------------------------------------------
+// Desc:  define if input 3d rectangle is outside, completely inside or
+//        intersected by the frustum (if rect is completely inside then
+//        everything inside of it is visible as well and can skip tests)
+//---------------------------------------------------------
+int Frustum::ClassifyRect(const Rect3d& rect) const
+{
+    ++numTests;
+
+    const Plane3d* planes[6] =
+    {
+        &leftPlane_, &rightPlane_, &topPlane_, &bottomPlane_, &nearPlane_, &farPlane_
+    };
+
+    int result = PLANE_FRONT;
+
+    for (const Plane3d* pPlane : planes)
+    {
+        const int side = PlaneClassify(rect, *pPlane);
+
+        if (side == PLANE_BACK)
+            return PLANE_BACK;
+
+        if (side == PLANE_INTERSECT)
+            result = PLANE_INTERSECT;
+    }
+
+    return result;
+}
+
 //---------------------------------------------------------
 // Desc:   test if inter sphere is contained or intersected by the frustum
 //---------------------------------------------------------
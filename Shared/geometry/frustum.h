@@ -109,5 +109,9 @@ public:
     bool TestRect  (const Rect3d& rect)   const;
     bool TestSphere(const Sphere& sphere) const;
 
+    // ret: PLANE_BACK if rect is outside, PLANE_FRONT if it is completely
+    //      inside, and PLANE_INTERSECT if it is crossed by some plane
+    int  ClassifyRect(const Rect3d& rect) const;
+
     int GetNumTests() const;
 };
@@ -0,0 +1,587 @@
+// =================================================================================
+// Filename:   frustum_culling.cpp
+// Desc:       implementation of batch SIMD frustum culling over SoA arrays
+//
+// Created:    17.10.2026  by DimaSkup
+// =================================================================================
+#include "frustum_culling.h"
+#include <geometry/rect3d_functions.h>
+#include <math/random.h>
+#include <job_system.h>
+#include <scratch_arena.h>
+#include <log.h>
+#include <immintrin.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+
+
+// volumes are split into slices of this size for parallel culling
+constexpr int CULL_SLICE_SIZE = 2048;
+
+//---------------------------------------------------------
+// frustum planes in SoA form (to broadcast components into SIMD registers)
+//---------------------------------------------------------
+struct FrustumPlanesSoA
+{
+    float nx[6];
+    float ny[6];
+    float nz[6];
+    float d[6];
+    float absNx[6];
+    float absNy[6];
+    float absNz[6];
+};
+
+//---------------------------------------------------------
+// Desc:  gather frustum planes into SoA form
+//---------------------------------------------------------
+void GetPlanesSoA(const Frustum& frustum, FrustumPlanesSoA& out)
+{
+    const Plane3d* planes[6] =
+    {
+        &frustum.leftPlane_,
+        &frustum.rightPlane_,
+        &frustum.topPlane_,
+        &frustum.bottomPlane_,
+        &frustum.nearPlane_,
+        &frustum.farPlane_,
+    };
+
+    for (int i = 0; i < 6; ++i)
+    {
+        out.nx[i]    = planes[i]->normal.x;
+        out.ny[i]    = planes[i]->normal.y;
+        out.nz[i]    = planes[i]->normal.z;
+        out.d[i]     = planes[i]->distance;
+        out.absNx[i] = fabsf(planes[i]->normal.x);
+        out.absNy[i] = fabsf(planes[i]->normal.y);
+        out.absNz[i] = fabsf(planes[i]->normal.z);
+    }
+}
+
+
+//==================================================================================
+// scalar kernels
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:  test boxes in range [start, end) one by one
+// Ret:   number of visible boxes (their indices are written into outIdxs)
+//---------------------------------------------------------
+int CullAABBsScalar(
+    const FrustumPlanesSoA& p,
+    const AABBsSoA& boxes,
+    const int start,
+    const int end,
+    int* outIdxs)
+{
+    int numVisible = 0;
+
+    for (int i = start; i < end; ++i)
+    {
+        const float cx = boxes.centerX[i];
+        const float cy = boxes.centerY[i];
+        const float cz = boxes.centerZ[i];
+        const float ex = boxes.extentX[i];
+        const float ey = boxes.extentY[i];
+        const float ez = boxes.extentZ[i];
+
+        bool visible = true;
+
+        for (int pl = 0; pl < 6; ++pl)
+        {
+            const float dist = p.nx[pl]*cx + p.ny[pl]*cy + p.nz[pl]*cz + p.d[pl];
+            const float r    = p.absNx[pl]*ex + p.absNy[pl]*ey + p.absNz[pl]*ez;
+
+            visible &= (dist + r > 0.0f);
+        }
+
+        outIdxs[numVisible] = i;
+        numVisible += visible;
+    }
+
+    return numVisible;
+}
+
+//---------------------------------------------------------
+// Desc:  test spheres in range [start, end) one by one
+//---------------------------------------------------------
+int CullSpheresScalar(
+    const FrustumPlanesSoA& p,
+    const SpheresSoA& spheres,
+    const int start,
+    const int end,
+    int* outIdxs)
+{
+    int numVisible = 0;
+
+    for (int i = start; i < end; ++i)
+    {
+        const float cx = spheres.centerX[i];
+        const float cy = spheres.centerY[i];
+        const float cz = spheres.centerZ[i];
+        const float r  = spheres.radius[i];
+
+        bool visible = true;
+
+        for (int pl = 0; pl < 6; ++pl)
+        {
+            const float dist = p.nx[pl]*cx + p.ny[pl]*cy + p.nz[pl]*cz + p.d[pl];
+            visible &= (dist + r > 0.0f);
+        }
+
+        outIdxs[numVisible] = i;
+        numVisible += visible;
+    }
+
+    return numVisible;
+}
+
+
+//==================================================================================
+// SIMD kernels
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:  write indices of visible volumes by bit mask (branchless)
+//---------------------------------------------------------
+template <int WIDTH>
+inline int WriteVisibleIdxs(const int mask, const int baseIdx, int* outIdxs)
+{
+    int numVisible = 0;
+
+    for (int j = 0; j < WIDTH; ++j)
+    {
+        outIdxs[numVisible] = baseIdx + j;
+        numVisible += (mask >> j) & 1;
+    }
+
+    return numVisible;
+}
+
+#if defined(__AVX__)
+
+//---------------------------------------------------------
+// Desc:  test 8 boxes per iteration (AVX)
+//---------------------------------------------------------
+int CullAABBsSIMD(
+    const FrustumPlanesSoA& p,
+    const AABBsSoA& boxes,
+    const int start,
+    const int end,
+    int* outIdxs)
+{
+    constexpr int WIDTH = 8;
+
+    const int   simdEnd    = start + ((end - start) & ~(WIDTH - 1));
+    const __m256 zero      = _mm256_setzero_ps();
+    int         numVisible = 0;
+
+    for (int i = start; i < simdEnd; i += WIDTH)
+    {
+        const __m256 cx = _mm256_loadu_ps(boxes.centerX.data() + i);
+        const __m256 cy = _mm256_loadu_ps(boxes.centerY.data() + i);
+        const __m256 cz = _mm256_loadu_ps(boxes.centerZ.data() + i);
+        const __m256 ex = _mm256_loadu_ps(boxes.extentX.data() + i);
+        const __m256 ey = _mm256_loadu_ps(boxes.extentY.data() + i);
+        const __m256 ez = _mm256_loadu_ps(boxes.extentZ.data() + i);
+
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for (int pl = 0; pl < 6; ++pl)
+        {
+            __m256 dist = _mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(p.nx[pl])), _mm256_set1_ps(p.d[pl]));
+            dist        = _mm256_add_ps(dist, _mm256_mul_ps(cy, _mm256_set1_ps(p.ny[pl])));
+            dist        = _mm256_add_ps(dist, _mm256_mul_ps(cz, _mm256_set1_ps(p.nz[pl])));
+
+            __m256 r    = _mm256_mul_ps(ex, _mm256_set1_ps(p.absNx[pl]));
+            r           = _mm256_add_ps(r, _mm256_mul_ps(ey, _mm256_set1_ps(p.absNy[pl])));
+            r           = _mm256_add_ps(r, _mm256_mul_ps(ez, _mm256_set1_ps(p.absNz[pl])));
+
+            visible     = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(dist, r), zero, _CMP_GT_OQ));
+        }
+
+        numVisible += WriteVisibleIdxs<WIDTH>(_mm256_movemask_ps(visible), i, outIdxs + numVisible);
+    }
+
+    // process the tail
+    return numVisible + CullAABBsScalar(p, boxes, simdEnd, end, outIdxs + numVisible);
+}
+
+//---------------------------------------------------------
+// Desc:  test 8 spheres per iteration (AVX)
+//---------------------------------------------------------
+int CullSpheresSIMD(
+    const FrustumPlanesSoA& p,
+    const SpheresSoA& spheres,
+    const int start,
+    const int end,
+    int* outIdxs)
+{
+    constexpr int WIDTH = 8;
+
+    const int    simdEnd    = start + ((end - start) & ~(WIDTH - 1));
+    const __m256 zero       = _mm256_setzero_ps();
+    int          numVisible = 0;
+
+    for (int i = start; i < simdEnd; i += WIDTH)
+    {
+        const __m256 cx = _mm256_loadu_ps(spheres.centerX.data() + i);
+        const __m256 cy = _mm256_loadu_ps(spheres.centerY.data() + i);
+        const __m256 cz = _mm256_loadu_ps(spheres.centerZ.data() + i);
+        const __m256 r  = _mm256_loadu_ps(spheres.radius.data() + i);
+
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for (int pl = 0; pl < 6; ++pl)
+        {
+            __m256 dist = _mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(p.nx[pl])), _mm256_set1_ps(p.d[pl]));
+            dist        = _mm256_add_ps(dist, _mm256_mul_ps(cy, _mm256_set1_ps(p.ny[pl])));
+            dist        = _mm256_add_ps(dist, _mm256_mul_ps(cz, _mm256_set1_ps(p.nz[pl])));
+
+            visible     = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(dist, r), zero, _CMP_GT_OQ));
+        }
+
+        numVisible += WriteVisibleIdxs<WIDTH>(_mm256_movemask_ps(visible), i, outIdxs + numVisible);
+    }
+
+    return numVisible + CullSpheresScalar(p, spheres, simdEnd, end, outIdxs + numVisible);
+}
+
+#else
+
+//---------------------------------------------------------
+// Desc:  test 4 boxes per iteration (SSE)
+//---------------------------------------------------------
+int CullAABBsSIMD(
+    const FrustumPlanesSoA& p,
+    const AABBsSoA& boxes,
+    const int start,
+    const int end,
+    int* outIdxs)
+{
+    constexpr int WIDTH = 4;
+
+    const int    simdEnd    = start + ((end - start) & ~(WIDTH - 1));
+    const __m128 zero       = _mm_setzero_ps();
+    int          numVisible = 0;
+
+    for (int i = start; i < simdEnd; i += WIDTH)
+    {
+        const __m128 cx = _mm_loadu_ps(boxes.centerX.data() + i);
+        const __m128 cy = _mm_loadu_ps(boxes.centerY.data() + i);
+        const __m128 cz = _mm_loadu_ps(boxes.centerZ.data() + i);
+        const __m128 ex = _mm_loadu_ps(boxes.extentX.data() + i);
+        const __m128 ey = _mm_loadu_ps(boxes.extentY.data() + i);
+        const __m128 ez = _mm_loadu_ps(boxes.extentZ.data() + i);
+
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for (int pl = 0; pl < 6; ++pl)
+        {
+            __m128 dist = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(p.nx[pl])), _mm_set1_ps(p.d[pl]));
+            dist        = _mm_add_ps(dist, _mm_mul_ps(cy, _mm_set1_ps(p.ny[pl])));
+            dist        = _mm_add_ps(dist, _mm_mul_ps(cz, _mm_set1_ps(p.nz[pl])));
+
+            __m128 r    = _mm_mul_ps(ex, _mm_set1_ps(p.absNx[pl]));
+            r           = _mm_add_ps(r, _mm_mul_ps(ey, _mm_set1_ps(p.absNy[pl])));
+            r           = _mm_add_ps(r, _mm_mul_ps(ez, _mm_set1_ps(p.absNz[pl])));
+
+            visible     = _mm_and_ps(visible, _mm_cmpgt_ps(_mm_add_ps(dist, r), zero));
+        }
+
+        numVisible += WriteVisibleIdxs<WIDTH>(_mm_movemask_ps(visible), i, outIdxs + numVisible);
+    }
+
+    // process the tail
+    return numVisible + CullAABBsScalar(p, boxes, simdEnd, end, outIdxs + numVisible);
+}
+
+//---------------------------------------------------------
+// Desc:  test 4 spheres per iteration (SSE)
+//---------------------------------------------------------
+int CullSpheresSIMD(
+    const FrustumPlanesSoA& p,
+    const SpheresSoA& spheres,
+    const int start,
+    const int end,
+    int* outIdxs)
+{
+    constexpr int WIDTH = 4;
+
+    const int    simdEnd    = start + ((end - start) & ~(WIDTH - 1));
+    const __m128 zero       = _mm_setzero_ps();
+    int          numVisible = 0;
+
+    for (int i = start; i < simdEnd; i += WIDTH)
+    {
+        const __m128 cx = _mm_loadu_ps(spheres.centerX.data() + i);
+        const __m128 cy = _mm_loadu_ps(spheres.centerY.data() + i);
+        const __m128 cz = _mm_loadu_ps(spheres.centerZ.data() + i);
+        const __m128 r  = _mm_loadu_ps(spheres.radius.data() + i);
+
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for (int pl = 0; pl < 6; ++pl)
+        {
+            __m128 dist = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(p.nx[pl])), _mm_set1_ps(p.d[pl]));
+            dist        = _mm_add_ps(dist, _mm_mul_ps(cy, _mm_set1_ps(p.ny[pl])));
+            dist        = _mm_add_ps(dist, _mm_mul_ps(cz, _mm_set1_ps(p.nz[pl])));
+
+            visible     = _mm_and_ps(visible, _mm_cmpgt_ps(_mm_add_ps(dist, r), zero));
+        }
+
+        numVisible += WriteVisibleIdxs<WIDTH>(_mm_movemask_ps(visible), i, outIdxs + numVisible);
+    }
+
+    return numVisible + CullSpheresScalar(p, spheres, simdEnd, end, outIdxs + numVisible);
+}
+
+#endif // __AVX__
+
+
+//==================================================================================
+// parallel culling
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:  args for culling of slices by worker threads
+//---------------------------------------------------------
+struct CullSlicesArgs
+{
+    const FrustumPlanesSoA* pPlanes    = nullptr;
+    const AABBsSoA*         pBoxes     = nullptr;
+    const SpheresSoA*       pSpheres   = nullptr;
+    int                     count      = 0;
+    bool                    useSIMD    = true;
+    int*                    outIdxs    = nullptr;
+    int*                    outCounts  = nullptr;  // number of visible volumes per slice
+};
+
+//---------------------------------------------------------
+// Desc:  cull slices in range [startSlice, endSlice);
+//        each slice writes indices into its own part of the output arr
+//---------------------------------------------------------
+void CullSlices(void* pArgs, const int startSlice, const int endSlice)
+{
+    const CullSlicesArgs& args = *(const CullSlicesArgs*)pArgs;
+
+    for (int slice = startSlice; slice < endSlice; ++slice)
+    {
+        const int start = slice * CULL_SLICE_SIZE;
+        const int end   = (start + CULL_SLICE_SIZE < args.count) ? start + CULL_SLICE_SIZE : args.count;
+        int*      out   = args.outIdxs + start;
+
+        if (args.pBoxes)
+        {
+            args.outCounts[slice] = (args.useSIMD)
+                ? CullAABBsSIMD  (*args.pPlanes, *args.pBoxes, start, end, out)
+                : CullAABBsScalar(*args.pPlanes, *args.pBoxes, start, end, out);
+        }
+        else
+        {
+            args.outCounts[slice] = (args.useSIMD)
+                ? CullSpheresSIMD  (*args.pPlanes, *args.pSpheres, start, end, out)
+                : CullSpheresScalar(*args.pPlanes, *args.pSpheres, start, end, out);
+        }
+    }
+}
+
+//---------------------------------------------------------
+// Desc:  cull volumes in parallel by slices and make the output compact
+//---------------------------------------------------------
+int CullVolumes(CullSlicesArgs& args)
+{
+    const int numSlices = (args.count + CULL_SLICE_SIZE - 1) / CULL_SLICE_SIZE;
+
+    ScratchVec<int> counts;
+    counts.resize(numSlices);
+    args.outCounts = counts.data();
+
+    g_JobSystem.ParallelFor(numSlices, 1, CullSlices, &args);
+
+    // move visible indices of each slice right after the previous one
+    int numVisible = args.outCounts[0];
+
+    for (int slice = 1; slice < numSlices; ++slice)
+    {
+        const int* sliceIdxs = args.outIdxs + slice * CULL_SLICE_SIZE;
+        const int  num       = args.outCounts[slice];
+
+        std::copy(sliceIdxs, sliceIdxs + num, args.outIdxs + numVisible);
+        numVisible += num;
+    }
+
+    return numVisible;
+}
+
+
+//==================================================================================
+// public functions
+//==================================================================================
+
+int CullAABBs(
+    const Frustum& frustum,
+    const AABBsSoA& boxes,
+    const int count,
+    int* outIdxs,
+    const bool useSIMD)
+{
+    if (count <= 0)
+        return 0;
+
+    if (!outIdxs || boxes.size() < count)
+    {
+        LogErr(LOG, "invalid input args (out idxs: %p, num boxes: %d, count: %d)", outIdxs, (int)boxes.size(), count);
+        return 0;
+    }
+
+    FrustumPlanesSoA planes;
+    GetPlanesSoA(frustum, planes);
+
+    // too few volumes to split
+    if (count <= CULL_SLICE_SIZE)
+    {
+        return (useSIMD)
+            ? CullAABBsSIMD  (planes, boxes, 0, count, outIdxs)
+            : CullAABBsScalar(planes, boxes, 0, count, outIdxs);
+    }
+
+    CullSlicesArgs args;
+    args.pPlanes = &planes;
+    args.pBoxes  = &boxes;
+    args.count   = count;
+    args.useSIMD = useSIMD;
+    args.outIdxs = outIdxs;
+
+    return CullVolumes(args);
+}
+
+//---------------------------------------------------------
+
+int CullSpheres(
+    const Frustum& frustum,
+    const SpheresSoA& spheres,
+    const int count,
+    int* outIdxs,
+    const bool useSIMD)
+{
+    if (count <= 0)
+        return 0;
+
+    if (!outIdxs || spheres.size() < count)
+    {
+        LogErr(LOG, "invalid input args (out idxs: %p, num spheres: %d, count: %d)", outIdxs, (int)spheres.size(), count);
+        return 0;
+    }
+
+    FrustumPlanesSoA planes;
+    GetPlanesSoA(frustum, planes);
+
+    if (count <= CULL_SLICE_SIZE)
+    {
+        return (useSIMD)
+            ? CullSpheresSIMD  (planes, spheres, 0, count, outIdxs)
+            : CullSpheresScalar(planes, spheres, 0, count, outIdxs);
+    }
+
+    CullSlicesArgs args;
+    args.pPlanes  = &planes;
+    args.pSpheres = &spheres;
+    args.count    = count;
+    args.useSIMD  = useSIMD;
+    args.outIdxs  = outIdxs;
+
+    return CullVolumes(args);
+}
+
+//---------------------------------------------------------
+// Desc:   headless benchmark of culling: generate synthetic boxes around
+//         the frustum, cull them with each path, compare results with
+//         each other and with Frustum::TestRect, and print timings
+// Args:   - numBoxes:  how many boxes to generate
+// Ret:    true if all the paths gave the same result
+//---------------------------------------------------------
+bool BenchmarkFrustumCulling(const int numBoxes)
+{
+    using Clock = std::chrono::high_resolution_clock;
+    constexpr int numRuns = 20;
+
+    if (numBoxes <= 0)
+    {
+        LogErr(LOG, "number of boxes must be > 0");
+        return false;
+    }
+
+    // camera at origin looking along +Z (fov 90 deg, aspect 16:9)
+    const Frustum frustum(1.5708f, 16.0f / 9.0f, 1.0f, 1000.0f);
+
+    AABBsSoA boxes;
+    boxes.Resize(numBoxes);
+
+    srand(12345);
+
+    for (int i = 0; i < numBoxes; ++i)
+    {
+        const Vec3 center (RandF(-1000, 1000), RandF(-100, 100), RandF(-1000, 1000));
+        const Vec3 extents(RandF(0.5f, 10),    RandF(0.5f, 10),  RandF(0.5f, 10));
+
+        boxes.Set(i, Rect3d(center, extents));
+    }
+
+    cvector<int> refIdxs(numBoxes);
+    cvector<int> idxs(numBoxes);
+
+    // reference: one box at a time through the Frustum class
+    int numRef = 0;
+
+    for (int i = 0; i < numBoxes; ++i)
+    {
+        const Rect3d rect(
+            boxes.centerX[i] - boxes.extentX[i], boxes.centerX[i] + boxes.extentX[i],
+            boxes.centerY[i] - boxes.extentY[i], boxes.centerY[i] + boxes.extentY[i],
+            boxes.centerZ[i] - boxes.extentZ[i], boxes.centerZ[i] + boxes.extentZ[i]);
+
+        if (frustum.TestRect(rect))
+            refIdxs[numRef++] = i;
+    }
+
+    // run culling by the input path and check the result
+    auto runPath = [&](const char* name, const bool useSIMD, const bool parallel) -> bool
+    {
+        FrustumPlanesSoA planes;
+        GetPlanesSoA(frustum, planes);
+
+        int numVisible = 0;
+        const auto t0  = Clock::now();
+
+        for (int run = 0; run < numRuns; ++run)
+        {
+            if (parallel)
+                numVisible = CullAABBs(frustum, boxes, numBoxes, idxs.data(), useSIMD);
+            else if (useSIMD)
+                numVisible = CullAABBsSIMD(planes, boxes, 0, numBoxes, idxs.data());
+            else
+                numVisible = CullAABBsScalar(planes, boxes, 0, numBoxes, idxs.data());
+        }
+
+        const auto  t1 = Clock::now();
+        const float ms = std::chrono::duration<float, std::milli>(t1 - t0).count() / numRuns;
+
+        const bool isValid =
+            (numVisible == numRef) &&
+            std::equal(idxs.begin(), idxs.begin() + numRef, refIdxs.begin());
+
+        LogMsg(LOG, "%-16s: %8.3f ms (visible: %d / %d) %s", name, ms, numVisible, numBoxes, (isValid) ? "OK" : "MISMATCH");
+        return isValid;
+    };
+
+    bool result = true;
+    result &= runPath("scalar",          false, false);
+    result &= runPath("SIMD",            true,  false);
+    result &= runPath("scalar parallel", false, true);
+    result &= runPath("SIMD parallel",   true,  true);
+
+    return result;
+}
@@ -0,0 +1,127 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: frustum_culling.h
+    Desc:     batch frustum culling of bounding volumes which are stored
+              as structure-of-arrays (SoA):
+
+              - SIMD path tests 4 (SSE) or 8 (AVX) volumes per iteration
+                against all the 6 planes at once;
+              - scalar path does the same math one volume at a time
+                (is used for the tail of arrays and for validation);
+              - big arrays are split into slices which are culled
+                in parallel by the job system
+
+              output is a compact array of indices of visible volumes
+              (in ascending order, so it can be directly mapped to IDs)
+
+              a volume is visible if for each plane: dist(center) + r > 0
+              where r is a radius of sphere or a projection of box extents
+              onto the plane normal (the same result as Frustum::TestRect/TestSphere)
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <geometry/frustum.h>
+#include <cvector.h>
+
+
+//---------------------------------------------------------
+// axis-aligned bounding boxes: center + extents (half sizes)
+//---------------------------------------------------------
+struct AABBsSoA
+{
+    cvector<float> centerX;
+    cvector<float> centerY;
+    cvector<float> centerZ;
+    cvector<float> extentX;
+    cvector<float> extentY;
+    cvector<float> extentZ;
+
+    void Resize(const vsize num)
+    {
+        centerX.resize(num);
+        centerY.resize(num);
+        centerZ.resize(num);
+        extentX.resize(num);
+        extentY.resize(num);
+        extentZ.resize(num);
+    }
+
+    inline void Set(const index i, const Rect3d& rect)
+    {
+        centerX[i] = (rect.x0 + rect.x1) * 0.5f;
+        centerY[i] = (rect.y0 + rect.y1) * 0.5f;
+        centerZ[i] = (rect.z0 + rect.z1) * 0.5f;
+        extentX[i] = (rect.x1 - rect.x0) * 0.5f;
+        extentY[i] = (rect.y1 - rect.y0) * 0.5f;
+        extentZ[i] = (rect.z1 - rect.z0) * 0.5f;
+    }
+
+    inline vsize size() const { return centerX.size(); }
+};
+
+//---------------------------------------------------------
+// bounding spheres: center + radius
+//---------------------------------------------------------
+struct SpheresSoA
+{
+    cvector<float> centerX;
+    cvector<float> centerY;
+    cvector<float> centerZ;
+    cvector<float> radius;
+
+    void Resize(const vsize num)
+    {
+        centerX.resize(num);
+        centerY.resize(num);
+        centerZ.resize(num);
+        radius.resize(num);
+    }
+
+    inline void Set(const index i, const float x, const float y, const float z, const float r)
+    {
+        centerX[i] = x;
+        centerY[i] = y;
+        centerZ[i] = z;
+        radius[i]  = r;
+    }
+
+    inline vsize size() const { return centerX.size(); }
+};
+
+
+//---------------------------------------------------------
+// Desc:   test input volumes against the frustum
+// Args:   - frustum:   frustum (in the same space as volumes)
+//         - volumes:   SoA arrays of bounding volumes
+//         - count:     number of volumes to test
+//         - outIdxs:   output arr of visible volumes indices (must have size >= count)
+//         - useSIMD:   false to use the scalar path (for validation)
+// Ret:    number of visible volumes
+//---------------------------------------------------------
+int CullAABBs(
+    const Frustum& frustum,
+    const AABBsSoA& boxes,
+    const int count,
+    int* outIdxs,
+    const bool useSIMD = true);
+
+int CullSpheres(
+    const Frustum& frustum,
+    const SpheresSoA& spheres,
+    const int count,
+    int* outIdxs,
+    const bool useSIMD = true);
+
+// headless benchmark: cull synthetic boxes with scalar/SIMD/parallel paths,
+// validate results against each other and print timings
+bool BenchmarkFrustumCulling(const int numBoxes = 100000);
@@ -241,3 +241,33 @@ inline bool IntersectRaySphere(
     return (t >= 0.0f);
 #endif
 }
+
+//---------------------------------------------------------
+// Desc:  ray/AABB test (slab method)
+// Args:  - invDir:  1.0 / ray direction (there must be no zero components
+//                   in the direction, replace them with tiny values)
+//        - tmax:    we aren't interested in intersections which are farther
+// Out:   - tEnter:  the distance along the ray where it enters the rect
+//                   (0 if the ray origin is inside)
+// Ret:   true if have an intersection
+//---------------------------------------------------------
+inline bool IntersectRayRect3d(
+    const Rect3d& rect,
+    const Vec3& rayOrig,
+    const Vec3& invDir,
+    const float tmax,
+    float& tEnter)
+{
+    const float tx0 = (rect.x0 - rayOrig.x) * invDir.x;
+    const float tx1 = (rect.x1 - rayOrig.x) * invDir.x;
+    const float ty0 = (rect.y0 - rayOrig.y) * invDir.y;
+    const float ty1 = (rect.y1 - rayOrig.y) * invDir.y;
+    const float tz0 = (rect.z0 - rayOrig.z) * invDir.z;
+    const float tz1 = (rect.z1 - rayOrig.z) * invDir.z;
+
+    const float enter = Max(Max(Min(tx0, tx1), Min(ty0, ty1)), Max(Min(tz0, tz1), 0.0f));
+    const float exit  = Min(Min(Max(tx0, tx1), Max(ty0, ty1)), Min(Max(tz0, tz1), tmax));
+
+    tEnter = enter;
+    return enter <= exit;
+}
@@ -0,0 +1,451 @@
+// =================================================================================
+// Filename:   job_system.cpp
+// Desc:       implementation of the work-stealing job system
+//
+// Created:    17.10.2026  by DimaSkup
+// =================================================================================
+#include "job_system.h"
+#include "log.h"
+#include "engine_exception.h"
+#include <assert.h>
+#include <exception>
+
+
+// init a global instance of the job system
+JobSystem g_JobSystem;
+
+// index of the current thread in the job system
+static thread_local int s_ThreadIdx = 0;
+
+
+//---------------------------------------------------------
+// Class name:  JobQueue
+// Desc:        a deque of jobs which belongs to a single thread:
+//              the owner pushes/pops at the bottom, others steal from the top;
+//              critical sections are tiny so we use a spinlock
+//---------------------------------------------------------
+class JobQueue
+{
+public:
+    bool Push(const Job& job)
+    {
+        Lock();
+
+        if (bottom_ - top_ >= MAX_NUM_JOBS_PER_QUEUE)
+        {
+            Unlock();
+            return false;
+        }
+
+        jobs_[bottom_ & (MAX_NUM_JOBS_PER_QUEUE - 1)] = job;
+        ++bottom_;
+
+        Unlock();
+        return true;
+    }
+
+    bool Pop(Job& outJob)
+    {
+        Lock();
+
+        if (bottom_ == top_)
+        {
+            Unlock();
+            return false;
+        }
+
+        --bottom_;
+        outJob = jobs_[bottom_ & (MAX_NUM_JOBS_PER_QUEUE - 1)];
+
+        Unlock();
+        return true;
+    }
+
+    bool Steal(Job& outJob)
+    {
+        // fast check without locking
+        if (IsEmpty())
+            return false;
+
+        Lock();
+
+        if (bottom_ == top_)
+        {
+            Unlock();
+            return false;
+        }
+
+        outJob = jobs_[top_ & (MAX_NUM_JOBS_PER_QUEUE - 1)];
+        ++top_;
+
+        Unlock();
+        return true;
+    }
+
+    inline bool IsEmpty() const
+    {
+        return bottom_.load(std::memory_order_relaxed) == top_.load(std::memory_order_relaxed);
+    }
+
+private:
+    inline void Lock()
+    {
+        while (lock_.exchange(true, std::memory_order_acquire))
+        {
+            while (lock_.load(std::memory_order_relaxed))
+                std::this_thread::yield();
+        }
+    }
+
+    inline void Unlock()
+    {
+        lock_.store(false, std::memory_order_release);
+    }
+
+private:
+    std::atomic<bool>    lock_   = false;
+    std::atomic<int64_t> top_    = 0;
+    std::atomic<int64_t> bottom_ = 0;
+    Job                  jobs_[MAX_NUM_JOBS_PER_QUEUE];
+};
+
+
+//---------------------------------------------------------
+// Desc:  arguments of a single batch of ParallelFor()
+//---------------------------------------------------------
+struct ParallelForBatch
+{
+    ParallelForFunc func  = nullptr;
+    void*           pArgs = nullptr;
+    int             start = 0;
+    int             end   = 0;
+};
+
+void ExecuteParallelForBatch(void* pArgs)
+{
+    const ParallelForBatch* pBatch = (const ParallelForBatch*)pArgs;
+    pBatch->func(pBatch->pArgs, pBatch->start, pBatch->end);
+}
+
+
+//==================================================================================
+// public methods
+//==================================================================================
+
+JobSystem::~JobSystem()
+{
+    Shutdown();
+}
+
+//---------------------------------------------------------
+// Desc:  create a deque per thread and start worker threads
+// Args:  - numWorkers:  number of worker threads
+//                       (-1 means "number of hardware threads - 1")
+//---------------------------------------------------------
+bool JobSystem::Init(const int numWorkers)
+{
+    if (IsInit())
+    {
+        LogErr(LOG, "the job system is already initialized");
+        return false;
+    }
+
+    int numThreads = numWorkers;
+
+    // the main thread also executes jobs so keep one hardware thread for it
+    if (numThreads < 0)
+        numThreads = (int)std::thread::hardware_concurrency() - 1;
+
+    if (numThreads < 0)
+        numThreads = 0;
+
+    if (numThreads > MAX_NUM_WORKER_THREADS)
+        numThreads = MAX_NUM_WORKER_THREADS;
+
+    numWorkers_ = numThreads;
+    pQueues_    = new JobQueue[numWorkers_ + 1];
+
+    isRunning_ = true;
+    s_ThreadIdx = 0;
+
+    for (int i = 0; i < numWorkers_; ++i)
+        workers_[i] = std::thread(&JobSystem::WorkerLoop, this, i + 1);
+
+    LogMsg(LOG, "job system is initialized (num worker threads: %d)", numWorkers_);
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:  stop and join all the worker threads, release memory
+//---------------------------------------------------------
+void JobSystem::Shutdown()
+{
+    if (!IsInit())
+        return;
+
+    isRunning_ = false;
+    WakeUpWorkers();
+
+    for (int i = 0; i < numWorkers_; ++i)
+    {
+        if (workers_[i].joinable())
+            workers_[i].join();
+    }
+
+    delete[] pQueues_;
+    pQueues_    = nullptr;
+    numWorkers_ = 0;
+    numPendingJobs_ = 0;
+}
+
+//---------------------------------------------------------
+// Desc:  push input jobs into the queue of the calling thread
+// Args:  - jobs:      arr of jobs
+//        - numJobs:   how many jobs we have
+//        - pCounter:  (optional) a counter which is used to wait for these jobs
+//---------------------------------------------------------
+void JobSystem::Run(const Job* jobs, const int numJobs, JobCounter* pCounter)
+{
+    if (!jobs || numJobs <= 0)
+    {
+        LogErr(LOG, "invalid input args (jobs arr: %p, num jobs: %d)", jobs, numJobs);
+        return;
+    }
+
+    if (pCounter)
+        pCounter->numJobs.fetch_add(numJobs, std::memory_order_relaxed);
+
+    // if there is no pool we just execute jobs immediately
+    if (!IsInit())
+    {
+        for (int i = 0; i < numJobs; ++i)
+        {
+            Job job = jobs[i];
+            job.pCounter = pCounter;
+            Execute(job);
+        }
+        return;
+    }
+
+    int threadIdx = GetThreadIdx();
+    if (threadIdx > numWorkers_)
+        threadIdx = 0;
+
+    JobQueue& queue = pQueues_[threadIdx];
+
+    for (int i = 0; i < numJobs; ++i)
+    {
+        Job job = jobs[i];
+        job.pCounter = pCounter;
+
+        // if the queue is full we execute the job right here
+        if (!queue.Push(job))
+        {
+            Execute(job);
+            continue;
+        }
+
+        numPendingJobs_.fetch_add(1, std::memory_order_release);
+    }
+
+    WakeUpWorkers();
+}
+
+//---------------------------------------------------------
+// Desc:  push a single job into the queue of the calling thread
+//---------------------------------------------------------
+void JobSystem::Run(JobFunc func, void* pArgs, JobCounter* pCounter)
+{
+    const Job job = { func, pArgs, pCounter };
+    Run(&job, 1, pCounter);
+}
+
+//---------------------------------------------------------
+// Desc:  wait until all the jobs related to the counter are done;
+//        meanwhile the calling thread executes jobs from queues
+//        (so waiting inside a job doesn't cause a deadlock)
+//---------------------------------------------------------
+void JobSystem::Wait(JobCounter* pCounter)
+{
+    if (!pCounter)
+        return;
+
+    const int threadIdx = (GetThreadIdx() > numWorkers_) ? 0 : GetThreadIdx();
+
+    while (!pCounter->IsDone())
+    {
+        Job job;
+
+        if (IsInit() && GetJob(threadIdx, job))
+            Execute(job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+//---------------------------------------------------------
+// Desc:  split range [0, count) into batches, execute them
+//        in parallel and wait for completion
+// Args:  - count:         number of elements to process
+//        - minBatchSize:  min number of elements per job
+//        - func:          a function to process elements in range [start, end)
+//        - pArgs:         arguments for the function
+//---------------------------------------------------------
+void JobSystem::ParallelFor(
+    const int count,
+    const int minBatchSize,
+    ParallelForFunc func,
+    void* pArgs)
+{
+    if (count <= 0)
+        return;
+
+    if (!func)
+    {
+        LogErr(LOG, "input func ptr == NULL");
+        return;
+    }
+
+    // define how many batches we need (a few per thread for balancing)
+    const int batchSize   = (minBatchSize > 0) ? minBatchSize : 1;
+    int       numBatches  = (count + batchSize - 1) / batchSize;
+    const int maxBatches  = GetNumThreads() * 4;
+
+    if (numBatches > maxBatches)
+        numBatches = maxBatches;
+
+    if (numBatches > MAX_NUM_PARALLEL_FOR_JOBS)
+        numBatches = MAX_NUM_PARALLEL_FOR_JOBS;
+
+    // nothing to parallelize
+    if (numBatches <= 1 || !IsInit())
+    {
+        func(pArgs, 0, count);
+        return;
+    }
+
+    ParallelForBatch batches[MAX_NUM_PARALLEL_FOR_JOBS];
+    Job              jobs[MAX_NUM_PARALLEL_FOR_JOBS];
+
+    const int numPerBatch = count / numBatches;
+    const int remainder   = count % numBatches;
+    int       start       = 0;
+
+    for (int i = 0; i < numBatches; ++i)
+    {
+        const int end = start + numPerBatch + (i < remainder);
+
+        batches[i] = { func, pArgs, start, end };
+        jobs[i]    = { ExecuteParallelForBatch, &batches[i], nullptr };
+
+        start = end;
+    }
+
+    // all the batches are executed before returning, so we can keep args on the stack
+    JobCounter counter;
+    Run(jobs, numBatches, &counter);
+    Wait(&counter);
+}
+
+//---------------------------------------------------------
+// Desc:  return an index of the calling thread
+//---------------------------------------------------------
+int JobSystem::GetThreadIdx()
+{
+    return s_ThreadIdx;
+}
+
+
+//==================================================================================
+// private methods
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:  main loop of a worker thread: execute own jobs, then try to steal
+//        jobs from others, and sleep if there is nothing to do
+//---------------------------------------------------------
+void JobSystem::WorkerLoop(const int threadIdx)
+{
+    s_ThreadIdx = threadIdx;
+
+    while (isRunning_.load(std::memory_order_acquire))
+    {
+        Job job;
+
+        if (GetJob(threadIdx, job))
+        {
+            Execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+
+        wakeCond_.wait(lock, [this]()
+        {
+            return (numPendingJobs_.load(std::memory_order_acquire) > 0) ||
+                   !isRunning_.load(std::memory_order_acquire);
+        });
+    }
+}
+
+//---------------------------------------------------------
+// Desc:  take a job from the own queue or steal it from another thread
+// Ret:   true if we got any job
+//---------------------------------------------------------
+bool JobSystem::GetJob(const int threadIdx, Job& outJob)
+{
+    const int numQueues = numWorkers_ + 1;
+
+    bool found = pQueues_[threadIdx].Pop(outJob);
+
+    // go around other queues starting from the next one
+    for (int i = 1; !found && (i < numQueues); ++i)
+        found = pQueues_[(threadIdx + i) % numQueues].Steal(outJob);
+
+    if (found)
+        numPendingJobs_.fetch_sub(1, std::memory_order_relaxed);
+
+    return found;
+}
+
+//---------------------------------------------------------
+// Desc:  execute the job and signal its counter
+//---------------------------------------------------------
+void JobSystem::Execute(const Job& job)
+{
+    assert(job.func);
+
+    // exceptions must not leave a worker thread (or the counter will never reach 0)
+    try
+    {
+        job.func(job.pArgs);
+    }
+    catch (EngineException& e)
+    {
+        LogErr(LOG, "job is failed: %s", e.what());
+    }
+    catch (std::exception& e)
+    {
+        LogErr(LOG, "job is failed (std::exception): %s", e.what());
+    }
+    catch (...)
+    {
+        LogErr(LOG, "job is failed: unknown exception");
+    }
+
+    if (job.pCounter)
+        job.pCounter->numJobs.fetch_sub(1, std::memory_order_release);
+}
+
+//---------------------------------------------------------
+// Desc:  wake up sleeping workers (there are new jobs or we're shutting down)
+//---------------------------------------------------------
+void JobSystem::WakeUpWorkers()
+{
+    // lock/unlock so a worker can't miss the notification
+    // between its check of the predicate and going to sleep
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    wakeCond_.notify_all();
+}
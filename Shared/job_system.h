@@ -0,0 +1,134 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: job_system.h
+
+    Desc:     a job system: fixed pool of worker threads where each thread
+              (including the main one) has its own deque of jobs;
+
+              - a thread pushes/pops jobs at the bottom of its own deque (LIFO);
+              - an idle thread steals jobs from the top of deques of others (FIFO);
+              - dependencies are expressed by counters (fences): Run() increments
+                a counter by the number of jobs, each finished job decrements it,
+                Wait() doesn't block but executes other jobs until counter == 0
+
+              usage:
+                  JobCounter counter;
+                  g_JobSystem.Run(UpdateTerrainJob, &args, &counter);
+                  ...                                // do some work meanwhile
+                  g_JobSystem.Wait(&counter);        // fence
+
+                  g_JobSystem.ParallelFor(numItems, 64, UpdateItems, &args);
+
+              if the job system isn't initialized all the jobs are executed
+              immediately on the calling thread
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+//---------------------------------------------------------
+// limits of the job system
+//---------------------------------------------------------
+constexpr int MAX_NUM_WORKER_THREADS    = 31;
+constexpr int MAX_NUM_JOBS_PER_QUEUE    = 4096;     // must be a power of 2
+constexpr int MAX_NUM_PARALLEL_FOR_JOBS = 256;
+
+
+typedef void (*JobFunc)        (void* pArgs);
+typedef void (*ParallelForFunc)(void* pArgs, const int start, const int end);
+
+//---------------------------------------------------------
+// a counter of unfinished jobs (is used as a fence)
+//---------------------------------------------------------
+struct JobCounter
+{
+    std::atomic<int> numJobs = 0;
+
+    inline bool IsDone() const { return numJobs.load(std::memory_order_acquire) == 0; }
+};
+
+//---------------------------------------------------------
+// a single unit of work
+//---------------------------------------------------------
+struct Job
+{
+    JobFunc     func     = nullptr;
+    void*       pArgs    = nullptr;
+    JobCounter* pCounter = nullptr;     // is decremented when the job is done
+};
+
+class JobQueue;
+
+//---------------------------------------------------------
+// Class name:  JobSystem
+//---------------------------------------------------------
+class JobSystem
+{
+public:
+    JobSystem() {}
+    ~JobSystem();
+
+    // restrict any copying
+    JobSystem(const JobSystem&)            = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // numWorkers == -1 means "number of hardware threads - 1"
+    bool Init(const int numWorkers = -1);
+    void Shutdown();
+
+    void Run(const Job* jobs, const int numJobs, JobCounter* pCounter);
+    void Run(JobFunc func, void* pArgs, JobCounter* pCounter);
+    void Wait(JobCounter* pCounter);
+
+    // split range [0, count) into batches (not smaller than minBatchSize),
+    // execute them in parallel and wait for completion
+    void ParallelFor(
+        const int count,
+        const int minBatchSize,
+        ParallelForFunc func,
+        void* pArgs);
+
+    // number of threads which execute jobs (workers + the main thread)
+    inline int  GetNumThreads() const { return numWorkers_ + 1; }
+    inline bool IsInit()        const { return pQueues_ != nullptr; }
+
+    // 0 for the main thread (or any thread out of the pool), [1, N] for workers
+    static int  GetThreadIdx();
+
+private:
+    void WorkerLoop(const int threadIdx);
+    bool GetJob    (const int threadIdx, Job& outJob);
+    void Execute   (const Job& job);
+    void WakeUpWorkers();
+
+private:
+    JobQueue*               pQueues_    = nullptr;      // [0] belongs to the main thread
+    int                     numWorkers_ = 0;
+
+    std::atomic<int>        numPendingJobs_ = 0;        // jobs which are in queues but not taken yet
+    std::atomic<bool>       isRunning_      = false;
+
+    std::mutex              sleepMutex_;
+    std::condition_variable wakeCond_;
+    std::thread             workers_[MAX_NUM_WORKER_THREADS];
+};
+
+
+//---------------------------------------------------------
+// a global instance of the job system
+//---------------------------------------------------------
+extern JobSystem g_JobSystem;
@@ -7,6 +7,7 @@
 #include <stdarg.h>
 #include <string.h>
 #include <time.h>
+#include <mutex>
 
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
@@ -23,6 +24,7 @@ static bool               s_IsInit = false;      // a flag to define if the logg
 static FILE*              s_pLogFile = nullptr;  // a static descriptor of the log file
 static LogMsgsCharsBuffer s_LogMsgsCharsBuf;     // a static buffer for log messages chars (is used to prevent dynamic allocations)
 static LogStorage         s_LogStorage;
+static std::mutex         s_LogMutex;            // log functions can be called from worker threads
 
 
 //---------------------------------------------------------
@@ -144,6 +146,8 @@ void PrintHelper(
     snprintf(buf, sizeof(buf), fmt, t, levels[type], fileName, funcName, codeLine, text);
 
     // print a message into the console and log-file
+    std::lock_guard<std::mutex> lock(s_LogMutex);
+
     printf(buf);
     AddMsgIntoLogStorage(buf, type);
 
@@ -158,6 +162,8 @@ void PrintHelper(
 //---------------------------------------------------------
 void PrintHelper(const char* msg, const eLogType type)
 {
+    std::lock_guard<std::mutex> lock(s_LogMutex);
+
     printf("%s\n", msg);
     AddMsgIntoLogStorage(msg, type);
 
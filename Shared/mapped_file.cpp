@@ -0,0 +1,128 @@
+// =================================================================================
+// Filename:   mapped_file.cpp
+// Desc:       implementation of the read-only memory mapped file
+//
+// Created:    17.10.2026  by DimaSkup
+// =================================================================================
+#include "mapped_file.h"
+#include "log.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+//---------------------------------------------------------
+// Desc:   map the whole file into memory for reading
+// Args:   - filePath:  a path to the file
+// Ret:    true if the file is mapped
+//---------------------------------------------------------
+bool MappedFile::Open(const char* filePath)
+{
+    if (!filePath || filePath[0] == '\0')
+    {
+        LogErr(LOG, "empty file path");
+        return false;
+    }
+
+    Close();
+
+#ifdef _WIN32
+    HANDLE hFile = CreateFileA(
+        filePath,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        NULL);
+
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+
+    if (!GetFileSizeEx(hFile, &fileSize) || (fileSize.QuadPart == 0))
+    {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!hMapping)
+    {
+        LogErr(LOG, "can't create a file mapping: %s", filePath);
+        CloseHandle(hFile);
+        return false;
+    }
+
+    void* pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    if (!pData)
+    {
+        LogErr(LOG, "can't map a view of file: %s", filePath);
+        CloseHandle(hMapping);
+        CloseHandle(hFile);
+        return false;
+    }
+
+    hFile_    = hFile;
+    hMapping_ = hMapping;
+    pData_    = (const uint8_t*)pData;
+    size_     = (size_t)fileSize.QuadPart;
+
+#else
+    const int fd = open(filePath, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+
+    if ((fstat(fd, &st) != 0) || (st.st_size == 0))
+    {
+        close(fd);
+        return false;
+    }
+
+    void* pData = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (pData == MAP_FAILED)
+    {
+        LogErr(LOG, "can't map a file: %s", filePath);
+        return false;
+    }
+
+    pData_ = (const uint8_t*)pData;
+    size_  = (size_t)st.st_size;
+#endif
+
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:   unmap the file (pointers into its data become invalid)
+//---------------------------------------------------------
+void MappedFile::Close()
+{
+    if (!pData_)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(pData_);
+    CloseHandle((HANDLE)hMapping_);
+    CloseHandle((HANDLE)hFile_);
+
+    hMapping_ = nullptr;
+    hFile_    = nullptr;
+#else
+    munmap((void*)pData_, size_);
+#endif
+
+    pData_ = nullptr;
+    size_  = 0;
+}
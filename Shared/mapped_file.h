@@ -0,0 +1,40 @@
+// =================================================================================
+// Filename:   mapped_file.h
+// Desc:       read-only memory mapped file: the whole file is mapped into
+//             the address space so binary assets can be read in place
+//             (without fread/parsing into temp buffers)
+//
+// Created:    17.10.2026  by DimaSkup
+// =================================================================================
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+class MappedFile
+{
+public:
+    MappedFile() {}
+    ~MappedFile() { Close(); }
+
+    // restrict copying (the mapping is owned by a single instance)
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const char* filePath);
+    void Close();
+
+    inline const uint8_t* GetData() const { return pData_; }
+    inline size_t         GetSize() const { return size_; }
+    inline bool           IsOpen()  const { return pData_ != nullptr; }
+
+private:
+    const uint8_t* pData_ = nullptr;
+    size_t         size_  = 0;
+
+#ifdef _WIN32
+    void*          hFile_    = nullptr;
+    void*          hMapping_ = nullptr;
+#endif
+};
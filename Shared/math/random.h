@@ -16,6 +16,7 @@
 #pragma once
 
 #include <stdlib.h>
+#include <stdint.h>
 
 
 // return random unsigned int in range [min, max)
@@ -35,3 +36,53 @@ inline static float RandF(const float a, const float b)
 {
     return a + RandF() * (b - a);
 }
+
+//---------------------------------------------------------
+// Desc:   small seeded generator (PCG32) for cases when we need the same
+//         sequence of values for the same seed (unlike rand() it has no
+//         global state so each thread/stream can have its own generator)
+//---------------------------------------------------------
+struct RandGen
+{
+    RandGen(const uint64_t seed, const uint64_t stream = 0)
+    {
+        state_ = 0;
+        inc_   = (stream << 1) | 1;
+        NextUint();
+        state_ += seed;
+        NextUint();
+    }
+
+    // returns random uint in range [0, 2^32)
+    inline uint32_t NextUint()
+    {
+        const uint64_t old = state_;
+        state_ = old * 6364136223846793005ULL + inc_;
+
+        const uint32_t xorShifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+        const uint32_t rot        = (uint32_t)(old >> 59);
+
+        return (xorShifted >> rot) | (xorShifted << ((0 - rot) & 31));
+    }
+
+    // returns random uint in range [min, max)
+    inline uint32_t NextUint(const uint32_t min, const uint32_t max)
+    {
+        return min + (uint32_t)(((uint64_t)NextUint() * (max - min)) >> 32);
+    }
+
+    // returns random float in [0, 1)
+    inline float NextF()
+    {
+        return (float)(NextUint() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // returns random float in [a, b)
+    inline float NextF(const float a, const float b)
+    {
+        return a + NextF() * (b - a);
+    }
+
+    uint64_t state_;
+    uint64_t inc_;
+};
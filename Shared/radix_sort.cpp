@@ -0,0 +1,90 @@
+// =================================================================================
+// Filename:   radix_sort.cpp
+// Desc:       implementation of LSD radix sort for 64-bit keys
+//
+// Created:    17.10.2026  by DimaSkup
+// =================================================================================
+#include "radix_sort.h"
+#include "log.h"
+#include <utility>
+
+
+//---------------------------------------------------------
+// Desc:   sort keys in ascending order and rearrange values with them
+//---------------------------------------------------------
+void RadixSort64(
+    uint64* keys,
+    uint32* values,
+    uint64* tmpKeys,
+    uint32* tmpValues,
+    const int num)
+{
+    if (num <= 1)
+        return;
+
+    if (!keys || !values || !tmpKeys || !tmpValues)
+    {
+        LogErr(LOG, "invalid input args (some of arrays == nullptr)");
+        return;
+    }
+
+    constexpr int NUM_PASSES = 8;
+    constexpr int NUM_BUCKETS = 256;
+
+    // histograms for each byte of keys
+    int counts[NUM_PASSES][NUM_BUCKETS] = { 0 };
+
+    for (int i = 0; i < num; ++i)
+    {
+        const uint64 key = keys[i];
+
+        for (int pass = 0; pass < NUM_PASSES; ++pass)
+            counts[pass][(key >> (pass * 8)) & 0xFF]++;
+    }
+
+    uint64* srcKeys   = keys;
+    uint32* srcValues = values;
+    uint64* dstKeys   = tmpKeys;
+    uint32* dstValues = tmpValues;
+
+    for (int pass = 0; pass < NUM_PASSES; ++pass)
+    {
+        int* count = counts[pass];
+        const int shift = pass * 8;
+
+        // all the keys have the same byte so this pass changes nothing
+        if (count[(srcKeys[0] >> shift) & 0xFF] == num)
+            continue;
+
+        // convert counts into offsets
+        int offset = 0;
+
+        for (int b = 0; b < NUM_BUCKETS; ++b)
+        {
+            const int c = count[b];
+            count[b] = offset;
+            offset += c;
+        }
+
+        // scatter elements by the current byte
+        for (int i = 0; i < num; ++i)
+        {
+            const int dst  = count[(srcKeys[i] >> shift) & 0xFF]++;
+            dstKeys[dst]   = srcKeys[i];
+            dstValues[dst] = srcValues[i];
+        }
+
+        std::swap(srcKeys, dstKeys);
+        std::swap(srcValues, dstValues);
+    }
+
+    // if the sorted data is in temp buffers we copy it back
+    if (srcKeys != keys)
+    {
+        for (int i = 0; i < num; ++i)
+        {
+            keys[i]   = srcKeys[i];
+            values[i] = srcValues[i];
+        }
+    }
+}
@@ -0,0 +1,52 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: radix_sort.h
+    Desc:     LSD radix sort of 64-bit keys together with 32-bit values
+              (usually indices of elements which are described by the keys)
+
+              - 8 bits per pass, up to 8 passes;
+              - histograms of all the passes are computed in a single read;
+              - a pass is skipped if all the keys have the same byte in it
+                (so keys with unused high bits are sorted in less passes);
+              - the sort is stable
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include "Types.h"
+
+
+//---------------------------------------------------------
+// Desc:   sort keys in ascending order and rearrange values with them
+// Args:   - keys, values:        in/out arrays of num elements
+//         - tmpKeys, tmpValues:  temp buffers of num elements
+//         - num:                 the number of elements
+//---------------------------------------------------------
+void RadixSort64(
+    uint64* keys,
+    uint32* values,
+    uint64* tmpKeys,
+    uint32* tmpValues,
+    const int num);
+
+//---------------------------------------------------------
+// Desc:   convert a float into a uint which has the same sorting order
+//         (so floats can be put into radix sort keys)
+//---------------------------------------------------------
+inline uint32 FloatToSortableUint(const float f)
+{
+    union { float f; uint32 u; } bits = { f };
+
+    // negative: flip all the bits; positive: flip only the sign bit
+    const uint32 mask = (bits.u & 0x80000000) ? 0xFFFFFFFF : 0x80000000;
+    return bits.u ^ mask;
+}
@@ -0,0 +1,127 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: scratch_arena.h
+
+    Desc:     per-thread arena of scratch arrays for temporary data of batch
+              queries (indices, IDs, matrices, etc.)
+
+              each thread has its own stack of cvectors per element type;
+              ScratchVec takes the next free array from the stack of the
+              calling thread and returns it back when goes out of scope;
+              arrays are never released, so after a few frames their
+              capacity is enough and there are no allocations at all
+
+              so getters which use ScratchVec are reentrant (nested calls get
+              different arrays) and can be called from several threads at once
+
+              usage:
+                  ScratchVec<index> idxs;
+                  comp.ids.get_idxs(ids, numEntts, idxs);
+
+                  for (const index idx : idxs)
+                      ...
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include "cvector.h"
+#include <assert.h>
+
+
+//---------------------------------------------------------
+// max number of scratch arrays of the same type which
+// can be used at the same time by a single thread
+//---------------------------------------------------------
+constexpr int MAX_SCRATCH_DEPTH = 16;
+
+
+//---------------------------------------------------------
+// Class name:  ScratchArena
+// Desc:        a stack of scratch arrays of type T (one per thread)
+//---------------------------------------------------------
+template <typename T>
+class ScratchArena
+{
+public:
+    static ScratchArena& Get()
+    {
+        thread_local ScratchArena arena;
+        return arena;
+    }
+
+    cvector<T>* Push()
+    {
+        assert(top_ < MAX_SCRATCH_DEPTH && "too deep nesting of scratch arrays");
+
+        cvector<T>* pArr = &arrs_[top_++];
+        pArr->clear();
+        return pArr;
+    }
+
+    void Pop(const cvector<T>* pArr)
+    {
+        // arrays must be returned in reverse order (it is guaranteed by scopes)
+        assert(top_ > 0 && pArr == &arrs_[top_ - 1]);
+        (void)pArr;
+        --top_;
+    }
+
+private:
+    ScratchArena() {}
+
+    cvector<T> arrs_[MAX_SCRATCH_DEPTH];
+    int        top_ = 0;
+};
+
+
+//---------------------------------------------------------
+// Class name:  ScratchVec
+// Desc:        a scoped handle to scratch array of the calling thread;
+//              can be passed anywhere where cvector<T>& is expected
+//---------------------------------------------------------
+template <typename T>
+class ScratchVec
+{
+public:
+    ScratchVec()  : pArr_(ScratchArena<T>::Get().Push()) {}
+    ~ScratchVec() { ScratchArena<T>::Get().Pop(pArr_); }
+
+    // restrict any copying/moving since the array belongs to the scope
+    ScratchVec(const ScratchVec&)            = delete;
+    ScratchVec(ScratchVec&&)                 = delete;
+    ScratchVec& operator=(const ScratchVec&) = delete;
+    ScratchVec& operator=(ScratchVec&&)      = delete;
+
+    inline operator cvector<T>&()                        { return *pArr_; }
+    inline operator const cvector<T>&()            const { return *pArr_; }
+    inline cvector<T>& get()                             { return *pArr_; }
+
+    inline T&       operator[](const index i)            { return (*pArr_)[i]; }
+    inline const T& operator[](const index i)      const { return (*pArr_)[i]; }
+
+    inline T*       begin()                        const { return pArr_->begin(); }
+    inline T*       end()                          const { return pArr_->end(); }
+    inline T*       data()                         const { return pArr_->data(); }
+    inline T&       back()                         const { return pArr_->back(); }
+    inline vsize    size()                         const { return pArr_->size(); }
+    inline bool     empty()                        const { return pArr_->empty(); }
+
+    inline void     clear()                              { pArr_->clear(); }
+    inline void     pop_back()                           { pArr_->pop_back(); }
+    inline void     push_back(const T& val)              { pArr_->push_back(val); }
+    inline void     reserve(const vsize n)               { pArr_->reserve(n); }
+    inline void     resize(const vsize n)                { pArr_->resize(n); }
+    inline void     resize(const vsize n, const T& val)  { pArr_->resize(n, val); }
+
+private:
+    cvector<T>* pArr_ = nullptr;
+};
@@ -0,0 +1,132 @@
+// =================================================================================
+// Filename:   str_hash_index.cpp
+// Desc:       implementation of the open-addressing hash index of names
+//
+// Created:    17.10.2026  by DimaSkup
+// =================================================================================
+#include "str_hash_index.h"
+
+
+constexpr int MIN_HASH_INDEX_CAPACITY = 16;
+
+//---------------------------------------------------------
+// Desc:   alloc memory so numElems can be inserted without rehashing
+//---------------------------------------------------------
+void StrHashIndex::Reserve(const int numElems)
+{
+    int capacity = MIN_HASH_INDEX_CAPACITY;
+
+    // keep load factor <= 0.5
+    while (capacity < numElems * 2)
+        capacity *= 2;
+
+    if (capacity > slots_.size())
+        Rehash(capacity);
+}
+
+//---------------------------------------------------------
+// Desc:   remove all the elements (memory is kept)
+//---------------------------------------------------------
+void StrHashIndex::Clear()
+{
+    for (Slot& slot : slots_)
+        slot = Slot();
+
+    numUsed_    = 0;
+    numDeleted_ = 0;
+}
+
+//---------------------------------------------------------
+// Desc:   add a new pair [hash => value] into the index
+//         (duplicates aren't checked: it is up to the caller)
+//---------------------------------------------------------
+void StrHashIndex::Insert(const uint64 hash, const uint32 value)
+{
+    // grow if load factor (including tombstones) becomes > 0.5
+    if ((numUsed_ + numDeleted_ + 1) * 2 > slots_.size())
+    {
+        // if there are many tombstones we just clean them up
+        const int capacity = (int)slots_.size();
+        const bool isGrow  = (numUsed_ + 1) * 4 > capacity;
+
+        if (capacity == 0)
+            Rehash(MIN_HASH_INDEX_CAPACITY);
+        else
+            Rehash(isGrow ? capacity * 2 : capacity);
+    }
+
+    const uint32 mask = GetMask();
+    uint32       i    = (uint32)hash & mask;
+
+    while (slots_[i].state == SLOT_USED)
+        i = (i + 1) & mask;
+
+    Slot& slot = slots_[i];
+
+    if (slot.state == SLOT_DELETED)
+        numDeleted_--;
+
+    slot.hash  = hash;
+    slot.value = value;
+    slot.state = SLOT_USED;
+    numUsed_++;
+}
+
+//---------------------------------------------------------
+// Desc:   remove a pair [hash => value] from the index
+// Ret:    false if there is no such a pair
+//---------------------------------------------------------
+bool StrHashIndex::Erase(const uint64 hash, const uint32 value)
+{
+    if (numUsed_ == 0)
+        return false;
+
+    const uint32 mask = GetMask();
+
+    for (uint32 i = (uint32)hash & mask; ; i = (i + 1) & mask)
+    {
+        Slot& slot = slots_[i];
+
+        if (slot.state == SLOT_EMPTY)
+            return false;
+
+        if (slot.state == SLOT_USED && slot.hash == hash && slot.value == value)
+        {
+            slot.state = SLOT_DELETED;
+            numUsed_--;
+            numDeleted_++;
+            return true;
+        }
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   realloc slots and reinsert all the elements
+//         (stored hashes are used so names aren't touched)
+//---------------------------------------------------------
+void StrHashIndex::Rehash(const int newCapacity)
+{
+    cvector<Slot> oldSlots(std::move(slots_));
+
+    slots_.resize(newCapacity);
+
+    for (Slot& slot : slots_)
+        slot = Slot();
+
+    const uint32 mask = GetMask();
+
+    for (const Slot& old : oldSlots)
+    {
+        if (old.state != SLOT_USED)
+            continue;
+
+        uint32 i = (uint32)old.hash & mask;
+
+        while (slots_[i].state == SLOT_USED)
+            i = (i + 1) & mask;
+
+        slots_[i] = old;
+    }
+
+    numDeleted_ = 0;
+}
@@ -0,0 +1,126 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: str_hash_index.h
+    Desc:     an open-addressing hash index [name => 32-bit value (usually an ID)]
+              which is used by managers/systems for fast search by names:
+
+              - the index doesn't own strings: each slot keeps only a hash
+                of name and a value, a caller provides a function to compare
+                the name by value (so there are no false matches by hash);
+              - hashes are stored in slots so rehashing on growth doesn't
+                touch strings at all;
+              - linear probing, power of 2 capacity, max load factor 0.5;
+              - removed slots are marked as deleted (tombstones) and are reused
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include "Types.h"
+#include "cvector.h"
+
+
+//---------------------------------------------------------
+// Desc:   compute a hash of a string (64-bit FNV-1a);
+//         since it is constexpr hashes of string literals can be precomputed
+//---------------------------------------------------------
+constexpr uint64 HashStr(const char* str)
+{
+    uint64 hash = 14695981039346656037ull;
+
+    for (; *str; ++str)
+    {
+        hash ^= (uint8)*str;
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+//---------------------------------------------------------
+
+class StrHashIndex
+{
+public:
+    StrHashIndex() {}
+
+    void Reserve(const int numElems);
+    void Clear();
+
+    void Insert(const uint64 hash, const uint32 value);
+    bool Erase (const uint64 hash, const uint32 value);
+
+    // find a value which name has input hash and for which isEqual(value) == true
+    template <typename EqualFunc>
+    bool Find(const uint64 hash, EqualFunc isEqual, uint32& outValue) const;
+
+    inline int Size() const { return numUsed_; }
+
+private:
+    enum eSlotState : uint32
+    {
+        SLOT_EMPTY,
+        SLOT_USED,
+        SLOT_DELETED,
+    };
+
+    struct Slot
+    {
+        uint64     hash  = 0;
+        uint32     value = 0;
+        eSlotState state = SLOT_EMPTY;
+    };
+
+    void Rehash(const int newCapacity);
+
+    inline uint32 GetMask() const { return (uint32)slots_.size() - 1; }
+
+private:
+    cvector<Slot> slots_;
+    int           numUsed_    = 0;
+    int           numDeleted_ = 0;
+};
+
+
+//==================================================================================
+// inline functions
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   find a value by hash of name; since different names can have
+//         the same hash, each candidate is checked with the input function
+// Args:   - hash:     hash of the name (see HashStr)
+//         - isEqual:  bool(uint32 value): check if name of value is searched one
+// Out:    - outValue: a found value
+// Ret:    true if we found anything
+//---------------------------------------------------------
+template <typename EqualFunc>
+bool StrHashIndex::Find(const uint64 hash, EqualFunc isEqual, uint32& outValue) const
+{
+    if (numUsed_ == 0)
+        return false;
+
+    const uint32 mask = GetMask();
+
+    for (uint32 i = (uint32)hash & mask; ; i = (i + 1) & mask)
+    {
+        const Slot& slot = slots_[i];
+
+        if (slot.state == SLOT_EMPTY)
+            return false;
+
+        if (slot.state == SLOT_USED && slot.hash == hash && isEqual(slot.value))
+        {
+            outValue = slot.value;
+            return true;
+        }
+    }
+}